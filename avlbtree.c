@@ -0,0 +1,631 @@
+#include "avlbtree.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+	#include <immintrin.h>
+#endif
+
+
+
+/* Takes a new, empty B+ tree node from heap, aligned to a cache line */
+static struct AVLbnode* avl_bnodeAlloc(char leaf, char type){
+	
+	struct AVLbnode *node = aligned_alloc(64, (sizeof(struct AVLbnode) + 63) & ~(size_t)63);
+	memset(node->lead, 0, sizeof(node->lead));
+	node->prev = node->next = NULL;
+	node->count = 0;
+	node->leaf = leaf;
+	node->type = type;
+	
+	
+	return node;
+	
+}
+
+
+
+/* Copies a key to be owned by a node, i.e. strings into heap */
+static inline union AVLkey avl_bkeyCopy(char type, union AVLkey key){
+	if(type == 'c')
+		key.string = strcpy(malloc(strlen(key.string)+1), key.string);
+	return key;
+}
+
+
+
+/* 	Maps a key into a signed 64 bits lead, in the same order as keys: exactly for
+	integers, and not strictly for reals, rounded to double, and strings, cut to
+	their prefix. Unsigned ones and prefixes get their upper bit flipped, and
+	negative doubles all others, so they're ordered as signed integers */
+static inline long long avl_bkeyLead(char type, const union AVLkey* key){
+	
+	union { double real; long long bits; } d;
+	
+	
+	switch(type){
+		
+		case 'i': return key->integer;
+		case 'u': return (long long)(key->uinteger ^ 1ULL << 63);
+		
+		case 'd':
+			d.real = (double)key->real + 0.0;
+			return d.bits ^ (long long)((unsigned long long)(d.bits >> 63) >> 1);
+		
+	}
+	
+	
+	return (long long)(key->prefix ^ 1ULL << 63);
+	
+}
+
+
+
+/* Sets key at index of node, along with its lead */
+static inline void avl_bkeySet(struct AVLbnode* node, int index, union AVLkey key){
+	node->keys[index] = key;
+	node->lead[index] = avl_bkeyLead(node->type, &key);
+}
+
+
+
+/* Moves n keys of src, from index si, to index di of dst, along with their leads */
+static inline void avl_bkeyMove(struct AVLbnode* dst, int di, struct AVLbnode* src, int si, int n){
+	memmove(&dst->keys[di], &src->keys[si], n*sizeof(union AVLkey));
+	memmove(&dst->lead[di], &src->lead[si], n*sizeof(long long));
+}
+
+
+
+/* 	Gets, into lt and le, how many of the first count leads are lesser than
+	lead, and not greater than it, comparing one lead at a time */
+static void avl_bleadRankScalar(const long long* leads, int count, long long lead, int* lt, int* le){
+	
+	int i;
+	*lt = *le = 0;
+	
+	for(i = 0; i < count; i++){
+		*lt += leads[i] < lead;
+		*le += leads[i] <= lead;
+	}
+	
+}
+
+
+
+#if defined(__x86_64__) || defined(__i386__)
+
+/* 	Same as avl_bleadRankScalar(), but comparing all AVL_BTREE_ORDER leads at
+	once, 2 per SSE4.2 compare, and counting the bits of those within count */
+__attribute__((target("sse4.2,popcnt")))
+static void avl_bleadRankSSE42(const long long* leads, int count, long long lead, int* lt, int* le){
+	
+	__m128i key = _mm_set1_epi64x(lead), v;
+	unsigned int gt = 0, eq = 0, mask = (1u << count) - 1;
+	int i;
+	
+	for(i = 0; i < AVL_BTREE_ORDER; i += 2){
+		v = _mm_load_si128((const __m128i*)&leads[i]);
+		gt |= (unsigned int)_mm_movemask_pd(_mm_castsi128_pd(_mm_cmpgt_epi64(key, v))) << i;
+		eq |= (unsigned int)_mm_movemask_pd(_mm_castsi128_pd(_mm_cmpeq_epi64(key, v))) << i;
+	}
+	
+	*lt = __builtin_popcount(gt & mask);
+	*le = __builtin_popcount((gt | eq) & mask);
+	
+}
+
+
+
+/* Same as avl_bleadRankSSE42(), but 4 leads per AVX2 compare */
+__attribute__((target("avx2,popcnt")))
+static void avl_bleadRankAVX2(const long long* leads, int count, long long lead, int* lt, int* le){
+	
+	__m256i key = _mm256_set1_epi64x(lead), v;
+	unsigned int gt = 0, eq = 0, mask = (1u << count) - 1;
+	int i;
+	
+	for(i = 0; i < AVL_BTREE_ORDER; i += 4){
+		v = _mm256_load_si256((const __m256i*)&leads[i]);
+		gt |= (unsigned int)_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(key, v))) << i;
+		eq |= (unsigned int)_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(key, v))) << i;
+	}
+	
+	*lt = __builtin_popcount(gt & mask);
+	*le = __builtin_popcount((gt | eq) & mask);
+	
+}
+
+#endif
+
+
+
+/* 	Lead ranking kernel searches use, picked by the first one. Threads searching
+	at once may all pick it, though the same one, so it's loaded and stored atomically */
+static void (*avl_bleadKernel)(const long long*, int, long long, int*, int*);
+
+
+
+/* Picks the widest lead ranking kernel this CPU runs, as CPUID tells */
+static void (*avl_bleadPick(void))(const long long*, int, long long, int*, int*){
+	
+#if defined(__x86_64__) || defined(__i386__)
+	__builtin_cpu_init();
+	if(__builtin_cpu_supports("avx2")) return avl_bleadRankAVX2;
+	if(__builtin_cpu_supports("sse4.2")) return avl_bleadRankSSE42;
+#endif
+	
+	
+	return avl_bleadRankScalar;
+	
+}
+
+
+
+/* 	Gets how many of node's keys are lesser than key or,
+	if 'upper' is set, how many are not greater than it */
+static int avl_bnodeFind(struct AVLbnode* node, char type, const union AVLkey* key, int upper){
+	
+	void (*rank)(const long long*, int, long long, int*, int*) = __atomic_load_n(&avl_bleadKernel, __ATOMIC_RELAXED);
+	int lo, hi, mid, eval;
+	if(!rank) __atomic_store_n(&avl_bleadKernel, rank = avl_bleadPick(), __ATOMIC_RELAXED);
+	
+	
+	/* 	Children or datas are read right after, at whichever index key
+		ranks, so their lines are fetched meanwhile, rather than after */
+	for(mid = 0; mid < (int)sizeof(node->children); mid += 64)
+		__builtin_prefetch((char*)node->children + mid);
+	
+	
+	/* Ranks key's lead among node's leads, which are exact for integers */
+	rank(node->lead, node->count, avl_bkeyLead(type, key), &lo, &hi);
+	if(type == 'i' || type == 'u') return upper ? hi : lo;
+	
+	
+	/* 	Otherwise, only keys with the same lead as key's, between
+		lo and hi, are compared in full, by binary search */
+	while(lo < hi){
+		mid = (lo + hi)/2;
+		eval = avl_keyCompare(type, &node->keys[mid], key);
+		
+		if(eval < 0 || (upper && !eval)) lo = mid+1;
+		else hi = mid;
+	}
+	
+	
+	return lo;
+	
+}
+
+
+
+/* 	Puts key at index of node, along with either its data, if
+	node is a leaf, or its right child, if node is an inner one */
+static void avl_bnodePut(struct AVLbnode* node, int index, union AVLkey key, void* ptr){
+	
+	int after = node->count - index;
+	
+	
+	avl_bkeyMove(node, index+1, node, index, after);
+	avl_bkeySet(node, index, key);
+	
+	if(node->leaf){
+		memmove(&node->data[index+1], &node->data[index], after*sizeof(void*));
+		node->data[index] = ptr;
+	} else {
+		memmove(&node->children[index+2], &node->children[index+1], after*sizeof(struct AVLbnode*));
+		node->children[index+1] = ptr;
+	}
+	
+	node->count++;
+	
+}
+
+
+
+/* 	Takes key at index out of node, along with either its data, if
+	node is a leaf, or its right child, if node is an inner one */
+static void avl_bnodeCut(struct AVLbnode* node, int index){
+	
+	int after = node->count - index - 1;
+	
+	
+	avl_bkeyMove(node, index, node, index+1, after);
+	
+	if(node->leaf)
+		memmove(&node->data[index], &node->data[index+1], after*sizeof(void*));
+	else
+		memmove(&node->children[index+1], &node->children[index+2], after*sizeof(struct AVLbnode*));
+	
+	node->count--;
+	
+}
+
+
+
+/* 	Moves node's upper half into a new right sibling, and gives the key
+	that separates them: a copy of the sibling's first one, for leaves,
+	or the middle one, which leaves the node, for inner nodes */
+static struct AVLbnode* avl_bnodeSplit(struct AVLbnode* node, union AVLkey* sep){
+	
+	struct AVLbnode *right = avl_bnodeAlloc(node->leaf, node->type);
+	int half = node->count/2;
+	
+	
+	if(node->leaf){
+		right->count = node->count - half;
+		avl_bkeyMove(right, 0, node, half, right->count);
+		memcpy(right->data, &node->data[half], right->count*sizeof(void*));
+		*sep = avl_bkeyCopy(node->type, right->keys[0]);
+		
+		/* The new leaf goes right after node into the leaves' list */
+		right->prev = node;
+		right->next = node->next;
+		if(node->next) node->next->prev = right;
+		node->next = right;
+	} else {
+		right->count = node->count - half - 1;
+		avl_bkeyMove(right, 0, node, half+1, right->count);
+		memcpy(right->children, &node->children[half+1], (right->count+1)*sizeof(struct AVLbnode*));
+		*sep = node->keys[half];
+	}
+	
+	node->count = half;
+	
+	
+	return right;
+	
+}
+
+
+
+/* 	Moves all of right's keys into left, its left sibling, along with 'sep'
+	key that separated them into parent, then frees right */
+static void avl_bnodeMerge(struct AVLbnode* parent, int sep, struct AVLbnode* left, struct AVLbnode* right){
+	
+	/* 	Leaves just drop the separator and unlink right from the leaves' list,
+		while inner nodes take it down, between both nodes' keys */
+	if(left->leaf){
+		if(left->type == 'c') free(parent->keys[sep].string);
+		memcpy(&left->data[left->count], right->data, right->count*sizeof(void*));
+		
+		left->next = right->next;
+		if(right->next) right->next->prev = left;
+	} else {
+		avl_bkeyMove(left, left->count++, parent, sep, 1);
+		memcpy(&left->children[left->count], right->children, (right->count+1)*sizeof(struct AVLbnode*));
+	}
+	
+	avl_bkeyMove(left, left->count, right, 0, right->count);
+	left->count += right->count;
+	
+	
+	/* Takes separator and right out of parent */
+	avl_bnodeCut(parent, sep);
+	free(right);
+	
+}
+
+
+
+/* 	Moves a key from one of node's siblings into node, by way of
+	parent's 'sep' key that separates them. If 'left' is set, its
+	left sibling's last key goes in, otherwise, its right's first */
+static void avl_bnodeBorrow(struct AVLbnode* parent, int sep, struct AVLbnode* node, struct AVLbnode* sibling, int left){
+	
+	if(node->leaf){
+		
+		/* 	Leaves move the key with its data, then
+			a copy of the right one's first key is the new separator */
+		if(left){
+			avl_bnodePut(node, 0, sibling->keys[sibling->count-1], sibling->data[sibling->count-1]);
+			sibling->count--;
+		} else {
+			avl_bnodePut(node, node->count, sibling->keys[0], sibling->data[0]);
+			avl_bnodeCut(sibling, 0);
+		}
+		
+		if(node->type == 'c') free(parent->keys[sep].string);
+		avl_bkeySet(parent, sep, avl_bkeyCopy(node->type, left ? node->keys[0] : sibling->keys[0]));
+		return;
+		
+	}
+	
+	
+	/* 	Inner nodes rotate keys through parent: the separator comes down
+		into node, and sibling's key goes up in its place, its child
+		moving over to node */
+	if(left){
+		avl_bkeyMove(node, 1, node, 0, node->count);
+		memmove(&node->children[1], node->children, (node->count+1)*sizeof(struct AVLbnode*));
+		avl_bkeyMove(node, 0, parent, sep, 1);
+		node->children[0] = sibling->children[sibling->count];
+		avl_bkeyMove(parent, sep, sibling, sibling->count-1, 1);
+		sibling->count--;
+	} else {
+		avl_bkeyMove(node, node->count, parent, sep, 1);
+		node->children[node->count+1] = sibling->children[0];
+		avl_bkeyMove(parent, sep, sibling, 0, 1);
+		avl_bkeyMove(sibling, 0, sibling, 1, sibling->count-1);
+		memmove(sibling->children, &sibling->children[1], sibling->count*sizeof(struct AVLbnode*));
+		sibling->count--;
+	}
+	
+	node->count++;
+	
+}
+
+
+
+void avl_btreeInsert(struct AVLbnode** root, char type, union AVLkey key, void* data){
+	
+	/* Nodes on the way down, and which of their children was taken */
+	struct AVLbnode *path[AVL_BTREE_HEIGHT], *node, *right;
+	int slot[AVL_BTREE_HEIGHT], depth = 0, index;
+	union AVLkey sep;
+	if(!*root) *root = avl_bnodeAlloc(1, type);
+	
+	
+	/* 	Goes down to the leaf where key belongs, after any equal
+		key, i.e. into the child past all keys not greater than it */
+	for(node = *root; !node->leaf; node = node->children[index]){
+		index = avl_bnodeFind(node, type, &key, 1);
+		path[depth] = node;
+		slot[depth++] = index;
+	}
+	
+	
+	/* Puts key and data into the leaf, copying strings into heap */
+	avl_bnodePut(node, avl_bnodeFind(node, type, &key, 1), avl_bkeyCopy(type, key), data);
+	
+	
+	/* 	While a node fills up, splits it in halves, putting the key
+		between them into its parent, or into a new root over both */
+	while(node->count == AVL_BTREE_ORDER){
+		right = avl_bnodeSplit(node, &sep);
+		
+		if(!depth){
+			*root = avl_bnodeAlloc(0, type);
+			(*root)->children[0] = node;
+			avl_bnodePut(*root, 0, sep, right);
+			return;
+		}
+		
+		node = path[--depth];
+		avl_bnodePut(node, slot[depth], sep, right);
+	}
+	
+}
+
+
+
+int avl_btreeLowerBound(struct AVLbnode* root, char type, union AVLkey key, struct AVLbnode** leaf, int* index){
+	
+	struct AVLbnode *node = root;
+	int i;
+	*leaf = NULL;
+	if(!node) return 0;
+	
+	
+	/* Goes down into the child past all keys lesser than key, the leftmost one key may be into */
+	while(!node->leaf)
+		node = node->children[avl_bnodeFind(node, type, &key, 0)];
+	
+	
+	/* 	If all keys of the leaf are lesser than key, the next
+		leaf's first one is not, for it's past a greater separator */
+	if((i = avl_bnodeFind(node, type, &key, 0)) == node->count){
+		node = node->next;
+		i = 0;
+	}
+	
+	*leaf = node;
+	*index = i;
+	
+	
+	return node != NULL;
+	
+}
+
+
+
+int avl_btreeSearch(struct AVLbnode* root, char type, union AVLkey key, struct AVLbnode** leaf, int* index){
+	
+	/* Key is found if the first key not lesser than it is not greater either */
+	return avl_btreeLowerBound(root, type, key, leaf, index) &&
+		   !avl_keyCompare(type, &(*leaf)->keys[*index], &key);
+	
+}
+
+
+
+int avl_btreeRemove(struct AVLbnode** root, char type, union AVLkey key){
+	
+	/* Nodes on the way down, and which of their children was taken */
+	struct AVLbnode *path[AVL_BTREE_HEIGHT], *node, *parent, *left, *right;
+	int slot[AVL_BTREE_HEIGHT], depth = 0, index, s;
+	if(!*root) return 0;
+	
+	
+	/* Goes down to the leftmost leaf key may be into */
+	for(node = *root; !node->leaf; node = node->children[index]){
+		index = avl_bnodeFind(node, type, &key, 0);
+		path[depth] = node;
+		slot[depth++] = index;
+	}
+	
+	
+	/* 	If all keys of the leaf are lesser than key, it may only be
+		the next leaf's first one, so the path moves on to that leaf */
+	if((index = avl_bnodeFind(node, type, &key, 0)) == node->count){
+		while(depth && slot[depth-1] == path[depth-1]->count) depth--;
+		if(!depth) return 0;
+		
+		node = path[depth-1]->children[++slot[depth-1]];
+		for(; !node->leaf; node = node->children[0]){
+			path[depth] = node;
+			slot[depth++] = 0;
+		}
+		index = 0;
+	}
+	
+	if(avl_keyCompare(type, &node->keys[index], &key)) return 0;
+	
+	
+	/* Frees key's data and ID, if it's a string, and takes it out of the leaf */
+	if(type == 'c') free(node->keys[index].string);
+	free(node->data[index]);
+	avl_bnodeCut(node, index);
+	
+	
+	/* 	While a node is left too empty, it borrows a key from a sibling
+		that can spare one, or else it's merged with a sibling, which
+		takes a key out of their parent */
+	for(; depth && node->count < AVL_BTREE_MIN; node = parent){
+		parent = path[--depth];
+		s = slot[depth];
+		left = (s > 0) ? parent->children[s-1] : NULL;
+		right = (s < parent->count) ? parent->children[s+1] : NULL;
+		
+		if(left && left->count > AVL_BTREE_MIN) avl_bnodeBorrow(parent, s-1, node, left, 1);
+		else if(right && right->count > AVL_BTREE_MIN) avl_bnodeBorrow(parent, s, node, right, 0);
+		else if(left) avl_bnodeMerge(parent, s-1, left, node);
+		else avl_bnodeMerge(parent, s, node, right);
+	}
+	
+	
+	/* 	A root left without keys is freed: an inner one's
+		only child becomes the root, and a leaf empties it */
+	if(!(node = *root)->count){
+		*root = node->leaf ? NULL : node->children[0];
+		free(node);
+	}
+	
+	
+	return 1;
+	
+}
+
+
+
+long avl_btreeTraverse(void** ID, void** data, long n, struct AVLbnode* root){
+	
+	struct AVLbnode *leaf = root;
+	long c = 0;
+	int i;
+	if(!leaf) return 0;
+	
+	
+	/* Goes down to the first leaf, then through the leaves' list */
+	while(!leaf->leaf) leaf = leaf->children[0];
+	
+	for(; leaf && c < n; leaf = leaf->next){
+		for(i = 0; i < leaf->count && c < n; i++, c++){
+			if(ID) ID[c] = avl_btreeID(leaf, i);
+			if(data) data[c] = leaf->data[i];
+		}
+	}
+	
+	
+	return c;
+	
+}
+
+
+
+/* 	Checks node's subtree, whose keys must be between lo and hi, if not NULL,
+	and whose leaves must follow 'last' leaf in the leaves' list, then returns
+	its height, or -1 if it's inconsistent */
+static long avl_bnodeVerify(struct AVLbnode* node, int isRoot, const union AVLkey* lo, const union AVLkey* hi, struct AVLbnode** last){
+	
+	long height = -2, h;
+	int i;
+	
+	
+	if(node->count >= AVL_BTREE_ORDER || (!isRoot && node->count < AVL_BTREE_MIN) || node->count < !node->leaf)
+		return -1;
+	
+	for(i = 0; i < node->count; i++){
+		if(node->lead[i] != avl_bkeyLead(node->type, &node->keys[i])) return -1;
+		if(i && avl_keyCompare(node->type, &node->keys[i-1], &node->keys[i]) > 0) return -1;
+		if(lo && avl_keyCompare(node->type, lo, &node->keys[i]) > 0) return -1;
+		if(hi && avl_keyCompare(node->type, &node->keys[i], hi) > 0) return -1;
+	}
+	
+	
+	/* A leaf must come right after the last one checked */
+	if(node->leaf){
+		if(node->prev != *last || (*last && (*last)->next != node)) return -1;
+		*last = node;
+		return 1;
+	}
+	
+	
+	/* Every child must be consistent, between its separators, and as high as the others */
+	for(i = 0; i <= node->count; i++){
+		h = avl_bnodeVerify(node->children[i], 0, i ? &node->keys[i-1] : lo, (i < node->count) ? &node->keys[i] : hi, last);
+		if(h < 0 || (height != -2 && h != height)) return -1;
+		height = h;
+	}
+	
+	
+	return height+1;
+	
+}
+
+
+
+long avl_btreeVerify(struct AVLbnode* root){
+	
+	struct AVLbnode *last = NULL;
+	long height;
+	if(!root) return 0;
+	
+	
+	/* The last leaf must end the leaves' list */
+	height = avl_bnodeVerify(root, 1, NULL, NULL, &last);
+	return (height < 0 || last->next) ? -1 : height;
+	
+}
+
+
+
+int avl_btreeRank(char kernel, const long long* leads, int count, long long lead, int* lt, int* le){
+	
+	void (*rank)(const long long*, int, long long, int*, int*) = NULL;
+	
+	
+	/* Only kernels this build has, and this CPU runs, rank anything */
+	if(kernel == 's') rank = avl_bleadRankScalar;
+#if defined(__x86_64__) || defined(__i386__)
+	__builtin_cpu_init();
+	if(kernel == 'x' && __builtin_cpu_supports("sse4.2")) rank = avl_bleadRankSSE42;
+	if(kernel == 'a' && __builtin_cpu_supports("avx2")) rank = avl_bleadRankAVX2;
+#endif
+	if(!rank || count < 0 || count > AVL_BTREE_ORDER) return 0;
+	
+	
+	rank(leads, count, lead, lt, le);
+	return 1;
+	
+}
+
+
+
+void avl_btreeFree(struct AVLbnode* root){
+	
+	int i;
+	if(!root) return;
+	
+	
+	/* Frees every key that's a string, every data of a leaf and every child of an inner node */
+	for(i = 0; i < root->count; i++){
+		if(root->type == 'c') free(root->keys[i].string);
+		if(root->leaf) free(root->data[i]);
+	}
+	
+	if(!root->leaf)
+		for(i = 0; i <= root->count; i++) avl_btreeFree(root->children[i]);
+	
+	
+	free(root);
+	
+}
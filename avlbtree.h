@@ -0,0 +1,347 @@
+#ifndef __AVL_BTREE__
+#define __AVL_BTREE__
+
+
+
+#include "avltree.h"
+
+
+
+/* Number of key slots of a B+ tree node. Nodes split as they fill them up */
+#define AVL_BTREE_ORDER		16
+
+/* Fewest keys a B+ tree node other than the root holds, before it borrows or merges */
+#define AVL_BTREE_MIN		(AVL_BTREE_ORDER/2 - 1)
+
+/* Greatest height a B+ tree may reach, with every node but the root at least half full */
+#define AVL_BTREE_HEIGHT	24
+
+
+
+
+
+/**	@Description
+ *		This structure is a node of a B+ tree, the engine
+ *		of a super avl tree created with AVL_ENGINE_BTREE.
+ *
+ *		Instead of one ID and two children, it holds up to
+ *		AVL_BTREE_ORDER-1 IDs, sorted and contiguous, so a
+ *		search reads a few adjacent cache lines per level
+ *		rather than a whole line for every single ID, and
+ *		the tree is many times shorter than an avl tree.
+ *
+ *		Each ID has a lead as well, a 64 bits integer in the
+ *		same order as IDs, which fits SIMD compares: the lead
+ *		array is searched as a whole, with as many compares
+ *		at once as the CPU takes, and only IDs sharing key's
+ *		lead, if reals or strings, are compared one by one.
+ *
+ *		Only leaves hold datas. Inner nodes hold separator
+ *		IDs, each one not lesser than any ID to its left and
+ *		not greater than any ID to its right. Leaves are
+ *		linked both ways, so IDs in order are read leaf by
+ *		leaf, sequentially in memory.
+ *
+ *		Every ID of every node, separators included, owns its
+ *		heap allocated copy of the string, if it's one.
+ *
+ *	@Members
+ *		long long lead[]:				each ID's lead: the ID itself, for int_root;
+ *										with its upper bit flipped, for uint_root;
+ *										rounded to a double, whose bits are ordered
+ *										as an integer, for double_root; and the
+ *										prefix, with its upper bit flipped, for
+ *										string_root. Slots past count are ignored;
+ *
+ *		union AVLkey keys[]:			the node's IDs, in ascending order;
+ *
+ *		struct AVLbnode* children[]:	an inner node's children, one more than
+ *										its IDs. children[i] holds IDs not greater
+ *										than keys[i], and children[i+1] not lesser;
+ *
+ *		void* data[]:					a leaf's datas, each one along with the ID
+ *										at the same index;
+ *
+ *		struct AVLbnode* prev:			a leaf's previous leaf. NULL if it's the first;
+ *
+ *		struct AVLbnode* next:			a leaf's next leaf. NULL if it's the last;
+ *
+ *		short count:					how many IDs the node holds;
+ *
+ *		char leaf:						whether the node is a leaf;
+ *
+ *		char type:						root type of the node, as given by avl_getKeyType().
+ *
+ */
+struct AVLbnode{
+	
+	long long lead[AVL_BTREE_ORDER];
+	union AVLkey keys[AVL_BTREE_ORDER];
+	union {
+		struct AVLbnode *children[AVL_BTREE_ORDER+1];
+		void *data[AVL_BTREE_ORDER];
+	};
+	struct AVLbnode *prev;
+	struct AVLbnode *next;
+	short count;
+	char leaf;
+	char type;
+	
+};
+
+
+/**	@Description
+ *		This structure holds a B+ tree for each root type
+ *		of a super avl tree created with AVL_ENGINE_BTREE,
+ *		in place of its avl trees.
+ *
+ *	@Members
+ *		struct AVLbnode* int_root:		B+ tree of int & variations IDs. NULL while
+ *										it's empty, as all other roots;
+ *
+ *		struct AVLbnode* uint_root:		B+ tree of unsigned int & variations IDs;
+ *
+ *		struct AVLbnode* double_root:	B+ tree of float & variations IDs;
+ *
+ *		struct AVLbnode* string_root:	B+ tree of string IDs.
+ *
+ */
+struct AVLbtree{
+	
+	struct AVLbnode *int_root;
+	struct AVLbnode *uint_root;
+	struct AVLbnode *double_root;
+	struct AVLbnode *string_root;
+	
+};
+
+
+
+
+
+/**	@Functionality
+ *		Inserts an identifier, already converted into an
+ *		AVLkey, and data into a B+ tree: finds the leaf it
+ *		belongs to and puts it there, after any equal ID.
+ *		A leaf that fills up is split in halves, which
+ *		may split its parent, up to the root. If it's a
+ *		string, it's copied into the leaf, heap allocated.
+ *
+ *		This is a helper function of avl_insertKey() function.
+ *
+ *	@Arguments
+ *		struct AVLbnode** root:	a pointer to one of an AVLbtree structure's roots;
+ *
+ *		char type:				root type, as given by avl_getKeyType();
+ *
+ *		union AVLkey key:		the identifier, as given by avl_toKey();
+ *
+ *		void* data:				pointer to the data to be stored into the B+ tree.
+ *
+ *	@Return
+ *		None
+ *
+ */
+void avl_btreeInsert(struct AVLbnode** root, char type, union AVLkey key, void* data);
+
+
+
+/**	@Functionality
+ *		Finds the first ID of a B+ tree not lesser than
+ *		key, in a single descent from root to a leaf.
+ *
+ *	@Arguments
+ *		struct AVLbnode* root:	one of an AVLbtree structure's roots;
+ *
+ *		char type:				root type, as given by avl_getKeyType();
+ *
+ *		union AVLkey key:		the identifier, as given by avl_toKey();
+ *
+ *		struct AVLbnode** leaf:	pointer to where the leaf holding the found ID
+ *								is put, or NULL if there's none;
+ *
+ *		int* index:				pointer to where the found ID's index into
+ *								its leaf is put.
+ *
+ *	@Return
+ *		On success:	1
+ *
+ *		On failure:	0 (if every ID is lesser than key)
+ *
+ */
+int avl_btreeLowerBound(struct AVLbnode* root, char type, union AVLkey key, struct AVLbnode** leaf, int* index);
+
+
+
+/**	@Functionality
+ *		Searches an identifier, already converted into an
+ *		AVLkey, into a B+ tree.
+ *
+ *		This is a helper function of avl_searchData() function.
+ *
+ *	@Arguments
+ *		struct AVLbnode* root:	one of an AVLbtree structure's roots;
+ *
+ *		char type:				root type, as given by avl_getKeyType();
+ *
+ *		union AVLkey key:		the identifier, as given by avl_toKey();
+ *
+ *		struct AVLbnode** leaf:	pointer to where the leaf holding the ID is put;
+ *
+ *		int* index:				pointer to where the ID's index into its leaf is put.
+ *
+ *	@Return
+ *		On success:	1
+ *
+ *		On failure:	0 (if key is not found)
+ *
+ */
+int avl_btreeSearch(struct AVLbnode* root, char type, union AVLkey key, struct AVLbnode** leaf, int* index);
+
+
+
+/**	@Functionality
+ *		Searches an identifier, already converted into an
+ *		AVLkey, into a B+ tree and removes it, if found,
+ *		freeing its ID and data. A leaf left with fewer
+ *		than AVL_BTREE_MIN IDs borrows one from a sibling,
+ *		or is merged into it, which may go on up to the root.
+ *
+ *		This is a helper function of avl_removeKey() function.
+ *
+ *	@Arguments
+ *		struct AVLbnode** root:	a pointer to one of an AVLbtree structure's roots;
+ *
+ *		char type:				root type, as given by avl_getKeyType();
+ *
+ *		union AVLkey key:		the identifier, as given by avl_toKey().
+ *
+ *	@Return
+ *		On success:	1
+ *
+ *		On failure:	0 (if key is not found)
+ *
+ */
+int avl_btreeRemove(struct AVLbnode** root, char type, union AVLkey key);
+
+
+
+/**	@Functionality
+ *		Gets up to n IDs and datas of a B+ tree, starting
+ *		from its smallest ID, in ascending order, into
+ *		preallocated ID and data arrays, leaf by leaf.
+ *
+ *		This is a helper function of avl_traverseRoot() function.
+ *
+ *	@Arguments
+ *		void** ID:				an array of at least n void pointers, that will
+ *								store IDs, or NULL;
+ *
+ *		void** data:			an array of at least n void pointers, that will
+ *								store datas, or NULL;
+ *
+ *		long n:					how many IDs and datas, at most, to get;
+ *
+ *		struct AVLbnode* root:	one of an AVLbtree structure's roots.
+ *
+ *	@Return
+ *		How many IDs and datas were put into the arrays
+ *
+ */
+long avl_btreeTraverse(void** ID, void** data, long n, struct AVLbnode* root);
+
+
+
+/**	@Functionality
+ *		Checks whether a B+ tree is consistent: IDs sorted,
+ *		matching their leads and within their separators,
+ *		every node but the root at least AVL_BTREE_MIN IDs
+ *		full, all leaves at the same depth and linked in order.
+ *
+ *	@Argument
+ *		struct AVLbnode* root:	one of an AVLbtree structure's roots.
+ *
+ *	@Return
+ *		On success:	the B+ tree height, 0 if it's empty
+ *
+ *		On failure:	-1 (if any of the above doesn't hold)
+ *
+ */
+long avl_btreeVerify(struct AVLbnode* root);
+
+
+
+/**	@Functionality
+ *		Ranks lead among the first count of leads, as B+
+ *		tree searches do within a node, with one of the
+ *		kernels they pick from, whichever the CPU would
+ *		pick, so each one may be checked against the others.
+ *
+ *	@Arguments
+ *		char kernel:			's' for the scalar kernel, 'x' for the SSE4.2 one,
+ *								'a' for the AVX2 one;
+ *
+ *		const long long* leads:	AVL_BTREE_ORDER leads, aligned to 64 bytes, as a
+ *								node's are. Slots past count are ignored;
+ *
+ *		int count:				how many leads to rank lead among, up to
+ *								AVL_BTREE_ORDER;
+ *
+ *		long long lead:			the lead to rank;
+ *
+ *		int* lt:				pointer to where how many leads are lesser than
+ *								lead is put;
+ *
+ *		int* le:				pointer to where how many leads are not greater
+ *								than lead is put.
+ *
+ *	@Return
+ *		On success:	1
+ *
+ *		On failure:	0 (if this build or CPU has no such kernel, or count is
+ *					out of range)
+ *
+ */
+int avl_btreeRank(char kernel, const long long* leads, int count, long long lead, int* lt, int* le);
+
+
+
+/**	@Functionality
+ *		Frees a B+ tree, with all of its IDs and datas.
+ *
+ *		This is a helper function of avl_free() function.
+ *
+ *	@Argument
+ *		struct AVLbnode* root:	one of an AVLbtree structure's roots.
+ *
+ *	@Return
+ *		None
+ *
+ */
+void avl_btreeFree(struct AVLbnode* root);
+
+
+
+
+
+/* Gets a pointer to B+ tree's root of 'type', as given by avl_getKeyType() */
+static inline struct AVLbnode** avl_btreeRoot(struct AVLbtree* btree, char type){
+	switch(type){
+		case 'i': return &btree->int_root;
+		case 'u': return &btree->uint_root;
+		case 'd': return &btree->double_root;
+		case 'c': return &btree->string_root;
+	}
+	return NULL;
+}
+
+
+
+/* Gets the ID at index of a leaf, as avl_traverse() hands it out */
+static inline void* avl_btreeID(struct AVLbnode* leaf, int index){
+	return (leaf->type == 'c') ? (void*)leaf->keys[index].string : (void*)&leaf->keys[index];
+}
+
+
+
+#endif
@@ -0,0 +1,179 @@
+#include "avlfrozen.h"
+
+
+
+/* 	Puts sorted IDs and datas, from index j on, into the subtree of entry i,
+	in order: its left subtree, itself, then its right subtree. Returns
+	the index of the first ID left for the entries after it */
+static long avl_frozenPlace(struct AVLfrozen* frozen, void** ID, void** data, long j, long i){
+	
+	if(i > frozen->size) return j;
+	
+	
+	j = avl_frozenPlace(frozen, ID, data, j, 2*i);
+	
+	frozen->keys[i] = (frozen->type == 'c') ? avl_stringKey(ID[j]) : *(union AVLkey*)ID[j];
+	frozen->data[i] = data[j++];
+	
+	return avl_frozenPlace(frozen, ID, data, j, 2*i+1);
+	
+}
+
+
+
+struct AVLfrozen* avl_freezeRoot(struct AVLtree* tree, char type){
+	
+	struct AVLfrozen *frozen;
+	void **ID, **data;
+	char *string;
+	size_t length = 0;
+	long i, n = 0;
+	
+	
+	switch(type){
+		case 'i': n = tree->int_size; break;
+		case 'u': n = tree->uint_size; break;
+		case 'd': n = tree->double_size; break;
+		case 'c': n = tree->string_size; break;
+		default: return NULL;
+	}
+	
+	
+	/* Gets the root's IDs and datas in order, whichever its engine */
+	ID = malloc((n+1)*sizeof(void*));
+	data = malloc((n+1)*sizeof(void*));
+	n = avl_traverseRoot(tree, type, ID, data, n);
+	
+	
+	/* 	Copies all strings into a single block, so IDs then point into it,
+		rather than into the tree, which may change afterwards */
+	frozen = malloc(sizeof(struct AVLfrozen));
+	frozen->strings = NULL;
+	if(type == 'c'){
+		for(i = 0; i < n; i++) length += strlen(ID[i]) + 1;
+		string = frozen->strings = malloc(length);
+		
+		for(i = 0; i < n; i++){
+			length = strlen(ID[i]) + 1;
+			ID[i] = memcpy(string, ID[i], length);
+			string += length;
+		}
+	}
+	
+	
+	/* 	Lays them out in Eytzinger order, from index 1, as entry 0 is never
+		used. Keys are aligned to a cache line, so each one of them holds
+		a whole number of entries */
+	frozen->keys = aligned_alloc(64, ((n+1)*sizeof(union AVLkey) + 63) & ~(size_t)63);
+	frozen->data = malloc((n+1)*sizeof(void*));
+	frozen->size = n;
+	frozen->type = type;
+	avl_frozenPlace(frozen, ID, data, 0, 1);
+	
+	
+	free(ID);
+	free(data);
+	
+	
+	return frozen;
+	
+}
+
+
+
+/* 	Goes down from entry 1, to the right of every key lesser than key and to the
+	left otherwise, then back up past the right turns taken at the end, to the
+	last entry that turned left, which is the first key not lesser than key.
+	Always inlined with a constant type, so compares of numbers take no branch */
+static inline __attribute__((always_inline)) long avl_frozenDescend(struct AVLfrozen* frozen, char type, const union AVLkey* key){
+	
+	long i = 1;
+	
+	
+	/* 	Entry i's descendants three levels down are 8 contiguous entries,
+		two cache lines, fetched well before the search gets to them */
+	while(i <= frozen->size){
+		__builtin_prefetch(&frozen->keys[8*i]);
+		__builtin_prefetch(&frozen->keys[8*i+4]);
+		i = 2*i + (avl_keyCompare(type, &frozen->keys[i], key) < 0);
+	}
+	
+	
+	return i >> __builtin_ffsl(~i);
+	
+}
+
+
+
+long avl_frozenLowerBound(struct AVLfrozen* frozen, union AVLkey key){
+	
+	switch(frozen->type){
+		case 'i': return avl_frozenDescend(frozen, 'i', &key);
+		case 'u': return avl_frozenDescend(frozen, 'u', &key);
+		case 'd': return avl_frozenDescend(frozen, 'd', &key);
+	}
+	return avl_frozenDescend(frozen, 'c', &key);
+	
+}
+
+
+
+long avl_frozenSearchKey(struct AVLfrozen* frozen, union AVLkey key){
+	
+	/* Key is found if the first ID not lesser than it is not greater either */
+	long i = avl_frozenLowerBound(frozen, key);
+	return (i && !avl_keyCompare(frozen->type, &frozen->keys[i], &key)) ? i : 0;
+	
+}
+
+
+
+long avl_frozenNext(struct AVLfrozen* frozen, long index){
+	
+	/* Goes to the leftmost entry of index's right subtree, if it has one */
+	if(2*index+1 <= frozen->size){
+		for(index = 2*index+1; 2*index <= frozen->size; index *= 2);
+		return index;
+	}
+	
+	
+	/* Otherwise, goes up past every ancestor it's a right child of, then to the parent */
+	while(index & 1) index >>= 1;
+	return index >> 1;
+	
+}
+
+
+
+long avl_frozenRangeKey(struct AVLfrozen* frozen, union AVLkey lo, union AVLkey hi,
+						int (*callback)(void* ID, void* data, void* arg), void* arg){
+	
+	long i, c = 0;
+	
+	
+	/* Goes from the first ID not lesser than lo, in order, until one is greater than hi */
+	for(i = avl_frozenLowerBound(frozen, lo); i; i = avl_frozenNext(frozen, i)){
+		if(avl_keyCompare(frozen->type, &frozen->keys[i], &hi) > 0) break;
+		
+		c++;
+		if(callback((frozen->type == 'c') ? (void*)frozen->keys[i].string : (void*)&frozen->keys[i], frozen->data[i], arg))
+			break;
+	}
+	
+	
+	return c;
+	
+}
+
+
+
+void avl_frozenFree(struct AVLfrozen* frozen){
+	
+	if(!frozen) return;
+	
+	free(frozen->keys);
+	free(frozen->data);
+	free(frozen->strings);
+	free(frozen);
+	
+}
@@ -0,0 +1,286 @@
+#ifndef __AVL_FROZEN__
+#define __AVL_FROZEN__
+
+
+
+#include "avltree.h"
+
+
+
+
+
+/**	@Description
+ *		This structure is a frozen root: a read only copy
+ *		of one of a super avl tree's roots, with no pointer
+ *		between entries, whatever the root's engine.
+ *
+ *		IDs are laid out in BFS order of a perfectly balanced
+ *		tree, the Eytzinger layout: entry i's children are
+ *		entries 2i and 2i+1, starting from entry 1, the root.
+ *		A search then goes down from entry to entry with no
+ *		branch to mispredict, and the first levels, which
+ *		every search reads, sit together at the array's start.
+ *		Since an entry's descendants a few levels down are
+ *		also contiguous, they're prefetched in a single go.
+ *
+ *		It's created by avl_freeze() and must be freed with
+ *		avl_frozenFree(). Datas are shared with the super avl
+ *		tree it was frozen from, which still owns them, so it
+ *		must not be used after their IDs are removed from it.
+ *
+ *	@Members
+ *		union AVLkey* keys:		the IDs, in Eytzinger order, from index 1 to size.
+ *								String IDs point into strings;
+ *
+ *		void** data:			the datas, each one along with the ID at the
+ *								same index;
+ *
+ *		char* strings:			a single heap block holding a copy of every
+ *								string ID, one after another. NULL for other roots;
+ *
+ *		long size:				how many IDs there are;
+ *
+ *		char type:				root type the IDs came from, as given by
+ *								avl_getKeyType().
+ *
+ */
+struct AVLfrozen{
+	
+	union AVLkey *keys;
+	void **data;
+	char *strings;
+	long size;
+	char type;
+	
+};
+
+
+
+
+
+/**	@Functionality
+ *		Freezes one of a super avl tree's roots into an
+ *		AVLfrozen structure, allocated on heap: gets its
+ *		IDs in order, copies them into an array, laid out
+ *		in Eytzinger order, and their datas into another.
+ *
+ *		This is a helper function of avl_freeze() macro function.
+ *
+ *	@Arguments
+ *		struct AVLtree* tree:	a pointer to an AVLtree structure, a super avl tree,
+ *								properly created with avl_createTree() function;
+ *
+ *		char type:				which root to freeze, as given by avl_getKeyType().
+ *
+ *	@Return
+ *		On success:	a pointer to an AVLfrozen structure, allocated on heap
+ *
+ *		On failure:	NULL (if type is not a root type)
+ *
+ */
+struct AVLfrozen* avl_freezeRoot(struct AVLtree* tree, char type);
+
+
+
+/**	@Functionality
+ *		Finds the first ID of a frozen root not lesser
+ *		than key, going down through its entries without
+ *		branching.
+ *
+ *	@Arguments
+ *		struct AVLfrozen* frozen:	a pointer to an AVLfrozen structure, as given
+ *									by avl_freeze();
+ *
+ *		union AVLkey key:			the identifier, as given by avl_toKey().
+ *
+ *	@Return
+ *		On success:	the found ID's index into frozen's arrays
+ *
+ *		On failure:	0 (if every ID is lesser than key)
+ *
+ */
+long avl_frozenLowerBound(struct AVLfrozen* frozen, union AVLkey key);
+
+
+
+/**	@Functionality
+ *		Searches an identifier, already converted into an
+ *		AVLkey, into a frozen root.
+ *
+ *		This is a helper function of avl_frozenSearch() macro function.
+ *
+ *	@Arguments
+ *		struct AVLfrozen* frozen:	a pointer to an AVLfrozen structure, as given
+ *									by avl_freeze();
+ *
+ *		union AVLkey key:			the identifier, as given by avl_toKey().
+ *
+ *	@Return
+ *		On success:	the ID's index into frozen's arrays
+ *
+ *		On failure:	0 (if key is not found)
+ *
+ */
+long avl_frozenSearchKey(struct AVLfrozen* frozen, union AVLkey key);
+
+
+
+/**	@Functionality
+ *		Gets the index of the ID right after the one
+ *		at index, in ascending order, by walking down
+ *		to the leftmost entry of its right subtree, or
+ *		up past the ancestors it's a right child of.
+ *
+ *	@Arguments
+ *		struct AVLfrozen* frozen:	a pointer to an AVLfrozen structure, as given
+ *									by avl_freeze();
+ *
+ *		long index:					index of an ID into frozen's arrays.
+ *
+ *	@Return
+ *		On success:	the next ID's index into frozen's arrays
+ *
+ *		On failure:	0 (if the ID at index is the greatest)
+ *
+ */
+long avl_frozenNext(struct AVLfrozen* frozen, long index);
+
+
+
+/**	@Functionality
+ *		Calls callback with ID, data and arg of every
+ *		entry of a frozen root from lo to hi, both
+ *		inclusive, in ascending order of IDs, until
+ *		callback returns non zero or the range is over.
+ *
+ *		This is a helper function of avl_frozenRange() macro function.
+ *
+ *	@Arguments
+ *		struct AVLfrozen* frozen:	a pointer to an AVLfrozen structure, as given
+ *									by avl_freeze();
+ *
+ *		union AVLkey lo:			the range's smallest identifier;
+ *
+ *		union AVLkey hi:			the range's greatest identifier;
+ *
+ *		int (*callback)():			function called with each ID, data and arg. It
+ *									returns non zero to stop the range early;
+ *
+ *		void* arg:					anything callback needs, passed along untouched.
+ *
+ *	@Return
+ *		Unconditionally:	how many times callback was called
+ *
+ */
+long avl_frozenRangeKey(struct AVLfrozen* frozen, union AVLkey lo, union AVLkey hi,
+						int (*callback)(void* ID, void* data, void* arg), void* arg);
+
+
+
+/**	@Functionality
+ *		Frees a frozen root, with its copies of the IDs,
+ *		but not its datas, which the super avl tree owns.
+ *
+ *	@Argument
+ *		struct AVLfrozen* frozen:	a pointer to an AVLfrozen structure, as given
+ *									by avl_freeze().
+ *
+ *	@Return
+ *		None
+ *
+ */
+void avl_frozenFree(struct AVLfrozen* frozen);
+
+
+
+
+
+/**	@Functionality
+ *		Freezes one of a super avl tree's roots into a
+ *		read only, pointer free copy, for trees built once
+ *		and then only searched, with avl_frozenSearch(),
+ *		and ranged over, with avl_frozenRange(). Searches
+ *		take no branches and half the memory of an avl tree.
+ *
+ *		The copy doesn't follow later changes of the tree.
+ *
+ *	@Arguments
+ *		struct AVLtree* root:	a pointer to an AVLtree structure, a super avl tree;
+ *
+ *		? type:					a primitive type to identify which root to freeze.
+ *
+ *	@Return
+ *		A pointer to an AVLfrozen structure, to be freed with
+ *		avl_frozenFree(), or NULL if type is not a primitive type
+ *
+ */
+#define avl_freeze(root, type)													\
+		avl_freezeRoot(root, avl_getKeyType(type))
+
+
+
+
+
+/**	@Functionality
+ *		Searches 'id' into a frozen root and, if found,
+ *		retrieves its data into DATA, or NULL otherwise.
+ *
+ *		'id' must be of the frozen root's own type.
+ *
+ *	@Arguments
+ *		struct AVLfrozen* frozen:	a pointer to an AVLfrozen structure, as given
+ *									by avl_freeze();
+ *
+ *		? id:						the identifier to search for;
+ *
+ *		? DATA:						a pointer to the data type expected to be
+ *									retrieved.
+ *
+ *	@Return
+ *		None, since it's a macro function, but alters what
+ *		DATA argument points to, when called
+ *
+ */
+#define avl_frozenSearch(frozen, id, DATA)										\
+		do {																	\
+																				\
+			/* Converts id into a key and searches for it */					\
+			long index = avl_frozenSearchKey(frozen, avl_toKey(id));			\
+			DATA = index ? (frozen)->data[index] : NULL;						\
+																				\
+		} while(0)
+
+
+
+
+
+/**	@Functionality
+ *		Calls callback with ID, data and arg of every
+ *		entry of a frozen root from lo to hi, both
+ *		inclusive, in ascending order of IDs, until
+ *		callback returns non zero.
+ *
+ *		'lo' and 'hi' must be of the frozen root's own type.
+ *
+ *	@Arguments
+ *		struct AVLfrozen* frozen:	a pointer to an AVLfrozen structure, as given
+ *									by avl_freeze();
+ *
+ *		? lo:						the smallest identifier of the range;
+ *
+ *		? hi:						the greatest identifier of the range;
+ *
+ *		int (*callback)():			function called with each ID, data and arg;
+ *
+ *		void* arg:					anything callback needs.
+ *
+ *	@Return
+ *		How many times callback was called
+ *
+ */
+#define avl_frozenRange(frozen, lo, hi, callback, arg)							\
+		avl_frozenRangeKey(frozen, avl_toKey(lo), avl_toKey(hi), callback, arg)
+
+
+
+#endif
@@ -0,0 +1,372 @@
+#include "avlgeneric.h"
+
+
+
+/* Gets the node at index i of a generic avl tree's slab */
+static inline struct AVLgnode* avl_gslabNode(struct AVLgtree* tree, struct AVLgslab* slab, long i){
+	return (struct AVLgnode*)(slab->nodes + i*tree->stride);
+}
+
+
+
+/* 	Puts 'new', which may be NULL, in 'old' place, either
+	as the root, whose parent is itself, or as its parent's child */
+static void avl_greplaceChild(struct AVLgtree* tree, struct AVLgnode* old, struct AVLgnode* new){
+	
+	if(old->parent == old){
+		if(new) new->parent = new;
+		tree->root = new;
+		return;
+	}
+	
+	if(new) new->parent = old->parent;
+	if(old->parent->Lchild == old) old->parent->Lchild = new;
+	else old->parent->Rchild = new;
+	
+}
+
+
+
+/* Rotates node 'l'eft or 'r'ight, as avl_rotate() does, and returns its child that took its place */
+static struct AVLgnode* avl_grotate(struct AVLgtree* tree, struct AVLgnode* node, char direction){
+	
+	struct AVLgnode *pivot;
+	
+	
+	if(direction == 'l'){
+		pivot = node->Rchild;
+		node->Rchild = pivot->Lchild;
+		if(node->Rchild) node->Rchild->parent = node;
+		pivot->Lchild = node;
+	} else {
+		pivot = node->Lchild;
+		node->Lchild = pivot->Rchild;
+		if(node->Lchild) node->Lchild->parent = node;
+		pivot->Rchild = node;
+	}
+	
+	avl_greplaceChild(tree, node, pivot);
+	node->parent = pivot;
+	
+	
+	if(direction == 'l'){
+		node->balance = node->balance - 1 - (pivot->balance > 0 ? pivot->balance : 0);
+		pivot->balance = pivot->balance - 1 + (node->balance < 0 ? node->balance : 0);
+	} else {
+		node->balance = node->balance + 1 - (pivot->balance < 0 ? pivot->balance : 0);
+		pivot->balance = pivot->balance + 1 + (node->balance > 0 ? node->balance : 0);
+	}
+	
+	
+	return pivot;
+	
+}
+
+
+
+/* Rotates an unbalanced node, twice if its taller child leans the other way, as avl_rebalance() does */
+static struct AVLgnode* avl_grebalance(struct AVLgtree* tree, struct AVLgnode* node){
+	
+	if(node->balance > 1){
+		if(node->Rchild->balance < 0) avl_grotate(tree, node->Rchild, 'r');
+		return avl_grotate(tree, node, 'l');
+	}
+	
+	if(node->balance < -1){
+		if(node->Lchild->balance > 0) avl_grotate(tree, node->Lchild, 'l');
+		return avl_grotate(tree, node, 'r');
+	}
+	
+	
+	return node;
+	
+}
+
+
+
+/* Rebalances node's ancestors from its 'side' on, which got shorter, as avl_balanceRemove() does */
+static void avl_gbalanceRemove(struct AVLgtree* tree, struct AVLgnode* node, char side){
+	
+	while(1){
+	
+		node->balance += (side == 'l') ? 1 : -1;
+		if(node->balance == 1 || node->balance == -1) return;
+	
+		if(node->balance){
+			node = avl_grebalance(tree, node);
+			if(node->balance) return;
+		}
+	
+		if(node->parent == node) return;
+		side = (node->parent->Lchild == node) ? 'l' : 'r';
+		node = node->parent;
+	
+	}
+	
+}
+
+
+
+struct AVLgtree* avl_createGeneric(size_t width, int (*compare)(const void*, const void*)){
+	
+	struct AVLgtree *tree = calloc(1, sizeof(struct AVLgtree));
+	
+	
+	/* Nodes end with their key, and each one starts 16 bytes aligned, as keys must */
+	tree->width = width;
+	tree->stride = (sizeof(struct AVLgnode) + width + 15) & ~(size_t)15;
+	tree->compare = compare;
+	
+	
+	return tree;
+	
+}
+
+
+
+struct AVLgnode* avl_genericAlloc(struct AVLgtree* tree, const void* key, void* data){
+	
+	struct AVLgslab *slab = tree->slabs;
+	struct AVLgnode *node;
+	long size;
+	
+	
+	/* Reuses a node given back by a removal, or takes the next one of the newest slab, or of a new one twice as big */
+	if((node = tree->freeNodes)) tree->freeNodes = node->Lchild;
+	else {
+		if(!slab || slab->used == slab->size){
+			size = slab ? slab->size*2 : AVL_SLAB_MIN;
+			if(size > AVL_SLAB_MAX) size = AVL_SLAB_MAX;
+	
+			slab = aligned_alloc(64, (sizeof(struct AVLgslab) + size*tree->stride + 63) & ~(size_t)63);
+			slab->next = tree->slabs;
+			slab->size = size;
+			slab->used = 0;
+			tree->slabs = slab;
+		}
+	
+		node = avl_gslabNode(tree, slab, slab->used++);
+	}
+	
+	
+	memset(node, 0, sizeof(struct AVLgnode));
+	memcpy(node->key, key, tree->width);
+	node->data = data;
+	return node;
+	
+}
+
+
+
+void avl_genericAttach(struct AVLgtree* tree, struct AVLgnode* parent, struct AVLgnode* node, char side){
+	
+	tree->size++;
+	
+	
+	/* Becomes the root, whose parent is itself, if the tree is empty */
+	if(!parent){
+		node->parent = node;
+		tree->root = node;
+		return;
+	}
+	
+	node->parent = parent;
+	if(side == 'r') parent->Rchild = node;
+	else parent->Lchild = node;
+	
+	
+	/* Goes up while node's subtree got taller, rotating the first ancestor that gets unbalanced */
+	for(; node->parent != node; node = parent){
+		parent = node->parent;
+		parent->balance += (parent->Lchild == node) ? -1 : 1;
+	
+		if(!parent->balance) return;
+		if(parent->balance > 1 || parent->balance < -1){
+			avl_grebalance(tree, parent);
+			return;
+		}
+	}
+	
+}
+
+
+
+void avl_genericInsert(struct AVLgtree* tree, const void* key, void* data){
+	
+	struct AVLgnode *parent = NULL, *node;
+	int right = 0;
+	
+	
+	/* Goes right if key is greater than node's, left otherwise, until there's no child */
+	for(node = tree->root; node; node = avl_genericChild(node, right)){
+		parent = node;
+		right = tree->compare(key, node->key) > 0;
+	}
+	
+	
+	avl_genericAttach(tree, parent, avl_genericAlloc(tree, key, data), right ? 'r' : 'l');
+	
+}
+
+
+
+struct AVLgnode* avl_genericSearch(struct AVLgtree* tree, const void* key){
+	
+	struct AVLgnode *node = tree->root;
+	int eval;
+	
+	
+	while(node){
+		eval = tree->compare(key, node->key);
+		if(__builtin_expect(!eval, 0)) return node;
+		node = avl_genericChild(node, eval > 0);
+	}
+	
+	
+	return NULL;
+	
+}
+
+
+
+struct AVLgnode* avl_genericLowerBound(struct AVLgtree* tree, const void* key){
+	
+	struct AVLgnode *node = tree->root, *found = NULL;
+	
+	
+	/* Every node not lesser than key is a candidate, and only lesser ones are on its left */
+	while(node){
+		if(tree->compare(key, node->key) > 0) node = node->Rchild;
+		else {
+			found = node;
+			node = node->Lchild;
+		}
+	}
+	
+	
+	return found;
+	
+}
+
+
+
+int avl_genericRemove(struct AVLgtree* tree, const void* key){
+	
+	struct AVLgnode *node = avl_genericSearch(tree, key);
+	if(node) avl_genericRemoveNode(tree, node);
+	
+	
+	return node != NULL;
+	
+}
+
+
+
+void avl_genericRemoveNode(struct AVLgtree* tree, struct AVLgnode* node){
+	
+	struct AVLgnode *i_node, *parent, *child;
+	char side;
+	tree->size--;
+	
+	
+	/* 	If node has both children, its biggest left child is unlinked
+		and takes node's place, with its children and balance */
+	if(node->Lchild && node->Rchild){
+	
+		for(i_node = node->Lchild; i_node->Rchild; i_node = i_node->Rchild);
+	
+		if(i_node == node->Lchild){
+			parent = i_node;
+			side = 'l';
+		} else {
+			parent = i_node->parent;
+			side = 'r';
+	
+			parent->Rchild = i_node->Lchild;
+			if(parent->Rchild) parent->Rchild->parent = parent;
+			i_node->Lchild = node->Lchild;
+			i_node->Lchild->parent = i_node;
+		}
+	
+		i_node->Rchild = node->Rchild;
+		i_node->Rchild->parent = i_node;
+		i_node->balance = node->balance;
+		avl_greplaceChild(tree, node, i_node);
+	
+	} else {
+	
+		/* Otherwise, its only child, if any, takes its place */
+		child = node->Lchild ? node->Lchild : node->Rchild;
+		parent = node->parent;
+		side = (parent->Lchild == node) ? 'l' : 'r';
+		avl_greplaceChild(tree, node, child);
+		if(parent == node) parent = NULL;
+	
+	}
+	
+	
+	/* 	Frees its data and gives it back to the free nodes. Having
+		no parent marks it as not in use for avl_genericFree() */
+	free(node->data);
+	node->data = NULL;
+	node->parent = NULL;
+	node->Lchild = tree->freeNodes;
+	tree->freeNodes = node;
+	
+	
+	/* Rebalances from where the tree got shorter */
+	if(parent) avl_gbalanceRemove(tree, parent, side);
+	
+}
+
+
+
+struct AVLgnode* avl_genericFirst(struct AVLgtree* tree){
+	
+	struct AVLgnode *node;
+	for(node = tree->root; node && node->Lchild; node = node->Lchild);
+	
+	
+	return node;
+	
+}
+
+
+
+struct AVLgnode* avl_genericNext(struct AVLgnode* node){
+	
+	/* If it has a right child, it's the smallest node under it */
+	if(node->Rchild){
+		for(node = node->Rchild; node->Lchild; node = node->Lchild);
+		return node;
+	}
+	
+	
+	/* Otherwise, it's the first ancestor from which node is on the left side */
+	while(node->parent != node && node->parent->Rchild == node) node = node->parent;
+	return (node->parent != node) ? node->parent : NULL;
+	
+}
+
+
+
+void avl_genericFree(struct AVLgtree* tree){
+	
+	struct AVLgslab *slab, *next;
+	long i;
+	
+	
+	/* Frees every slab, with datas of its nodes in use */
+	for(slab = tree->slabs; slab; slab = next){
+		next = slab->next;
+	
+		for(i = 0; i < slab->used; i++)
+			if(avl_gslabNode(tree, slab, i)->parent) free(avl_gslabNode(tree, slab, i)->data);
+	
+		free(slab);
+	}
+	
+	
+	free(tree);
+	
+}
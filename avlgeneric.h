@@ -0,0 +1,501 @@
+#ifndef __AVL_GENERIC__
+#define __AVL_GENERIC__
+
+
+
+#include <stddef.h>
+
+#include "avltree.h"
+
+
+
+
+
+/**	@Description
+ *		This structure is a node of a generic avl tree, one
+ *		whose IDs are keys of any fixed size, ordered by a
+ *		comparator, rather than the primitives of a super
+ *		avl tree's roots: structs, composite keys, or
+ *		primitives kept at their own width.
+ *
+ *		The key is copied right into the node, after its
+ *		links, so a search reads a single block per node.
+ *		Keys are copied byte by byte, so whatever they point
+ *		to, if anything, isn't.
+ *
+ *	@Members
+ *		struct AVLgnode* Lchild:	node's left child, with lesser or equal keys;
+ *
+ *		struct AVLgnode* Rchild:	node's right child, with greater keys;
+ *
+ *		struct AVLgnode* parent:	node's parent, or itself if it's the root.
+ *									NULL while it's not in a tree;
+ *
+ *		void* data:					pointer to the data stored along with the key;
+ *
+ *		char balance:				right subtree's height minus left subtree's;
+ *
+ *		unsigned char key[]:		the key, as many bytes as the tree's width,
+ *									aligned for any type.
+ *
+ */
+struct AVLgnode{
+	
+	struct AVLgnode *Lchild;
+	struct AVLgnode *Rchild;
+	struct AVLgnode *parent;
+	void *data;
+	char balance;
+	_Alignas(16) unsigned char key[];
+	
+};
+
+
+/**	@Description
+ *		This structure is a slab of a generic avl tree: a
+ *		single heap block holding many of its nodes, one
+ *		after another, as a super avl tree's slabs do.
+ *
+ *	@Members
+ *		struct AVLgslab* next:		pointer to the previously allocated slab.
+ *									NULL if it's the first one;
+ *
+ *		long size:					how many nodes this slab holds;
+ *
+ *		long used:					how many nodes, from the beginning of the
+ *									slab, have ever been handed out;
+ *
+ *		unsigned char nodes[]:		the nodes themselves, each one as many bytes
+ *									as the tree's stride.
+ *
+ */
+struct AVLgslab{
+	
+	struct AVLgslab *next;
+	long size;
+	long used;
+	_Alignas(64) unsigned char nodes[];
+	
+};
+
+
+/**	@Description
+ *		This structure is a generic avl tree, created by
+ *		avl_createGeneric(), or by a variant's Create()
+ *		function, generated by AVL_GENERIC_DEFINE().
+ *
+ *		Its own functions order keys by calling compare
+ *		through a pointer. Variants generated for a key type
+ *		go down the same tree with their comparator inlined,
+ *		so each compare is a few instructions, with no call,
+ *		while everything that doesn't compare, i.e. linking,
+ *		rebalancing and removing nodes, is shared.
+ *
+ *	@Members
+ *		struct AVLgnode* root:		the tree's root, NULL while it's empty;
+ *
+ *		long size:					how many nodes the tree holds;
+ *
+ *		size_t width:				how many bytes each key takes;
+ *
+ *		size_t stride:				how many bytes each node takes, its key
+ *									included, a multiple of 16;
+ *
+ *		int (*compare)():			the comparator, as qsort()'s: called with
+ *									pointers to two keys, it returns a negative
+ *									number, 0 or a positive one, if the first is
+ *									lesser than, equal to or greater than the second;
+ *
+ *		struct AVLgslab* slabs:		a pointer to the newest slab from which
+ *									nodes are taken;
+ *
+ *		struct AVLgnode* freeNodes:	a pointer to the first node given back by a
+ *									removal, chained through their Lchild member.
+ *
+ */
+struct AVLgtree{
+	
+	struct AVLgnode *root;
+	long size;
+	size_t width;
+	size_t stride;
+	int (*compare)(const void*, const void*);
+	struct AVLgslab *slabs;
+	struct AVLgnode *freeNodes;
+	
+};
+
+
+
+
+
+/**	@Functionality
+ *		Creates an empty generic avl tree allocated on heap,
+ *		whose keys take width bytes each, ordered by compare.
+ *
+ *		The tree must be freed afterwards using
+ *		avl_genericFree() function.
+ *
+ *	@Arguments
+ *		size_t width:			how many bytes each key takes, e.g. sizeof() of
+ *								its type;
+ *
+ *		int (*compare)():		the comparator, as qsort()'s.
+ *
+ *	@Return
+ *		Unconditionally:	a pointer to an AVLgtree structure, allocated on heap
+ *
+ */
+struct AVLgtree* avl_createGeneric(size_t width, int (*compare)(const void*, const void*));
+
+
+
+/**	@Functionality
+ *		Inserts a copy of key, along with data, into a
+ *		generic avl tree, before any equal key it holds.
+ *
+ *	@Arguments
+ *		struct AVLgtree* tree:	a pointer to an AVLgtree structure;
+ *
+ *		const void* key:		a pointer to the key, width bytes long;
+ *
+ *		void* data:				a pointer to the data to be stored, allocated on
+ *								heap, which the tree frees, or NULL.
+ *
+ *	@Return
+ *		None
+ *
+ */
+void avl_genericInsert(struct AVLgtree* tree, const void* key, void* data);
+
+
+
+/**	@Functionality
+ *		Searches key into a generic avl tree.
+ *
+ *	@Arguments
+ *		struct AVLgtree* tree:	a pointer to an AVLgtree structure;
+ *
+ *		const void* key:		a pointer to the key to search for.
+ *
+ *	@Return
+ *		On success:	a pointer to the node holding key, whose data member
+ *					is the data stored along with it
+ *
+ *		On failure:	NULL (if key is not found)
+ *
+ */
+struct AVLgnode* avl_genericSearch(struct AVLgtree* tree, const void* key);
+
+
+
+/**	@Functionality
+ *		Finds the first node of a generic avl tree whose key
+ *		isn't lesser than key, from which nodes in ascending
+ *		order are reached by avl_genericNext(). With composite
+ *		keys, that's how all keys sharing their first fields
+ *		are ranged over, searching for the smallest of them.
+ *
+ *	@Arguments
+ *		struct AVLgtree* tree:	a pointer to an AVLgtree structure;
+ *
+ *		const void* key:		a pointer to the key to search for.
+ *
+ *	@Return
+ *		On success:	a pointer to the found node
+ *
+ *		On failure:	NULL (if every key is lesser than key)
+ *
+ */
+struct AVLgnode* avl_genericLowerBound(struct AVLgtree* tree, const void* key);
+
+
+
+/**	@Functionality
+ *		Searches key into a generic avl tree and removes
+ *		its node, if found, freeing its data.
+ *
+ *	@Arguments
+ *		struct AVLgtree* tree:	a pointer to an AVLgtree structure;
+ *
+ *		const void* key:		a pointer to the key to remove.
+ *
+ *	@Return
+ *		On success:	1
+ *
+ *		On failure:	0 (if key is not found)
+ *
+ */
+int avl_genericRemove(struct AVLgtree* tree, const void* key);
+
+
+
+/**	@Functionality
+ *		Takes a node for a generic avl tree, from its free
+ *		nodes or slabs, and copies key and data into it. It's
+ *		not linked yet.
+ *
+ *		This is a helper function of avl_genericInsert() and
+ *		of every variant's Insert() function.
+ *
+ *	@Arguments
+ *		struct AVLgtree* tree:	a pointer to an AVLgtree structure;
+ *
+ *		const void* key:		a pointer to the key, width bytes long;
+ *
+ *		void* data:				a pointer to the data, or NULL.
+ *
+ *	@Return
+ *		Unconditionally:	a pointer to the node
+ *
+ */
+struct AVLgnode* avl_genericAlloc(struct AVLgtree* tree, const void* key, void* data);
+
+
+
+/**	@Functionality
+ *		Links a node, taken by avl_genericAlloc(), as the
+ *		'side' child of parent, where a descent found its
+ *		key belongs, or as the root, if parent is NULL, then
+ *		rebalances its ancestors, if needed.
+ *
+ *		This is a helper function of avl_genericInsert() and
+ *		of every variant's Insert() function.
+ *
+ *	@Arguments
+ *		struct AVLgtree* tree:		a pointer to an AVLgtree structure;
+ *
+ *		struct AVLgnode* parent:	the last node the descent went through, or NULL
+ *									if the tree is empty;
+ *
+ *		struct AVLgnode* node:		the node to link;
+ *
+ *		char side:					'l' or 'r', which of parent's children it becomes.
+ *
+ *	@Return
+ *		None
+ *
+ */
+void avl_genericAttach(struct AVLgtree* tree, struct AVLgnode* parent, struct AVLgnode* node, char side);
+
+
+
+/**	@Functionality
+ *		Removes a node from a generic avl tree, freeing its
+ *		data, and gives it back to the tree's free nodes,
+ *		then rebalances its ancestors, if needed. As with a
+ *		super avl tree, no other node has its key moved.
+ *
+ *		This is a helper function of avl_genericRemove() and
+ *		of every variant's Remove() function.
+ *
+ *	@Arguments
+ *		struct AVLgtree* tree:	a pointer to an AVLgtree structure;
+ *
+ *		struct AVLgnode* node:	the node to remove.
+ *
+ *	@Return
+ *		None
+ *
+ */
+void avl_genericRemoveNode(struct AVLgtree* tree, struct AVLgnode* node);
+
+
+
+/**	@Functionality
+ *		Gets the node of a generic avl tree with its
+ *		smallest key.
+ *
+ *	@Argument
+ *		struct AVLgtree* tree:	a pointer to an AVLgtree structure.
+ *
+ *	@Return
+ *		On success:	a pointer to the node
+ *
+ *		On failure:	NULL (if the tree is empty)
+ *
+ */
+struct AVLgnode* avl_genericFirst(struct AVLgtree* tree);
+
+
+
+/**	@Functionality
+ *		Gets the node of a generic avl tree right after
+ *		node, in ascending order of keys.
+ *
+ *	@Argument
+ *		struct AVLgnode* node:	a node of a generic avl tree.
+ *
+ *	@Return
+ *		On success:	a pointer to the next node
+ *
+ *		On failure:	NULL (if node is the tree's last one)
+ *
+ */
+struct AVLgnode* avl_genericNext(struct AVLgnode* node);
+
+
+
+/**	@Functionality
+ *		Frees a generic avl tree, with every data it holds.
+ *
+ *	@Argument
+ *		struct AVLgtree* tree:	a pointer to an AVLgtree structure.
+ *
+ *	@Return
+ *		None
+ *
+ */
+void avl_genericFree(struct AVLgtree* tree);
+
+
+
+
+
+/* 	Gets node's left child, if right is 0, or its right one, if 1, by its offset rather than
+	a branch, which would be mispredicted about every other time, since the way a descent
+	goes depends on the key, and compares inlined by variants are otherwise turned into one */
+static inline struct AVLgnode* avl_genericChild(struct AVLgnode* node, int right){
+	return *(struct AVLgnode**)((char*)node + offsetof(struct AVLgnode, Lchild)
+								+ right*(offsetof(struct AVLgnode, Rchild) - offsetof(struct AVLgnode, Lchild)));
+}
+
+
+
+
+
+/**	@Functionality
+ *		Compares two keys of any type ordered by the < and >
+ *		operators, through pointers to them, as qsort()'s
+ *		comparators do. The comparator of every primitive
+ *		variant below.
+ *
+ *	@Arguments
+ *		? a:	a pointer to the first key;
+ *
+ *		? b:	a pointer to the second key.
+ *
+ *	@Return
+ *		-1, 0 or 1, if a's key is lesser than, equal to or
+ *		greater than b's
+ *
+ */
+#define AVL_GENERIC_ORDER(a, b)													\
+		((*(a) > *(b)) - (*(a) < *(b)))
+
+
+
+
+
+/**	@Functionality
+ *		Generates a variant of generic avl trees for keys
+ *		of type K, whose functions are all named after name:
+ *
+ *			struct AVLgtree* nameCreate(void);
+ *			void nameInsert(struct AVLgtree* tree, K key, void* data);
+ *			struct AVLgnode* nameSearch(struct AVLgtree* tree, K key);
+ *			struct AVLgnode* nameLowerBound(struct AVLgtree* tree, K key);
+ *			int nameRemove(struct AVLgtree* tree, K key);
+ *			K* nameKey(struct AVLgnode* node);
+ *
+ *		They work as avl_createGeneric(), avl_genericInsert(),
+ *		avl_genericSearch(), avl_genericLowerBound() and
+ *		avl_genericRemove() do, but take keys by value, and
+ *		compare them with compare inlined, which is called
+ *		with pointers to two K keys, as qsort()'s comparators
+ *		are, and may be a static inline function, or a macro
+ *		such as AVL_GENERIC_ORDER. So a descent makes no call
+ *		at all, and the compiler sees what each compare does.
+ *
+ *		Trees created by nameCreate() are generic avl trees
+ *		as any other, compare being wrapped for their own
+ *		pointer, so avl_generic*() functions work on them as
+ *		well. They must only be used with the functions of
+ *		their own variant, though.
+ *
+ *		It's meant to be used once for each key type, at file
+ *		scope, and generates static inline functions only, so
+ *		it may be used in headers.
+ *
+ *	@Arguments
+ *		? name:		prefix of every generated function's name;
+ *
+ *		? K:		the key type: a primitive, or a struct;
+ *
+ *		? compare:	the comparator of two const K*.
+ *
+ *	@Return
+ *		None, since it's a macro function
+ *
+ */
+#define AVL_GENERIC_DEFINE(name, K, compare)									\
+																				\
+		static inline int name##Compare(const void* a, const void* b){			\
+			return compare((const K*)a, (const K*)b);							\
+		}																		\
+																				\
+		static inline struct AVLgtree* name##Create(void){						\
+			return avl_createGeneric(sizeof(K), name##Compare);					\
+		}																		\
+																				\
+		static inline K* name##Key(struct AVLgnode* node){						\
+			return (K*)node->key;												\
+		}																		\
+																				\
+		static inline void name##Insert(struct AVLgtree* tree, K key, void* data){	\
+			struct AVLgnode *parent = NULL, *node;								\
+			int right = 0;														\
+			for(node = tree->root; node; node = avl_genericChild(node, right)){	\
+				parent = node;													\
+				right = compare(&key, (const K*)node->key) > 0;					\
+			}																	\
+			avl_genericAttach(tree, parent, avl_genericAlloc(tree, &key, data), right ? 'r' : 'l');	\
+		}																		\
+																				\
+		static inline struct AVLgnode* name##Search(struct AVLgtree* tree, K key){	\
+			struct AVLgnode *node = tree->root;									\
+			int eval;															\
+			while(node){														\
+				eval = compare(&key, (const K*)node->key);						\
+				if(__builtin_expect(!eval, 0)) return node;						\
+				node = avl_genericChild(node, eval > 0);						\
+			}																	\
+			return NULL;														\
+		}																		\
+																				\
+		static inline struct AVLgnode* name##LowerBound(struct AVLgtree* tree, K key){	\
+			struct AVLgnode *node = tree->root, *found = NULL;					\
+			while(node){														\
+				if(compare(&key, (const K*)node->key) > 0) node = node->Rchild;	\
+				else {															\
+					found = node;												\
+					node = node->Lchild;										\
+				}																\
+			}																	\
+			return found;														\
+		}																		\
+																				\
+		static inline int name##Remove(struct AVLgtree* tree, K key){			\
+			struct AVLgnode *node = name##Search(tree, key);					\
+			if(node) avl_genericRemoveNode(tree, node);							\
+			return node != NULL;												\
+		}
+
+
+
+/* Variants for every primitive type, with keys kept at their own width */
+AVL_GENERIC_DEFINE(avl_char, signed char, AVL_GENERIC_ORDER)
+AVL_GENERIC_DEFINE(avl_short, short, AVL_GENERIC_ORDER)
+AVL_GENERIC_DEFINE(avl_int, int, AVL_GENERIC_ORDER)
+AVL_GENERIC_DEFINE(avl_long, long long, AVL_GENERIC_ORDER)
+AVL_GENERIC_DEFINE(avl_uchar, unsigned char, AVL_GENERIC_ORDER)
+AVL_GENERIC_DEFINE(avl_ushort, unsigned short, AVL_GENERIC_ORDER)
+AVL_GENERIC_DEFINE(avl_uint, unsigned int, AVL_GENERIC_ORDER)
+AVL_GENERIC_DEFINE(avl_ulong, unsigned long long, AVL_GENERIC_ORDER)
+AVL_GENERIC_DEFINE(avl_float, float, AVL_GENERIC_ORDER)
+AVL_GENERIC_DEFINE(avl_double, double, AVL_GENERIC_ORDER)
+AVL_GENERIC_DEFINE(avl_ldouble, long double, AVL_GENERIC_ORDER)
+
+
+
+#endif
@@ -0,0 +1,211 @@
+#include "avlhash.h"
+
+
+
+/* Scatters every bit of x over all of the others, so any slice of the result is as good as any other */
+static inline unsigned long long avl_hashMix(unsigned long long x){
+	
+	x ^= x >> 33;
+	x *= 0xff51afd7ed558ccdULL;
+	x ^= x >> 33;
+	x *= 0xc4ceb9fe1a85ec53ULL;
+	return x ^ (x >> 33);
+	
+}
+
+
+
+/* 	Hashes a key of 'type' root. Equal keys get equal hashes: reals are hashed as doubles,
+	with -0 as 0, and strings by their prefix, then 8 bytes at a time past it, if they're
+	any longer. The lower bits pick the slot, and the upper ones are kept in it */
+static unsigned long long avl_hashKey(char type, const union AVLkey* key){
+	
+	unsigned long long hash, word;
+	const char *string;
+	size_t length;
+	double real;
+	
+	
+	switch(type){
+	
+		case 'i':
+		case 'u': return avl_hashMix(key->uinteger);
+	
+		case 'd':
+			real = (key->real == 0) ? 0 : (double)key->real;
+			memcpy(&hash, &real, sizeof(hash));
+			return avl_hashMix(hash);
+	
+	}
+	
+	
+	hash = avl_hashMix(key->prefix);
+	if(!(key->prefix & 0xff)) return hash;
+	
+	string = key->string + 8;
+	for(length = strlen(string); length >= 8; length -= 8, string += 8){
+		memcpy(&word, string, 8);
+		hash = avl_hashMix(hash ^ word);
+	}
+	
+	word = 0;
+	memcpy(&word, string, length);
+	return avl_hashMix(hash ^ word);
+	
+}
+
+
+
+/* Puts slot into index, which has room for it, taking the place of nodes nearer to their own slots on the way */
+static void avl_hashPlace(struct AVLindex* index, struct AVLslot slot, size_t i){
+	
+	struct AVLslot swap;
+	
+	
+	for(; index->slots[i].distance; i = (i+1) & index->mask, slot.distance++){
+		if(index->slots[i].distance >= slot.distance) continue;
+	
+		swap = index->slots[i];
+		index->slots[i] = slot;
+		slot = swap;
+	}
+	
+	
+	index->slots[i] = slot;
+	
+}
+
+
+
+/* Gives index at least enough slots for n nodes, moving every node it holds into the new ones */
+static void avl_hashReserve(struct AVLindex* index, long n){
+	
+	struct AVLslot *old = index->slots;
+	size_t i, size = old ? index->mask + 1 : 0, grown = AVL_HASH_MIN;
+	while(grown*AVL_HASH_LOAD < (size_t)n*8) grown *= 2;
+	if(grown <= size) return;
+	
+	
+	index->slots = calloc(grown, sizeof(struct AVLslot));
+	index->mask = grown - 1;
+	
+	for(i = 0; i < size; i++){
+		if(!old[i].distance) continue;
+	
+		old[i].distance = 1;
+		avl_hashPlace(index, old[i], avl_hashKey(old[i].node->type, &old[i].node->ID) & index->mask);
+	}
+	
+	
+	free(old);
+	
+}
+
+
+
+struct AVLtree_sub* avl_hashSearch(struct AVLindex* index, char type, union AVLkey key){
+	
+	unsigned long long hash;
+	unsigned int distance;
+	size_t i;
+	if(!index->count) return NULL;
+	
+	
+	/* 	Goes through slots until key is found, or it'd have taken the current slot,
+		being further from its own than the slot's node, since it was never inserted */
+	hash = avl_hashKey(type, &key);
+	for(i = hash & index->mask, distance = 1; index->slots[i].distance >= distance; i = (i+1) & index->mask, distance++){
+		if(index->slots[i].hash != (unsigned int)(hash >> 32)) continue;
+		if(!avl_keyCompare(type, &key, &index->slots[i].node->ID)) return index->slots[i].node;
+	}
+	
+	
+	return NULL;
+	
+}
+
+
+
+void avl_hashInsert(struct AVLindex* index, struct AVLtree_sub* node){
+	
+	unsigned long long hash = avl_hashKey(node->type, &node->ID);
+	
+	
+	avl_hashReserve(index, index->count + 1);
+	avl_hashPlace(index, (struct AVLslot){node, hash >> 32, 1}, hash & index->mask);
+	index->count++;
+	
+}
+
+
+
+void avl_hashRemove(struct AVLindex* index, struct AVLtree_sub* node){
+	
+	size_t i, next;
+	if(!index->count) return;
+	
+	
+	/* Finds node's slot, on the way from its hash's */
+	for(i = avl_hashKey(node->type, &node->ID) & index->mask; index->slots[i].node != node; i = (i+1) & index->mask)
+		if(!index->slots[i].distance) return;
+	
+	
+	/* 	Every node after it, up to an empty slot or one in its own hash's slot,
+		is moved one slot back, nearer to its own, and the last one is emptied */
+	for(next = (i+1) & index->mask; index->slots[next].distance > 1; i = next, next = (next+1) & index->mask){
+		index->slots[i] = index->slots[next];
+		index->slots[i].distance--;
+	}
+	
+	index->slots[i] = (struct AVLslot){NULL, 0, 0};
+	index->count--;
+	
+}
+
+
+
+/* Inserts every node under node into index, which has room for them all */
+static void avl_hashNodes(struct AVLindex* index, struct AVLtree_sub* node){
+	
+	unsigned long long hash;
+	
+	
+	for(; node; node = node->Rchild){
+		avl_hashNodes(index, node->Lchild);
+	
+		hash = avl_hashKey(node->type, &node->ID);
+		avl_hashPlace(index, (struct AVLslot){node, hash >> 32, 1}, hash & index->mask);
+		index->count++;
+	}
+	
+}
+
+
+
+void avl_hashRebuild(struct AVLindex* index, struct AVLtree_sub* root){
+	
+	/* Empties index, keeping its slots, unless the root needs more */
+	if(index->slots) memset(index->slots, 0, (index->mask + 1)*sizeof(struct AVLslot));
+	index->count = 0;
+	if(!root) return;
+	
+	
+	avl_hashReserve(index, root->size);
+	avl_hashNodes(index, root);
+	
+}
+
+
+
+void avl_hashFree(struct AVLhash* hash){
+	
+	if(!hash) return;
+	
+	
+	free(hash->int_index.slots);
+	free(hash->uint_index.slots);
+	free(hash->double_index.slots);
+	free(hash->string_index.slots);
+	free(hash);
+	
+}
@@ -0,0 +1,232 @@
+#ifndef __AVL_HASH__
+#define __AVL_HASH__
+
+
+
+#include "avltree.h"
+
+
+
+/* Fewest slots of a hash index, once it holds any node. It doubles as it fills up */
+#define AVL_HASH_MIN	16
+
+/* Eighths of its slots a hash index fills, at most, before it doubles */
+#define AVL_HASH_LOAD	7
+
+
+
+
+
+/**	@Description
+ *		This structure is a slot of a hash index, holding
+ *		one node of its root, or none.
+ *
+ *	@Members
+ *		struct AVLtree_sub* node:	the node, or NULL if the slot is empty;
+ *
+ *		unsigned int hash:			upper half of the hash of node's ID, so
+ *									most slots of other IDs are told apart
+ *									without reading their nodes;
+ *
+ *		unsigned int distance:		how many slots past the one node's hash
+ *									points to it lies, plus 1, or 0 if the
+ *									slot is empty.
+ *
+ */
+struct AVLslot{
+	
+	struct AVLtree_sub *node;
+	unsigned int hash;
+	unsigned int distance;
+	
+};
+
+
+/**	@Description
+ *		This structure is the hash index of one of a super
+ *		avl tree's roots, created with AVL_HASH_INDEX: an
+ *		open addressing table holding every node of the
+ *		root, so a search finds its key in a probe or two,
+ *		rather than going down the root's whole height.
+ *
+ *		Slots are kept in Robin Hood order: a node being
+ *		inserted takes the slot of any node nearer to its
+ *		own hash's slot than it is, which goes on looking
+ *		instead. So every run of slots is sorted by distance,
+ *		a search stops as soon as it's further than the slot
+ *		it's at, and removals shift the run back by one, with
+ *		no tombstones left behind.
+ *
+ *		Nodes never move while they're in a root, since
+ *		rotations only relink them, so slots point to them
+ *		directly.
+ *
+ *	@Members
+ *		struct AVLslot* slots:	the slots, allocated on heap, or NULL while
+ *								the root has never held any node;
+ *
+ *		size_t mask:			how many slots there are, minus 1, a power of 2;
+ *
+ *		long count:				how many of them hold a node.
+ *
+ */
+struct AVLindex{
+	
+	struct AVLslot *slots;
+	size_t mask;
+	long count;
+	
+};
+
+
+/**	@Description
+ *		This structure holds the hash indexes of a super avl
+ *		tree's roots, one for each type, as the tree itself
+ *		holds its roots.
+ *
+ *	@Members
+ *		struct AVLindex int_index:		hash index of int_root;
+ *
+ *		struct AVLindex uint_index:		hash index of uint_root;
+ *
+ *		struct AVLindex double_index:	hash index of double_root;
+ *
+ *		struct AVLindex string_index:	hash index of string_root.
+ *
+ */
+struct AVLhash{
+	
+	struct AVLindex int_index;
+	struct AVLindex uint_index;
+	struct AVLindex double_index;
+	struct AVLindex string_index;
+	
+};
+
+
+
+
+
+/**	@Functionality
+ *		Searches an identifier, already converted into an
+ *		AVLkey, into a hash index, probing from the slot
+ *		its hash points to until it's found, or a slot is
+ *		empty or nearer to its own hash's slot than key
+ *		would be. If the root holds key more than once,
+ *		any of its nodes may be the one found.
+ *
+ *		This is a helper function of avl_searchKey() function.
+ *
+ *	@Arguments
+ *		struct AVLindex* index:	a pointer to one of an AVLhash structure's indexes;
+ *
+ *		char type:				root type, as given by avl_getKeyType();
+ *
+ *		union AVLkey key:		the identifier, as given by avl_toKey().
+ *
+ *	@Return
+ *		On success:	a pointer to the node holding key
+ *
+ *		On failure:	NULL (if key is not found)
+ *
+ */
+struct AVLtree_sub* avl_hashSearch(struct AVLindex* index, char type, union AVLkey key);
+
+
+
+/**	@Functionality
+ *		Inserts a node, just linked into a root, into its
+ *		hash index, doubling it first if it's full enough.
+ *
+ *		This is a helper function of avl_insertKey() function.
+ *
+ *	@Arguments
+ *		struct AVLindex* index:		a pointer to one of an AVLhash structure's indexes;
+ *
+ *		struct AVLtree_sub* node:	the node, with its ID and type set.
+ *
+ *	@Return
+ *		None
+ *
+ */
+void avl_hashInsert(struct AVLindex* index, struct AVLtree_sub* node);
+
+
+
+/**	@Functionality
+ *		Removes a node, about to leave a root, from its
+ *		hash index, shifting back the nodes right after
+ *		it that aren't in their own hash's slot.
+ *
+ *		This is a helper function of avl_removeNode() function.
+ *
+ *	@Arguments
+ *		struct AVLindex* index:		a pointer to one of an AVLhash structure's indexes;
+ *
+ *		struct AVLtree_sub* node:	the node, still with its ID.
+ *
+ *	@Return
+ *		None
+ *
+ */
+void avl_hashRemove(struct AVLindex* index, struct AVLtree_sub* node);
+
+
+
+/**	@Functionality
+ *		Empties a hash index, then inserts every node of
+ *		the root given, with enough slots for all of them
+ *		taken at once. For operations that put many nodes
+ *		into a root, or take many out, at once: bulk loads,
+ *		splits, joins and set operations.
+ *
+ *		This is a helper function of avl_bulkLoadKeys(),
+ *		avl_splitRoot(), avl_joinRoot(), avl_union(),
+ *		avl_intersect() and avl_difference() functions.
+ *
+ *	@Arguments
+ *		struct AVLindex* index:		a pointer to one of an AVLhash structure's indexes;
+ *
+ *		struct AVLtree_sub* root:	the root it indexes, or NULL if it's empty.
+ *
+ *	@Return
+ *		None
+ *
+ */
+void avl_hashRebuild(struct AVLindex* index, struct AVLtree_sub* root);
+
+
+
+/**	@Functionality
+ *		Frees the hash indexes of a super avl tree. Their
+ *		nodes are left untouched.
+ *
+ *		This is a helper function of avl_free() function.
+ *
+ *	@Argument
+ *		struct AVLhash* hash:	a pointer to an AVLhash structure, or NULL.
+ *
+ *	@Return
+ *		None
+ *
+ */
+void avl_hashFree(struct AVLhash* hash);
+
+
+
+
+
+/* Gets a pointer to the hash index of super avl tree's root of 'type', as given by avl_getKeyType() */
+static inline struct AVLindex* avl_hashRoot(struct AVLhash* hash, char type){
+	switch(type){
+		case 'i': return &hash->int_index;
+		case 'u': return &hash->uint_index;
+		case 'd': return &hash->double_index;
+		case 'c': return &hash->string_index;
+	}
+	return NULL;
+}
+
+
+
+#endif
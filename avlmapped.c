@@ -0,0 +1,449 @@
+/* fileno() and mmap() are POSIX, which strict C11 headers leave out */
+#define _XOPEN_SOURCE 700
+
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "avlmapped.h"
+#include "avlwal.h"
+
+
+
+/* A root's IDs and datas, as gotten from the tree, and how many bytes its strings take */
+struct AVLsaved{
+	
+	void **ID;
+	void **data;
+	long size;
+	size_t strings;
+	
+};
+
+
+
+/* Rounds an offset up to the next multiple of AVL_MAPPED_ALIGN */
+static inline unsigned long long avl_mappedAlign(unsigned long long offset){
+	return (offset + AVL_MAPPED_ALIGN-1) & ~(unsigned long long)(AVL_MAPPED_ALIGN-1);
+}
+
+
+
+/* Writes length bytes into file, then zeros up to the next aligned offset. Returns 0 on failure */
+static int avl_mappedWrite(FILE* file, const void* bytes, size_t length){
+	
+	static const char zeros[AVL_MAPPED_ALIGN];
+	size_t padding = avl_mappedAlign(length) - length;
+	
+	
+	if(length && fwrite(bytes, 1, length, file) != length) return 0;
+	return !padding || fwrite(zeros, 1, padding, file) == padding;
+	
+}
+
+
+
+/* 	Puts sorted IDs and datas, from index j on, into the subtree of entry i, in order,
+	as avl_freeze() does, copying width bytes of each data. Returns the index of the
+	first ID left for the entries after it */
+static long avl_mappedPlace(union AVLkey* keys, char* data, size_t width, union AVLkey* sorted, void** from, long size, long j, long i){
+	
+	if(i > size) return j;
+	
+	
+	j = avl_mappedPlace(keys, data, width, sorted, from, size, j, 2*i);
+	
+	keys[i] = sorted[j];
+	if(width && from[j]) memcpy(data + i*width, from[j], width);
+	j++;
+	
+	return avl_mappedPlace(keys, data, width, sorted, from, size, j, 2*i+1);
+	
+}
+
+
+
+/* 	Writes a root's sections, whose offsets are already into root: IDs in Eytzinger order,
+	each string one holding its string's offset, datas alongside, then strings themselves */
+static int avl_mappedWriteRoot(FILE* file, struct AVLsaved* saved, struct AVLimageRoot* root, char type, size_t width){
+	
+	union AVLkey *sorted, *keys;
+	char *data, *strings = NULL, *string = NULL;
+	size_t length;
+	long j, n = saved->size;
+	int written;
+	
+	
+	/* Gets every ID as a key, with string ones pointing into the strings' section */
+	sorted = malloc((n+1)*sizeof(union AVLkey));
+	if(type == 'c') string = strings = malloc(saved->strings + 1);
+	for(j = 0; j < n; j++){
+		if(type != 'c'){
+			sorted[j] = *(union AVLkey*)saved->ID[j];
+			continue;
+		}
+		length = strlen(saved->ID[j]) + 1;
+		sorted[j] = avl_stringKey(memcpy(string, saved->ID[j], length));
+		sorted[j].string = (char*)(size_t)(root->strings + (string - strings));
+		string += length;
+	}
+	
+	
+	/* Lays them out in Eytzinger order, from index 1, as entry 0 is never used */
+	keys = calloc(n+1, sizeof(union AVLkey));
+	data = calloc(n+1, width ? width : 1);
+	avl_mappedPlace(keys, data, width, sorted, saved->data, n, 0, 1);
+	
+	written = avl_mappedWrite(file, keys, (n+1)*sizeof(union AVLkey)) && avl_mappedWrite(file, data, (n+1)*width)
+			  && (type != 'c' || avl_mappedWrite(file, strings, saved->strings));
+	
+	
+	free(sorted);
+	free(keys);
+	free(data);
+	free(strings);
+	
+	
+	return written;
+	
+}
+
+
+
+/* 	Spreads a multimap root's IDs, each one along with all of its datas, into an entry
+	for each data, repeating the ID, so the image holds them as any other duplicate IDs */
+static void avl_mappedSpread(struct AVLsaved* saved){
+	
+	struct AVLvalues *values;
+	void **ID, **data;
+	long i, j, n = 0;
+	
+	
+	for(i = 0; i < saved->size; i++) n += ((struct AVLvalues*)saved->data[i])->count;
+	ID = malloc((n+1)*sizeof(void*));
+	data = malloc((n+1)*sizeof(void*));
+	
+	for(i = n = 0; i < saved->size; i++){
+		values = saved->data[i];
+		for(j = 0; j < values->count; j++, n++){
+			ID[n] = saved->ID[i];
+			data[n] = values->data[j];
+		}
+	}
+	
+	
+	free(saved->ID);
+	free(saved->data);
+	saved->ID = ID;
+	saved->data = data;
+	saved->size = n;
+	
+}
+
+
+
+int avl_save(struct AVLtree* tree, const char* path, size_t width){
+	
+	struct AVLimage header = {.magic = AVL_MAPPED_MAGIC, .width = width, .sequence = tree->wal ? tree->wal->sequence : 0};
+	struct AVLsaved saved[4];
+	const char *types = "iudc";
+	char *temporary;
+	FILE *file;
+	long i, j, n;
+	int written;
+	
+	
+	/* Gets every root's IDs and datas in order, whichever its engine, and how many bytes its strings take */
+	for(i = 0; i < 4; i++){
+		n = 0;
+		switch(types[i]){
+			case 'i': n = tree->int_size; break;
+			case 'u': n = tree->uint_size; break;
+			case 'd': n = tree->double_size; break;
+			case 'c': n = tree->string_size; break;
+		}
+		saved[i].ID = malloc((n+1)*sizeof(void*));
+		saved[i].data = malloc((n+1)*sizeof(void*));
+		saved[i].size = avl_traverseRoot(tree, types[i], saved[i].ID, saved[i].data, n);
+		if(tree->options & AVL_MULTIMAP) avl_mappedSpread(&saved[i]);
+		saved[i].strings = 0;
+		if(types[i] == 'c')
+			for(j = 0; j < saved[i].size; j++) saved[i].strings += strlen(saved[i].ID[j]) + 1;
+	}
+	
+	
+	/* 	Places every root's sections one after another, past the header, each
+		one aligned, so the image's length is known before anything is written */
+	header.length = avl_mappedAlign(sizeof(struct AVLimage));
+	for(i = 0; i < 4; i++){
+		header.roots[i].size = saved[i].size;
+		header.roots[i].keys = header.length;
+		header.length = avl_mappedAlign(header.length + (saved[i].size+1)*sizeof(union AVLkey));
+		header.roots[i].data = header.length;
+		header.length = avl_mappedAlign(header.length + (saved[i].size+1)*width);
+		header.roots[i].strings = (types[i] == 'c') ? header.length : 0;
+		header.length = avl_mappedAlign(header.length + saved[i].strings);
+	}
+	
+	
+	/* 	Writes the image into a new file beside path, then renames it over
+		path once it's all on disk, so path always holds a whole image */
+	temporary = malloc(strlen(path) + 5);
+	sprintf(temporary, "%s.tmp", path);
+	written = (file = fopen(temporary, "wb")) != NULL && avl_mappedWrite(file, &header, sizeof(struct AVLimage));
+	for(i = 0; written && i < 4; i++)
+		written = avl_mappedWriteRoot(file, &saved[i], &header.roots[i], types[i], width);
+	
+	if(file){
+		written = written && !fflush(file) && !fsync(fileno(file));
+		written = !fclose(file) && written;
+	}
+	written = written && !rename(temporary, path);
+	if(!written) remove(temporary);
+	
+	
+	for(i = 0; i < 4; i++){
+		free(saved[i].ID);
+		free(saved[i].data);
+	}
+	free(temporary);
+	
+	
+	return written;
+	
+}
+
+
+
+/* Whether count blocks of width bytes from offset on are within an image of length bytes */
+static inline int avl_mappedFits(unsigned long long offset, unsigned long long count, unsigned long long width, unsigned long long length){
+	return offset <= length && (!width || count <= (length - offset) / width);
+}
+
+
+
+/* 	Whether every string entry of an image points into its root's strings, to a string
+	ending within the image, whose first bytes are the entry's prefix. Compares then never
+	read past the mapping, even on an image a crash or a bad disk corrupted */
+static int avl_mappedStrings(char* image, struct AVLimage* header){
+	
+	struct AVLimageRoot *root = &header->roots[3];
+	union AVLkey *keys = (union AVLkey*)(image + root->keys);
+	unsigned long long i, offset;
+	
+	
+	for(i = 1; i <= root->size; i++){
+		offset = (unsigned long long)(size_t)keys[i].string;
+		if(offset < root->strings || offset >= header->length
+		   || !memchr(image + offset, '\0', header->length - offset)
+		   || avl_stringKey(image + offset).prefix != keys[i].prefix)
+			return 0;
+	}
+	
+	
+	return 1;
+	
+}
+
+
+
+struct AVLmapped* avl_openMapped(const char* path){
+	
+	struct AVLmapped *mapped;
+	struct AVLimage *header;
+	struct AVLimageRoot *root;
+	struct AVLmappedRoot *into;
+	const char *types = "iudc";
+	struct stat status;
+	void *image;
+	int fd, i;
+	
+	
+	/* Maps the whole file read only. The system reads each page as it's first touched */
+	if((fd = open(path, O_RDONLY)) < 0) return NULL;
+	if(fstat(fd, &status) || (size_t)status.st_size < sizeof(struct AVLimage)){
+		close(fd);
+		return NULL;
+	}
+	image = mmap(NULL, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if(image == MAP_FAILED) return NULL;
+	
+	
+	/* The image must be a whole one, saved by this kind of machine, with every section within it */
+	header = image;
+	if(header->magic != AVL_MAPPED_MAGIC || header->length != (unsigned long long)status.st_size){
+		munmap(image, status.st_size);
+		return NULL;
+	}
+	
+	/* 	Sections are aligned as avl_save() places them, and no root holds more IDs than
+		the image has room for, so size+1 can't wrap, nor be negative once it's a long */
+	for(i = 0; i < 4; i++){
+		root = &header->roots[i];
+		if(root->size >= header->length / sizeof(union AVLkey)
+		   || (root->keys | root->data | root->strings) % AVL_MAPPED_ALIGN
+		   || !avl_mappedFits(root->keys, root->size+1, sizeof(union AVLkey), header->length)
+		   || !avl_mappedFits(root->data, root->size+1, header->width, header->length)
+		   || root->strings > header->length){
+			munmap(image, status.st_size);
+			return NULL;
+		}
+	}
+	
+	if(!avl_mappedStrings(image, header)){
+		munmap(image, status.st_size);
+		return NULL;
+	}
+	
+	
+	/* Points every root right into the image, which is all there is to opening it */
+	mapped = malloc(sizeof(struct AVLmapped));
+	mapped->image = image;
+	mapped->length = status.st_size;
+	mapped->width = header->width;
+	for(i = 0; i < 4; i++){
+		into = avl_mappedRoot(mapped, types[i]);
+		into->keys = (union AVLkey*)(mapped->image + header->roots[i].keys);
+		into->data = mapped->image + header->roots[i].data;
+		into->size = header->roots[i].size;
+	}
+	
+	
+	return mapped;
+	
+}
+
+
+
+/* 	Compares a mapped root's entry to key, as avl_keyCompare() does, but
+	with the entry's string, if any, at an offset into the image */
+static inline __attribute__((always_inline)) int avl_mappedCompare(const char* image, char type, const union AVLkey* entry, const union AVLkey* key){
+	
+	if(type != 'c') return avl_keyCompare(type, entry, key);
+	
+	
+	if(entry->prefix != key->prefix) return (entry->prefix > key->prefix) ? 1 : -1;
+	if(!(entry->prefix & 0xff)) return 0;
+	return strcmp(image + (size_t)entry->string + 8, key->string + 8);
+	
+}
+
+
+
+/* 	Goes down from entry 1 to the first key not lesser than key, as avl_frozenLowerBound()
+	does. Always inlined with a constant type, so compares of numbers take no branch */
+static inline __attribute__((always_inline)) long avl_mappedDescend(struct AVLmapped* mapped, struct AVLmappedRoot* root, char type, const union AVLkey* key){
+	
+	long i = 1;
+	
+	
+	while(i <= root->size){
+		__builtin_prefetch(&root->keys[8*i]);
+		__builtin_prefetch(&root->keys[8*i+4]);
+		i = 2*i + (avl_mappedCompare(mapped->image, type, &root->keys[i], key) < 0);
+	}
+	
+	
+	return i >> __builtin_ffsl(~i);
+	
+}
+
+
+
+/* Gets the index of the first ID of a mapped root not lesser than key, or 0 if there's none */
+static long avl_mappedLowerBound(struct AVLmapped* mapped, char type, const union AVLkey* key){
+	
+	switch(type){
+		case 'i': return avl_mappedDescend(mapped, &mapped->int_root, 'i', key);
+		case 'u': return avl_mappedDescend(mapped, &mapped->uint_root, 'u', key);
+		case 'd': return avl_mappedDescend(mapped, &mapped->double_root, 'd', key);
+		case 'c': return avl_mappedDescend(mapped, &mapped->string_root, 'c', key);
+	}
+	return 0;
+	
+}
+
+
+
+long avl_mappedSearchKey(struct AVLmapped* mapped, char type, union AVLkey key){
+	
+	/* Key is found if the first ID not lesser than it is not greater either */
+	long i = avl_mappedLowerBound(mapped, type, &key);
+	return (i && !avl_mappedCompare(mapped->image, type, &avl_mappedRoot(mapped, type)->keys[i], &key)) ? i : 0;
+	
+}
+
+
+
+/* Gets the index of the ID right after the one at index of a mapped root, as avl_frozenNext() does */
+static long avl_mappedNext(struct AVLmappedRoot* root, long index){
+	
+	if(2*index+1 <= root->size){
+		for(index = 2*index+1; 2*index <= root->size; index *= 2);
+		return index;
+	}
+	
+	
+	while(index & 1) index >>= 1;
+	return index >> 1;
+	
+}
+
+
+
+long avl_mappedRangeKey(struct AVLmapped* mapped, char type, union AVLkey lo, union AVLkey hi,
+						int (*callback)(void* ID, void* data, void* arg), void* arg){
+	
+	struct AVLmappedRoot *root;
+	long i, c = 0;
+	if(!(root = avl_mappedRoot(mapped, type))) return 0;
+	
+	
+	/* Goes from the first ID not lesser than lo, in order, until one is greater than hi */
+	for(i = avl_mappedLowerBound(mapped, type, &lo); i; i = avl_mappedNext(root, i)){
+		if(avl_mappedCompare(mapped->image, type, &root->keys[i], &hi) > 0) break;
+		
+		c++;
+		if(callback(avl_mappedID(mapped, type, i), avl_mappedData(mapped, type, i), arg))
+			break;
+	}
+	
+	
+	return c;
+	
+}
+
+
+
+long avl_mappedTraverse(struct AVLmapped* mapped, char type, void** ID, void** data, long n){
+	
+	struct AVLmappedRoot *root;
+	long i, c = 0;
+	if(!(root = avl_mappedRoot(mapped, type)) || root->size < 1) return 0;
+	
+	
+	/* Goes from the leftmost entry, the smallest ID, to each next one, in order */
+	for(i = 1; 2*i <= root->size; i *= 2);
+	for(; i && c < n; i = avl_mappedNext(root, i), c++){
+		if(ID) ID[c] = avl_mappedID(mapped, type, i);
+		if(data) data[c] = avl_mappedData(mapped, type, i);
+	}
+	
+	
+	return c;
+	
+}
+
+
+
+void avl_closeMapped(struct AVLmapped* mapped){
+	
+	if(!mapped) return;
+	
+	munmap(mapped->image, mapped->length);
+	free(mapped);
+	
+}
@@ -0,0 +1,426 @@
+#ifndef __AVL_MAPPED__
+#define __AVL_MAPPED__
+
+
+
+#include "avltree.h"
+
+
+
+/* First 8 bytes of a saved super avl tree's image, "AVLMAP01", which tell it from anything else */
+#define AVL_MAPPED_MAGIC	0x31304150414d4c41ULL
+
+/* Alignment of every section of an image, so entries never straddle cache lines more than they must */
+#define AVL_MAPPED_ALIGN	64
+
+
+
+
+
+/**	@Description
+ *		This structure is where one of a super avl tree's
+ *		roots is within an image saved by avl_save(), by
+ *		offsets from the image's start, as the image may be
+ *		mapped anywhere.
+ *
+ *	@Members
+ *		unsigned long long size:	how many IDs the root holds;
+ *
+ *		unsigned long long keys:	offset of its IDs, size+1 AVLkey unions in
+ *									Eytzinger order, as avl_freeze() lays them
+ *									out, from index 1. A string ID holds its
+ *									string's offset instead of a pointer, and
+ *									its prefix as usual;
+ *
+ *		unsigned long long data:	offset of its datas, size+1 blocks of the
+ *									image's width, each one along with the ID
+ *									at the same index;
+ *
+ *		unsigned long long strings:	offset of the strings of a string root, one
+ *									after another, or 0 for other roots.
+ *
+ */
+struct AVLimageRoot{
+	
+	unsigned long long size;
+	unsigned long long keys;
+	unsigned long long data;
+	unsigned long long strings;
+	
+};
+
+
+/**	@Description
+ *		This structure is the header of an image of a super
+ *		avl tree, as avl_save() writes it into a file and
+ *		avl_openMapped() maps it back: a read only copy of
+ *		every root, whichever its engine, with no pointer at
+ *		all, so it's searched right where it's mapped.
+ *
+ *		Its numbers are the saving machine's own, so an
+ *		image is only opened by machines of the same kind.
+ *
+ *	@Members
+ *		unsigned long long magic:		AVL_MAPPED_MAGIC;
+ *
+ *		unsigned long long length:		how many bytes the whole image takes;
+ *
+ *		unsigned long long width:		how many bytes of each data were saved,
+ *										0 if none;
+ *
+ *		unsigned long long sequence:	the last change of a durable tree's log the
+ *										image holds, so recovery only replays those
+ *										after it, or 0 for any other tree;
+ *
+ *		struct AVLimageRoot roots[4]:	where the int & variations, unsigned int
+ *										& variations, float & variations and string
+ *										roots are, in that order.
+ *
+ */
+struct AVLimage{
+	
+	unsigned long long magic;
+	unsigned long long length;
+	unsigned long long width;
+	unsigned long long sequence;
+	struct AVLimageRoot roots[4];
+	
+};
+
+
+/**	@Description
+ *		This structure is one of the roots of a mapped image,
+ *		pointing right into it.
+ *
+ *	@Members
+ *		union AVLkey* keys:		the IDs, in Eytzinger order, from index 1 to size;
+ *
+ *		char* data:				the datas, width bytes each, at the same indexes;
+ *
+ *		long size:				how many IDs there are.
+ *
+ */
+struct AVLmappedRoot{
+	
+	union AVLkey *keys;
+	char *data;
+	long size;
+	
+};
+
+
+/**	@Description
+ *		This structure is a super avl tree's image, saved
+ *		by avl_save() and mapped read only by avl_openMapped(),
+ *		so the system reads it from the file as its pages
+ *		are first touched, rather than all at once.
+ *
+ *		Opening it only reads its string IDs, to check them,
+ *		and its roots are searched right where they are, with
+ *		nothing read back into nodes. It must be closed with
+ *		avl_closeMapped().
+ *
+ *	@Members
+ *		char* image:						where the image is mapped;
+ *
+ *		size_t length:						how many bytes are mapped;
+ *
+ *		size_t width:						how many bytes each data takes;
+ *
+ *		struct AVLmappedRoot int_root:		root of int & variations IDs, as well as
+ *											the other roots;
+ *
+ *		struct AVLmappedRoot uint_root:		root of unsigned int & variations IDs;
+ *
+ *		struct AVLmappedRoot double_root:	root of float & variations IDs;
+ *
+ *		struct AVLmappedRoot string_root:	root of string IDs.
+ *
+ */
+struct AVLmapped{
+	
+	char *image;
+	size_t length;
+	size_t width;
+	struct AVLmappedRoot int_root;
+	struct AVLmappedRoot uint_root;
+	struct AVLmappedRoot double_root;
+	struct AVLmappedRoot string_root;
+	
+};
+
+
+
+
+
+/**	@Functionality
+ *		Saves a super avl tree into a file, as an image
+ *		avl_openMapped() maps back: every root, whichever
+ *		its engine, with numeric IDs inline, strings in a
+ *		section of their own, and every pointer replaced
+ *		by an offset, or by an index, for children.
+ *
+ *		Datas are opaque to the tree, so the first width
+ *		bytes each one points to are copied, and zeros
+ *		for NULL datas. With width 0, only IDs are saved.
+ *		A tree created with AVL_MULTIMAP has its IDs saved
+ *		once for each of their datas, in the order they
+ *		were inserted, and loading the image back gathers
+ *		them together again.
+ *
+ *		The image is written into a new file beside path,
+ *		then renamed over it, so a crash never leaves a
+ *		half written image at path.
+ *
+ *		A durable tree's image also holds how far into
+ *		its log it goes, as avl_checkpoint() needs.
+ *
+ *	@Arguments
+ *		struct AVLtree* tree:	a pointer to an AVLtree structure, a super avl tree;
+ *
+ *		const char* path:		the file to save it into;
+ *
+ *		size_t width:			how many bytes of each data to save.
+ *
+ *	@Return
+ *		On success:	1
+ *
+ *		On failure:	0 (if the file couldn't be written)
+ *
+ */
+int avl_save(struct AVLtree* tree, const char* path, size_t width);
+
+
+
+/**	@Functionality
+ *		Maps an image saved by avl_save() read only, so
+ *		its roots may be searched right away.
+ *
+ *		Every section of the image must lie within it,
+ *		and so must every string ID, along with its end,
+ *		matching its entry's prefix, so a truncated or
+ *		corrupted image is turned down, rather than read
+ *		past its end. Checking strings takes a pass over
+ *		them, the only one opening takes.
+ *
+ *	@Argument
+ *		const char* path:	the file the image was saved into.
+ *
+ *	@Return
+ *		On success:	a pointer to an AVLmapped structure, allocated on heap
+ *
+ *		On failure:	NULL (if the file can't be mapped, or isn't a whole,
+ *					sound image of this kind of machine)
+ *
+ */
+struct AVLmapped* avl_openMapped(const char* path);
+
+
+
+/**	@Functionality
+ *		Searches an identifier, already converted into an
+ *		AVLkey, into one of a mapped image's roots, going
+ *		down through its entries without branching.
+ *
+ *		This is a helper function of avl_mappedSearch() macro function.
+ *
+ *	@Arguments
+ *		struct AVLmapped* mapped:	a pointer to an AVLmapped structure, as given
+ *									by avl_openMapped();
+ *
+ *		char type:					which root to search, as given by avl_getKeyType();
+ *
+ *		union AVLkey key:			the identifier, as given by avl_toKey().
+ *
+ *	@Return
+ *		On success:	the ID's index into the root's entries
+ *
+ *		On failure:	0 (if key is not found)
+ *
+ */
+long avl_mappedSearchKey(struct AVLmapped* mapped, char type, union AVLkey key);
+
+
+
+/**	@Functionality
+ *		Calls callback with ID, data and arg of every
+ *		entry of a mapped image's root from lo to hi,
+ *		both inclusive, in ascending order of IDs, until
+ *		callback returns non zero or the range is over.
+ *
+ *		This is a helper function of avl_mappedRange() macro function.
+ *
+ *	@Arguments
+ *		struct AVLmapped* mapped:	a pointer to an AVLmapped structure;
+ *
+ *		char type:					which root to go through, as given by avl_getKeyType();
+ *
+ *		union AVLkey lo:			the range's smallest identifier;
+ *
+ *		union AVLkey hi:			the range's greatest identifier;
+ *
+ *		int (*callback)():			function called with each ID and data, both
+ *									pointing into the image, and arg. It returns
+ *									non zero to stop the range early;
+ *
+ *		void* arg:					anything callback needs, passed along untouched.
+ *
+ *	@Return
+ *		Unconditionally:	how many times callback was called
+ *
+ */
+long avl_mappedRangeKey(struct AVLmapped* mapped, char type, union AVLkey lo, union AVLkey hi,
+						int (*callback)(void* ID, void* data, void* arg), void* arg);
+
+
+
+/**	@Functionality
+ *		Gets up to n IDs and datas of a mapped image's
+ *		root, in ascending order, into preallocated ID
+ *		and data arrays, as avl_traverseRoot() does, both
+ *		pointing into the image.
+ *
+ *	@Arguments
+ *		struct AVLmapped* mapped:	a pointer to an AVLmapped structure;
+ *
+ *		char type:					which root to go through, as given by avl_getKeyType();
+ *
+ *		void** ID:					an array of at least n void pointers, that will
+ *									store IDs, or NULL;
+ *
+ *		void** data:				an array of at least n void pointers, that will
+ *									store datas, or NULL;
+ *
+ *		long n:						how many IDs and datas, at most, to get.
+ *
+ *	@Return
+ *		Unconditionally:	how many IDs and datas were put into the arrays
+ *
+ */
+long avl_mappedTraverse(struct AVLmapped* mapped, char type, void** ID, void** data, long n);
+
+
+
+/**	@Functionality
+ *		Unmaps an image mapped by avl_openMapped(). Nothing
+ *		pointing into it may be used afterwards.
+ *
+ *	@Argument
+ *		struct AVLmapped* mapped:	a pointer to an AVLmapped structure, or NULL.
+ *
+ *	@Return
+ *		None
+ *
+ */
+void avl_closeMapped(struct AVLmapped* mapped);
+
+
+
+
+
+/* Gets a mapped image's root of 'type', as given by avl_getKeyType() */
+static inline struct AVLmappedRoot* avl_mappedRoot(struct AVLmapped* mapped, char type){
+	switch(type){
+		case 'i': return &mapped->int_root;
+		case 'u': return &mapped->uint_root;
+		case 'd': return &mapped->double_root;
+		case 'c': return &mapped->string_root;
+	}
+	return NULL;
+}
+
+
+
+/* Gets a pointer to the ID at index of a mapped image's root: its string, for string IDs */
+static inline void* avl_mappedID(struct AVLmapped* mapped, char type, long index){
+	union AVLkey *key = &avl_mappedRoot(mapped, type)->keys[index];
+	return (type == 'c') ? (void*)(mapped->image + (size_t)key->string) : (void*)key;
+}
+
+
+
+/* Gets a pointer to the data at index of a mapped image's root, or NULL if no data was saved */
+static inline void* avl_mappedData(struct AVLmapped* mapped, char type, long index){
+	return mapped->width ? avl_mappedRoot(mapped, type)->data + index*mapped->width : NULL;
+}
+
+
+
+
+
+/**	@Functionality
+ *		Searches 'id' into a mapped image and, if found,
+ *		retrieves a pointer to its data, right into the
+ *		image, into DATA, or NULL otherwise.
+ *
+ *	@Arguments
+ *		struct AVLmapped* mapped:	a pointer to an AVLmapped structure, as given
+ *									by avl_openMapped();
+ *
+ *		? id:						the identifier to search for;
+ *
+ *		? DATA:						a pointer to the data type expected to be
+ *									retrieved, which must not be written through.
+ *
+ *	@Return
+ *		None, since it's a macro function, but alters what
+ *		DATA argument points to, when called
+ *
+ */
+#define avl_mappedSearch(mapped, id, DATA)										\
+		do {																	\
+																				\
+			/* Converts id into a key and searches for it */					\
+			long index = avl_mappedSearchKey(mapped, avl_getKeyType(id), avl_toKey(id));	\
+			DATA = index ? avl_mappedData(mapped, avl_getKeyType(id), index) : NULL;	\
+																				\
+		} while(0)
+
+
+
+/**	@Functionality
+ *		Calls callback with ID, data and arg of every
+ *		entry of a mapped image from lo to hi, both
+ *		inclusive, in ascending order of IDs, until
+ *		callback returns non zero.
+ *
+ *	@Arguments
+ *		struct AVLmapped* mapped:	a pointer to an AVLmapped structure;
+ *
+ *		? lo:						the smallest identifier of the range;
+ *
+ *		? hi:						the greatest identifier of the range, of
+ *									lo's type;
+ *
+ *		int (*callback)():			function called with each ID, data and arg;
+ *
+ *		void* arg:					anything callback needs.
+ *
+ *	@Return
+ *		How many times callback was called
+ *
+ */
+#define avl_mappedRange(mapped, lo, hi, callback, arg)							\
+		avl_mappedRangeKey(mapped, avl_getKeyType(lo), avl_toKey(lo), avl_toKey(hi), callback, arg)
+
+
+
+/**	@Functionality
+ *		Gets how many IDs of 'type' primitive type a
+ *		mapped image holds.
+ *
+ *	@Arguments
+ *		struct AVLmapped* mapped:	a pointer to an AVLmapped structure;
+ *
+ *		? type:						a primitive type to identify which root to count.
+ *
+ *	@Return
+ *		How many IDs the root holds
+ *
+ */
+#define avl_mappedCount(mapped, type)											\
+		(avl_mappedRoot(mapped, avl_getKeyType(type))->size)
+
+
+
+#endif
@@ -0,0 +1,492 @@
+#include <limits.h>
+
+#include "avlpersist.h"
+
+
+
+/* Height of a persistent node's subtree, 0 if it's empty */
+static inline int avl_pHeight(struct AVLpnode* node){
+	return node ? node->height : 0;
+}
+
+
+
+/* Updates a persistent node's height from its children's */
+static inline void avl_pUpdate(struct AVLpnode* node){
+	
+	int left = avl_pHeight(node->Lchild), right = avl_pHeight(node->Rchild);
+	node->height = ((left > right) ? left : right) + 1;
+	
+}
+
+
+
+/* Points to a persistent node once more, from a new parent, root or snapshot */
+static inline void avl_pHold(struct AVLpnode* node){
+	if(node) __atomic_add_fetch(&node->refs, 1, __ATOMIC_RELAXED);
+}
+
+
+
+/* 	Drops a reference to a persistent node, freeing it once there's none left, along
+	with its own references to its children. Not its ID nor data, which its copies
+	may share, and which are freed on their own, as they're removed */
+static void avl_pRelease(struct AVLpnode* node){
+	
+	struct AVLpnode *next;
+	
+	
+	/* Goes on through right children, so only left ones take the stack */
+	for(; node && __atomic_sub_fetch(&node->refs, 1, __ATOMIC_ACQ_REL) == 0; node = next){
+		avl_pRelease(node->Lchild);
+		next = node->Rchild;
+		free(node);
+	}
+	
+}
+
+
+
+/* 	Makes the node link points to belong to the current version alone, so it may be
+	changed in place: if anything else points to it, a snapshot or an older copy of
+	its parent, link gets a copy of it instead, sharing its children. Returns it */
+static struct AVLpnode* avl_pOwn(struct AVLpnode** link){
+	
+	struct AVLpnode *node = *link, *copy;
+	if(__atomic_load_n(&node->refs, __ATOMIC_ACQUIRE) == 1) return node;
+	
+	
+	/* Copies all but refs, which others may be changing meanwhile */
+	copy = malloc(sizeof(struct AVLpnode));
+	copy->ID = node->ID;
+	copy->data = node->data;
+	copy->Lchild = node->Lchild;
+	copy->Rchild = node->Rchild;
+	copy->refs = 1;
+	copy->height = node->height;
+	copy->type = node->type;
+	avl_pHold(copy->Lchild);
+	avl_pHold(copy->Rchild);
+	
+	*link = copy;
+	avl_pRelease(node);
+	
+	
+	return copy;
+	
+}
+
+
+
+/* 	Rotates the subtree link points to, to the left if direction is 'l', or else to
+	the right, making both nodes moved belong to the current version first. Every
+	pointer moved takes the reference it had along, so no count changes */
+static void avl_pRotate(struct AVLpnode** link, char direction){
+	
+	struct AVLpnode *node = avl_pOwn(link), *pivot;
+	
+	
+	if(direction == 'l'){
+		pivot = avl_pOwn(&node->Rchild);
+		node->Rchild = pivot->Lchild;
+		pivot->Lchild = node;
+	} else {
+		pivot = avl_pOwn(&node->Lchild);
+		node->Lchild = pivot->Rchild;
+		pivot->Rchild = node;
+	}
+	
+	avl_pUpdate(node);
+	avl_pUpdate(pivot);
+	*link = pivot;
+	
+}
+
+
+
+/* 	Rebalances the subtree link points to, whose node belongs to the current version,
+	after one of its children got one higher or lower, with one rotation or two */
+static void avl_pRebalance(struct AVLpnode** link){
+	
+	struct AVLpnode *node = *link;
+	int balance = avl_pHeight(node->Rchild) - avl_pHeight(node->Lchild);
+	
+	
+	if(balance > 1){
+		if(avl_pHeight(node->Rchild->Lchild) > avl_pHeight(node->Rchild->Rchild))
+			avl_pRotate(&node->Rchild, 'r');
+		avl_pRotate(link, 'l');
+	} else if(balance < -1){
+		if(avl_pHeight(node->Lchild->Rchild) > avl_pHeight(node->Lchild->Lchild))
+			avl_pRotate(&node->Lchild, 'l');
+		avl_pRotate(link, 'r');
+	} else avl_pUpdate(node);
+	
+}
+
+
+
+/* Inserts new node into the subtree link points to, left of any equal ID, owning every node on its way */
+static void avl_pInsert(struct AVLpnode** link, struct AVLpnode* new){
+	
+	struct AVLpnode *node;
+	
+	
+	if(!*link){
+		*link = new;
+		return;
+	}
+	
+	node = avl_pOwn(link);
+	avl_pInsert((avl_keyCompare(new->type, &new->ID, &node->ID) > 0) ? &node->Rchild : &node->Lchild, new);
+	avl_pRebalance(link);
+	
+}
+
+
+
+/* Takes the smallest node out of the subtree link points to, which has one, handing out its ID and data */
+static void avl_pRemoveFirst(struct AVLpnode** link, union AVLkey* ID, void** data){
+	
+	struct AVLpnode *node = avl_pOwn(link);
+	
+	
+	if(node->Lchild){
+		avl_pRemoveFirst(&node->Lchild, ID, data);
+		avl_pRebalance(link);
+		return;
+	}
+	
+	*ID = node->ID;
+	*data = node->data;
+	*link = node->Rchild;
+	node->Rchild = NULL;
+	avl_pRelease(node);
+	
+}
+
+
+
+/* 	Takes the first node found with key out of the subtree link points to, which has
+	one, handing out its ID and data. A node with two children takes its successor's
+	ID and data instead, so it's the successor that's taken out */
+static void avl_pRemove(struct AVLpnode** link, char type, union AVLkey key, union AVLkey* ID, void** data){
+	
+	struct AVLpnode *node = avl_pOwn(link);
+	int eval = avl_keyCompare(type, &key, &node->ID);
+	
+	
+	if(eval){
+		avl_pRemove((eval > 0) ? &node->Rchild : &node->Lchild, type, key, ID, data);
+		avl_pRebalance(link);
+		return;
+	}
+	
+	*ID = node->ID;
+	*data = node->data;
+	
+	
+	/* 	A node with a single child at most is replaced by it, which takes
+		the node's reference to it along, so the node has none left */
+	if(!node->Lchild || !node->Rchild){
+		*link = node->Lchild ? node->Lchild : node->Rchild;
+		node->Lchild = node->Rchild = NULL;
+		avl_pRelease(node);
+		return;
+	}
+	
+	avl_pRemoveFirst(&node->Rchild, &node->ID, &node->data);
+	avl_pRebalance(link);
+	
+}
+
+
+
+void avl_persistInsert(struct AVLpnode** root, char type, union AVLkey key, void* data){
+	
+	/* Takes a new node, and copies key into its ID, and strings into heap */
+	struct AVLpnode *node = malloc(sizeof(struct AVLpnode));
+	if(type == 'c')
+		key.string = strcpy(malloc(strlen(key.string)+1), key.string);
+	node->ID = key;
+	node->data = data;
+	node->Lchild = node->Rchild = NULL;
+	node->refs = 1;
+	node->height = 1;
+	node->type = type;
+	
+	
+	avl_pInsert(root, node);
+	
+}
+
+
+
+struct AVLpnode* avl_persistSearch(struct AVLpnode* root, char type, union AVLkey key){
+	
+	struct AVLpnode *node = root;
+	int eval;
+	
+	
+	/* Goes right if key is greater than node's ID, left if lesser, until it's found */
+	while(node && (eval = avl_keyCompare(type, &key, &node->ID)))
+		node = (eval > 0) ? node->Rchild : node->Lchild;
+	
+	
+	return node;
+	
+}
+
+
+
+int avl_persistRemove(struct AVLpersist* persist, struct AVLpnode** root, char type, union AVLkey key){
+	
+	union AVLkey ID;
+	void *data;
+	
+	
+	/* Searches for key first, so nothing is copied if it isn't there */
+	if(!avl_persistSearch(*root, type, key)) return 0;
+	avl_pRemove(root, type, key, &ID, &data);
+	
+	
+	/* 	With no live snapshot, ID and data are freed right away. Otherwise, they wait
+		for every snapshot taken before this version, which may hold them, to be released */
+	pthread_mutex_lock(&persist->lock);
+	if(!persist->snapshots){
+		if(type == 'c') free(ID.string);
+		free(data);
+	} else {
+		if(persist->deadCount == persist->deadSize){
+			persist->deadSize = persist->deadSize ? persist->deadSize*2 : 64;
+			persist->dead = realloc(persist->dead, persist->deadSize*sizeof(struct AVLpdead));
+		}
+		persist->dead[persist->deadCount++] = (struct AVLpdead){(type == 'c') ? ID.string : NULL, data, persist->version};
+	}
+	pthread_mutex_unlock(&persist->lock);
+	
+	
+	return 1;
+	
+}
+
+
+
+long avl_persistTraverse(void** ID, void** data, long n, struct AVLpnode* root){
+	
+	struct AVLpnode *stack[AVL_MAX_HEIGHT], *node = root;
+	long c = 0;
+	int top = 0;
+	
+	
+	/* Goes down left as far as it can, then hands node out and does the same from its right child */
+	while(c < n && (node || top)){
+		for(; node; node = node->Lchild) stack[top++] = node;
+		node = stack[--top];
+		if(ID) ID[c] = avl_persistID(node);
+		if(data) data[c] = node->data;
+		c++;
+		node = node->Rchild;
+	}
+	
+	
+	return c;
+	
+}
+
+
+
+/* 	Checks node's subtree, whose IDs must be between lo and hi, if not NULL,
+	then returns its height, or -1 if it's inconsistent */
+static long avl_pVerify(struct AVLpnode* node, const union AVLkey* lo, const union AVLkey* hi){
+	
+	long left, right;
+	if(!node) return 0;
+	
+	
+	if(!__atomic_load_n(&node->refs, __ATOMIC_RELAXED)) return -1;
+	if(lo && avl_keyCompare(node->type, lo, &node->ID) > 0) return -1;
+	if(hi && avl_keyCompare(node->type, &node->ID, hi) > 0) return -1;
+	
+	left = avl_pVerify(node->Lchild, lo, &node->ID);
+	right = avl_pVerify(node->Rchild, &node->ID, hi);
+	if(left < 0 || right < 0 || left-right > 1 || right-left > 1) return -1;
+	
+	
+	left = ((left > right) ? left : right) + 1;
+	return (node->height == left) ? left : -1;
+	
+}
+
+
+
+long avl_persistVerify(struct AVLpnode* root){
+	return avl_pVerify(root, NULL, NULL);
+}
+
+
+
+/* Frees the ID and data of every node of a persistent tree's current version, which hold each one once */
+static void avl_pFreeData(struct AVLpnode* node){
+	
+	for(; node; node = node->Rchild){
+		avl_pFreeData(node->Lchild);
+		if(node->type == 'c') free(node->ID.string);
+		free(node->data);
+	}
+	
+}
+
+
+
+void avl_persistFree(struct AVLpersist* persist){
+	
+	const char *types = "iudc";
+	long i;
+	if(!persist) return;
+	
+	
+	/* Frees every root, with IDs and datas, then those removed while snapshots held them */
+	for(i = 0; i < 4; i++){
+		avl_pFreeData(*avl_persistRoot(persist, types[i]));
+		avl_pRelease(*avl_persistRoot(persist, types[i]));
+	}
+	
+	for(i = 0; i < persist->deadCount; i++){
+		free(persist->dead[i].string);
+		free(persist->dead[i].data);
+	}
+	
+	
+	pthread_mutex_destroy(&persist->lock);
+	free(persist->dead);
+	free(persist);
+	
+}
+
+
+
+struct AVLsnapshot* avl_snapshot(struct AVLtree* tree){
+	
+	struct AVLpersist *persist = tree->persist;
+	struct AVLsnapshot *snapshot;
+	const char *types = "iudc";
+	int i;
+	if(!persist) return NULL;
+	
+	
+	/* 	Keeps writers out of every root meanwhile, so all are taken at the same
+		moment, then points to each one, which is all it takes to keep them as they are */
+	snapshot = malloc(sizeof(struct AVLsnapshot));
+	snapshot->persist = persist;
+	for(i = 0; i < 4; i++) avl_lockRoot(tree, types[i], 'x');
+	
+	for(i = 0; i < 4; i++){
+		avl_pHold(*avl_persistRoot(persist, types[i]));
+		*avl_snapshotRoot(snapshot, types[i]) = *avl_persistRoot(persist, types[i]);
+	}
+	snapshot->int_size = tree->int_size;
+	snapshot->uint_size = tree->uint_size;
+	snapshot->double_size = tree->double_size;
+	snapshot->string_size = tree->string_size;
+	
+	
+	/* Becomes the newest live snapshot, of a version of its own */
+	pthread_mutex_lock(&persist->lock);
+	snapshot->version = persist->version++;
+	snapshot->prev = NULL;
+	snapshot->next = persist->snapshots;
+	if(persist->snapshots) persist->snapshots->prev = snapshot;
+	persist->snapshots = snapshot;
+	pthread_mutex_unlock(&persist->lock);
+	
+	for(i = 3; i >= 0; i--) avl_unlockRoot(tree, types[i]);
+	
+	
+	return snapshot;
+	
+}
+
+
+
+void* avl_snapshotSearchKey(struct AVLsnapshot* snapshot, char type, union AVLkey key){
+	
+	struct AVLpnode **root, *node;
+	if(!(root = avl_snapshotRoot(snapshot, type))) return NULL;
+	
+	
+	/* A snapshot's nodes never change, so it needs no lock */
+	node = avl_persistSearch(*root, type, key);
+	return node ? node->data : NULL;
+	
+}
+
+
+
+long avl_snapshotTraverseRoot(struct AVLsnapshot* snapshot, char type, void** ID, void** data, long n){
+	
+	struct AVLpnode **root;
+	if(!(root = avl_snapshotRoot(snapshot, type))) return 0;
+	
+	
+	return avl_persistTraverse(ID, data, n, *root);
+	
+}
+
+
+
+long avl_snapshotCountRoot(struct AVLsnapshot* snapshot, char type){
+	
+	switch(type){
+		case 'i': return snapshot->int_size;
+		case 'u': return snapshot->uint_size;
+		case 'd': return snapshot->double_size;
+		case 'c': return snapshot->string_size;
+	}
+	
+	
+	return 0;
+	
+}
+
+
+
+void avl_releaseSnapshot(struct AVLsnapshot* snapshot){
+	
+	struct AVLpersist *persist;
+	struct AVLsnapshot *oldest;
+	unsigned long version;
+	const char *types = "iudc";
+	long i, freed;
+	if(!snapshot) return;
+	persist = snapshot->persist;
+	
+	
+	/* Drops its roots, freeing every node no other version points to */
+	for(i = 0; i < 4; i++) avl_pRelease(*avl_snapshotRoot(snapshot, types[i]));
+	
+	
+	/* Leaves the live snapshots */
+	pthread_mutex_lock(&persist->lock);
+	if(snapshot->prev) snapshot->prev->next = snapshot->next;
+	else persist->snapshots = snapshot->next;
+	if(snapshot->next) snapshot->next->prev = snapshot->prev;
+	
+	
+	/* 	IDs and datas removed from versions up to the oldest live snapshot's, which
+		only older ones held, or all of them with no snapshot left, are freed */
+	for(oldest = persist->snapshots; oldest && oldest->next; oldest = oldest->next);
+	version = oldest ? oldest->version : ULONG_MAX;
+	
+	for(freed = 0; freed < persist->deadCount && persist->dead[freed].version <= version; freed++){
+		free(persist->dead[freed].string);
+		free(persist->dead[freed].data);
+	}
+	persist->deadCount -= freed;
+	if(freed) memmove(persist->dead, persist->dead + freed, persist->deadCount*sizeof(struct AVLpdead));
+	pthread_mutex_unlock(&persist->lock);
+	
+	
+	free(snapshot);
+	
+}
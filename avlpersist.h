@@ -0,0 +1,548 @@
+#ifndef __AVL_PERSIST__
+#define __AVL_PERSIST__
+
+
+
+#include <pthread.h>
+
+#include "avltree.h"
+
+
+
+
+
+/**	@Description
+ *		This structure is a node of a persistent avl tree,
+ *		the roots of a super avl tree created with
+ *		AVL_PERSISTENT, whose past versions, taken by
+ *		avl_snapshot(), stay readable as they were.
+ *
+ *		Versions share every node they have in common, so
+ *		a node has no parent, but counts how many parents,
+ *		roots and snapshots point to it. A node pointed to
+ *		once only belongs to the current version, and is
+ *		changed in place. Otherwise, an insertion or removal
+ *		copies it, along with every node on its way from the
+ *		root, so older versions never see it change: path
+ *		copying, O(log(n)) new nodes at most.
+ *
+ *		Copies of a node share its ID and data, which are
+ *		only freed once removed from the current version and
+ *		from every snapshot that may still hold them.
+ *
+ *	@Members
+ *		union AVLkey ID:				node's identifier, of its root's type;
+ *
+ *		void* data:						pointer to the data stored along with ID;
+ *
+ *		struct AVLpnode* Lchild:		pointer to node's left child. NULL if it hasn't one;
+ *
+ *		struct AVLpnode* Rchild:		pointer to node's right child. NULL if it hasn't one;
+ *
+ *		unsigned int refs:				how many parents, roots and snapshots point to
+ *										the node. It's freed once there's none left;
+ *
+ *		char height:					height of node's subtree, 1 for a leaf;
+ *
+ *		char type:						root type of the node, as given by avl_getKeyType().
+ *
+ */
+struct AVLpnode{
+	
+	union AVLkey ID;
+	void *data;
+	struct AVLpnode *Lchild;
+	struct AVLpnode *Rchild;
+	unsigned int refs;
+	char height;
+	char type;
+	
+};
+
+
+/**	@Description
+ *		This structure is an ID and data removed from the
+ *		current version of a persistent tree while snapshots
+ *		may still hold them, waiting to be freed.
+ *
+ *	@Members
+ *		char* string:				the ID, if it's a string, or NULL;
+ *
+ *		void* data:					the data stored along with it;
+ *
+ *		unsigned long version:		the version it was removed from: snapshots taken
+ *									before it, whose versions are lesser, hold it.
+ *
+ */
+struct AVLpdead{
+	
+	char *string;
+	void *data;
+	unsigned long version;
+	
+};
+
+
+/**	@Description
+ *		This structure holds the persistent avl trees of a
+ *		super avl tree created with AVL_PERSISTENT, in place
+ *		of its avl roots, which stay empty, along with its
+ *		live snapshots.
+ *
+ *	@Members
+ *		struct AVLpnode* int_root:			current version of the persistent tree of int
+ *											& variations IDs. NULL while it's empty, as
+ *											all other roots;
+ *
+ *		struct AVLpnode* uint_root:			persistent tree of unsigned int & variations IDs;
+ *
+ *		struct AVLpnode* double_root:		persistent tree of float & variations IDs;
+ *
+ *		struct AVLpnode* string_root:		persistent tree of string IDs;
+ *
+ *		struct AVLsnapshot* snapshots:		the live snapshots, newest first;
+ *
+ *		struct AVLpdead* dead:				IDs and datas removed while snapshots may still
+ *											hold them, oldest first, allocated on heap;
+ *
+ *		long deadCount:						how many there are;
+ *
+ *		long deadSize:						how many fit into dead;
+ *
+ *		unsigned long version:				the version the next snapshot will be of;
+ *
+ *		pthread_mutex_t lock:				protects snapshots, dead and version, since
+ *											snapshots may be released by any thread.
+ *
+ */
+struct AVLpersist{
+	
+	struct AVLpnode *int_root;
+	struct AVLpnode *uint_root;
+	struct AVLpnode *double_root;
+	struct AVLpnode *string_root;
+	struct AVLsnapshot *snapshots;
+	struct AVLpdead *dead;
+	long deadCount;
+	long deadSize;
+	unsigned long version;
+	pthread_mutex_t lock;
+	
+};
+
+
+/**	@Description
+ *		This structure is a snapshot of a super avl tree
+ *		created with AVL_PERSISTENT: every root as it was
+ *		when avl_snapshot() took it, in O(1), readable by
+ *		any thread, with no lock at all, while writers go
+ *		on changing the tree.
+ *
+ *		It must be released with avl_releaseSnapshot(),
+ *		before the tree is freed.
+ *
+ *	@Members
+ *		struct AVLpersist* persist:			the persistent trees it was taken from;
+ *
+ *		struct AVLpnode* int_root:			root of the int & variations IDs, as it was,
+ *											as well as the other roots;
+ *
+ *		struct AVLpnode* uint_root:			root of the unsigned int & variations IDs;
+ *
+ *		struct AVLpnode* double_root:		root of the float & variations IDs;
+ *
+ *		struct AVLpnode* string_root:		root of the string IDs;
+ *
+ *		long int_size:						how many nodes int_root holds, as well as
+ *											uint_size, double_size and string_size do
+ *											for their roots;
+ *
+ *		unsigned long version:				the version it's of, greater than older ones';
+ *
+ *		struct AVLsnapshot* prev:			the next newer live snapshot. NULL if it's the newest;
+ *
+ *		struct AVLsnapshot* next:			the next older live snapshot. NULL if it's the oldest.
+ *
+ */
+struct AVLsnapshot{
+	
+	struct AVLpersist *persist;
+	struct AVLpnode *int_root;
+	struct AVLpnode *uint_root;
+	struct AVLpnode *double_root;
+	struct AVLpnode *string_root;
+	long int_size;
+	long uint_size;
+	long double_size;
+	long string_size;
+	unsigned long version;
+	struct AVLsnapshot *prev;
+	struct AVLsnapshot *next;
+	
+};
+
+
+
+
+
+/**	@Functionality
+ *		Inserts an identifier, already converted into an
+ *		AVLkey, and data into the current version of a
+ *		persistent tree, going left of any equal ID, copying every
+ *		node on its way that a snapshot shares. If it's a
+ *		string, it's copied into the node, heap allocated.
+ *
+ *		This is a helper function of avl_insertKey() function.
+ *
+ *	@Arguments
+ *		struct AVLpnode** root:	a pointer to one of an AVLpersist structure's roots;
+ *
+ *		char type:				root type, as given by avl_getKeyType();
+ *
+ *		union AVLkey key:		the identifier, as given by avl_toKey();
+ *
+ *		void* data:				pointer to the data to be stored into the tree.
+ *
+ *	@Return
+ *		None
+ *
+ */
+void avl_persistInsert(struct AVLpnode** root, char type, union AVLkey key, void* data);
+
+
+
+/**	@Functionality
+ *		Searches an identifier, already converted into an
+ *		AVLkey, into any version of a persistent tree.
+ *
+ *		This is a helper function of avl_searchData() function.
+ *
+ *	@Arguments
+ *		struct AVLpnode* root:	a root of a persistent tree, current or a snapshot's;
+ *
+ *		char type:				root type, as given by avl_getKeyType();
+ *
+ *		union AVLkey key:		the identifier, as given by avl_toKey().
+ *
+ *	@Return
+ *		On success:	a pointer to the node holding the identifier
+ *
+ *		On failure:	NULL (if key is not found)
+ *
+ */
+struct AVLpnode* avl_persistSearch(struct AVLpnode* root, char type, union AVLkey key);
+
+
+
+/**	@Functionality
+ *		Searches an identifier, already converted into an
+ *		AVLkey, into the current version of a persistent
+ *		tree and removes it, if found, copying every node
+ *		on its way that a snapshot shares. Its ID and data
+ *		are freed right away if there's no live snapshot,
+ *		or else once every one that may hold them is released.
+ *
+ *		This is a helper function of avl_removeKey() function.
+ *
+ *	@Arguments
+ *		struct AVLpersist* persist:	a pointer to an AVLpersist structure;
+ *
+ *		struct AVLpnode** root:		a pointer to one of its roots;
+ *
+ *		char type:					root type, as given by avl_getKeyType();
+ *
+ *		union AVLkey key:			the identifier, as given by avl_toKey().
+ *
+ *	@Return
+ *		On success:	1
+ *
+ *		On failure:	0 (if key is not found)
+ *
+ */
+int avl_persistRemove(struct AVLpersist* persist, struct AVLpnode** root, char type, union AVLkey key);
+
+
+
+/**	@Functionality
+ *		Gets up to n IDs and datas of any version of a
+ *		persistent tree, in ascending order, into
+ *		preallocated ID and data arrays.
+ *
+ *		This is a helper function of avl_traverseRoot() function.
+ *
+ *	@Arguments
+ *		void** ID:				an array of at least n void pointers, that will
+ *								store IDs, or NULL;
+ *
+ *		void** data:			an array of at least n void pointers, that will
+ *								store datas, or NULL;
+ *
+ *		long n:					how many IDs and datas, at most, to get;
+ *
+ *		struct AVLpnode* root:	a root of a persistent tree, current or a snapshot's.
+ *
+ *	@Return
+ *		How many IDs and datas were put into the arrays
+ *
+ */
+long avl_persistTraverse(void** ID, void** data, long n, struct AVLpnode* root);
+
+
+
+/**	@Functionality
+ *		Checks whether a version of a persistent tree is
+ *		a consistent avl tree: IDs sorted, heights right
+ *		and balanced, and every node pointed to at least once.
+ *
+ *	@Arguments
+ *		struct AVLpnode* root:	a root of a persistent tree, current or a snapshot's.
+ *
+ *	@Return
+ *		On success:	the tree height, 0 if it's empty
+ *
+ *		On failure:	-1 (if any of the above doesn't hold)
+ *
+ */
+long avl_persistVerify(struct AVLpnode* root);
+
+
+
+/**	@Functionality
+ *		Frees persistent trees, with all of their IDs and
+ *		datas, those waiting for snapshots included. Every
+ *		snapshot must be released beforehand.
+ *
+ *		This is a helper function of avl_free() function.
+ *
+ *	@Argument
+ *		struct AVLpersist* persist:	a pointer to an AVLpersist structure, or NULL.
+ *
+ *	@Return
+ *		None
+ *
+ */
+void avl_persistFree(struct AVLpersist* persist);
+
+
+
+/**	@Functionality
+ *		Takes a snapshot of a super avl tree created with
+ *		AVL_PERSISTENT, in O(1): every current root stays
+ *		readable as it is, by any thread with no lock, no
+ *		matter how the tree changes afterwards.
+ *
+ *		The tree's writers then copy the nodes they change
+ *		the first time, along with their way from the root,
+ *		while the snapshot holds them.
+ *
+ *		On a tree created with AVL_CONCURRENT, it keeps
+ *		writers out of every root meanwhile, so all roots
+ *		are taken at the same moment.
+ *
+ *	@Argument
+ *		struct AVLtree* tree:	a pointer to an AVLtree structure, a super avl tree,
+ *								created with avl_createTreeEx() and AVL_PERSISTENT.
+ *
+ *	@Return
+ *		On success:	a pointer to an AVLsnapshot structure, allocated on
+ *					heap, to be released by avl_releaseSnapshot()
+ *
+ *		On failure:	NULL (if the tree isn't persistent)
+ *
+ */
+struct AVLsnapshot* avl_snapshot(struct AVLtree* tree);
+
+
+
+/**	@Functionality
+ *		Searches an identifier, already converted into
+ *		an AVLkey, into a snapshot, with no lock.
+ *
+ *		This is a helper function of avl_snapshotSearch() macro function.
+ *
+ *	@Arguments
+ *		struct AVLsnapshot* snapshot:	a pointer to an AVLsnapshot structure;
+ *
+ *		char type:						which root to search, as given by avl_getKeyType();
+ *
+ *		union AVLkey key:				the identifier, as given by avl_toKey().
+ *
+ *	@Return
+ *		On success:	the data stored along with key when the snapshot
+ *					was taken
+ *
+ *		On failure:	NULL (if key wasn't in the tree back then)
+ *
+ */
+void* avl_snapshotSearchKey(struct AVLsnapshot* snapshot, char type, union AVLkey key);
+
+
+
+/**	@Functionality
+ *		Gets up to n IDs and datas of one of a snapshot's
+ *		roots, in ascending order, into preallocated ID and
+ *		data arrays, with no lock.
+ *
+ *		This is a helper function of avl_snapshotTraverseInto() macro function.
+ *
+ *	@Arguments
+ *		struct AVLsnapshot* snapshot:	a pointer to an AVLsnapshot structure;
+ *
+ *		char type:						which root to traverse, as given by avl_getKeyType();
+ *
+ *		void** ID:						array of at least n void pointers, or NULL;
+ *
+ *		void** data:					array of at least n void pointers, or NULL;
+ *
+ *		long n:							how many IDs and datas, at most, to get.
+ *
+ *	@Return
+ *		Unconditionally:	how many IDs and datas were put into the arrays
+ *
+ */
+long avl_snapshotTraverseRoot(struct AVLsnapshot* snapshot, char type, void** ID, void** data, long n);
+
+
+
+/**	@Functionality
+ *		Gets how many IDs one of a snapshot's roots holds.
+ *
+ *		This is a helper function of avl_snapshotCount() macro function.
+ *
+ *	@Arguments
+ *		struct AVLsnapshot* snapshot:	a pointer to an AVLsnapshot structure;
+ *
+ *		char type:						which root to count, as given by avl_getKeyType().
+ *
+ *	@Return
+ *		Unconditionally:	how many IDs the root held when the snapshot was taken
+ *
+ */
+long avl_snapshotCountRoot(struct AVLsnapshot* snapshot, char type);
+
+
+
+/**	@Functionality
+ *		Releases a snapshot, freeing every node only it
+ *		held, and every removed ID and data no older live
+ *		snapshot may still hold. May be called by any
+ *		thread, while writers change the tree.
+ *
+ *	@Argument
+ *		struct AVLsnapshot* snapshot:	a pointer to an AVLsnapshot structure, as given
+ *										by avl_snapshot(), or NULL.
+ *
+ *	@Return
+ *		None
+ *
+ */
+void avl_releaseSnapshot(struct AVLsnapshot* snapshot);
+
+
+
+
+
+/* Gets a pointer to a persistent tree's root of 'type', as given by avl_getKeyType() */
+static inline struct AVLpnode** avl_persistRoot(struct AVLpersist* persist, char type){
+	switch(type){
+		case 'i': return &persist->int_root;
+		case 'u': return &persist->uint_root;
+		case 'd': return &persist->double_root;
+		case 'c': return &persist->string_root;
+	}
+	return NULL;
+}
+
+
+
+/* Gets a pointer to a snapshot's root of 'type', as given by avl_getKeyType() */
+static inline struct AVLpnode** avl_snapshotRoot(struct AVLsnapshot* snapshot, char type){
+	switch(type){
+		case 'i': return &snapshot->int_root;
+		case 'u': return &snapshot->uint_root;
+		case 'd': return &snapshot->double_root;
+		case 'c': return &snapshot->string_root;
+	}
+	return NULL;
+}
+
+
+
+/* Gets a persistent node's ID, as avl_traverse() hands it out */
+static inline void* avl_persistID(struct AVLpnode* node){
+	return (node->type == 'c') ? (void*)node->ID.string : (void*)&node->ID;
+}
+
+
+
+
+
+/**	@Functionality
+ *		Searches for 'id' into a snapshot of a super
+ *		avl tree, retrieving its data as it was when
+ *		the snapshot was taken, with no lock.
+ *
+ *	@Arguments
+ *		struct AVLsnapshot* snapshot:	a pointer to an AVLsnapshot structure;
+ *
+ *		? id:							the identifier to search for;
+ *
+ *		void* DATA:						a pointer variable to hold the found data,
+ *										or NULL, if it wasn't found.
+ *
+ *	@Return
+ *		None
+ *
+ */
+#define avl_snapshotSearch(snapshot, id, DATA)										\
+		do {																		\
+			DATA = avl_snapshotSearchKey(snapshot, avl_getKeyType(id), avl_toKey(id));	\
+		} while(0)
+
+
+
+/**	@Functionality
+ *		Gets up to n IDs and datas of a snapshot of a
+ *		super avl tree, in ascending order, into
+ *		preallocated arrays, with no lock.
+ *
+ *	@Arguments
+ *		struct AVLsnapshot* snapshot:	a pointer to an AVLsnapshot structure;
+ *
+ *		void** ID:						an array of at least n void pointers, or NULL;
+ *
+ *		void** data:					an array of at least n void pointers, or NULL;
+ *
+ *		long n:							how many IDs and datas, at most, to get,
+ *										normally avl_snapshotCount() of the same type;
+ *
+ *		? type:							a primitive type to identify which root to traverse.
+ *
+ *	@Return
+ *		How many IDs and datas were put into the arrays
+ *
+ */
+#define avl_snapshotTraverseInto(snapshot, ID, data, n, type)						\
+		avl_snapshotTraverseRoot(snapshot, avl_getKeyType(type), ID, data, n)
+
+
+
+/**	@Functionality
+ *		Gets how many IDs a snapshot of a super avl
+ *		tree holds, of 'type' primitive type.
+ *
+ *	@Arguments
+ *		struct AVLsnapshot* snapshot:	a pointer to an AVLsnapshot structure;
+ *
+ *		? type:							a primitive type to identify which root to count.
+ *
+ *	@Return
+ *		How many IDs the root held when the snapshot was taken
+ *
+ */
+#define avl_snapshotCount(snapshot, type)											\
+		avl_snapshotCountRoot(snapshot, avl_getKeyType(type))
+
+
+
+#endif
@@ -0,0 +1,212 @@
+#include <sched.h>
+#include <unistd.h>
+
+#include "avlpool.h"
+
+
+
+/* Index of this thread's deque, in the pool whose job it's working on */
+static _Thread_local int avl_worker;
+
+
+
+/* Pushes task at deque's tail, making room for it if deque is full */
+static void avl_poolPush(struct AVLdeque* deque, struct AVLtask task){
+	
+	pthread_mutex_lock(&deque->lock);
+	
+	
+	/* Moves tasks back to the start, if stolen ones left room there, or else doubles deque */
+	if(deque->tail == deque->size){
+		if(deque->head){
+			memmove(deque->tasks, deque->tasks + deque->head, (deque->tail - deque->head)*sizeof(struct AVLtask));
+			deque->tail -= deque->head;
+			deque->head = 0;
+		} else {
+			deque->size *= 2;
+			deque->tasks = realloc(deque->tasks, deque->size*sizeof(struct AVLtask));
+		}
+	}
+	deque->tasks[deque->tail++] = task;
+	
+	
+	pthread_mutex_unlock(&deque->lock);
+	
+}
+
+
+
+/* 	Takes a task out of deque into task, the newest one if end is 't', for its own
+	worker, or the oldest one if end is 'h', for a thief. Returns 0 if it's empty */
+static int avl_poolTake(struct AVLdeque* deque, struct AVLtask* task, char end){
+	
+	int taken = 0;
+	pthread_mutex_lock(&deque->lock);
+	
+	
+	if(deque->head < deque->tail){
+		*task = (end == 't') ? deque->tasks[--deque->tail] : deque->tasks[deque->head++];
+		if(deque->head == deque->tail) deque->head = deque->tail = 0;
+		taken = 1;
+	}
+	
+	
+	pthread_mutex_unlock(&deque->lock);
+	return taken;
+	
+}
+
+
+
+/* 	Runs tasks of pool's current job as worker 'me', its own ones first, then
+	stealing from other workers, until every task of the job is done */
+static void avl_poolWork(struct AVLpool* pool, int me){
+	
+	struct AVLtask task;
+	int i, found;
+	
+	
+	while(__atomic_load_n(&pool->pending, __ATOMIC_ACQUIRE)){
+		
+		/* Looks for a task in its own deque, then in the others', from the next one on */
+		found = avl_poolTake(&pool->deques[me], &task, 't');
+		for(i = 1; !found && i < pool->count; i++)
+			found = avl_poolTake(&pool->deques[(me+i) % pool->count], &task, 'h');
+		
+		
+		/* 	With no task anywhere, others' are still running and may spawn more. Once it's
+			done, what the task wrote is seen by whoever sees pending drop because of it */
+		if(!found){
+			sched_yield();
+			continue;
+		}
+		task.run(pool, &task);
+		__atomic_sub_fetch(&pool->pending, 1, __ATOMIC_ACQ_REL);
+		
+	}
+	
+}
+
+
+
+/* Body of a pool's own thread, which sleeps until a job begins, then works on it */
+static void* avl_poolThread(void* arg){
+	
+	struct AVLdeque *deque = arg;
+	struct AVLpool *pool = deque->pool;
+	long jobs = 0;
+	avl_worker = deque - pool->deques;
+	
+	
+	for(;;){
+		
+		pthread_mutex_lock(&pool->lock);
+		while(!pool->stop && pool->jobs == jobs) pthread_cond_wait(&pool->wake, &pool->lock);
+		if(pool->stop){
+			pthread_mutex_unlock(&pool->lock);
+			return NULL;
+		}
+		jobs = pool->jobs;
+		pthread_mutex_unlock(&pool->lock);
+		
+		avl_poolWork(pool, avl_worker);
+		
+	}
+	
+}
+
+
+
+struct AVLpool* avl_createPool(int threads){
+	
+	struct AVLpool *pool = malloc(sizeof(struct AVLpool));
+	int i;
+	
+	
+	if(threads <= 0) threads = sysconf(_SC_NPROCESSORS_ONLN);
+	if(threads <= 0) threads = 1;
+	
+	pool->count = threads;
+	pool->stop = 0;
+	pool->pending = 0;
+	pool->jobs = 0;
+	pthread_mutex_init(&pool->lock, NULL);
+	pthread_cond_init(&pool->wake, NULL);
+	
+	
+	/* Gives every worker an empty deque, then starts the pool's own threads */
+	pool->deques = malloc(threads*sizeof(struct AVLdeque));
+	for(i = 0; i < threads; i++){
+		pthread_mutex_init(&pool->deques[i].lock, NULL);
+		pool->deques[i].tasks = malloc(AVL_POOL_TASKS*sizeof(struct AVLtask));
+		pool->deques[i].head = pool->deques[i].tail = 0;
+		pool->deques[i].size = AVL_POOL_TASKS;
+		pool->deques[i].pool = pool;
+	}
+	
+	pool->threads = malloc(threads*sizeof(pthread_t));
+	for(i = 1; i < threads; i++) pthread_create(&pool->threads[i], NULL, avl_poolThread, &pool->deques[i]);
+	
+	
+	return pool;
+	
+}
+
+
+
+void avl_poolRun(struct AVLpool* pool, struct AVLtask task){
+	
+	/* The calling thread is worker 0, whose deque the job's first task goes into */
+	avl_worker = 0;
+	__atomic_store_n(&pool->pending, 1, __ATOMIC_RELAXED);
+	avl_poolPush(&pool->deques[0], task);
+	
+	
+	/* Wakes the pool's own threads up, then works along with them */
+	pthread_mutex_lock(&pool->lock);
+	pool->jobs++;
+	pthread_cond_broadcast(&pool->wake);
+	pthread_mutex_unlock(&pool->lock);
+	
+	avl_poolWork(pool, 0);
+	
+}
+
+
+
+void avl_poolSpawn(struct AVLpool* pool, struct AVLtask task){
+	
+	/* Counts the task before anyone may take it, so the job can't seem done meanwhile */
+	__atomic_add_fetch(&pool->pending, 1, __ATOMIC_RELAXED);
+	avl_poolPush(&pool->deques[avl_worker], task);
+	
+}
+
+
+
+void avl_freePool(struct AVLpool* pool){
+	
+	int i;
+	if(!pool) return;
+	
+	
+	/* Wakes the pool's own threads up to exit, and waits for them */
+	pthread_mutex_lock(&pool->lock);
+	pool->stop = 1;
+	pthread_cond_broadcast(&pool->wake);
+	pthread_mutex_unlock(&pool->lock);
+	
+	for(i = 1; i < pool->count; i++) pthread_join(pool->threads[i], NULL);
+	
+	
+	for(i = 0; i < pool->count; i++){
+		pthread_mutex_destroy(&pool->deques[i].lock);
+		free(pool->deques[i].tasks);
+	}
+	pthread_mutex_destroy(&pool->lock);
+	pthread_cond_destroy(&pool->wake);
+	free(pool->deques);
+	free(pool->threads);
+	free(pool);
+	
+}
@@ -0,0 +1,210 @@
+#ifndef __AVL_POOL__
+#define __AVL_POOL__
+
+
+
+#include <pthread.h>
+
+#include "avltree.h"
+
+
+
+/* Tasks a thread pool's worker's deque holds at first. It grows as needed */
+#define AVL_POOL_TASKS	64
+
+
+
+
+
+/**	@Description
+ *		This structure is a task of a thread pool: a function
+ *		to be run with the task itself, which carries what the
+ *		function works on.
+ *
+ *	@Members
+ *		void (*run)():		function that does the task, called with the pool
+ *							and a copy of the task;
+ *
+ *		void* arg:			anything every task of a job shares;
+ *
+ *		void* node:			what this task in particular works on, as a node
+ *							or a slab;
+ *
+ *		long index:			where this task's work starts, as an index into
+ *							an array;
+ *
+ *		long n:				how much work there is, from index on.
+ *
+ */
+struct AVLtask{
+	
+	void (*run)(struct AVLpool* pool, struct AVLtask* task);
+	void *arg;
+	void *node;
+	long index;
+	long n;
+	
+};
+
+
+/**	@Description
+ *		This structure is a deque of tasks of one of a thread
+ *		pool's workers. Its worker pushes and pops tasks at its
+ *		tail, newest first, while idle workers steal them from
+ *		its head, oldest first, which are the biggest ones when
+ *		tasks split their work into halves.
+ *
+ *	@Members
+ *		pthread_mutex_t lock:	keeps the worker and thieves from taking the same task;
+ *
+ *		struct AVLtask* tasks:	the tasks, from head to tail, allocated on heap;
+ *
+ *		long head:				index of the oldest task;
+ *
+ *		long tail:				index after the newest task;
+ *
+ *		long size:				how many tasks fit into tasks;
+ *
+ *		struct AVLpool* pool:	the pool its worker belongs to.
+ *
+ */
+struct AVLdeque{
+	
+	pthread_mutex_t lock;
+	struct AVLtask *tasks;
+	long head;
+	long tail;
+	long size;
+	struct AVLpool *pool;
+	
+};
+
+
+/**	@Description
+ *		This structure is a work stealing thread pool, which
+ *		runs one job at a time: a task that may spawn more
+ *		tasks, as they split their work among the workers.
+ *
+ *		Its workers are the thread that runs a job and the
+ *		pool's own threads, one less, which sleep between jobs.
+ *
+ *		It's created by avl_createPool() and must be freed
+ *		with avl_freePool().
+ *
+ *	@Members
+ *		pthread_t* threads:			the pool's own threads;
+ *
+ *		struct AVLdeque* deques:	a deque of tasks for each worker, the one
+ *									running jobs first;
+ *
+ *		int count:					how many workers there are;
+ *
+ *		int stop:					whether the pool's threads must exit;
+ *
+ *		long pending:				how many tasks of the current job are yet to
+ *									be done. 0 between jobs;
+ *
+ *		long jobs:					how many jobs have been run, so sleeping
+ *									threads know when a new one begins;
+ *
+ *		pthread_mutex_t lock:		protects stop and jobs;
+ *
+ *		pthread_cond_t wake:		signals sleeping threads that a job began, or
+ *									that they must exit.
+ *
+ */
+struct AVLpool{
+	
+	pthread_t *threads;
+	struct AVLdeque *deques;
+	int count;
+	int stop;
+	long pending;
+	long jobs;
+	pthread_mutex_t lock;
+	pthread_cond_t wake;
+	
+};
+
+
+
+
+
+/**	@Functionality
+ *		Creates a thread pool allocated on heap, with
+ *		'threads' workers: the thread running a job and
+ *		threads-1 of the pool's own.
+ *
+ *	@Argument
+ *		int threads:	how many workers the pool has. If 0 or less, as many
+ *						as there are CPUs online.
+ *
+ *	@Return
+ *		Unconditionally:	a pointer to an AVLpool structure,
+ *							allocated on heap, ready to use
+ *
+ */
+struct AVLpool* avl_createPool(int threads);
+
+
+
+/**	@Functionality
+ *		Runs a job on a thread pool: runs task, and every
+ *		task spawned meanwhile by avl_poolSpawn(), split
+ *		among the pool's workers, returning once all of
+ *		them are done. The calling thread works as well.
+ *
+ *		A pool runs a single job at a time, so it must
+ *		not be called on the same pool by two threads at
+ *		once, nor from within a task.
+ *
+ *	@Arguments
+ *		struct AVLpool* pool:	a pointer to an AVLpool structure, as given by
+ *								avl_createPool();
+ *
+ *		struct AVLtask task:	the job's first task.
+ *
+ *	@Return
+ *		None
+ *
+ */
+void avl_poolRun(struct AVLpool* pool, struct AVLtask task);
+
+
+
+/**	@Functionality
+ *		Spawns a task of the job a thread pool is running,
+ *		from within one of its tasks: pushes it into the
+ *		calling worker's deque, to be run by that worker
+ *		later, or stolen by an idle one.
+ *
+ *	@Arguments
+ *		struct AVLpool* pool:	a pointer to an AVLpool structure, running a job;
+ *
+ *		struct AVLtask task:	the task to spawn.
+ *
+ *	@Return
+ *		None
+ *
+ */
+void avl_poolSpawn(struct AVLpool* pool, struct AVLtask task);
+
+
+
+/**	@Functionality
+ *		Frees a thread pool, waiting for its threads to
+ *		exit.
+ *
+ *	@Argument
+ *		struct AVLpool* pool:	a pointer to an AVLpool structure, as given by
+ *								avl_createPool().
+ *
+ *	@Return
+ *		None
+ *
+ */
+void avl_freePool(struct AVLpool* pool);
+
+
+
+#endif
@@ -0,0 +1,233 @@
+#include "avlshard.h"
+
+
+
+/* Mixes a hash's bits all over it, so IDs close to each other still spread evenly among shards */
+static inline unsigned long long avl_shardMix(unsigned long long hash){
+	hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebULL;
+	return hash ^ (hash >> 31);
+}
+
+
+
+/* 	Hashes key: numbers by their bits, reals rounded to a double, so 0.0 and -0.0
+	as well as any reals equal to each other hash the same, and strings by FNV-1a */
+static unsigned long long avl_shardHash(char type, union AVLkey key){
+	
+	union { double real; unsigned long long bits; } d;
+	unsigned long long hash = 14695981039346656037ULL;
+	const char *c;
+	
+	
+	switch(type){
+		
+		case 'i': case 'u': return avl_shardMix(key.uinteger);
+		
+		case 'd':
+			d.real = (double)key.real + 0.0;
+			return avl_shardMix(d.bits);
+		
+	}
+	
+	
+	for(c = key.string; *c; c++) hash = (hash ^ (unsigned char)*c) * 1099511628211ULL;
+	return avl_shardMix(hash);
+	
+}
+
+
+
+struct AVLshards* avl_createShards(int count, int options){
+	
+	struct AVLshards *shards = malloc(sizeof(struct AVLshards));
+	int i;
+	
+	
+	/* Every shard is concurrent, so each one is locked on its own */
+	shards->trees = malloc(count*sizeof(struct AVLtree*));
+	shards->count = count;
+	for(i = 0; i < count; i++)
+		shards->trees[i] = avl_createTreeEx(options | AVL_CONCURRENT);
+	
+	
+	return shards;
+	
+}
+
+
+
+struct AVLtree* avl_shardOf(struct AVLshards* shards, char type, union AVLkey key){
+	return shards->trees[avl_shardHash(type, key) % shards->count];
+}
+
+
+
+long avl_shardCountRoot(struct AVLshards* shards, char type){
+	
+	long c = 0;
+	int i;
+	
+	
+	for(i = 0; i < shards->count; i++){
+		switch(type){
+			case 'i': c += shards->trees[i]->int_size; break;
+			case 'u': c += shards->trees[i]->uint_size; break;
+			case 'd': c += shards->trees[i]->double_size; break;
+			case 'c': c += shards->trees[i]->string_size; break;
+		}
+	}
+	
+	
+	return c;
+	
+}
+
+
+
+/* Whether shard a's next ID comes before shard b's. Equal IDs go in order of shards */
+static inline int avl_shardBefore(struct AVLshardRange* range, int a, int b){
+	int eval = avl_keyCompare(range->type, &range->keys[a], &range->keys[b]);
+	return eval < 0 || (eval == 0 && a < b);
+}
+
+
+
+/* 	Pulls the next ID and data of shard i out of its own range, keeping
+	its key to compare with other shards'. Returns 0 if there's none left */
+static int avl_shardPull(struct AVLshardRange* range, int i){
+	
+	if(!avl_rangeNext(&range->ranges[i], &range->ID[i], &range->data[i])) return 0;
+	
+	range->keys[i] = (range->type == 'c') ? avl_stringKey(range->ID[i]) : *(union AVLkey*)range->ID[i];
+	return 1;
+	
+}
+
+
+
+/* Moves the shard at heap's index i down, until no shard under it comes before it */
+static void avl_shardSift(struct AVLshardRange* range, int i){
+	
+	int *heap = range->heap, least, shard = heap[i];
+	
+	
+	while((least = 2*i + 1) < range->size){
+		if(least + 1 < range->size && avl_shardBefore(range, heap[least+1], heap[least])) least++;
+		if(!avl_shardBefore(range, heap[least], shard)) break;
+		
+		heap[i] = heap[least];
+		i = least;
+	}
+	heap[i] = shard;
+	
+}
+
+
+
+void avl_shardRangeStart(struct AVLshards* shards, struct AVLshardRange* range, char type, union AVLkey lo, union AVLkey hi){
+	
+	int i, count = shards->count;
+	
+	
+	/* Takes all of range's arrays from a single heap block */
+	range->shards = shards;
+	range->type = type;
+	range->ranges = malloc(count*(sizeof(struct AVLrange) + sizeof(union AVLkey) + 2*sizeof(void*) + sizeof(int)));
+	range->keys = (union AVLkey*)(range->ranges + count);
+	range->ID = (void**)(range->keys + count);
+	range->data = range->ID + count;
+	range->heap = (int*)(range->data + count);
+	range->size = 0;
+	
+	
+	/* 	Keeps every shard's root from changing, always in the same order, so ranges
+		at once never wait for each other, then starts a range over each one */
+	for(i = 0; i < count; i++){
+		avl_lockRoot(shards->trees[i], type, 'x');
+		avl_rangeStart(shards->trees[i], &range->ranges[i], type, lo, hi);
+		if(avl_shardPull(range, i)) range->heap[range->size++] = i;
+	}
+	
+	
+	/* Orders the shards with IDs in the range as a heap */
+	for(i = range->size/2 - 1; i >= 0; i--) avl_shardSift(range, i);
+	
+}
+
+
+
+int avl_shardRangeNext(struct AVLshardRange* range, void** ID, void** data){
+	
+	int shard;
+	if(!range->size) return 0;
+	
+	
+	/* Hands out the smallest next ID among the shards */
+	shard = range->heap[0];
+	if(ID) *ID = range->ID[shard];
+	if(data) *data = range->data[shard];
+	
+	
+	/* 	Its shard moves on to its own next ID, and down the heap, or
+		out of it, with the last shard of the heap taking its place */
+	if(!avl_shardPull(range, shard)) range->heap[0] = range->heap[--range->size];
+	avl_shardSift(range, 0);
+	
+	
+	return 1;
+	
+}
+
+
+
+void avl_shardRangeEnd(struct AVLshardRange* range){
+	
+	int i;
+	
+	
+	for(i = range->shards->count - 1; i >= 0; i--)
+		avl_unlockRoot(range->shards->trees[i], range->type);
+	
+	free(range->ranges);
+	range->ranges = NULL;
+	range->size = 0;
+	
+}
+
+
+
+long avl_shardRangeKey(struct AVLshards* shards, char type, union AVLkey lo, union AVLkey hi,
+					   int (*callback)(void* ID, void* data, void* arg), void* arg){
+	
+	struct AVLshardRange range;
+	void *ID, *data;
+	long c = 0;
+	
+	
+	/* Pulls every ID of the range, passing them to callback until it asks to stop */
+	avl_shardRangeStart(shards, &range, type, lo, hi);
+	while(avl_shardRangeNext(&range, &ID, &data)){
+		c++;
+		if(callback(ID, data, arg)) break;
+	}
+	avl_shardRangeEnd(&range);
+	
+	
+	return c;
+	
+}
+
+
+
+void avl_freeShards(struct AVLshards* shards){
+	
+	int i;
+	if(!shards) return;
+	
+	
+	for(i = 0; i < shards->count; i++) avl_free(shards->trees[i]);
+	free(shards->trees);
+	free(shards);
+	
+}
@@ -0,0 +1,456 @@
+#ifndef __AVL_SHARD__
+#define __AVL_SHARD__
+
+
+
+#include "avltree.h"
+
+
+
+
+
+/**	@Description
+ *		This structure is a sharded tree: many independent
+ *		super avl trees, all concurrent, among which IDs
+ *		are spread by a hash of their own.
+ *
+ *		Every ID always goes to the same shard, so each one
+ *		is inserted, searched for and removed in its shard
+ *		only, under that shard's root lock. Writers of IDs
+ *		in different shards then never wait for each other,
+ *		nor go through the same nodes at the top of a root.
+ *
+ *		IDs are spread with no order among shards, so ranges
+ *		go through every shard at once, merging their IDs
+ *		into ascending order as they go.
+ *
+ *		It's created by avl_createShards() and must be freed
+ *		with avl_freeShards().
+ *
+ *	@Members
+ *		struct AVLtree** trees:		the shards, each one a super avl tree created
+ *									with AVL_CONCURRENT, or AVL_RCU;
+ *
+ *		int count:					how many shards there are.
+ *
+ */
+struct AVLshards{
+	
+	struct AVLtree **trees;
+	int count;
+	
+};
+
+
+/**	@Description
+ *		This structure is a range of IDs being pulled, in
+ *		ascending order, out of one of the roots of every
+ *		shard of a sharded tree, one ID at a time.
+ *
+ *		It keeps a range over each shard, and a heap of
+ *		the shards by the ID each one has next, so every
+ *		ID pulled takes O(log(count)) compares, a k-way
+ *		merge of the shards.
+ *
+ *		It's set up by avl_shardRangeBegin(), advanced by
+ *		avl_shardRangeNext() and must be ended by
+ *		avl_shardRangeEnd(), since every shard's root is
+ *		kept from changing in between, and it holds heap
+ *		memory.
+ *
+ *	@Members
+ *		struct AVLshards* shards:	the sharded tree the range goes through;
+ *
+ *		struct AVLrange* ranges:	a range over each shard;
+ *
+ *		union AVLkey* keys:			the next ID of each shard;
+ *
+ *		void** ID:					the next ID of each shard, as avl_rangeNext()
+ *									hands it out;
+ *
+ *		void** data:				the next data of each shard;
+ *
+ *		int* heap:					the shards with IDs left, ordered as a binary
+ *									heap with the smallest next ID first;
+ *
+ *		int size:					how many shards there are in heap;
+ *
+ *		char type:					root type of the range, as given by avl_getKeyType().
+ *
+ */
+struct AVLshardRange{
+	
+	struct AVLshards *shards;
+	struct AVLrange *ranges;
+	union AVLkey *keys;
+	void **ID;
+	void **data;
+	int *heap;
+	int size;
+	char type;
+	
+};
+
+
+
+
+
+/**	@Functionality
+ *		Creates a sharded tree allocated on heap, with
+ *		'count' shards, all empty, each one a super avl
+ *		tree created with avl_createTreeEx() and options,
+ *		along with AVL_CONCURRENT. With AVL_RCU, ranges
+ *		count as nested locks, so count must be within
+ *		AVL_RCU_NEST.
+ *
+ *	@Arguments
+ *		int count:		how many shards to create, at least 1;
+ *
+ *		int options:	options for each shard, as avl_createTreeEx() takes them.
+ *
+ *	@Return
+ *		Unconditionally:	a pointer to an AVLshards structure,
+ *							allocated on heap, ready to use
+ *
+ */
+struct AVLshards* avl_createShards(int count, int options);
+
+
+
+/**	@Functionality
+ *		Gets the shard an identifier, already converted
+ *		into an AVLkey, belongs to, by a hash of it.
+ *
+ *		This is a helper function of avl_shard() macro function.
+ *
+ *	@Arguments
+ *		struct AVLshards* shards:	a pointer to an AVLshards structure, as given
+ *									by avl_createShards();
+ *
+ *		char type:					root type, as given by avl_getKeyType();
+ *
+ *		union AVLkey key:			the identifier, as given by avl_toKey().
+ *
+ *	@Return
+ *		Unconditionally:	a pointer to the shard's AVLtree structure
+ *
+ */
+struct AVLtree* avl_shardOf(struct AVLshards* shards, char type, union AVLkey key);
+
+
+
+/**	@Functionality
+ *		Gets how many IDs one of the roots of every shard
+ *		holds altogether. It takes no lock, so it's only
+ *		a snapshot while other threads change them.
+ *
+ *		This is a helper function of avl_shardCount() macro function.
+ *
+ *	@Arguments
+ *		struct AVLshards* shards:	a pointer to an AVLshards structure, as given
+ *									by avl_createShards();
+ *
+ *		char type:					root type, as given by avl_getKeyType().
+ *
+ *	@Return
+ *		Unconditionally:	how many IDs the roots hold
+ *
+ */
+long avl_shardCountRoot(struct AVLshards* shards, char type);
+
+
+
+/**	@Functionality
+ *		Sets up range to pull, with avl_shardRangeNext(),
+ *		all IDs and datas of one of the roots of every
+ *		shard from lo to hi, both inclusive, in ascending
+ *		order of IDs. Every shard's root is kept from
+ *		changing, as by avl_stableLock(), until the range
+ *		is ended by avl_shardRangeEnd().
+ *
+ *		This is a helper function of avl_shardRangeBegin() macro function.
+ *
+ *	@Arguments
+ *		struct AVLshards* shards:		a pointer to an AVLshards structure, as given
+ *										by avl_createShards();
+ *
+ *		struct AVLshardRange* range:	a pointer to an AVLshardRange structure to set up;
+ *
+ *		char type:						root type, as given by avl_getKeyType();
+ *
+ *		union AVLkey lo:				the range's smallest identifier;
+ *
+ *		union AVLkey hi:				the range's greatest identifier.
+ *
+ *	@Return
+ *		None
+ *
+ */
+void avl_shardRangeStart(struct AVLshards* shards, struct AVLshardRange* range, char type, union AVLkey lo, union AVLkey hi);
+
+
+
+/**	@Functionality
+ *		Pulls the next ID and data out of a range over
+ *		a sharded tree: the smallest next ID among all
+ *		shards, which then moves on to its own next one.
+ *
+ *	@Arguments
+ *		struct AVLshardRange* range:	a pointer to an AVLshardRange structure, set
+ *										up by avl_shardRangeBegin();
+ *
+ *		void** ID:						pointer to where the ID is put, as avl_rangeNext()
+ *										puts it, or NULL;
+ *
+ *		void** data:					pointer to where the data is put, or NULL.
+ *
+ *	@Return
+ *		On success:	1
+ *
+ *		On failure:	0 (if the range is over)
+ *
+ */
+int avl_shardRangeNext(struct AVLshardRange* range, void** ID, void** data);
+
+
+
+/**	@Functionality
+ *		Ends a range over a sharded tree, whether or not
+ *		it's over, letting every shard's root change again
+ *		and freeing the range's heap memory.
+ *
+ *	@Argument
+ *		struct AVLshardRange* range:	a pointer to an AVLshardRange structure, set
+ *										up by avl_shardRangeBegin().
+ *
+ *	@Return
+ *		None
+ *
+ */
+void avl_shardRangeEnd(struct AVLshardRange* range);
+
+
+
+/**	@Functionality
+ *		Calls callback with ID, data and arg of every
+ *		ID of one of the roots of every shard from lo to
+ *		hi, both inclusive, in ascending order of IDs,
+ *		until callback returns non zero or the range is over.
+ *		Since every shard's root is kept from changing
+ *		meanwhile, callback must not lock them again.
+ *
+ *		This is a helper function of avl_shardRange() macro function.
+ *
+ *	@Arguments
+ *		struct AVLshards* shards:	a pointer to an AVLshards structure, as given
+ *									by avl_createShards();
+ *
+ *		char type:					root type, as given by avl_getKeyType();
+ *
+ *		union AVLkey lo:			the range's smallest identifier;
+ *
+ *		union AVLkey hi:			the range's greatest identifier;
+ *
+ *		int (*callback)():			function called with each ID, data and arg. It
+ *									returns non zero to stop the range early;
+ *
+ *		void* arg:					anything callback needs, passed along untouched.
+ *
+ *	@Return
+ *		Unconditionally:	how many times callback was called
+ *
+ */
+long avl_shardRangeKey(struct AVLshards* shards, char type, union AVLkey lo, union AVLkey hi,
+					   int (*callback)(void* ID, void* data, void* arg), void* arg);
+
+
+
+/**	@Functionality
+ *		Frees a sharded tree, with every shard, their IDs
+ *		and datas, as avl_free() does.
+ *
+ *	@Argument
+ *		struct AVLshards* shards:	a pointer to an AVLshards structure, as given
+ *									by avl_createShards().
+ *
+ *	@Return
+ *		None
+ *
+ */
+void avl_freeShards(struct AVLshards* shards);
+
+
+
+
+
+/**	@Functionality
+ *		Gets the shard 'id' belongs to, a super avl tree
+ *		to be passed to avl_insert(), avl_search(),
+ *		avl_remove() and the like, along with that same id.
+ *
+ *	@Arguments
+ *		struct AVLshards* shards:	a pointer to an AVLshards structure, as given
+ *									by avl_createShards();
+ *
+ *		? id:						the identifier whose shard to get.
+ *
+ *	@Return
+ *		A pointer to the shard's AVLtree structure
+ *
+ */
+#define avl_shard(shards, id)													\
+		avl_shardOf(shards, avl_getKeyType(id), avl_toKey(id))
+
+
+
+
+
+/**	@Functionality
+ *		Inserts DATA, identified by 'id', into its shard
+ *		of a sharded tree, as avl_insert() does.
+ *
+ *	@Arguments
+ *		struct AVLshards* shards:	a pointer to an AVLshards structure, as given
+ *									by avl_createShards();
+ *
+ *		? DATA:						pointer to the data to be stored;
+ *
+ *		? id:						the identifier of the data.
+ *
+ *	@Return
+ *		None
+ *
+ */
+#define avl_shardInsert(shards, DATA, id)										\
+		avl_insert(avl_shard(shards, id), DATA, id)
+
+
+
+
+
+/**	@Functionality
+ *		Searches 'id' into its shard of a sharded tree
+ *		and, if found, retrieves its data into DATA, or
+ *		NULL otherwise, as avl_search() does.
+ *
+ *	@Arguments
+ *		struct AVLshards* shards:	a pointer to an AVLshards structure, as given
+ *									by avl_createShards();
+ *
+ *		? id:						the identifier to search for;
+ *
+ *		? DATA:						a pointer to the data type expected to be
+ *									retrieved.
+ *
+ *	@Return
+ *		None, since it's a macro function, but alters what
+ *		DATA argument points to, when called
+ *
+ */
+#define avl_shardSearch(shards, id, DATA)										\
+		avl_search(avl_shard(shards, id), id, DATA)
+
+
+
+
+
+/**	@Functionality
+ *		Searches for 'id' into its shard of a sharded tree
+ *		and removes it, if found, as avl_remove() does.
+ *
+ *	@Arguments
+ *		struct AVLshards* shards:	a pointer to an AVLshards structure, as given
+ *									by avl_createShards();
+ *
+ *		? id:						the identifier to remove.
+ *
+ *	@Return
+ *		None
+ *
+ */
+#define avl_shardRemove(shards, id)												\
+		avl_remove(avl_shard(shards, id), id)
+
+
+
+
+
+/**	@Functionality
+ *		Returns how many IDs of a type all shards of a
+ *		sharded tree hold altogether.
+ *
+ *	@Arguments
+ *		struct AVLshards* shards:	a pointer to an AVLshards structure, as given
+ *									by avl_createShards();
+ *
+ *		? type:						a primitive type to identify which root to count.
+ *
+ *	@Return
+ *		How many IDs the shards hold
+ *
+ */
+#define avl_shardCount(shards, type)											\
+		avl_shardCountRoot(shards, avl_getKeyType(type))
+
+
+
+
+
+/**	@Functionality
+ *		Sets up range to pull, with avl_shardRangeNext(),
+ *		all IDs and datas of a sharded tree from lo to hi,
+ *		both inclusive, in ascending order of IDs, across
+ *		all shards. It must be ended with avl_shardRangeEnd().
+ *
+ *	@Arguments
+ *		struct AVLshards* shards:		a pointer to an AVLshards structure, as given
+ *										by avl_createShards();
+ *
+ *		struct AVLshardRange* range:	a pointer to an AVLshardRange structure to set up;
+ *
+ *		? lo:							the smallest identifier of the range;
+ *
+ *		? hi:							the greatest identifier of the range, of the
+ *										same root type as lo.
+ *
+ *	@Return
+ *		None
+ *
+ */
+#define avl_shardRangeBegin(shards, range, lo, hi)								\
+		avl_shardRangeStart(shards, range, avl_getKeyType(lo), avl_toKey(lo), avl_toKey(hi))
+
+
+
+
+
+/**	@Functionality
+ *		Calls callback with ID, data and arg of every
+ *		ID of a sharded tree from lo to hi, both inclusive,
+ *		in ascending order of IDs across all shards, until
+ *		callback returns anything but 0.
+ *
+ *	@Arguments
+ *		struct AVLshards* shards:	a pointer to an AVLshards structure, as given
+ *									by avl_createShards();
+ *
+ *		? lo:						the smallest identifier of the range;
+ *
+ *		? hi:						the greatest identifier of the range, of the
+ *									same root type as lo;
+ *
+ *		int (*callback)(void*, void*, void*):
+ *									function to call with each ID, data and arg;
+ *
+ *		void* arg:					anything callback needs, passed as is to it.
+ *
+ *	@Return
+ *		How many IDs were passed to callback
+ *
+ */
+#define avl_shardRange(shards, lo, hi, callback, arg)							\
+		avl_shardRangeKey(shards, avl_getKeyType(lo), avl_toKey(lo), avl_toKey(hi), callback, arg)
+
+
+
+#endif
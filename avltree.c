@@ -1,253 +1,2859 @@
+/* Read-write locks and their writer preference are POSIX and X/Open, left out of strict C11 headers */
+#define _XOPEN_SOURCE 700
+
+#include <pthread.h>
+#include <stdint.h>
+
 #include "avltree.h"
+#include "avlbtree.h"
+#include "avlhash.h"
+#include "avlpersist.h"
+#include "avlpool.h"
+#include "avlwal.h"
+
+
+
+/* A pair of counters alone in a cache line, so threads updating them don't slow down others nearby */
+struct AVLcounter{
+	
+	_Alignas(64) unsigned long value[2];
+	
+};
+
+
+
+/* 	Locks of a concurrent super avl tree: a reader-writer lock for each
+	root, and a mutex for the slabs and free nodes, which all roots share.
+
+	An RCU tree's readers take none of them. Each one counts itself in
+	its thread's reader slot, for the epoch it's entered in, and checks
+	every root it finds a key missing from, and every range, against the
+	root's sequence, which its writers make odd while they change it.
+	Nodes removed from the tree are retired for their epoch, and reused
+	two epochs later, once no reader may still be going through them.
+	A durable tree also marks each root whose writer came from outside,
+	by avl_lockRoot(), and holds its log's gate along with the lock */
+struct AVLlocks{
+	
+	struct AVLcounter readers[AVL_RCU_SLOTS];
+	struct AVLcounter sequence[4];
+	pthread_rwlock_t roots[4];
+	char gated[4];
+	pthread_mutex_t nodes;
+	unsigned long epoch;
+	long retiring;
+	struct AVLtree_sub **retired[3];
+	long retiredCount[3];
+	long retiredSize[3];
+	
+};
+
+
+
+/* A read section or lock a thread holds on an RCU super avl tree's root */
+struct AVLheld{
+	
+	struct AVLtree *tree;
+	unsigned long *readers;
+	char mode;
+	
+};
+
+
+
+/* 	Reader slot of this thread, taken on its first read section, and the read
+	sections and locks it holds on RCU super avl trees, innermost last */
+static _Thread_local long avl_slot = -1;
+static _Thread_local struct AVLheld avl_held[AVL_RCU_NEST];
+static _Thread_local int avl_holding;
+static long avl_threads;
+
+
+
+/* Gets a pointer to super avl tree's root of 'type', as given by avl_getKeyType() */
+static inline struct AVLtree_sub** avl_getRoot(struct AVLtree* tree, char type){
+	switch(type){
+		case 'i': return &tree->int_root;
+		case 'u': return &tree->uint_root;
+		case 'd': return &tree->double_root;
+		case 'c': return &tree->string_root;
+	}
+	return NULL;
+}
+
+
+
+/* Gets the index of 'type' root, as given by avl_getKeyType(), into a concurrent tree's locks */
+static inline int avl_getIndex(char type){
+	switch(type){
+		case 'i': return 0;
+		case 'u': return 1;
+		case 'd': return 2;
+		case 'c': return 3;
+	}
+	return -1;
+}
+
+
+
+/* Gets a pointer to the lock of super avl tree's root of 'type', or NULL if it's not concurrent */
+static inline pthread_rwlock_t* avl_getLock(struct AVLtree* tree, char type){
+	if(!tree->locks || avl_getIndex(type) < 0) return NULL;
+	return &tree->locks->roots[avl_getIndex(type)];
+}
+
+
+
+/* Gets a pointer to the sequence of RCU super avl tree's root of 'type', or NULL if it's not a root's type */
+static inline unsigned long* avl_getSequence(struct AVLtree* tree, char type){
+	if(avl_getIndex(type) < 0) return NULL;
+	return &tree->locks->sequence[avl_getIndex(type)].value[0];
+}
+
+
+
+/* Whether super avl tree's roots are read with no lock, as created with AVL_RCU. B+ and persistent trees never are */
+static inline int avl_isRCU(struct AVLtree* tree){
+	return (tree->options & AVL_RCU) && !tree->btree && !tree->persist;
+}
+
+
+
+/* Locks and unlocks super avl tree's slabs and free nodes, if it's concurrent */
+static inline void avl_lockNodes(struct AVLtree* tree){
+	if(tree->locks) pthread_mutex_lock(&tree->locks->nodes);
+}
+
+static inline void avl_unlockNodes(struct AVLtree* tree){
+	if(tree->locks) pthread_mutex_unlock(&tree->locks->nodes);
+}
+
+
+
+/* Gets a pointer to super avl tree's size of 'type' root, as given by avl_getKeyType() */
+static inline long* avl_getSize(struct AVLtree* tree, char type){
+	switch(type){
+		case 'i': return &tree->int_size;
+		case 'u': return &tree->uint_size;
+		case 'd': return &tree->double_size;
+		case 'c': return &tree->string_size;
+	}
+	return NULL;
+}
+
+
+
+/* 	What a descent down a string root knows of its key: how many first bytes it shares with the
+	last ID it went right of, and with the last one it went left of, which every ID below shares
+	as well, and its length */
+struct AVLshared{
+	
+	size_t lesser;
+	size_t greater;
+	size_t length;
+	
+};
+
+
+
+/* 	Compares key to node's ID on the way down a root, as avl_keyCompare() does, but interned
+	strings only from the bytes they're known to share, updating what's known for the way eval
+	tells, ties going left. Not for RCU readers, which writers may move to a subtree key isn't
+	between the bounds of */
+static inline __attribute__((always_inline)) int avl_descendCompare(char type, const union AVLkey* key, struct AVLtree_sub* node, struct AVLshared* shared){
+	
+	size_t common;
+	int eval;
+	if(type != 'c' || !node->interned) return avl_keyCompare(type, key, &node->ID);
+	
+	
+	common = (shared->lesser < shared->greater) ? shared->lesser : shared->greater;
+	eval = avl_stringCompare(key, &node->ID, common, shared->length, &common);
+	if(eval > 0) shared->lesser = common;
+	else shared->greater = common;
+	
+	
+	return eval;
+	
+}
+
+
+
+/* Gets what's handed out as node's ID: its string, or a pointer to its numeric identifier */
+static inline void* avl_getID(struct AVLtree_sub* node){
+	return (node->type == 'c') ? node->ID.string : (void*)&node->ID;
+}
+
+
+
+/* Gets the node that comes right after 'node' in ascending order, NULL if it's the last one */
+static inline struct AVLtree_sub* avl_successor(struct AVLtree_sub* node){
+	
+	/* If it has a right child, it's the smallest node under it */
+	if(node->Rchild){
+		for(node = node->Rchild; node->Lchild; node = node->Lchild);
+		return node;
+	}
+	
+	
+	/* Otherwise, it's the first ancestor from which node is on the left side */
+	while(node->parent != node && node->parent->Rchild == node) node = node->parent;
+	return (node->parent != node) ? node->parent : NULL;
+	
+}
+
+
+
+/* Gets the node that comes right before 'node' in ascending order, NULL if it's the first one */
+static inline struct AVLtree_sub* avl_predecessor(struct AVLtree_sub* node){
+	
+	/* If it has a left child, it's the biggest node under it */
+	if(node->Lchild){
+		for(node = node->Lchild; node->Rchild; node = node->Rchild);
+		return node;
+	}
+	
+	
+	/* Otherwise, it's the first ancestor from which node is on the right side */
+	while(node->parent != node && node->parent->Lchild == node) node = node->parent;
+	return (node->parent != node) ? node->parent : NULL;
+	
+}
+
+
+
+/* 	Loads and stores a link an RCU tree's readers may be going through meanwhile,
+	so a node is seen as it was when it was linked, with its ID and data set */
+static inline struct AVLtree_sub* avl_load(struct AVLtree_sub** link){
+	return __atomic_load_n(link, __ATOMIC_ACQUIRE);
+}
+
+static inline void avl_publish(struct AVLtree_sub** link, struct AVLtree_sub* node){
+	__atomic_store_n(link, node, __ATOMIC_RELEASE);
+}
+
+
+
+/* 	Stores a link, or a size, of nodes readers may already reach, as rotations
+	and removals move them around. Only the last link of a change, which
+	avl_publish() stores, orders what readers see of it */
+static inline void avl_link(struct AVLtree_sub** link, struct AVLtree_sub* node){
+	__atomic_store_n(link, node, __ATOMIC_RELAXED);
+}
+
+static inline void avl_resize(struct AVLtree_sub* node, unsigned int size){
+	__atomic_store_n(&node->size, size, __ATOMIC_RELAXED);
+}
+
+
+
+/* 	Begins a lockless read of an RCU tree's root, getting its sequence. After
+	AVL_RCU_TRIES failed ones, it keeps the root's writers out instead */
+static inline unsigned long avl_readBegin(struct AVLtree* tree, char type, int* tries){
+	if(!avl_isRCU(tree)) return 0;
+	if(*tries == AVL_RCU_TRIES) pthread_rwlock_wrlock(avl_getLock(tree, type));
+	return __atomic_load_n(avl_getSequence(tree, type), __ATOMIC_ACQUIRE);
+}
+
+
+
+/* 	Checks whether a lockless read of an RCU tree's root begun at sequence 's'
+	saw no writer, or it must be tried again. Always 0 for other trees */
+static inline int avl_readRetry(struct AVLtree* tree, char type, unsigned long s, int* tries){
+	
+	if(!avl_isRCU(tree)) return 0;
+	
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	if(!(s & 1) && __atomic_load_n(avl_getSequence(tree, type), __ATOMIC_RELAXED) == s){
+		if(*tries >= AVL_RCU_TRIES) pthread_rwlock_unlock(avl_getLock(tree, type));
+		return 0;
+	}
+	
+	(*tries)++;
+	return 1;
+	
+}
+
+
+
+/* 	Gets the node after 'node' as avl_successor() does, though in no more
+	than AVL_MAX_HEIGHT steps each way, as a writer may be rotating it */
+static struct AVLtree_sub* avl_rcuSuccessor(struct AVLtree_sub* node){
+	
+	struct AVLtree_sub *next, *parent;
+	int h;
+	
+	
+	if((next = avl_load(&node->Rchild))){
+		for(h = 0; h < AVL_MAX_HEIGHT && (node = avl_load(&next->Lchild)); h++) next = node;
+		return next;
+	}
+	
+	for(h = 0; h < AVL_MAX_HEIGHT; h++){
+		parent = avl_load(&node->parent);
+		if(!parent || parent == node) return NULL;
+		if(avl_load(&parent->Lchild) == node) return parent;
+		node = parent;
+	}
+	
+	
+	return NULL;
+	
+}
+
+
+
+/* 	Searches key into an RCU tree's root as avl_searchKey() does, though no more
+	than AVL_MAX_HEIGHT levels down. A found key was in the root at some point of
+	the search, so it's right, while a missing one may just have been rotated away,
+	so the search is tried again if a writer was changing the root meanwhile */
+static struct AVLtree_sub* avl_rcuSearchKey(struct AVLtree* tree, char type, union AVLkey key){
+	
+	struct AVLtree_sub *node;
+	unsigned long s;
+	int eval, h, tries = 0;
+	
+	
+	do {
+		s = avl_readBegin(tree, type, &tries);
+		for(node = avl_load(avl_getRoot(tree, type)), h = 0; node; h++){
+			eval = avl_keyCompare(type, &key, &node->ID);
+			
+			if(eval == 0) break;
+			node = (h == AVL_MAX_HEIGHT) ? NULL : avl_load(eval > 0 ? &node->Rchild : &node->Lchild);
+		}
+	} while(avl_readRetry(tree, type, s, &tries) && !node);
+	
+	
+	return node;
+	
+}
+
+
+
+/* 	Gets the smallest node of an RCU tree's root whose ID is not lesser than key,
+	as avl_lowerBound() does, though no more than AVL_MAX_HEIGHT levels down */
+static struct AVLtree_sub* avl_rcuLowerBound(struct AVLtree* tree, char type, union AVLkey key){
+	
+	struct AVLtree_sub *node, *bound = NULL;
+	int h;
+	
+	
+	for(node = avl_load(avl_getRoot(tree, type)), h = 0; node && h < AVL_MAX_HEIGHT; h++){
+		if(avl_keyCompare(type, &key, &node->ID) > 0) node = avl_load(&node->Rchild);
+		else {
+			bound = node;
+			node = avl_load(&node->Lchild);
+		}
+	}
+	
+	
+	return bound;
+	
+}
+
+
+
+/* Gets the smallest node of 'type' root whose ID is not lesser than key, NULL if there's none */
+static struct AVLtree_sub* avl_lowerBound(struct AVLtree* tree, char type, union AVLkey key){
+	
+	struct AVLtree_sub **root, *node, *bound = NULL;
+	struct AVLshared shared = {0, 0, (type == 'c' && (tree->options & AVL_STRING_ARENA)) ? strlen(key.string) : 0};
+	if(!(root = avl_getRoot(tree, type))) return NULL;
+	
+	
+	/* Goes down looking for key, keeping the last node whose ID is not lesser than it */
+	for(node = *root; node; ){
+		if(avl_descendCompare(type, &key, node, &shared) > 0) node = node->Rchild;
+		else {
+			bound = node;
+			node = node->Lchild;
+		}
+	}
+	
+	
+	return bound;
+	
+}
+
+
+
+/* Gets how many nodes there are under 'node', itself included, 0 if it's NULL */
+static inline unsigned int avl_getSubSize(struct AVLtree_sub* node){
+	return node ? __atomic_load_n(&node->size, __ATOMIC_RELAXED) : 0;
+}
+
+
+
+/* Gets node's data, or its first one, if super avl tree holds each ID's datas together, as created with AVL_MULTIMAP */
+static inline void* avl_firstData(struct AVLtree* tree, struct AVLtree_sub* node){
+	return (tree->options & AVL_MULTIMAP) ? ((struct AVLvalues*)node->data)->data[0] : node->data;
+}
+
+
+
+/* Frees a node's data, or every one of its datas, along with what holds them, if super avl tree was created with AVL_MULTIMAP */
+static void avl_freeData(struct AVLtree* tree, void* data){
+	
+	struct AVLvalues *values = data;
+	long i;
+	
+	
+	if(values && (tree->options & AVL_MULTIMAP))
+		for(i = 0; i < values->count; i++) free(values->data[i]);
+	free(data);
+	
+}
+
+
+
+/* 	Appends data to an ID's datas, or starts them, if values is NULL, with room for a single
+	one, since most IDs never get another, and twice as much whenever they're full. Returns
+	where they are now */
+static struct AVLvalues* avl_addValue(struct AVLvalues* values, void* data){
+	
+	if(!values){
+		values = malloc(sizeof(struct AVLvalues) + sizeof(void*));
+		values->count = 0;
+		values->size = 1;
+	} else if(values->count == values->size){
+		values->size *= 2;
+		values = realloc(values, sizeof(struct AVLvalues) + values->size*sizeof(void*));
+	}
+	
+	
+	values->data[values->count++] = data;
+	return values;
+	
+}
+
+
+
+/* 	Copies a string into super avl tree's arena, taking a new block if it doesn't fit into the
+	newest one. Strings longer than a block get one of their own, chained after the newest one,
+	which is still used. Called with the string root's lock held, the only one using it */
+static char* avl_intern(struct AVLtree* tree, const char* string){
+	
+	struct AVLarena *block = tree->arena;
+	size_t length = strlen(string) + 1, padded = (length + 7) & ~(size_t)7, size;
+	char *copy;
+	
+	
+	if(!block || block->size - block->used < padded){
+		size = (padded > AVL_ARENA_BLOCK) ? padded : AVL_ARENA_BLOCK;
+		block = malloc(sizeof(struct AVLarena) + size);
+		block->size = size;
+		block->used = 0;
+		
+		if(size > AVL_ARENA_BLOCK && tree->arena){
+			block->next = tree->arena->next;
+			tree->arena->next = block;
+		} else {
+			block->next = tree->arena;
+			tree->arena = block;
+		}
+	}
+	
+	
+	/* 	Every string starts at a multiple of 8 bytes and is padded with zeros up to
+		the next one, so avl_stringCompare() may read it 8 bytes at a time */
+	copy = block->bytes + block->used;
+	block->used += padded;
+	memset(copy + padded - 8, 0, 8);
+	return memcpy(copy, string, length);
+	
+}
+
+
+
+/* Allocates an empty slab of 'size' nodes on heap, aligned to a cache line */
+static struct AVLslab* avl_newSlab(long size){
+	
+	struct AVLslab *slab = aligned_alloc(64, sizeof(struct AVLslab) + size*sizeof(struct AVLtree_sub));
+	slab->next = NULL;
+	slab->size = size;
+	slab->used = 0;
+	
+	
+	return slab;
+	
+}
+
+
+
+/* Reads the i-th element of a keys array, each 'width' bytes wide, as a key of 'type' root */
+static union AVLkey avl_readKey(char type, const void* keys, size_t width, long i){
+	
+	const char *key = (const char*)keys + i*width;
+	
+	
+	switch(type){
+		
+		case 'i':
+			if(width == sizeof(signed char)) return avl_integerKey(*(const signed char*)key);
+			if(width == sizeof(short)) return avl_integerKey(*(const short*)key);
+			if(width == sizeof(int)) return avl_integerKey(*(const int*)key);
+			return avl_integerKey(*(const long long*)key);
+			
+		case 'u':
+			if(width == sizeof(unsigned char)) return avl_uintegerKey(*(const unsigned char*)key);
+			if(width == sizeof(unsigned short)) return avl_uintegerKey(*(const unsigned short*)key);
+			if(width == sizeof(unsigned int)) return avl_uintegerKey(*(const unsigned int*)key);
+			return avl_uintegerKey(*(const unsigned long long*)key);
+			
+		case 'd':
+			if(width == sizeof(float)) return avl_realKey(*(const float*)key);
+			if(width == sizeof(double)) return avl_realKey(*(const double*)key);
+			return avl_realKey(*(const long double*)key);
+		
+	}
+	
+	
+	return avl_stringKey(*(char* const*)key);
+	
+}
+
+
+
+/* Comparators of nodes' IDs for qsort(), one for each root type */
+static int avl_sortInteger(const void* a, const void* b){
+	return avl_keyCompare('i', &((const struct AVLtree_sub*)a)->ID, &((const struct AVLtree_sub*)b)->ID);
+}
+
+static int avl_sortUinteger(const void* a, const void* b){
+	return avl_keyCompare('u', &((const struct AVLtree_sub*)a)->ID, &((const struct AVLtree_sub*)b)->ID);
+}
+
+static int avl_sortReal(const void* a, const void* b){
+	return avl_keyCompare('d', &((const struct AVLtree_sub*)a)->ID, &((const struct AVLtree_sub*)b)->ID);
+}
+
+static int avl_sortString(const void* a, const void* b){
+	return avl_keyCompare('c', &((const struct AVLtree_sub*)a)->ID, &((const struct AVLtree_sub*)b)->ID);
+}
+
+
+
+/* Gets the height of a perfectly balanced tree of n nodes, i.e. how many bits n takes */
+static inline int avl_balancedHeight(long n){
+	int height = 0;
+	for(; n; n >>= 1) height++;
+	return height;
+}
+
+
+
+/* 	Links n sorted nodes into a perfectly balanced tree under 'parent',
+	with the middle node as its root, and returns that root */
+static struct AVLtree_sub* avl_linkSorted(struct AVLtree_sub* nodes, long n, struct AVLtree_sub* parent){
+	
+	long l_size = n/2, r_size = n - l_size - 1;
+	struct AVLtree_sub *node = &nodes[l_size];
+	if(!n) return NULL;
+	
+	
+	/* The middle node takes each half as a subtree, whose heights differ by 1 at most */
+	node->parent = parent ? parent : node;
+	node->size = n;
+	node->balance = avl_balancedHeight(r_size) - avl_balancedHeight(l_size);
+	node->Lchild = avl_linkSorted(nodes, l_size, node);
+	node->Rchild = avl_linkSorted(node+1, r_size, node);
+	
+	
+	return node;
+	
+}
+
+
+
+/* Points super avl tree's root that was 'old' to 'new' */
+static void avl_replaceRoot(struct AVLtree* tree, struct AVLtree_sub* old, struct AVLtree_sub* new){
+	if(tree->int_root == old) avl_publish(&tree->int_root, new);
+	else if(tree->uint_root == old) avl_publish(&tree->uint_root, new);
+	else if(tree->double_root == old) avl_publish(&tree->double_root, new);
+	else if(tree->string_root == old) avl_publish(&tree->string_root, new);
+}
+
+
+
+/* 	Puts 'new', which may be NULL, in 'old' place, either
+	as a root, whose parent is itself, or as its parent's child */
+static void avl_replaceChild(struct AVLtree* tree, struct AVLtree_sub* old, struct AVLtree_sub* new){
+	
+	if(old->parent == old){
+		if(new) avl_link(&new->parent, new);
+		avl_replaceRoot(tree, old, new);
+		return;
+	}
+	
+	if(new) avl_link(&new->parent, old->parent);
+	if(old->parent->Lchild == old) avl_publish(&old->parent->Lchild, new);
+	else avl_publish(&old->parent->Rchild, new);
+	
+}
+
+
+
+struct AVLtree* avl_createTree(void){
+	
+	/* Creates a super avl tree, with all of its roots empty */
+	return avl_createTreeEx(AVL_ENGINE_AVL);
+	
+}
+
+
+
+struct AVLtree* avl_createTreeEx(int options){
+	
+	struct AVLtree *tree = calloc(1, sizeof(struct AVLtree));
+	pthread_rwlockattr_t attr;
+	int i;
+	tree->options = options;
+	
+	
+	/* A B+ tree engine holds all roots in its own B+ trees, also empty */
+	if(options & AVL_ENGINE_BTREE)
+		tree->btree = calloc(1, sizeof(struct AVLbtree));
+	
+	
+	/* 	A persistent tree holds its roots in persistent avl trees, also empty,
+		which share nodes with the snapshots taken of them */
+	else if(options & AVL_PERSISTENT){
+		tree->persist = calloc(1, sizeof(struct AVLpersist));
+		pthread_mutex_init(&tree->persist->lock, NULL);
+	}
+	
+	
+	/* Only avl roots read with locks hold each ID's datas together */
+	if(tree->btree || tree->persist || (options & AVL_RCU))
+		tree->options &= ~AVL_MULTIMAP;
+	
+	
+	/* Avl roots read with locks get hash indexes, all empty as well */
+	if((options & AVL_HASH_INDEX) && !tree->btree && !tree->persist && !(options & AVL_RCU))
+		tree->hash = calloc(1, sizeof(struct AVLhash));
+	
+	
+	/* 	A concurrent tree gets a lock for each root, which lets writers
+		in first, so a stream of readers can't keep them waiting forever */
+	if(options & (AVL_CONCURRENT | AVL_RCU)){
+		tree->locks = memset(aligned_alloc(64, sizeof(struct AVLlocks)), 0, sizeof(struct AVLlocks));
+		pthread_rwlockattr_init(&attr);
+#ifdef __GLIBC__
+		pthread_rwlockattr_setkind_np(&attr, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+#endif
+		for(i = 0; i < 4; i++) pthread_rwlock_init(&tree->locks->roots[i], &attr);
+		pthread_rwlockattr_destroy(&attr);
+		pthread_mutex_init(&tree->locks->nodes, NULL);
+	}
+	
+	
+	return tree;
+	
+}
+
+
+
+/* 	Enters a read section of an RCU super avl tree, counting itself in this thread's
+	reader slot for the current epoch, which is checked again in case it just moved
+	on. Gets the counter to be decremented when the read section is over */
+static unsigned long* avl_rcuEnter(struct AVLlocks* locks){
+	
+	unsigned long epoch, *readers;
+	if(avl_slot < 0) avl_slot = __atomic_fetch_add(&avl_threads, 1, __ATOMIC_RELAXED) % AVL_RCU_SLOTS;
+	
+	
+	for(;;){
+		epoch = __atomic_load_n(&locks->epoch, __ATOMIC_SEQ_CST);
+		readers = &locks->readers[avl_slot].value[epoch & 1];
+		
+		__atomic_fetch_add(readers, 1, __ATOMIC_SEQ_CST);
+		if(__atomic_load_n(&locks->epoch, __ATOMIC_SEQ_CST) == epoch) return readers;
+		__atomic_fetch_sub(readers, 1, __ATOMIC_RELEASE);
+	}
+	
+}
+
+
+
+/* 	Moves an RCU super avl tree's epoch on, if no reader is left in the one before
+	it, and reuses the nodes retired back then, which no reader can reach anymore.
+	Called with the tree's nodes locked */
+static void avl_rcuAdvance(struct AVLtree* tree){
+	
+	struct AVLlocks *locks = tree->locks;
+	struct AVLtree_sub *node;
+	unsigned long epoch = locks->epoch;
+	int bucket = (epoch + 2) % 3;
+	long i;
+	
+	
+	for(i = 0; i < AVL_RCU_SLOTS; i++)
+		if(__atomic_load_n(&locks->readers[i].value[(epoch - 1) & 1], __ATOMIC_SEQ_CST)) return;
+	__atomic_store_n(&locks->epoch, epoch + 1, __ATOMIC_SEQ_CST);
+	locks->retiring = 0;
+	
+	
+	/* 	Frees their data and ID, if it's a string, and gives them back to the
+		tree's free nodes, with no parent, as avl_freeNode() does */
+	for(i = 0; i < locks->retiredCount[bucket]; i++){
+		node = locks->retired[bucket][i];
+		if(node->type == 'c' && !node->interned)
+			free(node->ID.string);
+		free(node->data);
+		
+		node->ID.string = node->data = NULL;
+		node->parent = NULL;
+		node->Lchild = tree->freeNodes;
+		tree->freeNodes = node;
+	}
+	locks->retiredCount[bucket] = 0;
+	
+}
+
+
+
+/* 	Retires a node unlinked by an RCU super avl tree's writer for the current
+	epoch, instead of freeing it, since readers may still be going through it */
+static void avl_rcuRetire(struct AVLtree* tree, struct AVLtree_sub* node){
+	
+	struct AVLlocks *locks = tree->locks;
+	int bucket;
+	avl_lockNodes(tree);
+	bucket = locks->epoch % 3;
+	
+	
+	if(locks->retiredCount[bucket] == locks->retiredSize[bucket]){
+		locks->retiredSize[bucket] = locks->retiredSize[bucket] ? 2*locks->retiredSize[bucket] : AVL_RCU_BATCH;
+		locks->retired[bucket] = realloc(locks->retired[bucket], locks->retiredSize[bucket]*sizeof(struct AVLtree_sub*));
+	}
+	locks->retired[bucket][locks->retiredCount[bucket]++] = node;
+	
+	
+	/* Every AVL_RCU_BATCH nodes, tries to move the epoch on, so older ones get reused */
+	if(++locks->retiring >= AVL_RCU_BATCH) avl_rcuAdvance(tree);
+	avl_unlockNodes(tree);
+	
+}
+
+
+
+/* 	Locks super avl tree's root of 'type' in 'mode', as avl_lockRoot() does, though
+	leaving a durable tree's log alone, which its own changes take care of */
+static void avl_takeRoot(struct AVLtree* tree, char type, char mode){
+	
+	pthread_rwlock_t *lock = avl_getLock(tree, type);
+	unsigned long *sequence;
+	struct AVLheld *held;
+	if(!lock) return;
+	
+	
+	/* Readers share the lock, and so do those keeping writers out, while writers take it alone */
+	if(!avl_isRCU(tree)){
+		if(mode == 'w') pthread_rwlock_wrlock(lock);
+		else pthread_rwlock_rdlock(lock);
+		return;
+	}
+	
+	
+	/* 	An RCU tree's readers only enter a read section, while writers and
+		those keeping them out take the lock alone. Writers make the root's
+		sequence odd as well, so lockless readers know it's changing */
+	held = &avl_held[avl_holding++];
+	held->tree = tree;
+	held->mode = mode;
+	held->readers = NULL;
+	
+	if(mode == 'r'){
+		held->readers = avl_rcuEnter(tree->locks);
+		return;
+	}
+	
+	pthread_rwlock_wrlock(lock);
+	if(mode == 'w'){
+		sequence = avl_getSequence(tree, type);
+		__atomic_store_n(sequence, *sequence + 1, __ATOMIC_RELAXED);
+		__atomic_thread_fence(__ATOMIC_RELEASE);
+	}
+	
+}
+
+
+
+/* Unlocks super avl tree's root of 'type', locked by avl_takeRoot() */
+static void avl_releaseRoot(struct AVLtree* tree, char type){
+	
+	pthread_rwlock_t *lock = avl_getLock(tree, type);
+	unsigned long *sequence;
+	struct AVLheld *held;
+	if(!lock) return;
+	
+	if(!avl_isRCU(tree)){
+		pthread_rwlock_unlock(lock);
+		return;
+	}
+	
+	
+	/* 	Leaves the thread's innermost read section or lock, making the
+		root's sequence even again, if it was a writer's */
+	held = &avl_held[--avl_holding];
+	if(held->mode == 'r'){
+		__atomic_fetch_sub(held->readers, 1, __ATOMIC_RELEASE);
+		return;
+	}
+	
+	if(held->mode == 'w'){
+		sequence = avl_getSequence(tree, type);
+		__atomic_store_n(sequence, *sequence + 1, __ATOMIC_RELEASE);
+	}
+	pthread_rwlock_unlock(lock);
+	
+}
+
+
+
+void avl_lockRoot(struct AVLtree* tree, char type, char mode){
+	
+	int gated = mode == 'w' && tree->wal && avl_getLock(tree, type);
+	
+	
+	/* 	A concurrent durable tree's writer, such as an iterator removing
+		nodes, holds its log's gate as well, so no checkpoint is saved
+		halfway through the changes it logs */
+	if(gated) avl_walEnter(tree->wal);
+	avl_takeRoot(tree, type, mode);
+	if(gated) tree->locks->gated[avl_getIndex(type)] = 1;
+	
+}
+
+
+
+void avl_unlockRoot(struct AVLtree* tree, char type){
+	
+	int gated = 0;
+	
+	
+	/* 	Only the root's writer may have marked it, which an RCU tree's
+		readers, holding no lock, tell by their own mode instead */
+	if(avl_getLock(tree, type) && (!avl_isRCU(tree) || avl_held[avl_holding - 1].mode == 'w'))
+		if((gated = tree->locks->gated[avl_getIndex(type)])) tree->locks->gated[avl_getIndex(type)] = 0;
+	
+	avl_releaseRoot(tree, type);
+	if(gated) avl_walExit(tree->wal);
+	
+}
+
+
+
+struct AVLtree_sub* avl_allocNode(struct AVLtree* tree){
+	
+	struct AVLtree_sub *node;
+	struct AVLslab *slab;
+	avl_lockNodes(tree);
+	slab = tree->slabs;
+	
+	
+	/* Reuses a node given back by a removal, if there's any */
+	if(tree->freeNodes){
+		node = tree->freeNodes;
+		tree->freeNodes = node->Lchild;
+		avl_unlockNodes(tree);
+		return memset(node, 0, sizeof(struct AVLtree_sub));
+	}
+	
+	
+	/* 	If newest slab is full, allocates a new one on heap,
+		twice as big as it, and chains it as the newest */
+	if(!slab || slab->used == slab->size){
+		long size = slab ? slab->size*2 : AVL_SLAB_MIN;
+		if(size > AVL_SLAB_MAX) size = AVL_SLAB_MAX;
+		
+		slab = avl_newSlab(size);
+		slab->next = tree->slabs;
+		tree->slabs = slab;
+	}
+	
+	
+	/* Hands out the next unused node of the slab */
+	node = &slab->nodes[slab->used++];
+	avl_unlockNodes(tree);
+	return memset(node, 0, sizeof(struct AVLtree_sub));
+	
+}
+
+
+
+/* 	Takes n nodes at once, from a single slab exactly as big as
+	needed, chained right after the newest one so it's still used */
+static struct AVLtree_sub* avl_takeNodes(struct AVLtree* tree, long n){
+	
+	struct AVLslab *slab = avl_newSlab(n);
+	slab->used = n;
+	
+	
+	avl_lockNodes(tree);
+	if(tree->slabs){
+		slab->next = tree->slabs->next;
+		tree->slabs->next = slab;
+	} else tree->slabs = slab;
+	avl_unlockNodes(tree);
+	
+	
+	return slab->nodes;
+	
+}
+
+
+
+/* 	Copies n keys, from the i-th on, into the IDs of nodes, and strings into tree's
+	arena, if it's given one, or into heap; links set the rest. Returns whether those
+	keys are in order, along with the one right before them */
+static int avl_fillNodes(struct AVLtree* tree, struct AVLtree_sub* nodes, char type, const void* keys, size_t width, void** data, long i, long n){
+	
+	union AVLkey key, last;
+	int sorted = 1;
+	if(i) last = avl_readKey(type, keys, width, i-1);
+	
+	
+	for(n += i; i < n; i++, nodes++){
+		key = avl_readKey(type, keys, width, i);
+		if(i && avl_keyCompare(type, &last, &key) > 0) sorted = 0;
+		last = key;
+		
+		nodes->interned = (type == 'c' && tree);
+		if(nodes->interned) key.string = avl_intern(tree, key.string);
+		else if(type == 'c') key.string = strcpy(malloc(strlen(key.string)+1), key.string);
+		nodes->ID = key;
+		nodes->type = type;
+		nodes->data = data ? data[i] : NULL;
+	}
+	
+	
+	return sorted;
+	
+}
+
+
+
+/* Sorts n nodes of 'type' root by their IDs */
+static void avl_sortNodes(struct AVLtree_sub* nodes, long n, char type){
+	switch(type){
+		case 'i': qsort(nodes, n, sizeof(struct AVLtree_sub), avl_sortInteger); break;
+		case 'u': qsort(nodes, n, sizeof(struct AVLtree_sub), avl_sortUinteger); break;
+		case 'd': qsort(nodes, n, sizeof(struct AVLtree_sub), avl_sortReal); break;
+		case 'c': qsort(nodes, n, sizeof(struct AVLtree_sub), avl_sortString); break;
+	}
+}
+
+
+
+/* Logs n keys and datas loaded into a durable super avl tree's root, whose lock is held */
+static void avl_logLoaded(struct AVLtree* tree, char type, const void* keys, size_t width, void** data, long n){
+	
+	long i;
+	for(i = 0; i < n; i++) avl_walLog(tree->wal, 'i', type, avl_readKey(type, keys, width, i), data ? data[i] : NULL);
+	
+}
+
+
+
+long avl_bulkLoadKeys(struct AVLtree* tree, char type, const void* keys, size_t width, void** data, long n){
+	
+	struct AVLtree_sub **root, *nodes;
+	long i;
+	if(!(root = avl_getRoot(tree, type)) || n <= 0) return 0;
+	
+	
+	/* 	If the root already has nodes, or it's a B+ tree or persistent
+		engine's, or a multimap's, whose equal keys share a node, keys
+		can only be inserted one by one */
+	if(tree->wal) avl_walEnter(tree->wal);
+	avl_takeRoot(tree, type, 'w');
+	if(*root || tree->btree || tree->persist || (tree->options & AVL_MULTIMAP)){
+		avl_releaseRoot(tree, type);
+		if(tree->wal) avl_walLeave(tree);
+		for(i = 0; i < n; i++) avl_insertKey(tree, type, avl_readKey(type, keys, width, i), data ? data[i] : NULL);
+		return n;
+	}
+	
+	
+	/* 	Copies every key into a node of its own, all taken at once,
+		then sorts them, in case keys weren't already sorted */
+	nodes = avl_takeNodes(tree, n);
+	if(!avl_fillNodes((tree->options & AVL_STRING_ARENA) ? tree : NULL, nodes, type, keys, width, data, 0, n))
+		avl_sortNodes(nodes, n, type);
+	
+	
+	/* Links them into a perfectly balanced tree, which becomes the root, and indexes it */
+	avl_publish(root, avl_linkSorted(nodes, n, NULL));
+	*avl_getSize(tree, type) = n;
+	if(tree->hash) avl_hashRebuild(avl_hashRoot(tree->hash, type), *root);
+	if(tree->wal) avl_logLoaded(tree, type, keys, width, data, n);
+	avl_releaseRoot(tree, type);
+	if(tree->wal) avl_walLeave(tree);
+	
+	
+	return n;
+	
+}
+
+
+
+/* What every task of a parallel bulk load shares: the keys and datas to load, and whether they're sorted */
+struct AVLload{
+	
+	char type;
+	const void *keys;
+	size_t width;
+	void **data;
+	int sorted;
+	
+};
+
+
+
+/* 	Task of a parallel bulk load: fills n nodes, from task's node on, with keys from
+	task's index on, and links them as a perfectly balanced tree, whose root, their
+	middle node, already has its parent. Splits off left halves as tasks of their own,
+	while they're big enough, setting up their middle nodes' parents beforehand */
+static void avl_loadTask(struct AVLpool* pool, struct AVLtask* task){
+	
+	struct AVLload *load = task->arg;
+	struct AVLtree_sub *nodes = task->node, *node;
+	long i = task->index, n = task->n, l_size, r_size;
+	int sorted = 1;
+	
+	
+	while(n > AVL_PARALLEL_GRAIN){
+		l_size = n/2;
+		r_size = n - l_size - 1;
+		node = &nodes[l_size];
+		
+		sorted &= avl_fillNodes(NULL, node, load->type, load->keys, load->width, load->data, i + l_size, 1);
+		node->size = n;
+		node->balance = avl_balancedHeight(r_size) - avl_balancedHeight(l_size);
+		node->Lchild = &nodes[l_size/2];
+		node->Rchild = &node[1 + r_size/2];
+		node->Lchild->parent = node->Rchild->parent = node;
+		
+		avl_poolSpawn(pool, (struct AVLtask){avl_loadTask, load, nodes, i, l_size});
+		nodes = node + 1;
+		i += l_size + 1;
+		n = r_size;
+	}
+	
+	
+	sorted &= avl_fillNodes(NULL, nodes, load->type, load->keys, load->width, load->data, i, n);
+	avl_linkSorted(nodes, n, nodes[n/2].parent);
+	if(!sorted) __atomic_store_n(&load->sorted, 0, __ATOMIC_RELAXED);
+	
+}
+
+
+
+long avl_parallelBulkLoadKeys(struct AVLtree* tree, char type, const void* keys, size_t width, void** data, long n, struct AVLpool* pool){
+	
+	struct AVLload load = {type, keys, width, data, 1};
+	struct AVLtree_sub **root, *nodes;
+	if(!(root = avl_getRoot(tree, type)) || n <= 0) return 0;
+	
+	
+	/* Only an empty avl root, not a multimap's, is loaded in parallel */
+	if(tree->wal) avl_walEnter(tree->wal);
+	avl_takeRoot(tree, type, 'w');
+	if(*root || tree->btree || tree->persist || (tree->options & AVL_MULTIMAP)){
+		avl_releaseRoot(tree, type);
+		if(tree->wal) avl_walLeave(tree);
+		return avl_bulkLoadKeys(tree, type, keys, width, data, n);
+	}
+	
+	
+	/* 	Fills and links nodes among the pool's workers, the middle one as the root. If
+		keys turn out not to be sorted, sorts the nodes and links them again, on its own */
+	nodes = avl_takeNodes(tree, n);
+	nodes[n/2].parent = &nodes[n/2];
+	avl_poolRun(pool, (struct AVLtask){avl_loadTask, &load, nodes, 0, n});
+	if(!load.sorted){
+		avl_sortNodes(nodes, n, type);
+		avl_linkSorted(nodes, n, NULL);
+	}
+	
+	
+	avl_publish(root, &nodes[n/2]);
+	*avl_getSize(tree, type) = n;
+	if(tree->hash) avl_hashRebuild(avl_hashRoot(tree->hash, type), *root);
+	if(tree->wal) avl_logLoaded(tree, type, keys, width, data, n);
+	avl_releaseRoot(tree, type);
+	if(tree->wal) avl_walLeave(tree);
+	
+	
+	return n;
+	
+}
+
+
+
+/* 	Inserts key and data into super avl tree's root of 'type', whose lock is
+	held, or into a B+ tree or persistent engine's own root instead */
+static void avl_insertLocked(struct AVLtree* tree, struct AVLtree_sub** root, char type, union AVLkey key, void* data){
+	
+	struct AVLtree_sub *parent = NULL, *node;
+	struct AVLshared shared = {0, 0, (type == 'c' && (tree->options & AVL_STRING_ARENA)) ? strlen(key.string) : 0};
+	char *same = NULL, c_type = 0;
+	int eval;
+	
+	
+	/* A B+ tree engine inserts it into its own root instead */
+	if(tree->btree){
+		avl_btreeInsert(avl_btreeRoot(tree->btree, type), type, key, data);
+		(*avl_getSize(tree, type))++;
+		return;
+	}
+	
+	
+	/* A persistent engine copies whatever a snapshot shares on key's way */
+	if(tree->persist){
+		avl_persistInsert(avl_persistRoot(tree->persist, type), type, key, data);
+		(*avl_getSize(tree, type))++;
+		return;
+	}
+	
+	
+	/* 	A multimap appends data to key's datas, if it already holds key,
+		or starts them, for key's new node */
+	if(tree->options & AVL_MULTIMAP){
+		if((node = avl_searchKey(tree, type, key))){
+			node->data = avl_addValue(node->data, data);
+			return;
+		}
+		data = avl_addValue(NULL, data);
+	}
+	
+	
+	/* 	Runs through the root until it reaches where key belongs,
+		going right if key is greater than node's ID, left otherwise.
+		Every node on the way gets one more node under it. An equal
+		string met on the way, if interned, is kept to be shared */
+	for(node = *root; node; node = (c_type == 'r') ? node->Rchild : node->Lchild){
+		parent = node;
+		avl_resize(parent, parent->size + 1);
+		eval = avl_descendCompare(type, &key, node, &shared);
+		if(!eval && node->interned) same = node->ID.string;
+		c_type = (eval > 0) ? 'r' : 'l';
+	}
+	
+	
+	/* Takes a new node and copies key into its ID, and strings into the arena or heap */
+	node = avl_allocNode(tree);
+	if(type == 'c' && (tree->options & AVL_STRING_ARENA)){
+		key.string = same ? same : avl_intern(tree, key.string);
+		node->interned = 1;
+	} else if(type == 'c')
+		key.string = strcpy(malloc(strlen(key.string)+1), key.string);
+	node->ID = key;
+	node->type = type;
+	node->data = data;
+	node->size = 1;
+	(*avl_getSize(tree, type))++;
+	if(tree->hash) avl_hashInsert(avl_hashRoot(tree->hash, type), node);
+	
+	
+	/* 	Attaches it as the root, whose parent is itself,
+		if it's empty, or as its parent's child */
+	if(!parent){
+		node->parent = node;
+		avl_publish(root, node);
+		return;
+	}
+	
+	node->parent = parent;
+	avl_publish((c_type == 'r') ? &parent->Rchild : &parent->Lchild, node);
+	
+	
+	/* Rebalances node's ancestors, if needed */
+	avl_balanceInsert(tree, node);
+	
+}
+
+
+
+void avl_insertKey(struct AVLtree* tree, char type, union AVLkey key, void* data){
+	
+	/* Gets super avl tree's root depending on type */
+	struct AVLtree_sub **root;
+	if(!(root = avl_getRoot(tree, type))) return;
+	
+	
+	/* 	A durable tree logs it under the root's lock as well,
+		so its log holds changes in the same order they're made */
+	if(tree->wal) avl_walEnter(tree->wal);
+	avl_takeRoot(tree, type, 'w');
+	if(tree->wal) avl_walLog(tree->wal, 'i', type, key, data);
+	avl_insertLocked(tree, root, type, key, data);
+	avl_releaseRoot(tree, type);
+	if(tree->wal) avl_walLeave(tree);
+	
+}
+
+
+
+struct AVLtree_sub* avl_searchKey(struct AVLtree* tree, char type, union AVLkey key){
+	
+	/* Gets super avl tree's root depending on type */
+	struct AVLtree_sub **root, *node;
+	struct AVLshared shared = {0, 0, (type == 'c' && (tree->options & AVL_STRING_ARENA)) ? strlen(key.string) : 0};
+	int eval;
+	if(!(root = avl_getRoot(tree, type))) return NULL;
+	
+	
+	/* An indexed root is searched through its hash index instead */
+	if(tree->hash) return avl_hashSearch(avl_hashRoot(tree->hash, type), type, key);
+	
+	
+	/* Goes right or left, until key is found or there's no child */
+	for(node = *root; node; ){
+		eval = avl_descendCompare(type, &key, node, &shared);
+		
+		if(eval > 0) node = node->Rchild;
+		else if(eval < 0) node = node->Lchild;
+		else return node;
+	}
+	
+	
+	return NULL;
+	
+}
+
+
+
+void* avl_searchData(struct AVLtree* tree, char type, union AVLkey key){
+	
+	struct AVLtree_sub *node;
+	struct AVLbnode *leaf;
+	struct AVLpnode *pnode;
+	void *data = NULL;
+	int index;
+	if(!avl_getRoot(tree, type)) return NULL;
+	
+	
+	/* Searches whichever engine's root, getting data if it's found */
+	avl_lockRoot(tree, type, 'r');
+	if(tree->btree){
+		if(avl_btreeSearch(*avl_btreeRoot(tree->btree, type), type, key, &leaf, &index))
+			data = leaf->data[index];
+	} else if(tree->persist){
+		if((pnode = avl_persistSearch(*avl_persistRoot(tree->persist, type), type, key)))
+			data = pnode->data;
+	} else if((node = avl_isRCU(tree) ? avl_rcuSearchKey(tree, type, key) : avl_searchKey(tree, type, key)))
+		data = avl_firstData(tree, node);
+	avl_unlockRoot(tree, type);
+	
+	
+	return data;
+	
+}
+
+
+
+/* 	Walks searches of keys[next..n) from root interleaved, up to AVL_BATCH_LANES at a time.
+	Always inlined with a constant type, so each root type gets its own compare */
+static inline __attribute__((always_inline)) long avl_searchLanes(struct AVLtree_sub* root, char type, const void* keys, size_t width, long n, void** data){
+	
+	/* Each lane holds one ongoing search: its key, where it is and which index it's for */
+	struct AVLtree_sub *node[AVL_BATCH_LANES];
+	union AVLkey key[AVL_BATCH_LANES];
+	long index[AVL_BATCH_LANES], next = 0, found = 0;
+	int lane, active = 0, eval;
+	
+	
+	/* Starts as many searches as there are lanes, all at the root */
+	for(; active < AVL_BATCH_LANES && next < n; active++, next++){
+		key[active] = avl_readKey(type, keys, width, next);
+		node[active] = root;
+		index[active] = next;
+	}
+	
+	
+	/* 	Moves every search one level down per round, prefetching where it goes to.
+		When one ends, the next identifier takes its lane, or the last lane does */
+	while(active){
+		for(lane = 0; lane < active; ){
+			
+			if(node[lane] && (eval = avl_keyCompare(type, &key[lane], &node[lane]->ID))){
+				node[lane] = eval > 0 ? node[lane]->Rchild : node[lane]->Lchild;
+				if(node[lane]) __builtin_prefetch(node[lane]);
+				lane++;
+				continue;
+			}
+			
+			data[index[lane]] = node[lane] ? node[lane]->data : NULL;
+			found += node[lane] != NULL;
+			
+			if(next < n){
+				key[lane] = avl_readKey(type, keys, width, next);
+				node[lane] = root;
+				index[lane] = next++;
+			} else {
+				active--;
+				key[lane] = key[active];
+				node[lane] = node[active];
+				index[lane] = index[active];
+			}
+		}
+	}
+	
+	
+	return found;
+	
+}
+
+
+
+long avl_searchBatchKeys(struct AVLtree* tree, char type, const void* keys, size_t width, long n, void** data){
+	
+	struct AVLtree_sub **root, *node;
+	struct AVLbnode *leaf;
+	struct AVLpnode *pnode;
+	long i, found = 0;
+	int index;
+	if(!(root = avl_getRoot(tree, type)) || n <= 0) return 0;
+	
+	
+	/* 	A B+ tree engine's root is a few levels high, a persistent engine's
+		nodes have no sizes to tell, roots small enough to stay in cache have
+		no misses to hide, an indexed root is a probe away from any key, a
+		multimap's datas are each ID's first one, and an RCU tree's root is
+		checked for writers after each missing key, so searches go one by one */
+	avl_lockRoot(tree, type, 'r');
+	if(tree->btree){
+		for(i = 0; i < n; i++){
+			data[i] = NULL;
+			if(!avl_btreeSearch(*avl_btreeRoot(tree->btree, type), type, avl_readKey(type, keys, width, i), &leaf, &index))
+				continue;
+			data[i] = leaf->data[index];
+			found++;
+		}
+	} else if(tree->persist){
+		for(i = 0; i < n; i++){
+			pnode = avl_persistSearch(*avl_persistRoot(tree->persist, type), type, avl_readKey(type, keys, width, i));
+			data[i] = pnode ? pnode->data : NULL;
+			found += pnode != NULL;
+		}
+	} else if(!*root || (*root)->size <= AVL_BATCH_CACHED || tree->hash || (tree->options & AVL_MULTIMAP) || avl_isRCU(tree)){
+		for(i = 0; i < n; i++){
+			node = avl_isRCU(tree) ? avl_rcuSearchKey(tree, type, avl_readKey(type, keys, width, i))
+								   : avl_searchKey(tree, type, avl_readKey(type, keys, width, i));
+			data[i] = node ? avl_firstData(tree, node) : NULL;
+			found += node != NULL;
+		}
+	} else switch(type){
+		case 'i': found = avl_searchLanes(*root, 'i', keys, width, n, data); break;
+		case 'u': found = avl_searchLanes(*root, 'u', keys, width, n, data); break;
+		case 'd': found = avl_searchLanes(*root, 'd', keys, width, n, data); break;
+		case 'c': found = avl_searchLanes(*root, 'c', keys, width, n, data); break;
+	}
+	avl_unlockRoot(tree, type);
+	
+	
+	return found;
+	
+}
+
+
+
+long avl_tTraverse(void** ID, void** data, long n, struct AVLtree_sub* node){
+	
+	/* 	Nodes whose left side is being visited. Since the tree height is
+		within 1.44*log2(n), it never needs more than AVL_MAX_HEIGHT of them */
+	struct AVLtree_sub *stack[AVL_MAX_HEIGHT];
+	int top = 0;
+	long c = 0;
+	
+	
+	while(c < n && (node || top)){
+		
+		/* Goes down through left children, stacking them */
+		for(; node; node = node->Lchild) stack[top++] = node;
+		
+		
+		/* 	Pointer arrays at index c now point to the smallest
+			stacked node's ID and data, then goes to its right side */
+		node = stack[--top];
+		if(ID) ID[c] = avl_getID(node);
+		if(data) data[c] = node->data;
+		c++;
+		node = node->Rchild;
+		
+	}
+	
+	
+	return c;
+	
+}
+
+
+
+long avl_traverseRoot(struct AVLtree* tree, char type, void** ID, void** data, long n){
+	
+	/* Traverses whichever engine's root */
+	struct AVLtree_sub **root;
+	long c;
+	if(!(root = avl_getRoot(tree, type))) return 0;
+	
+	/* Keeps writers out, as an RCU tree's readers don't, so it gets a consistent copy */
+	avl_lockRoot(tree, type, 'x');
+	if(tree->btree) c = avl_btreeTraverse(ID, data, n, *avl_btreeRoot(tree->btree, type));
+	else if(tree->persist) c = avl_persistTraverse(ID, data, n, *avl_persistRoot(tree->persist, type));
+	else c = avl_tTraverse(ID, data, n, *root);
+	avl_unlockRoot(tree, type);
+	
+	
+	return c;
+	
+}
+
+
+
+/* What every task of a parallel traversal shares: the arrays to fill, and how many IDs fit into them */
+struct AVLfill{
+	
+	void **ID;
+	void **data;
+	long n;
+	
+};
+
+
+
+/* 	Task of a parallel traversal: puts the subtree of task's node into the arrays,
+	from task's index on, its left subtree first, which it takes the size of to know
+	where the node itself goes. Splits off left subtrees as tasks of their own, while
+	they're big enough, going on with right ones */
+static void avl_traverseTask(struct AVLpool* pool, struct AVLtask* task){
+	
+	struct AVLfill *fill = task->arg;
+	struct AVLtree_sub *node = task->node;
+	long i = task->index;
+	
+	
+	for(; node && i < fill->n && node->size > AVL_PARALLEL_GRAIN; node = node->Rchild){
+		avl_poolSpawn(pool, (struct AVLtask){avl_traverseTask, fill, node->Lchild, i, 0});
+		i += avl_getSubSize(node->Lchild);
+		if(i >= fill->n) return;
+		
+		if(fill->ID) fill->ID[i] = avl_getID(node);
+		if(fill->data) fill->data[i] = node->data;
+		i++;
+	}
+	
+	
+	if(node && i < fill->n)
+		avl_tTraverse(fill->ID ? fill->ID + i : NULL, fill->data ? fill->data + i : NULL, fill->n - i, node);
+	
+}
+
+
+
+long avl_parallelTraverseRoot(struct AVLtree* tree, char type, void** ID, void** data, long n, struct AVLpool* pool){
+	
+	struct AVLfill fill = {ID, data, n};
+	struct AVLtree_sub **root;
+	long c;
+	if(!(root = avl_getRoot(tree, type))) return 0;
+	
+	
+	/* 	Keeps writers out while the pool's workers go through an avl root. A B+ tree
+		engine's root is gone through on its own, leaf after leaf, as is a persistent
+		engine's, whose nodes have no sizes to split it by */
+	avl_lockRoot(tree, type, 'x');
+	if(tree->btree) c = avl_btreeTraverse(ID, data, n, *avl_btreeRoot(tree->btree, type));
+	else if(tree->persist) c = avl_persistTraverse(ID, data, n, *avl_persistRoot(tree->persist, type));
+	else {
+		c = avl_getSubSize(*root);
+		if(c > n) c = n;
+		if(c > 0) avl_poolRun(pool, (struct AVLtask){avl_traverseTask, &fill, *root, 0, 0});
+	}
+	avl_unlockRoot(tree, type);
+	
+	
+	return c;
+	
+}
+
+
+
+void avl_rangeStart(struct AVLtree* tree, struct AVLrange* range, char type, union AVLkey lo, union AVLkey hi){
+	
+	/* 	The range starts at the smallest node whose ID is not lesser than lo,
+		or at the first such ID of a B+ tree engine's leaves */
+	range->node = NULL;
+	range->leaf = NULL;
+	range->hi = hi;
+	range->type = type;
+	
+	if(!tree->btree) range->node = avl_lowerBound(tree, type, lo);
+	else if(avl_getRoot(tree, type))
+		avl_btreeLowerBound(*avl_btreeRoot(tree->btree, type), type, lo, &range->leaf, &range->index);
+	
+}
+
+
+
+int avl_rangeNext(struct AVLrange* range, void** ID, void** data){
+	
+	struct AVLtree_sub *node = range->node;
+	struct AVLbnode *leaf = range->leaf;
+	
+	
+	/* 	A B+ tree engine's range goes through its leaves, one ID
+		after another, until there's none left, or it's past hi */
+	if(leaf){
+		if(avl_keyCompare(range->type, &leaf->keys[range->index], &range->hi) > 0){
+			range->leaf = NULL;
+			return 0;
+		}
+		
+		if(ID) *ID = avl_btreeID(leaf, range->index);
+		if(data) *data = leaf->data[range->index];
+		if(++range->index == leaf->count){
+			range->leaf = leaf->next;
+			range->index = 0;
+		}
+		return 1;
+	}
+	
+	
+	/* The range is over if there's no node left, or it's past hi */
+	if(!node || avl_keyCompare(range->type, &node->ID, &range->hi) > 0){
+		range->node = NULL;
+		return 0;
+	}
+	
+	
+	/* Hands out node's ID and data, and moves on to the next one */
+	if(ID) *ID = avl_getID(node);
+	if(data) *data = node->data;
+	range->node = avl_successor(node);
+	
+	
+	return 1;
+	
+}
+
+
+
+/* 	Passes every node of an RCU tree's root from lo to hi to callback, as
+	avl_rangeKey() does, with no lock. Each step to the next node is checked
+	against the root's sequence, and if a writer changed it meanwhile, the
+	range seeks the last ID handed out again, past those equal to it */
+static long avl_rcuRangeKey(struct AVLtree* tree, char type, union AVLkey lo, union AVLkey hi,
+							int (*callback)(void* ID, void* data, void* arg), void* arg){
+	
+	struct AVLtree_sub *node;
+	union AVLkey last;
+	unsigned long s;
+	long i, c = 0, same = 0;
+	int tries = 0;
+	
+	
+	do {
+		s = avl_readBegin(tree, type, &tries);
+		node = avl_rcuLowerBound(tree, type, lo);
+	} while(avl_readRetry(tree, type, s, &tries));
+	
+	
+	while(node && avl_keyCompare(type, &node->ID, &hi) <= 0){
+		c++;
+		if(callback(avl_getID(node), node->data, arg)) break;
+		
+		same = (same && !avl_keyCompare(type, &node->ID, &last)) ? same + 1 : 1;
+		last = node->ID;
+		
+		node = avl_rcuSuccessor(node);
+		for(tries = 0; avl_readRetry(tree, type, s, &tries); ){
+			s = avl_readBegin(tree, type, &tries);
+			node = avl_rcuLowerBound(tree, type, last);
+			for(i = 0; node && i < same && !avl_keyCompare(type, &node->ID, &last); i++)
+				node = avl_rcuSuccessor(node);
+		}
+	}
+	
+	
+	return c;
+	
+}
+
+
+
+long avl_rangeKey(struct AVLtree* tree, char type, union AVLkey lo, union AVLkey hi,
+				  int (*callback)(void* ID, void* data, void* arg), void* arg){
+	
+	struct AVLrange range;
+	void *ID, *data;
+	long c = 0;
+	
+	
+	/* Pulls every node of the range, passing them to callback until it asks to stop */
+	avl_lockRoot(tree, type, 'r');
+	if(avl_isRCU(tree)) c = avl_rcuRangeKey(tree, type, lo, hi, callback, arg);
+	else {
+		avl_rangeStart(tree, &range, type, lo, hi);
+		while(avl_rangeNext(&range, &ID, &data)){
+			c++;
+			if(callback(ID, data, arg)) break;
+		}
+	}
+	avl_unlockRoot(tree, type);
+	
+	
+	return c;
+	
+}
+
+
+
+int avl_iterEdge(struct AVLiter* iter, struct AVLtree_sub* root, char side){
+	
+	/* Goes all the way down to root's leftmost or rightmost node */
+	iter->node = root;
+	if(!root) return 0;
+	
+	if(side == 'l') while(iter->node->Lchild) iter->node = iter->node->Lchild;
+	else while(iter->node->Rchild) iter->node = iter->node->Rchild;
+	
+	
+	return 1;
+	
+}
+
+
+
+int avl_iterSeekKey(struct AVLtree* tree, struct AVLiter* iter, char type, union AVLkey key){
+	
+	/* Stops at the smallest node whose ID is not lesser than key */
+	iter->node = avl_lowerBound(tree, type, key);
+	return iter->node != NULL;
+	
+}
+
+
+
+int avl_iterNext(struct AVLiter* iter){
+	
+	/* Moves on to the node right after the current one, if there's any */
+	if(iter->node) iter->node = avl_successor(iter->node);
+	return iter->node != NULL;
+	
+}
+
+
+
+int avl_iterPrev(struct AVLiter* iter){
+	
+	/* Moves back to the node right before the current one, if there's any */
+	if(iter->node) iter->node = avl_predecessor(iter->node);
+	return iter->node != NULL;
+	
+}
+
+
+
+int avl_iterGet(struct AVLiter* iter, void** ID, void** data){
+	
+	/* Hands out current node's ID and data, if it's on one */
+	if(!iter->node) return 0;
+	if(ID) *ID = avl_getID(iter->node);
+	if(data) *data = iter->node->data;
+	
+	
+	return 1;
+	
+}
+
+
+
+long avl_rankKey(struct AVLtree* tree, char type, union AVLkey key){
+	
+	/* Gets super avl tree's root depending on type */
+	struct AVLtree_sub **root, *node;
+	unsigned long s;
+	long rank;
+	int h, tries = 0;
+	if(!(root = avl_getRoot(tree, type))) return 0;
+	
+	
+	/* 	Goes down looking for key. Whenever it goes right, node
+		and all of its left subtree are lesser than key. An RCU
+		tree's root is read again if a writer changed it meanwhile */
+	avl_lockRoot(tree, type, 'r');
+	do {
+		s = avl_readBegin(tree, type, &tries);
+		rank = 0;
+		for(node = avl_load(root), h = 0; node && h < AVL_MAX_HEIGHT; h++){
+			if(avl_keyCompare(type, &key, &node->ID) > 0){
+				rank += avl_getSubSize(avl_load(&node->Lchild)) + 1;
+				node = avl_load(&node->Rchild);
+			} else node = avl_load(&node->Lchild);
+		}
+	} while(avl_readRetry(tree, type, s, &tries));
+	avl_unlockRoot(tree, type);
+	
+	
+	return rank;
+	
+}
+
+
+
+int avl_selectNode(struct AVLtree_sub* node, long k, void** ID, void** data){
+	
+	long l_size;
+	
+	
+	/* There's no such node if k is out of the tree */
+	if(k < 0 || k >= (long)avl_getSubSize(node)) return 0;
+	
+	
+	/* 	Goes down comparing k to the left subtree's size: if
+		it's lesser, the node is there, if it's equal, it's the
+		current one, otherwise it's on the right, skipping them */
+	while(1){
+		l_size = avl_getSubSize(node->Lchild);
+		
+		if(k < l_size) node = node->Lchild;
+		else if(k == l_size) break;
+		else {
+			k -= l_size + 1;
+			node = node->Rchild;
+		}
+	}
+	
+	
+	/* Hands out node's ID and data */
+	if(ID) *ID = avl_getID(node);
+	if(data) *data = node->data;
+	return 1;
+	
+}
+
+
+
+int avl_percentileNode(struct AVLtree_sub* node, double p, void** ID, void** data){
+	
+	/* Nearest rank: the ceil(p*n)-th smallest node, i.e. index ceil(p*n)-1 */
+	long n = avl_getSubSize(node), k;
+	if(!n) return 0;
+	
+	if(p <= 0) k = 0;
+	else if(p >= 1) k = n-1;
+	else {
+		k = (long)(p*n);
+		if(k < p*n) k++;
+		k--;
+		if(k < 0) k = 0;
+	}
+	
+	
+	return avl_selectNode(node, k, ID, data);
+	
+}
+
+
+
+void avl_removeNode(struct AVLtree* tree, struct AVLtree_sub* node){
+	
+	struct AVLtree_sub *child, *parent;
+	char c_type;
+	
+	
+	/* 	Node leaves its root and hash index, and its ID and data are freed along with it.
+		A durable tree logs its removal first, while its ID is still there */
+	if(tree->wal) avl_walLog(tree->wal, 'r', node->type, node->ID, NULL);
+	(*avl_getSize(tree, node->type))--;
+	if(tree->hash) avl_hashRemove(avl_hashRoot(tree->hash, node->type), node);
+	
+	
+	/* Every ancestor of node gets one node less under it */
+	for(parent = node; parent->parent != parent; ){
+		parent = parent->parent;
+		avl_resize(parent, parent->size - 1);
+	}
+	
+	
+	
+	/* 	If node has both children, its biggest left child is unlinked
+		and takes node's place, so no other node has its ID or data moved */
+	if(node->Lchild && node->Rchild){
+		
+		/* 	Gets node's biggest left child, and every node on the
+			way to it gets one node less under it, since it's leaving */
+		struct AVLtree_sub *i_node = node->Lchild;
+		while(i_node->Rchild){
+			avl_resize(i_node, i_node->size - 1);
+			i_node = i_node->Rchild;
+		}
+		
+		
+		/* 	If it's node's own left child, its left side is what shrinks.
+			Otherwise, its left child takes its place under its parent,
+			whose right side shrinks, and it takes node's left child */
+		if(i_node == node->Lchild){
+			parent = i_node;
+			c_type = 'l';
+		} else {
+			parent = i_node->parent;
+			c_type = 'r';
+			
+			avl_link(&parent->Rchild, i_node->Lchild);
+			if(parent->Rchild) avl_link(&parent->Rchild->parent, parent);
+			avl_link(&i_node->Lchild, node->Lchild);
+			avl_link(&i_node->Lchild->parent, i_node);
+		}
+		
+		
+		/* It takes node's right child, balance, size and place */
+		avl_link(&i_node->Rchild, node->Rchild);
+		avl_link(&i_node->Rchild->parent, i_node);
+		i_node->balance = node->balance;
+		avl_resize(i_node, node->size - 1);
+		avl_replaceChild(tree, node, i_node);
+		
+		
+		/* Frees node and rebalances from where the tree got shorter */
+		avl_freeNode(tree, node);
+		avl_balanceRemove(tree, parent, c_type);
+		return;
+		
+	}
+	
+	
+	
+	/* 	Now node has at most one child, which takes its place:
+		if it's the root, its child becomes the root, or the root
+		becomes empty */
+	child = node->Lchild ? node->Lchild : node->Rchild;
+	parent = node->parent;
+	c_type = (parent->Lchild == node) ? 'l' : 'r';
+	avl_replaceChild(tree, node, child);
+	
+	
+	/* 	Frees node, whose ID and data are already freed, and
+		rebalances its ancestors, since that side got shorter */
+	avl_freeNode(tree, node);
+	if(parent != node) avl_balanceRemove(tree, parent, c_type);
+	
+}
+
+
+
+int avl_removeKey(struct AVLtree* tree, char type, union AVLkey key){
+	
+	struct AVLtree_sub *node;
+	int removed = 0;
+	if(!avl_getRoot(tree, type)) return 0;
+	
+	
+	/* 	Searches for key, and removes its node if it's found, or removes
+		it from a B+ tree or persistent engine's own root instead */
+	if(tree->wal) avl_walEnter(tree->wal);
+	avl_takeRoot(tree, type, 'w');
+	if(tree->btree){
+		if((removed = avl_btreeRemove(avl_btreeRoot(tree->btree, type), type, key)))
+			(*avl_getSize(tree, type))--;
+	} else if(tree->persist){
+		if((removed = avl_persistRemove(tree->persist, avl_persistRoot(tree->persist, type), type, key)))
+			(*avl_getSize(tree, type))--;
+	} else if((node = avl_searchKey(tree, type, key))){
+		avl_removeNode(tree, node);
+		removed = 1;
+	}
+	
+	/* 	A durable tree logs only what was there to remove, which
+		avl_removeNode() already did for an avl root's node */
+	if(tree->wal && removed && (tree->btree || tree->persist)) avl_walLog(tree->wal, 'r', type, key, NULL);
+	avl_releaseRoot(tree, type);
+	if(tree->wal) avl_walLeave(tree);
+	
+	
+	return removed;
+	
+}
+
+
+
+long avl_searchValues(struct AVLtree* tree, char type, union AVLkey key, void** data, long n){
+	
+	struct AVLtree_sub *node;
+	struct AVLvalues *values;
+	long count = 0;
+	if(!avl_getRoot(tree, type) || !(tree->options & AVL_MULTIMAP)) return 0;
+	
+	
+	/* Copies up to n of key's datas, if it's found, and counts all of them */
+	avl_lockRoot(tree, type, 'r');
+	if((node = avl_searchKey(tree, type, key))){
+		values = node->data;
+		count = values->count;
+		if(data && n > 0) memcpy(data, values->data, (n < count ? n : count)*sizeof(void*));
+	}
+	avl_unlockRoot(tree, type);
+	
+	
+	return count;
+	
+}
+
+
+
+int avl_removeValue(struct AVLtree* tree, char type, union AVLkey key, void* data){
+	
+	struct AVLtree_sub *node;
+	struct AVLvalues *values;
+	long i = 0;
+	int removed = 0;
+	if(!avl_getRoot(tree, type) || !(tree->options & AVL_MULTIMAP)) return 0;
+	
+	
+	/* Searches for key, and for data among its datas */
+	if(tree->wal) avl_walEnter(tree->wal);
+	avl_takeRoot(tree, type, 'w');
+	if((node = avl_searchKey(tree, type, key))){
+		values = node->data;
+		for(; i < values->count && values->data[i] != data; i++);
+		removed = i < values->count;
+	}
+	
+	/* 	Its node goes along with its last data, logged as its removal.
+		Otherwise, the ones after it are moved back, so the others keep
+		their order */
+	if(removed){
+		if(values->count == 1) avl_removeNode(tree, node);
+		else {
+			if(tree->wal) avl_walLog(tree->wal, 'o', type, key, data);
+			memmove(values->data + i, values->data + i + 1, (values->count - i - 1)*sizeof(void*));
+			values->count--;
+			free(data);
+		}
+	}
+	avl_releaseRoot(tree, type);
+	if(tree->wal) avl_walLeave(tree);
+	
+	
+	return removed;
+	
+}
+
+
+
+struct AVLtree_sub* avl_rotate(struct AVLtree* tree, struct AVLtree_sub* node, char direction){
+	
+	struct AVLtree_sub *pivot;
+	
+	
+	/* 	Pivot is the child that goes up, and its inner
+		subtree is handed over to node */
+	if(direction == 'l'){
+		pivot = node->Rchild;
+		avl_link(&node->Rchild, pivot->Lchild);
+		if(node->Rchild) avl_link(&node->Rchild->parent, node);
+		avl_link(&pivot->Lchild, node);
+	} else {
+		pivot = node->Lchild;
+		avl_link(&node->Lchild, pivot->Rchild);
+		if(node->Lchild) avl_link(&node->Lchild->parent, node);
+		avl_link(&pivot->Rchild, node);
+	}
+	
+	
+	/* 	Pivot takes node's place, either as a root or as its parent's child,
+		which publishes the rotation to an RCU tree's readers */
+	avl_replaceChild(tree, node, pivot);
+	avl_link(&node->parent, pivot);
+	
+	
+	/* Pivot now has all of node's subtree under it, and node has only its children's */
+	avl_resize(pivot, node->size);
+	avl_resize(node, avl_getSubSize(node->Lchild) + avl_getSubSize(node->Rchild) + 1);
+	
+	
+	/* 	Updates balances based only on their previous
+		values, so it works for any rotation case */
+	if(direction == 'l'){
+		node->balance = node->balance - 1 - (pivot->balance > 0 ? pivot->balance : 0);
+		pivot->balance = pivot->balance - 1 + (node->balance < 0 ? node->balance : 0);
+	} else {
+		node->balance = node->balance + 1 - (pivot->balance < 0 ? pivot->balance : 0);
+		pivot->balance = pivot->balance + 1 + (node->balance > 0 ? node->balance : 0);
+	}
+	
+	
+	return pivot;
+	
+}
+
+
+
+struct AVLtree_sub* avl_rebalance(struct AVLtree* tree, struct AVLtree_sub* node){
+	
+	/* Right heavy: double rotation if its right child leans left */
+	if(node->balance > 1){
+		if(node->Rchild->balance < 0) avl_rotate(tree, node->Rchild, 'r');
+		return avl_rotate(tree, node, 'l');
+	}
+	
+	
+	/* Left heavy: double rotation if its left child leans right */
+	if(node->balance < -1){
+		if(node->Lchild->balance > 0) avl_rotate(tree, node->Lchild, 'l');
+		return avl_rotate(tree, node, 'r');
+	}
+	
+	
+	return node;
+	
+}
+
+
+
+void avl_balanceInsert(struct AVLtree* tree, struct AVLtree_sub* node){
+	
+	struct AVLtree_sub *parent;
+	
+	
+	/* Goes up while node's subtree got taller */
+	while(node->parent != node){
+		
+		parent = node->parent;
+		parent->balance += (parent->Lchild == node) ? -1 : 1;
+		
+		
+		/* Parent's height didn't change, nothing else to do */
+		if(!parent->balance) return;
+		
+		
+		/* 	Parent got unbalanced: after rotating, its subtree
+			has the height it had before the insertion */
+		if(parent->balance > 1 || parent->balance < -1){
+			avl_rebalance(tree, parent);
+			return;
+		}
+		
+		node = parent;
+		
+	}
+	
+}
+
+
+
+void avl_balanceRemove(struct AVLtree* tree, struct AVLtree_sub* node, char c_type){
+	
+	/* Goes up while node's subtree got shorter */
+	while(1){
+		
+		node->balance += (c_type == 'l') ? 1 : -1;
+		
+		
+		/* Node was balanced, so its height didn't change */
+		if(node->balance == 1 || node->balance == -1) return;
+		
+		
+		/* 	Node got unbalanced: rotates it, and its height only
+			changes if its new subtree root is balanced */
+		if(node->balance){
+			node = avl_rebalance(tree, node);
+			if(node->balance) return;
+		}
+		
+		
+		/* Node's subtree got shorter, so checks its parent */
+		if(node->parent == node) return;
+		c_type = (node->parent->Lchild == node) ? 'l' : 'r';
+		node = node->parent;
+		
+	}
+	
+}
+
+
+
+long avl_verify(struct AVLtree_sub* node){
+	
+	long l_height, r_height;
+	
+	
+	/* Base case: empty trees have no height */
+	if(!node) return 0;
+	
+	
+	/* Children must point back to node */
+	if(node->Lchild && node->Lchild->parent != node) return -1;
+	if(node->Rchild && node->Rchild->parent != node) return -1;
+	
+	
+	/* Recursively gets children's heights */
+	if((l_height = avl_verify(node->Lchild)) < 0) return -1;
+	if((r_height = avl_verify(node->Rchild)) < 0) return -1;
+	
+	
+	/* Node's balance must match its children's heights, and be between -1 and 1 */
+	if(node->balance != r_height - l_height) return -1;
+	if(node->balance > 1 || node->balance < -1) return -1;
+	
+	
+	/* Node's size must match its children's sizes */
+	if(node->size != avl_getSubSize(node->Lchild) + avl_getSubSize(node->Rchild) + 1) return -1;
+	
+	
+	return 1 + (l_height > r_height ? l_height : r_height);
+	
+}
+
+
+
+/* 	Goes through every node ever handed out by slab, freeing ID and data
+	of the ones in use, i.e. those that have a parent, retired ones
+	included, then frees the slab itself */
+static void avl_freeSlab(struct AVLtree* tree, struct AVLslab* slab){
+	
+	long i;
+	
+	
+	for(i = 0; i < slab->used; i++){
+		struct AVLtree_sub *node = &slab->nodes[i];
+		if(!node->parent) continue;
+		
+		if(node->type == 'c' && !node->interned)
+			free(node->ID.string);
+		avl_freeData(tree, node->data);
+	}
+	
+	free(slab);
+	
+}
 
 
 
-struct AVLtree* avl_createTree(void){
+/* 	Frees what's left of a super avl tree once its nodes are freed: B+ tree engine, persistent
+	engine, whose roots are freed on their own along with their IDs and datas, log, hash indexes,
+	string arena, locks and the tree itself */
+static void avl_freeTree(struct AVLtree* tree){
 	
-	/* Creates a super avl tree */
-	struct AVLtree *tree = calloc(1, sizeof(struct AVLtree));
+	struct AVLarena *block;
+	int i;
 	
 	
-	/* Creates all root types for that tree on heap */
-	tree->int_root		= calloc(1, sizeof(struct AVLtree_sub));
-	tree->uint_root		= calloc(1, sizeof(struct AVLtree_sub));
-	tree->double_root	= calloc(1, sizeof(struct AVLtree_sub));
-	tree->string_root	= calloc(1, sizeof(struct AVLtree_sub));
+	free(tree->btree);
+	avl_persistFree(tree->persist);
+	avl_walClose(tree->wal);
+	avl_hashFree(tree->hash);
 	
 	
-	/* Sets all roots to leaves */
-	tree->int_root->isLeaf		= 1;
-	tree->uint_root->isLeaf		= 1;
-	tree->double_root->isLeaf	= 1;
-	tree->string_root->isLeaf	= 1;
+	/* Frees the string arena, with every string interned into it */
+	for(; (block = tree->arena); free(block)) tree->arena = block->next;
 	
 	
-	/* Since they're roots, their parents are themselves */
-	tree->int_root->parent		= tree->int_root;
-	tree->uint_root->parent 	= tree->uint_root;
-	tree->double_root->parent	= tree->double_root;
-	tree->string_root->parent	= tree->string_root;
+	/* Destroys a concurrent tree's locks */
+	if(tree->locks){
+		for(i = 0; i < 4; i++) pthread_rwlock_destroy(&tree->locks->roots[i]);
+		for(i = 0; i < 3; i++) free(tree->locks->retired[i]);
+		pthread_mutex_destroy(&tree->locks->nodes);
+		free(tree->locks);
+	}
 	
 	
-	/* Returns configured tree */
-	return tree;
+	/* Frees the super tree iteslf */
+	free(tree);
 	
 }
 
 
 
-void avl_checkChild(struct AVLtree_sub* parent, char c_type){
+void avl_free(struct AVLtree* tree){
+	
+	struct AVLslab *slab, *next;
 	
-	/* 	Allocates and configures a right child to parent, on heap,
-		if it's to check for it and if parent doesn't have one */
-	if(c_type == 'r' && !parent->Rchild){
-		parent->Rchild = calloc(1, sizeof(struct AVLtree_sub));
-		parent->Rchild->isLeaf = 1;
-		parent->Rchild->parent = parent;
-		return;
-	}
 	
+	/* Frees every slab, with IDs and datas of its nodes */
+	for(slab = tree->slabs; slab; slab = next){
+		next = slab->next;
+		avl_freeSlab(tree, slab);
+	}
 	
 	
-	/* 	Allocates and configures a left child to parent, on heap,
-		if it's to check for it and if parent doesn't have one */
-	if(c_type == 'l' && !parent->Lchild){
-		parent->Lchild = calloc(1, sizeof(struct AVLtree_sub));
-		parent->Lchild->isLeaf = 1;
-		parent->Lchild->parent = parent;
+	/* Frees a B+ tree engine's roots, with their IDs and datas */
+	if(tree->btree){
+		avl_btreeFree(tree->btree->int_root);
+		avl_btreeFree(tree->btree->uint_root);
+		avl_btreeFree(tree->btree->double_root);
+		avl_btreeFree(tree->btree->string_root);
 	}
 	
+	
+	avl_freeTree(tree);
+	tree = NULL;
+	
 }
 
 
 
-void avl_tTraverse(void*** ID, void*** data, long* c, struct AVLtree_sub* node){
+/* 	Task of a parallel free: frees task's node as a slab, or as a B+ tree engine's
+	root if task's index is 1. With no node, spawns a task for every slab and root */
+static void avl_freeTask(struct AVLpool* pool, struct AVLtask* task){
+	
+	struct AVLtree *tree = task->arg;
+	struct AVLslab *slab;
 	
-	/* Base case: returns if there's no node, or there's no ID nor data inside node */
-	if(!node) return;
-	if(!node->ID && !node->data) return;
 	
+	if(task->node){
+		if(task->index) avl_btreeFree(task->node);
+		else avl_freeSlab(tree, task->node);
+		return;
+	}
 	
-	/* Recursively goes through node's children */
-	if(node->Lchild) avl_tTraverse(ID, data, c, node->Lchild);
-	if(node->Rchild) avl_tTraverse(ID, data, c, node->Rchild);
 	
+	for(slab = tree->slabs; slab; slab = slab->next)
+		avl_poolSpawn(pool, (struct AVLtask){avl_freeTask, tree, slab, 0, 0});
 	
-	/* Pointer array at index c now points to current node's ID and data */
-	(*ID)[(*c)] = node->ID;
-	(*data)[(*c)] = node->data;
+	if(tree->btree){
+		if(tree->btree->int_root) avl_poolSpawn(pool, (struct AVLtask){avl_freeTask, tree, tree->btree->int_root, 1, 0});
+		if(tree->btree->uint_root) avl_poolSpawn(pool, (struct AVLtask){avl_freeTask, tree, tree->btree->uint_root, 1, 0});
+		if(tree->btree->double_root) avl_poolSpawn(pool, (struct AVLtask){avl_freeTask, tree, tree->btree->double_root, 1, 0});
+		if(tree->btree->string_root) avl_poolSpawn(pool, (struct AVLtask){avl_freeTask, tree, tree->btree->string_root, 1, 0});
+	}
 	
+}
+
+
+
+void avl_parallelFree(struct AVLtree* tree, struct AVLpool* pool){
 	
-	/* Increase counter and reallocates ID and data arrays */
-	(*c)++;
-	(*ID) = realloc((*ID), ((*c)+1)*sizeof(void*));
-	(*data) = realloc((*data), ((*c)+1)*sizeof(void*));
+	avl_poolRun(pool, (struct AVLtask){avl_freeTask, tree, NULL, 0, 0});
+	avl_freeTree(tree);
 	
 }
 
 
 
-void avl_removeNode(struct AVLtree* tree, struct AVLtree_sub* node){
+/* Gets the height of an avl tree, going down its taller side */
+static int avl_getHeight(struct AVLtree_sub* node){
+	int height = 0;
+	for(; node; node = (node->balance > 0) ? node->Rchild : node->Lchild) height++;
+	return height;
+}
+
+
+
+/* Gets the height of node's child on 'side', 'l' or 'r', from node's own height */
+static inline int avl_childHeight(struct AVLtree_sub* node, int height, char side){
+	if(side == 'l') return height - ((node->balance > 0) ? 2 : 1);
+	return height - ((node->balance < 0) ? 2 : 1);
+}
+
+
+
+/* Makes node the root of an avl tree on its own, whose parent is itself, if there's any */
+static inline struct AVLtree_sub* avl_detach(struct AVLtree_sub* node){
+	if(node) avl_link(&node->parent, node);
+	return node;
+}
+
+
+
+/* 	Makes node a root whose children are left and right, of heights
+	l_height and r_height, which differ by 1 at most. Returns its height */
+static int avl_linkNode(struct AVLtree_sub* node, struct AVLtree_sub* left, int l_height, struct AVLtree_sub* right, int r_height){
 	
-	struct AVLtree_sub* aux;
+	avl_link(&node->Lchild, left);
+	avl_link(&node->Rchild, right);
+	if(left) avl_link(&left->parent, node);
+	if(right) avl_link(&right->parent, node);
 	
+	avl_link(&node->parent, node);
+	node->balance = r_height - l_height;
+	avl_resize(node, avl_getSubSize(left) + avl_getSubSize(right) + 1);
 	
-	/* Frees data and ID, if it's not equal to data */
-	if(node->ID != node->data)
-		free(node->ID);
-	free(node->data);
-	node->data = NULL;
-	node->ID = NULL;
 	
+	return (l_height > r_height ? l_height : r_height) + 1;
+	
+}
+
+
+
+/* 	Joins left, node and right, of which left is more than 1 taller, by
+	going down left's right side until a subtree as tall as right, or 1
+	taller, which node takes its place with right. Ancestors on the way
+	are rotated as they get unbalanced, on the way back up */
+static struct AVLtree_sub* avl_joinRight(struct AVLtree_sub* left, int l_height, struct AVLtree_sub* node,
+										 struct AVLtree_sub* right, int r_height, int* height){
+	
+	struct AVLtree_sub *l = left->Lchild, *c = left->Rchild, *t;
+	int l_h = avl_childHeight(left, l_height, 'l'), c_h = avl_childHeight(left, l_height, 'r'), t_h;
 	
 	
-	/* If node has both children: swaps current node with biggets under it and frees it */
-	if(node->Lchild && node->Rchild){
+	if(c_h <= r_height + 1){
 		
-		/* Gets node's biggest left child */
-		struct AVLtree_sub *i_node = node->Lchild;
-		while(1){
-			if(i_node->Rchild) i_node = i_node->Rchild;
-			else break;
+		/* Node takes c and right, and left takes node, unless it'd get unbalanced */
+		if((c_h > r_height ? c_h : r_height) + 1 <= l_h + 1){
+			t_h = avl_linkNode(node, c, c_h, right, r_height);
+			*height = avl_linkNode(left, l, l_h, node, t_h);
+			return left;
 		}
 		
 		
-		/* Sets node's ID and data to point to those of the biggets left child */
-		node->ID = i_node->ID;
-		node->data = i_node->data;
-		
-		
-		/* */
-		if(i_node->parent->Lchild == i_node){
-			
-			if(i_node->Lchild){
-				
-				i_node->Lchild->parent = i_node->parent;
-				i_node->parent->Lchild = i_node->Lchild;
-				
-			} else i_node->parent->Lchild = NULL;
-			
-		} else if(i_node->Lchild) {
+		/* 	Otherwise, c is 1 taller than right, and goes up, taking left
+			and node, which share its children: a double rotation */
+		{
+			struct AVLtree_sub *cl = c->Lchild, *cr = c->Rchild;
+			int cl_h = avl_childHeight(c, c_h, 'l'), cr_h = avl_childHeight(c, c_h, 'r');
 			
-			i_node->Lchild->parent = i_node->parent;
-			i_node->parent->Rchild = i_node->Lchild;
-			
-		} else i_node->parent->Rchild = NULL;
-		
+			l_h = avl_linkNode(left, l, l_h, cl, cl_h);
+			t_h = avl_linkNode(node, cr, cr_h, right, r_height);
+			*height = avl_linkNode(c, left, l_h, node, t_h);
+			return c;
+		}
 		
-		/* Frees node's biggets left child and returns */
-		free(i_node);
-		i_node = NULL;
-		return;
-
 	}
 	
 	
+	/* 	Joins node and right further down, into t, which left takes as its right
+		child, unless it'd get unbalanced: then t goes up, rotating left */
+	t = avl_joinRight(c, c_h, node, right, r_height, &t_h);
+	if(t_h <= l_h + 1){
+		*height = avl_linkNode(left, l, l_h, t, t_h);
+		return left;
+	}
+	
+	c = t->Rchild;
+	c_h = avl_childHeight(t, t_h, 'r');
+	l_h = avl_linkNode(left, l, l_h, t->Lchild, avl_childHeight(t, t_h, 'l'));
+	*height = avl_linkNode(t, left, l_h, c, c_h);
+	return t;
+	
+}
+
+
+
+/* Same as avl_joinRight(), but right is the one more than 1 taller, and goes down its left side */
+static struct AVLtree_sub* avl_joinLeft(struct AVLtree_sub* left, int l_height, struct AVLtree_sub* node,
+										struct AVLtree_sub* right, int r_height, int* height){
 	
-	/* If node has no children */
-	if(!node->Lchild && !node->Rchild){
+	struct AVLtree_sub *r = right->Rchild, *c = right->Lchild, *t;
+	int r_h = avl_childHeight(right, r_height, 'r'), c_h = avl_childHeight(right, r_height, 'l'), t_h;
+	
+	
+	if(c_h <= l_height + 1){
 		
-		/* If it's the root, simply turns it into a leaf again and returns */
-		if(node->parent == node){
-			node->isLeaf = 1;
-			return;
+		if((c_h > l_height ? c_h : l_height) + 1 <= r_h + 1){
+			t_h = avl_linkNode(node, left, l_height, c, c_h);
+			*height = avl_linkNode(right, node, t_h, r, r_h);
+			return right;
 		}
 		
-		
-		/* Set its parent to point its child to NULL */
-		if(node->parent->Lchild == node) node->parent->Lchild = NULL;
-		else node->parent->Rchild = NULL;
-		
-		
-		/* Frees node and returns */
-		free(node);
-		node = NULL;
-		return;
+		{
+			struct AVLtree_sub *cl = c->Lchild, *cr = c->Rchild;
+			int cl_h = avl_childHeight(c, c_h, 'l'), cr_h = avl_childHeight(c, c_h, 'r');
+			
+			t_h = avl_linkNode(node, left, l_height, cl, cl_h);
+			r_h = avl_linkNode(right, cr, cr_h, r, r_h);
+			*height = avl_linkNode(c, node, t_h, right, r_h);
+			return c;
+		}
 		
 	}
 	
 	
+	t = avl_joinLeft(left, l_height, node, c, c_h, &t_h);
+	if(t_h <= r_h + 1){
+		*height = avl_linkNode(right, t, t_h, r, r_h);
+		return right;
+	}
 	
-	/* Then node has either left or right child */
-	if(node->Lchild){
-		
-		/* */
-		if(node->parent == node){
-			node->Lchild->parent = node->Lchild;
-			aux = node->Lchild;
-		} else node->Lchild->parent = node->parent;
+	c = t->Lchild;
+	c_h = avl_childHeight(t, t_h, 'l');
+	r_h = avl_linkNode(right, t->Rchild, avl_childHeight(t, t_h, 'r'), r, r_h);
+	*height = avl_linkNode(t, c, c_h, right, r_h);
+	return t;
 	
-		/* */
-		if(node->parent->Lchild == node)
-			node->parent->Lchild = node->Lchild;
-		else node->parent->Rchild = node->Lchild;
-		
-		
-	} else if(node->Rchild) {
+}
+
+
+
+/* 	Joins avl trees left and right, of heights l_height and r_height, with node
+	in between, every ID of left being lesser than or equal to node's, and node's
+	to every one of right. Returns the joined tree's root, and its height. Takes
+	O(|l_height - r_height|), for only the taller one's side is gone through */
+static struct AVLtree_sub* avl_joinNodes(struct AVLtree_sub* left, int l_height, struct AVLtree_sub* node,
+										 struct AVLtree_sub* right, int r_height, int* height){
+	
+	if(l_height > r_height + 1) return avl_joinRight(left, l_height, node, right, r_height, height);
+	if(r_height > l_height + 1) return avl_joinLeft(left, l_height, node, right, r_height, height);
+	
+	*height = avl_linkNode(node, left, l_height, right, r_height);
+	return node;
+	
+}
+
+
+
+/* 	Takes the node with the greatest ID out of an avl tree, of height 'height', into
+	last. Returns the root of what's left of the tree, and its height */
+static struct AVLtree_sub* avl_splitLast(struct AVLtree_sub* node, int height, struct AVLtree_sub** last, int* l_height){
+	
+	struct AVLtree_sub *r;
+	int r_h;
+	
+	
+	if(!node->Rchild){
+		*last = node;
+		*l_height = height - 1;
+		return avl_detach(node->Lchild);
+	}
+	
+	
+	r = avl_splitLast(node->Rchild, avl_childHeight(node, height, 'r'), last, &r_h);
+	return avl_joinNodes(node->Lchild, avl_childHeight(node, height, 'l'), node, r, r_h, l_height);
+	
+}
+
+
+
+/* Same as avl_joinNodes(), with no node in between: the greatest of left takes its place */
+static struct AVLtree_sub* avl_joinTrees(struct AVLtree_sub* left, int l_height, struct AVLtree_sub* right, int r_height, int* height){
+	
+	struct AVLtree_sub *node;
+	
+	
+	if(!left || !right){
+		*height = left ? l_height : r_height;
+		return avl_detach(left ? left : right);
+	}
+	
+	left = avl_splitLast(left, l_height, &node, &l_height);
+	return avl_joinNodes(left, l_height, node, right, r_height, height);
+	
+}
+
+
+
+/* Same as avl_joinNodes(), with an avl tree of IDs equal to each other, or none, in place of node */
+static struct AVLtree_sub* avl_concatNodes(struct AVLtree_sub* left, int l_height, struct AVLtree_sub* equal, int e_height,
+										   struct AVLtree_sub* right, int r_height, int* height){
+	
+	if(equal && equal->size == 1) return avl_joinNodes(left, l_height, equal, right, r_height, height);
+	
+	left = avl_joinTrees(left, l_height, equal, e_height, &l_height);
+	return avl_joinTrees(left, l_height, right, r_height, height);
+	
+}
+
+
+
+/* 	Splits an avl tree of 'type' IDs, of height 'height', into avl trees of IDs lesser than
+	key, left, and of IDs greater than key, right, along with their heights. Returns an avl
+	tree of the nodes whose IDs are equal to key, and its height, or NULL if there's none.
+	Takes O(log(n)), since every join on the way back up is as costly as the heights differ */
+static struct AVLtree_sub* avl_splitNodes(struct AVLtree_sub* node, int height, char type, union AVLkey key,
+										  struct AVLtree_sub** left, int* l_height, struct AVLtree_sub** right, int* r_height, int* e_height){
+	
+	struct AVLtree_sub *l, *r, *m, *equal, *equal_r;
+	int l_h, r_h, m_h, e_h, er_h, eval;
+	
+	
+	if(!node){
+		*left = *right = NULL;
+		*l_height = *r_height = *e_height = 0;
+		return NULL;
+	}
+	
+	l = node->Lchild;
+	r = node->Rchild;
+	l_h = avl_childHeight(node, height, 'l');
+	r_h = avl_childHeight(node, height, 'r');
+	eval = avl_keyCompare(type, &key, &node->ID);
+	
+	
+	/* 	Key goes on one side of node: that side is split, and its part
+		on node's other side is joined back to it, with node in between */
+	if(eval < 0){
+		equal = avl_splitNodes(l, l_h, type, key, left, l_height, &m, &m_h, e_height);
+		*right = avl_joinNodes(m, m_h, node, r, r_h, r_height);
+		return equal;
+	}
+	
+	if(eval > 0){
+		equal = avl_splitNodes(r, r_h, type, key, &m, &m_h, right, r_height, e_height);
+		*left = avl_joinNodes(l, l_h, node, m, m_h, l_height);
+		return equal;
+	}
+	
+	
+	/* 	Node is equal to key, but there may be more nodes equal to it on
+		both sides, which are split off and joined along with it */
+	equal = avl_splitNodes(l, l_h, type, key, left, l_height, &m, &m_h, &e_h);
+	equal_r = avl_splitNodes(r, r_h, type, key, &m, &m_h, right, r_height, &er_h);
+	return avl_joinNodes(equal, e_h, node, equal_r, er_h, e_height);
+	
+}
+
+
+
+/* Frees every node of an avl tree, as avl_freeNode() does */
+static void avl_freeNodes(struct AVLtree* tree, struct AVLtree_sub* node){
+	
+	struct AVLtree_sub *l, *r;
+	if(!node) return;
+	
+	
+	l = node->Lchild;
+	r = node->Rchild;
+	avl_freeNode(tree, node);
+	avl_freeNodes(tree, l);
+	avl_freeNodes(tree, r);
+	
+}
+
+
+
+/* 	Moves every data of a multimap's node 'other' after node's, whose ID is the same, so
+	other is freed with none of them. Both hold distinct IDs, so other has no equal child */
+static void avl_mergeValues(struct AVLtree_sub* node, struct AVLtree_sub* other){
+	
+	struct AVLvalues *values = other->data;
+	long i;
+	
+	
+	for(i = 0; i < values->count; i++) node->data = avl_addValue(node->data, values->data[i]);
+	values->count = 0;
+	
+}
+
+
+
+/* 	Joins avl trees a and b of 'type' IDs, of heights a_height and b_height, into one
+	holding every ID of both, and returns it, along with its height. An ID in both keeps
+	a's nodes, and b's are freed, a multimap's datas moved after a's first. The smaller
+	tree's root splits the other one, and each side is joined on its own, so it takes
+	O(m*log(n/m + 1)), m being the smaller size.
+	Both sides are independent from each other, so they may be joined at once */
+static struct AVLtree_sub* avl_unionNodes(struct AVLtree* tree, struct AVLtree_sub* a, int a_height,
+										  struct AVLtree_sub* b, int b_height, char type, int* height){
+	
+	struct AVLtree_sub *l, *r, *split_l, *split_r, *equal;
+	int l_h, r_h, split_lh, split_rh, e_h;
+	
+	
+	if(!a || !b){
+		*height = a ? a_height : b_height;
+		return avl_detach(a ? a : b);
+	}
+	
+	
+	/* 	b's root splits a, keeping a's nodes equal to it, if there's any.
+		Otherwise, it's a's root that splits b, freeing b's equal nodes */
+	if(a->size >= b->size){
+		l = b->Lchild;
+		r = b->Rchild;
+		equal = avl_splitNodes(a, a_height, type, b->ID, &split_l, &split_lh, &split_r, &split_rh, &e_h);
 		
-		/* */
-		if(node->parent == node){
-			node->Rchild->parent = node->Rchild;
-			aux = node->Rchild;
-		} else node->Rchild->parent = node->parent;
+		l = avl_unionNodes(tree, split_l, split_lh, l, avl_childHeight(b, b_height, 'l'), type, &l_h);
+		r = avl_unionNodes(tree, split_r, split_rh, r, avl_childHeight(b, b_height, 'r'), type, &r_h);
+		if(!equal) return avl_joinNodes(l, l_h, b, r, r_h, height);
 		
-		/* */
-		if(node->parent->Lchild == node)
-			node->parent->Lchild = node->Rchild;
-		else node->parent->Rchild = node->Rchild;
+		if(tree->options & AVL_MULTIMAP) avl_mergeValues(equal, b);
+		avl_freeNode(tree, b);
+		return avl_concatNodes(l, l_h, equal, e_h, r, r_h, height);
+	}
+	
+	l = a->Lchild;
+	r = a->Rchild;
+	equal = avl_splitNodes(b, b_height, type, a->ID, &split_l, &split_lh, &split_r, &split_rh, &e_h);
+	
+	l = avl_unionNodes(tree, l, avl_childHeight(a, a_height, 'l'), split_l, split_lh, type, &l_h);
+	r = avl_unionNodes(tree, r, avl_childHeight(a, a_height, 'r'), split_r, split_rh, type, &r_h);
+	if(equal && (tree->options & AVL_MULTIMAP)) avl_mergeValues(a, equal);
+	avl_freeNodes(tree, equal);
+	return avl_joinNodes(l, l_h, a, r, r_h, height);
+	
+}
+
+
 
+/* 	Takes out of avl tree a every node whose ID isn't in avl tree b, if 'keep' is 1,
+	or is in b, if it's 0, freeing them, and returns what's left of a, along with its
+	height. b isn't changed at all. Each of b's nodes splits what's under it of a, so
+	it takes O(m*log(n/m + 1)), m being b's size */
+static struct AVLtree_sub* avl_filterNodes(struct AVLtree* tree, struct AVLtree_sub* a, int a_height,
+										   struct AVLtree_sub* b, int b_height, char type, int keep, int* height){
+	
+	struct AVLtree_sub *l, *r, *equal;
+	int l_h, r_h, e_h;
+	
+	
+	if(!a || !b){
+		*height = (a && !keep) ? a_height : 0;
+		if(a && keep) avl_freeNodes(tree, a);
+		return (a && !keep) ? avl_detach(a) : NULL;
 	}
 	
 	
-	/* If it was the root, points now to its left or right child */
-	if(tree->int_root == node) tree->int_root = aux;
-	else if(tree->uint_root == node) tree->uint_root = aux;
-	else if(tree->double_root == node) tree->double_root = aux;
-	else if(tree->string_root == node) tree->string_root = aux;
+	equal = avl_splitNodes(a, a_height, type, b->ID, &l, &l_h, &r, &r_h, &e_h);
+	l = avl_filterNodes(tree, l, l_h, b->Lchild, avl_childHeight(b, b_height, 'l'), type, keep, &l_h);
+	r = avl_filterNodes(tree, r, r_h, b->Rchild, avl_childHeight(b, b_height, 'r'), type, keep, &r_h);
+	
 	
+	/* a's nodes equal to b's root are in b, so they're kept only for an intersection */
+	if(keep) return avl_concatNodes(l, l_h, equal, e_h, r, r_h, height);
 	
-	/* Frees node */
-	free(node);
-	node = NULL;
+	avl_freeNodes(tree, equal);
+	return avl_joinTrees(l, l_h, r, r_h, height);
 	
 }
 
 
 
-void avl_free(struct AVLtree* tree){
+/* Locks every avl root of tree in 'mode', in order of types, or unlocks them, in reverse order, if mode is 0 */
+static void avl_lockRoots(struct AVLtree* tree, char mode){
 	
-	/* Calls helper function to free each root */
-	avl_freeNode(tree->int_root);
-	avl_freeNode(tree->uint_root);
-	avl_freeNode(tree->double_root);
-	avl_freeNode(tree->string_root);
+	const char *types = "iudc";
+	int i;
 	
 	
-	/* Frees the super tree iteslf */
-	free(tree);
-	tree = NULL;
+	if(mode) for(i = 0; i < 4; i++) avl_takeRoot(tree, types[i], mode);
+	else for(i = 3; i >= 0; i--) avl_releaseRoot(tree, types[i]);
+	
+}
+
+
+
+/* 	Locks every avl root of two distinct trees, tree's in t_mode and other's in o_mode,
+	or unlocks them, if both modes are 0. The tree at the lower address always goes first,
+	and is unlocked last, so two threads working on the same pair, whichever way round,
+	never hold one tree each while waiting for the other */
+static void avl_lockPair(struct AVLtree* tree, char t_mode, struct AVLtree* other, char o_mode){
+	
+	struct AVLtree *first = tree, *second = other;
+	char f_mode = t_mode, s_mode = o_mode;
+	
+	
+	if((uintptr_t)other < (uintptr_t)tree){
+		first = other;
+		second = tree;
+		f_mode = o_mode;
+		s_mode = t_mode;
+	}
+	
+	if(f_mode){
+		avl_lockRoots(first, f_mode);
+		avl_lockRoots(second, s_mode);
+	} else {
+		avl_lockRoots(second, 0);
+		avl_lockRoots(first, 0);
+	}
+	
+}
+
+
+
+struct AVLtree_sub* avl_splitRoot(struct AVLtree* tree, char type, union AVLkey key, struct AVLtree_sub** left, struct AVLtree_sub** right){
 	
+	struct AVLtree_sub **root, *equal = NULL;
+	int l_h, r_h, e_h;
+	*left = *right = NULL;
+	if(!(root = avl_getRoot(tree, type)) || tree->btree || tree->persist) return NULL;
+	
+	
+	/* 	The root becomes empty, while its nodes are split into the two sides.
+		A durable tree keeps every other change out, and saves a checkpoint
+		right after, since a split isn't logged */
+	if(tree->wal) avl_walExclude(tree->wal);
+	avl_takeRoot(tree, type, 'w');
+	if(*root){
+		equal = avl_splitNodes(*root, avl_getHeight(*root), type, key, left, &l_h, right, &r_h, &e_h);
+		avl_publish(root, NULL);
+		*avl_getSize(tree, type) = 0;
+		if(tree->hash) avl_hashRebuild(avl_hashRoot(tree->hash, type), NULL);
+	}
+	avl_releaseRoot(tree, type);
+	if(tree->wal) avl_walResume(tree);
+	
+	
+	return equal;
+	
+}
+
+
+
+int avl_joinRoot(struct AVLtree* tree, char type, struct AVLtree_sub* left, struct AVLtree_sub* node, struct AVLtree_sub* right){
+	
+	struct AVLtree_sub **root;
+	int height;
+	if(!(root = avl_getRoot(tree, type)) || tree->btree || tree->persist) return 0;
+	
+	
+	/* Only an empty root takes them, and a durable tree saves a checkpoint once they're in */
+	if(tree->wal) avl_walExclude(tree->wal);
+	avl_takeRoot(tree, type, 'w');
+	if(*root){
+		avl_releaseRoot(tree, type);
+		if(tree->wal) avl_walExit(tree->wal);
+		return 0;
+	}
+	
+	node = avl_concatNodes(left, avl_getHeight(left), node, avl_getHeight(node), right, avl_getHeight(right), &height);
+	avl_publish(root, node);
+	*avl_getSize(tree, type) = avl_getSubSize(node);
+	if(tree->hash) avl_hashRebuild(avl_hashRoot(tree->hash, type), node);
+	avl_releaseRoot(tree, type);
+	if(tree->wal) avl_walResume(tree);
+	
+	
+	return 1;
+	
+}
+
+
+
+int avl_union(struct AVLtree* tree, struct AVLtree* other){
+	
+	const char *types = "iudc";
+	struct AVLtree_sub **root, **o_root, *node;
+	struct AVLslab **slab;
+	struct AVLarena **arena;
+	int i, height;
+	if(tree->btree || other->btree || tree->persist || other->persist || tree == other) return 0;
+	if((tree->options ^ other->options) & AVL_MULTIMAP) return 0;
+	
+	
+	/* 	Joins each of other's roots into tree's. A durable tree keeps every
+		other change out until it's saved a checkpoint, since it isn't logged */
+	if(tree->wal) avl_walExclude(tree->wal);
+	avl_lockPair(tree, 'w', other, 'w');
+	for(i = 0; i < 4; i++){
+		root = avl_getRoot(tree, types[i]);
+		o_root = avl_getRoot(other, types[i]);
+		
+		node = avl_unionNodes(tree, *root, avl_getHeight(*root), *o_root, avl_getHeight(*o_root), types[i], &height);
+		avl_publish(root, node);
+		*avl_getSize(tree, types[i]) = avl_getSubSize(node);
+		if(tree->hash) avl_hashRebuild(avl_hashRoot(tree->hash, types[i]), node);
+		*o_root = NULL;
+	}
+	
+	
+	/* 	Tree now holds nodes of other's slabs, so it takes them all, along with
+		other's free nodes. Nodes other retired are freed right away, since no
+		one may be reading other anymore */
+	avl_lockNodes(tree);
+	for(slab = &tree->slabs; *slab; slab = &(*slab)->next);
+	*slab = other->slabs;
+	
+	for(i = 0; other->locks && i < 3; i++){
+		for(; other->locks->retiredCount[i]; other->locks->retiredCount[i]--){
+			node = other->locks->retired[i][other->locks->retiredCount[i] - 1];
+			if(node->type == 'c' && !node->interned)
+				free(node->ID.string);
+			free(node->data);
+			
+			node->ID.string = node->data = NULL;
+			node->parent = NULL;
+			node->Lchild = other->freeNodes;
+			other->freeNodes = node;
+		}
+	}
+	
+	while((node = other->freeNodes)){
+		other->freeNodes = node->Lchild;
+		node->Lchild = tree->freeNodes;
+		tree->freeNodes = node;
+	}
+	avl_unlockNodes(tree);
+	
+	
+	/* 	Strings other interned stay where they are, so tree takes other's arena as
+		well, chained after its own blocks, so its newest one is still used */
+	for(arena = &tree->arena; *arena; arena = &(*arena)->next);
+	*arena = other->arena;
+	other->arena = NULL;
+	
+	
+	avl_lockPair(tree, 0, other, 0);
+	if(tree->wal) avl_walResume(tree);
+	avl_freeTree(other);
+	
+	
+	return 1;
+	
+}
+
+
+
+/* Does avl_intersect(), if keep is 1, or avl_difference(), if it's 0 */
+static int avl_filter(struct AVLtree* tree, struct AVLtree* other, int keep){
+	
+	const char *types = "iudc";
+	struct AVLtree_sub **root, **o_root, *node;
+	int i, height;
+	if(tree->btree || other->btree || tree->persist || other->persist || tree == other) return 0;
+	
+	
+	/* 	Other's roots are only read, so they're only kept from changing. A durable
+		tree keeps every other change out until it's saved a checkpoint, as a union */
+	if(tree->wal) avl_walExclude(tree->wal);
+	avl_lockPair(tree, 'w', other, 'x');
+	for(i = 0; i < 4; i++){
+		root = avl_getRoot(tree, types[i]);
+		o_root = avl_getRoot(other, types[i]);
+		
+		node = avl_filterNodes(tree, *root, avl_getHeight(*root), *o_root, avl_getHeight(*o_root), types[i], keep, &height);
+		avl_publish(root, node);
+		*avl_getSize(tree, types[i]) = avl_getSubSize(node);
+		if(tree->hash) avl_hashRebuild(avl_hashRoot(tree->hash, types[i]), node);
+	}
+	avl_lockPair(tree, 0, other, 0);
+	if(tree->wal) avl_walResume(tree);
+	
+	
+	return 1;
+	
+}
+
+
+
+int avl_intersect(struct AVLtree* tree, struct AVLtree* other){
+	return avl_filter(tree, other, 1);
+}
+
+
+
+int avl_difference(struct AVLtree* tree, struct AVLtree* other){
+	return avl_filter(tree, other, 0);
 }
 
 
 
-void avl_freeNode(struct AVLtree_sub* node){
+void avl_freeNode(struct AVLtree* tree, struct AVLtree_sub* node){
 	
-	/* Recursively calls itself to free its children */
-	if(node->Rchild) avl_freeNode(node->Rchild);
-	if(node->Lchild) avl_freeNode(node->Lchild);
+	/* An RCU tree's readers may still be going through node, so it's only retired */
+	if(avl_isRCU(tree)){
+		avl_rcuRetire(tree, node);
+		return;
+	}
 	
 	
-	/* Frees data and ID, if it's not equal to data */
-	if(node->ID != node->data)
-		free(node->ID);
-	free(node->data);
-	node->data = NULL;
-	node->ID = NULL;
+	/* Frees data, or datas, and ID, if it's a string */
+	if(node->type == 'c' && !node->interned)
+		free(node->ID.string);
+	avl_freeData(tree, node->data);
 	
 	
-	/* Frees the node itself */
-	free(node);
-	node = NULL;
+	/* 	Gives the node back to the tree's free nodes. Having
+		no parent marks it as not in use for avl_free() */
+	node->ID.string = node->data = NULL;
+	node->parent = NULL;
+	avl_lockNodes(tree);
+	node->Lchild = tree->freeNodes;
+	tree->freeNodes = node;
+	avl_unlockNodes(tree);
 	
 }
\ No newline at end of file
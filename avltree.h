@@ -1,5 +1,5 @@
 #ifndef __GNUC__
-	#error This library requires GCC compiler for it uses typeof() function
+	#error This library requires GCC compiler for it uses __builtin_prefetch() function
 #endif
 #if __STDC_VERSION__ < 201112L
 	#error This library requires C11 or newer for it uses _Generic() function
@@ -17,11 +17,125 @@
 
 
 
+/* Number of nodes of the first and of the biggest slabs of a super avl tree */
+#define AVL_SLAB_MIN	64
+#define AVL_SLAB_MAX	65536
+
+/* Greatest height an avl tree may reach, 1.44*log2(n) for any n a long can count */
+#define AVL_MAX_HEIGHT	96
+
+/* Number of searches avl_searchBatch() walks interleaved, each one hiding the others' cache misses */
+#define AVL_BATCH_LANES	16
+
+/* Greatest root size avl_searchBatch() searches key by key, for its nodes likely stay in cache */
+#define AVL_BATCH_CACHED	4096
+
+/* Engines a super avl tree may hold its roots in, chosen by avl_createTreeEx(): avl trees or B+ trees */
+#define AVL_ENGINE_AVL		0
+#define AVL_ENGINE_BTREE	1
+
+/* Option of avl_createTreeEx() for a tree shared between threads, with a reader-writer lock per root */
+#define AVL_CONCURRENT		2
+
+/* Option of avl_createTreeEx() for a concurrent tree whose avl roots are read with no lock at all */
+#define AVL_RCU				4
+
+/* Option of avl_createTreeEx() for a tree whose avl roots keep past versions readable, by avl_snapshot() */
+#define AVL_PERSISTENT		8
+
+/* Option of avl_createTreeEx() for a tree whose string IDs are interned into an arena of its own */
+#define AVL_STRING_ARENA	16
+
+/* Option of avl_createTreeEx() for a tree whose avl roots are indexed by hash tables as well, for exact searches */
+#define AVL_HASH_INDEX		32
+
+/* Option of avl_createTreeEx() for a tree whose avl roots hold each ID once, along with all of its datas */
+#define AVL_MULTIMAP		64
+
+/* Bytes of each block of a super avl tree's string arena. Longer strings get a block of their own */
+#define AVL_ARENA_BLOCK	65536
+
+/* Reader slots of an RCU tree, each one in its own cache line. Threads beyond them share slots */
+#define AVL_RCU_SLOTS	64
+
+/* Nodes an RCU tree's writers retire before trying to move its epoch on and reuse them */
+#define AVL_RCU_BATCH	64
+
+/* Lockless reads of an RCU tree's root that may fail, on writers changing it, before one keeps them out */
+#define AVL_RCU_TRIES	4
+
+/* Deepest a thread may nest locks and read sections of RCU trees */
+#define AVL_RCU_NEST	64
+
+/* Fewest nodes a parallel traversal or bulk load splits among a thread pool's workers. Less go to a single one */
+#define AVL_PARALLEL_GRAIN	16384
+
+
+
+/* B+ tree engine's structures, from avlbtree.h */
+struct AVLbtree;
+struct AVLbnode;
+
+/* Persistent engine's structures, from avlpersist.h */
+struct AVLpersist;
+
+/* Locks of a concurrent super avl tree, private to avltree.c */
+struct AVLlocks;
+
+/* Work stealing thread pool, from avlpool.h */
+struct AVLpool;
+
+/* Write-ahead log of a durable tree, from avlwal.h */
+struct AVLwal;
+
+/* Hash indexes of a tree's roots, from avlhash.h */
+struct AVLhash;
+
+
+
+
+
+/**	@Description
+ *		This union is the identifier of an avl tree node,
+ *		stored inline in the node itself, so comparing it
+ *		takes no pointer dereference besides the node's.
+ *
+ *		Each root uses only the member of its own type: every
+ *		int & variations is widened to a long long, every unsigned
+ *		int & variations to an unsigned long long, and every
+ *		float & variations to a long double.
+ *
+ *	@Members
+ *		long long integer:				identifier of an int_root node;
+ *
+ *		unsigned long long uinteger:	identifier of an uint_root node;
+ *
+ *		long double real:				identifier of a double_root node;
+ *
+ *		char* string:					identifier of a string_root node, a heap
+ *										allocated copy of the inserted string;
+ *
+ *		unsigned long long prefix:		string's first 8 bytes, big endian and zero
+ *										padded, so comparing two prefixes as numbers
+ *										orders them just like strcmp() would.
+ *
+ */
+union AVLkey{
+	
+	long long integer;
+	unsigned long long uinteger;
+	long double real;
+	struct {
+		char *string;
+		unsigned long long prefix;
+	};
+	
+};
 
 
 /**	@Description
  *		This structure is a node of a generic avl tree,
- *		so ID and data shall be heap allocated.
+ *		so data shall be heap allocated.
  *
  *		It may store data from stack as long as all tree
  *		operations are contained inside the same function scope,
@@ -29,9 +143,9 @@
  *		data from functions is discarted after its completion.
  *
  *	@Members
- *		void* ID:						a pointer to any kind of primitive variable,
- *										i.e. int & variations, unsigned int & variations,
- *										float & variations, or string (char*).
+ *		union AVLkey ID:				the identifier of the node, any kind of primitive
+ *										variable, i.e. int & variations, unsigned int &
+ *										variations, float & variations, or string (char*).
  *										It's used as a comparator within this library's
  *										functions, to search for and retrieve the data;
  *					
@@ -40,10 +154,23 @@
  *										the node so it's possible to search for it, data
  *										refers to the data itself;
  *					
- *		char isLeaf:					0 if node is not a leaf, 1 otherwise;
- *				
- *		charbalance:					current balance of the node. Used to reorganize the tree
- *										and maintain O(log(n)) operation cost;
+ *		char balance:					current balance of the node, i.e. the height of its
+ *										right subtree minus the height of its left one. It's
+ *										kept between -1 and 1 by rotations on insertion and
+ *										removal, so the tree height stays within 1.44*log2(n)
+ *										and all operations keep O(log(n)) cost;
+ *
+ *		char type:						which member of ID the node uses, the same as
+ *										avl_getKeyType() for the inserted identifier;
+ *
+ *		char interned:					whether ID's string is in its super avl tree's
+ *										arena, which frees it, rather than on heap on
+ *										its own;
+ *
+ *		unsigned int size:				how many nodes there are in the subtree rooted at
+ *										this node, itself included. Kept up to date by
+ *										insertions, removals and rotations, so nodes can
+ *										be found by their rank in O(log(n));
  *
  *		struct AVLtree_sub* Lchild:		pointer to node's left child. NULL if it hasn't one;
  *
@@ -54,10 +181,12 @@
  */
 struct AVLtree_sub{
 	
-	void *ID;
+	union AVLkey ID;
 	void *data;
-	char isLeaf;
 	char balance;
+	char type;
+	char interned;
+	unsigned int size;
 	struct AVLtree_sub *Lchild;
 	struct AVLtree_sub *Rchild;
 	struct AVLtree_sub *parent;
@@ -65,6 +194,101 @@ struct AVLtree_sub{
 };
 
 
+/**	@Description
+ *		This structure is a slab: a single heap block holding
+ *		many avl tree nodes, from which a super avl tree takes
+ *		its nodes instead of allocating each one on its own.
+ *
+ *		Slabs of a super avl tree are chained, newest first,
+ *		and each one is twice as big as the previous one, up
+ *		to AVL_SLAB_MAX nodes, so bulk insertions make few
+ *		allocations and keep nodes close together in memory.
+ *
+ *	@Members
+ *		struct AVLslab* next:			pointer to the previously allocated slab.
+ *										NULL if it's the first one;
+ *
+ *		long size:						how many nodes this slab holds;
+ *
+ *		long used:						how many nodes, from the beginning of the
+ *										slab, have ever been handed out;
+ *
+ *		struct AVLtree_sub nodes[]:		the nodes themselves, aligned to a cache line,
+ *										so each node takes a single one.
+ *
+ */
+struct AVLslab{
+	
+	struct AVLslab *next;
+	long size;
+	long used;
+	_Alignas(64) struct AVLtree_sub nodes[];
+	
+};
+
+
+/**	@Description
+ *		This structure is a block of a super avl tree's string
+ *		arena, into which string IDs are copied one after another,
+ *		if the tree was created with AVL_STRING_ARENA, instead of
+ *		each one being allocated on its own.
+ *
+ *		Strings are never freed one by one: a removed one keeps
+ *		its bytes until the whole tree is freed, while inserting
+ *		a string the root already holds shares its bytes.
+ *
+ *	@Members
+ *		struct AVLarena* next:	pointer to the previously allocated block.
+ *								NULL if it's the first one;
+ *
+ *		size_t size:			how many bytes this block holds;
+ *
+ *		size_t used:			how many bytes, from the beginning of the
+ *								block, strings take;
+ *
+ *		char bytes[]:			the strings themselves, each one starting at a
+ *								multiple of 8 bytes.
+ *
+ */
+struct AVLarena{
+	
+	struct AVLarena *next;
+	size_t size;
+	size_t used;
+	_Alignas(8) char bytes[];
+	
+};
+
+
+/**	@Description
+ *		This structure holds every data of an ID of a super
+ *		avl tree created with AVL_MULTIMAP, contiguous, in
+ *		the order they were inserted, so a node's data member
+ *		points to it instead of a data of its own, and the
+ *		root holds a single node for each distinct ID, however
+ *		many datas it's inserted along with.
+ *
+ *		It's what traversals, ranges, iterators and selections
+ *		of such a tree hand out as each ID's data.
+ *
+ *	@Members
+ *		long count:		how many datas there are, never 0, since the
+ *						ID's node is removed along with its last one;
+ *
+ *		long size:		how many datas there's room for;
+ *
+ *		void* data[]:	the datas themselves.
+ *
+ */
+struct AVLvalues{
+	
+	long count;
+	long size;
+	void *data[];
+	
+};
+
+
 /**	@Description
  *		This structure is the super avl tree that has
  *		a pointer to a root of each main primitive type.
@@ -76,7 +300,8 @@ struct AVLtree_sub{
  *	@Members
  *		struct AVLtree_sub* int_root:		a pointer to an avl tree that holds only
  *											int & variations (char, short, long, long long)
- *											primitives for ID;
+ *											primitives for ID. NULL while it's empty, as
+ *											all other roots;
  *	
  *		struct AVLtree_sub* uint_root:		a pointer to an avl tree that holds only
  *											unsigned int & variations (char, short, long, long long)
@@ -87,7 +312,52 @@ struct AVLtree_sub{
  *											primitives for ID;
  *
  *		struct AVLtree_sub* string_root:	a pointer to an avl tree that holds only
- *											strings (char*) for ID.
+ *											strings (char*) for ID;
+ *
+ *		long int_size:						how many nodes int_root holds, as well as
+ *											uint_size, double_size and string_size do
+ *											for their roots. Kept up to date by every
+ *											insertion and removal;
+ *
+ *		struct AVLslab* slabs:				a pointer to the newest slab from which
+ *											all nodes of all roots are taken;
+ *
+ *		struct AVLtree_sub* freeNodes:		a pointer to the first node given back
+ *											by a removal, which will be reused before
+ *											taking a new one from the slabs. Free nodes
+ *											are chained through their Lchild member;
+ *
+ *		int options:						the options the tree was created with, by
+ *											avl_createTreeEx(), but AVL_MULTIMAP where it
+ *											has no effect;
+ *
+ *		struct AVLbtree* btree:				the B+ trees that hold all IDs in place of
+ *											the avl roots, which stay empty, if the tree
+ *											was created with AVL_ENGINE_BTREE. NULL otherwise;
+ *
+ *		struct AVLpersist* persist:			the persistent avl trees that hold all IDs in
+ *											place of the avl roots, which stay empty, along
+ *											with the live snapshots, if the tree was created
+ *											with AVL_PERSISTENT. NULL otherwise;
+ *
+ *		struct AVLlocks* locks:				a reader-writer lock for each root, and a
+ *											mutex for slabs and free nodes, if the tree
+ *											was created with AVL_CONCURRENT, along with
+ *											the epochs and nodes retired by removals, if
+ *											with AVL_RCU. NULL otherwise;
+ *
+ *		struct AVLwal* wal:					the log every insertion and removal is appended
+ *											to, if the tree was opened by avl_openDurable().
+ *											NULL otherwise;
+ *
+ *		struct AVLarena* arena:				the newest block of the arena string IDs are
+ *											interned into, if the tree was created with
+ *											AVL_STRING_ARENA, or took nodes from one that
+ *											was, by avl_union(). NULL otherwise;
+ *
+ *		struct AVLhash* hash:				the hash indexes of the avl roots, each one
+ *											holding all of its root's nodes, if the tree
+ *											was created with AVL_HASH_INDEX. NULL otherwise.
  *
  */
 struct AVLtree{
@@ -96,6 +366,95 @@ struct AVLtree{
 	struct AVLtree_sub *uint_root;
 	struct AVLtree_sub *double_root;
 	struct AVLtree_sub *string_root;
+	long int_size;
+	long uint_size;
+	long double_size;
+	long string_size;
+	struct AVLslab *slabs;
+	struct AVLtree_sub *freeNodes;
+	int options;
+	struct AVLbtree *btree;
+	struct AVLpersist *persist;
+	struct AVLlocks *locks;
+	struct AVLwal *wal;
+	struct AVLarena *arena;
+	struct AVLhash *hash;
+	
+};
+
+
+
+
+
+/**	@Description
+ *		This structure is a range of IDs being pulled, in
+ *		ascending order, out of one of a super avl tree's
+ *		roots, one node at a time.
+ *
+ *		It's set up by avl_rangeBegin() and advanced by
+ *		avl_rangeNext(). It holds no heap memory, so it may
+ *		be simply discarded at any time. It must not be used
+ *		after the node it points to is removed.
+ *
+ *	@Members
+ *		struct AVLtree_sub* node:	pointer to the next node to be pulled.
+ *									NULL once the range is over;
+ *
+ *		struct AVLbnode* leaf:		pointer to the leaf holding the next ID to be
+ *									pulled, instead of node, for a B+ tree engine;
+ *
+ *		int index:					index of the next ID to be pulled into leaf;
+ *
+ *		union AVLkey hi:			the range's greatest ID;
+ *
+ *		char type:					root type of the range, as given by avl_getKeyType().
+ *
+ */
+struct AVLrange{
+	
+	struct AVLtree_sub *node;
+	struct AVLbnode *leaf;
+	int index;
+	union AVLkey hi;
+	char type;
+	
+};
+
+
+
+
+
+/**	@Description
+ *		This structure is an iterator over one of a super
+ *		avl tree's roots, which goes both ways, in order of
+ *		IDs, from node to node through their parents.
+ *
+ *		It holds no heap memory, so it may be simply discarded
+ *		at any time. Since a node is only ever freed when its
+ *		own ID is removed, never moved around nor reused for
+ *		another ID, an iterator stays valid across searches,
+ *		insertions and removals of other IDs, and goes on from
+ *		its node to whichever nodes are its neighbours by then.
+ *		It must not be used after its own node's ID is removed.
+ *
+ *		None of this holds for a tree changed by another
+ *		thread meanwhile. On a tree created with AVL_CONCURRENT,
+ *		the root's avl_readLock() must be held for as long as
+ *		the iterator is used, as for avl_rangeBegin() with
+ *		avl_rangeNext(), avl_select() and avl_percentile().
+ *		On one created with AVL_RCU, avl_readLock() only keeps
+ *		nodes from being reused, and an iterator may skip or
+ *		repeat nodes moved around by writers meanwhile, unless
+ *		avl_stableLock() is held instead.
+ *
+ *	@Member
+ *		struct AVLtree_sub* node:	pointer to the current node. NULL once
+ *									the iterator has gone past either end.
+ *
+ */
+struct AVLiter{
+	
+	struct AVLtree_sub *node;
 	
 };
 
@@ -105,9 +464,8 @@ struct AVLtree{
 
 /**	@Functionality
  *		Creates a super avl tree allocated on heap, a
- *		pointer to a struct AVLtree, and prepares its
- *		roots: allocates them into heap, sets them to
- *		leaves and sets their parents to themselves.
+ *		pointer to a struct AVLtree, with all of its
+ *		roots empty.
  *
  *		The tree must be freed afterwards using
  *		avl_free() function.
@@ -126,495 +484,2077 @@ struct AVLtree* avl_createTree(void);
 
 
 /**	@Functionality
- *		Removes a node from a super avl tree,
- *		freeing its ID and data members, as well as itself.
- *
- *		This is a helper function of avl_remove() macro function.
+ *		Creates a super avl tree allocated on heap, just
+ *		as avl_createTree() does, with the given options.
+ *
+ *		With AVL_ENGINE_BTREE, every root is held by a B+
+ *		tree instead of an avl tree, whose nodes keep many
+ *		IDs contiguous and whose leaves are linked in order.
+ *		Insertions, searches, removals, traversals, counts
+ *		and ranges work the same on both engines, while
+ *		iterators, ranks and selections see empty roots.
+ *
+ *		With AVL_CONCURRENT, the tree may be shared between
+ *		threads: each root has a reader-writer lock, so any
+ *		number of searches, traversals, ranks and ranges run
+ *		at once on the same root, and on different roots
+ *		whatever they do, while insertions and removals get
+ *		their root for themselves. Writers go first, so they
+ *		aren't kept waiting by a stream of readers. Datas
+ *		handed out by a search are freed as soon as another
+ *		thread removes their IDs, though, so threads still
+ *		have to agree on when IDs may be removed.
+ *
+ *		With AVL_RCU, the tree is concurrent as well, but
+ *		searches, ranks and ranges of avl roots take no lock,
+ *		so they never wait for writers, nor slow each other
+ *		down. A search that finds its key is done right away,
+ *		while one that doesn't, like ranks and every step of
+ *		a range, is checked against the root's sequence, which
+ *		writers change, and tried again if the root changed
+ *		meanwhile. Nodes removed are only reused, and their ID
+ *		and data freed, once no reader may still be going
+ *		through them, so datas found while avl_readLock() is
+ *		held stay valid until it's unlocked. Traversals keep
+ *		writers out, for a consistent copy, and B+ tree roots
+ *		are read under their locks, as with AVL_CONCURRENT.
+ *
+ *		With AVL_PERSISTENT, avl roots are held by persistent
+ *		avl trees, so avl_snapshot() may take, in O(1), a copy
+ *		of every root that stays readable as it is, while the
+ *		tree changes. Insertions and removals copy the nodes
+ *		they change, along with their way from the root, if a
+ *		snapshot holds them. Insertions, searches, removals,
+ *		traversals and counts work the same, while iterators,
+ *		ranks, selections, ranges and set operations see empty
+ *		roots. With AVL_RCU, it's just concurrent. It has no
+ *		effect along with AVL_ENGINE_BTREE.
+ *
+ *		With AVL_STRING_ARENA, string IDs of avl roots are
+ *		copied into big blocks of the tree's own, rather
+ *		than each one into a heap allocation, and an ID the
+ *		root already holds shares the bytes of the equal one
+ *		met on the way down. Removed strings' bytes are only
+ *		given back by avl_free(). It has no effect along with
+ *		AVL_ENGINE_BTREE or AVL_PERSISTENT.
+ *
+ *		With AVL_HASH_INDEX, each avl root is indexed by a
+ *		hash table as well, holding all of its nodes, which
+ *		exact searches, avl_search(), avl_searchBatch() and
+ *		avl_remove(), go through instead of down the root,
+ *		in a probe or two. Insertions and removals keep it
+ *		up to date, while bulk loads, splits, joins and set
+ *		operations rebuild it as a whole, in O(n). Ordered
+ *		operations still go through the root. It takes some
+ *		18 to 36 more bytes per node. It has no effect along
+ *		with AVL_ENGINE_BTREE, AVL_PERSISTENT or AVL_RCU.
+ *
+ *		With AVL_MULTIMAP, an avl root holds a single node
+ *		for each distinct ID, along with an AVLvalues holding
+ *		every data it was inserted with, rather than a node
+ *		for each insertion. So roots and their counts grow
+ *		with distinct IDs only. avl_search() gets the first
+ *		data of an ID, avl_searchAll() all of them, in the
+ *		order they were inserted, avl_countKey() how many
+ *		there are, avl_removeOne() removes one of them, and
+ *		avl_remove() all of them. Bulk loads insert keys one
+ *		by one, and avl_union() only takes trees created
+ *		with it as well. It has no effect along with
+ *		AVL_ENGINE_BTREE, AVL_PERSISTENT or AVL_RCU.
  *
- *	@Arguments
- *		struct AVLtree* tree:		a pointer to an AVLtree structure, a super avl tree,
- *									properly created with avl_createTree() function;
+ *		The tree must be freed afterwards using
+ *		avl_free() function.
  *
- *		struct AVLtree_sub* node:	which node to remove from whichever root type
- *									of the super avl tree.
+ *	@Argument
+ *		int options:	the engine, AVL_ENGINE_AVL or AVL_ENGINE_BTREE,
+ *						or'ed with AVL_CONCURRENT or AVL_RCU, and with
+ *						AVL_PERSISTENT, AVL_STRING_ARENA, AVL_HASH_INDEX or
+ *						AVL_MULTIMAP, if wanted.
  *
  *	@Return
- *		None
+ *		Unconditionally:	a pointer to an AVLtree structure,
+ *							a super avl tree, allocated on heap,
+ *							ready to use
  *
  */
-void avl_removeNode(struct AVLtree* tree, struct AVLtree_sub* node);
+struct AVLtree* avl_createTreeEx(int options);
 
 
 
 /**	@Functionality
- *		Checks if node has left or right child and, if not,
- *		allocates one on heap and configures it to that node.
- *
- *		This is a helper function of avl_forward() macro function.
+ *		Locks one of a concurrent super avl tree's roots,
+ *		waiting until it's possible: shared with other
+ *		readers, or all for itself, if it's a writer. Does
+ *		nothing if the tree wasn't created with AVL_CONCURRENT
+ *		or AVL_RCU.
+ *
+ *		On an RCU tree, readers of avl roots only enter a
+ *		read section, which keeps nodes they may reach from
+ *		being reused, and may nest them up to AVL_RCU_NEST
+ *		deep. Writers, and those keeping writers out, take
+ *		the root's lock alone, though readers still go on.
+ *
+ *		A thread holding a root's lock must not call any
+ *		function that takes it again, i.e. any but the
+ *		iterators, avl_rangeNext(), avl_select(),
+ *		avl_percentile(), avl_count() and, for a writer,
+ *		avl_removeNode(), on that root. Readers of an RCU
+ *		tree's avl roots may call any but writers' ones.
+ *
+ *		A writer of a concurrent durable tree holds its log's
+ *		gate as well, so no checkpoint is saved until it
+ *		unlocks, and must hold no other root's lock meanwhile.
+ *
+ *		This is a helper function of avl_readLock(),
+ *		avl_stableLock() and avl_writeLock() macro functions.
  *
  *	@Arguments
- *		struct AVLtree_sub* parent:	a pointer to an avl tree node;
+ *		struct AVLtree* tree:	a pointer to an AVLtree structure, a super avl tree;
+ *
+ *		char type:				root type, as given by avl_getKeyType();
  *
- *		char c_type:				child type to check for node ('r' if right, 'l' if left).
+ *		char mode:				'r' to read the root, 'x' to keep writers out
+ *								of it while reading, 'w' to change it.
  *
  *	@Return
  *		None
  *
  */
-void avl_checkChild(struct AVLtree_sub* parent, char c_type);
+void avl_lockRoot(struct AVLtree* tree, char type, char mode);
 
 
 
 /**	@Functionality
- *		Recursively gets all IDs and datas from a
- *		starting node of an avl tree, normally a root,
- *		inside a heap allocated ID and data arrays.
+ *		Unlocks one of a concurrent super avl tree's roots,
+ *		locked by avl_lockRoot(), or leaves the innermost
+ *		read section or lock of an RCU tree. Does nothing
+ *		if the tree wasn't created with AVL_CONCURRENT
+ *		or AVL_RCU.
  *
- *		It first gets all left children, then all
- *		right children ID and data of a node,
- *		then the node's ID and data themselves.
- *
- *		ID and data must be freed by the caller, only
- *		the arrays, not their contents (free(ID) and
- *		free(data)), since their contents just point
- *		to those of the nodes, it's not a copy on heap.
- *
- *		This is a helper function of avl_traverse() macro function
+ *		This is a helper function of avl_unlock() macro function.
  *
  *	@Arguments
- *		void*** ID:					pointer to a matrix of void pointers, on heap,
- *									so it's possible to resize it internally. This
- *									will have all IDs pointers inside an avl tree;
- *
- *		void*** data:				pointer to a matrix of void pointers, on heap,
- *									so it's possible to resize it internally. This
- *									will have all datas pointers inside an avl tree;
- *
- *		int* c:						a pointer to an int, which will count how many
- *									nodes there are in an avl tree;
+ *		struct AVLtree* tree:	a pointer to an AVLtree structure, a super avl tree;
  *
- *		struct AVLtree_sub* node:	a pointer to an avl tree node, normally a root.
+ *		char type:				root type, as given by avl_getKeyType().
  *
  *	@Return
  *		None
  *
  */
-void avl_tTraverse(void*** ID, void*** data, long* c, struct AVLtree_sub* node);
+void avl_unlockRoot(struct AVLtree* tree, char type);
 
 
 
 /**	@Functionality
- *		Frees all data from an AVLtree structure,
- *		a super avl tree, namely: all nodes' ID
- *		and data. Also calls its helper function,
- *		avl_freeNode(), for each root, then frees
- *		the AVLtree structure itself.
- *
- *		If data is not a primitive type or string
- *		and it has some members on heap, one shall
- *		call avl_traverse function to get said members
- *		and free them manually.
+ *		Takes a node for a super avl tree, zeroed,
+ *		either from its free nodes or from its newest
+ *		slab. If there's none left, allocates a new
+ *		slab on heap, twice as big as the newest one.
  *
- *		For example: a structure with two string members,
- *		each heap allocated. In that case, there'll be
- *		three variables on heap: the two strings and
- *		the structure itself. If the avl_free function
- *		is called without the avl_traverse function
- *		and manual free of the two members beforehand,
- *		the two strings will be leaked.
+ *		This is a helper function of avl_insertKey() function.
  *
  *	@Argument
- *		struct AVLtree* tree:	a pointer to an AVLtree structure,
- *								the super avl tree to be freed.
+ *		struct AVLtree* tree:	a pointer to an AVLtree structure, a super avl tree,
+ *								properly created with avl_createTree() function.
  *
  *	@Return
- *		None
+ *		Unconditionally:	a pointer to a zeroed node, owned by
+ *							the super avl tree's slabs
  *
  */
-void avl_free(struct AVLtree* tree);
+struct AVLtree_sub* avl_allocNode(struct AVLtree* tree);
 
 
 
 /**	@Functionality
- *		Frees node's ID and data, calling this
- *		function recursively to its children,
- *		and then frees the node itself.
+ *		Inserts an identifier, already converted into
+ *		an AVLkey, and data into one of a super avl tree's
+ *		roots: finds where it belongs, takes a new node
+ *		and attaches it there, then rebalances the tree.
+ *		If it's a string, it's copied into the node,
+ *		heap allocated.
+ *
+ *		This is a helper function of avl_insert() macro function.
  *
- *		This is a helper function of avl_free() function.
+ *	@Arguments
+ *		struct AVLtree* tree:	a pointer to an AVLtree structure, a super avl tree,
+ *								properly created with avl_createTree() function;
  *
- *	@Argument
- *		struct AVLtree_sub* node:	a pointer to an avl tree node,
- *									to be freed, as well as all of
- *									its children.
+ *		char type:				which root to insert into, as given by avl_getKeyType();
+ *
+ *		union AVLkey key:		the identifier, as given by avl_toKey();
+ *
+ *		void* data:				pointer to the data to be stored into the avl tree.
  *
  *	@Return
  *		None
  *
  */
-void avl_freeNode(struct AVLtree_sub* node);
-
-
+void avl_insertKey(struct AVLtree* tree, char type, union AVLkey key, void* data);
 
 
 
 /**	@Functionality
- *		Returns respective super avl tree's
- *		root structure pointer, according
- *		to 'id' primitive type.
+ *		Loads n identifiers, from an array of any primitive
+ *		type or of strings, and their datas into one of a
+ *		super avl tree's roots, all at once.
  *
- *		It needs at least C11 to work, for it uses
- *		_Generic() function.
+ *		If the root is empty, takes all nodes from a single
+ *		slab, copies keys into them and links them directly
+ *		into a perfectly balanced tree, which costs O(n) if
+ *		keys are already sorted. Otherwise, they're sorted
+ *		first, which costs O(n*log(n)).
  *
- *		It is a macro function because otherwise,
- *		'id' would need to be a void* to support a
- *		generic type when calling the function,
- *		and so _Generic() would not work to
- *		distinguish which root it should return.
+ *		If the root already has nodes, it just inserts them
+ *		one by one, as avl_insertKey() does.
+ *
+ *		This is a helper function of avl_bulkLoad() macro function.
  *
  *	@Arguments
- *		struct AVLtree* sAVL:	a pointer to an AVLtree structure, a super avl tree,
+ *		struct AVLtree* tree:	a pointer to an AVLtree structure, a super avl tree,
  *								properly created with avl_createTree() function;
  *
- *		? id:					a variable which primitive type identifies
- *								to which root type it refers.
+ *		char type:				which root to load into, as given by avl_getKeyType();
  *
- *	@Returns
- *		On success:	a pointer to one of super avl tree's root,
- *					depending on 'id' primitive type:	int_root	-> 	int, short int,
- *																		char, signed char,
- *																		long, long long;
+ *		const void* keys:		array of n identifiers, all of the same primitive
+ *								type, or of n strings;
  *
- *														uint_root	->	unsigned int, unsigned short int,
- *																		unsigned char, unsigned long,
- *																		unsigned long long;
+ *		size_t width:			size of each identifier in keys, in bytes;
  *
- *														double_root	->	float, double, long double;
+ *		void** data:			array of n pointers to the datas to be stored, each
+ *								one along with the identifier at the same index.
+ *								May be NULL, if there's no data;
  *
- *														string_root ->	char*;
+ *		long n:					how many identifiers there are.
  *
- *		On failure:	NULL (if 'id' is not a primitive type)
+ *	@Return
+ *		Unconditionally:	how many identifiers were loaded
  *
  */
-#define avl_getRootType(sAVL, id) 																		\
-		_Generic((id),	int:			sAVL->int_root,		unsigned int:			sAVL->uint_root,	\
-						char:			sAVL->int_root,		unsigned char:			sAVL->uint_root,	\
-						long:			sAVL->int_root,		unsigned long:			sAVL->uint_root,	\
-						long long:		sAVL->int_root,		unsigned long long:		sAVL->uint_root,	\
-						short int:		sAVL->int_root,		unsigned short int:		sAVL->uint_root,	\
-						signed char: 	sAVL->int_root,		char*:					sAVL->string_root,	\
-						double: 		sAVL->double_root,	long double:			sAVL->double_root,	\
-						float:			sAVL->double_root,	default:				NULL				\
-				)
-
-
+long avl_bulkLoadKeys(struct AVLtree* tree, char type, const void* keys, size_t width, void** data, long n);
 
 
 
 /**	@Functionality
- *		Compares some identifier, 'id', with
- *		node's ID. If it's greater, auxiliary
- *		node points to current node's right child,
- *		otherwise points to current node's left child.
- *		If the root is a string root, uses strcmp() function
- *		for comparison.
+ *		Loads n identifiers into an empty root of a super
+ *		avl tree at once, as avl_bulkLoadKeys() does, with
+ *		the work split among a thread pool's workers: each
+ *		one fills and links the nodes of its own subtrees,
+ *		whose offsets into keys come from their sizes.
  *
- *		It is a macro function because otherwise,
- *		'id' would need to be a void* to support a
- *		generic type when calling the function,
- *		and so typeof() function would not work to
- *		dinamically cast node's ID to id's type.
+ *		Keys are expected sorted. If they turn out not to
+ *		be, the nodes are sorted and linked again by the
+ *		calling thread alone. A root with nodes already,
+ *		or a B+ tree or persistent engine's, is loaded as by
+ *		avl_bulkLoadKeys(), with no pool at all.
  *
- *		This is a helper function of avl_insert() macro function.
+ *		This is a helper function of avl_parallelBulkLoad() macro function.
  *
  *	@Arguments
- *		struct AVLtree_sub* node:	pointer to an AVLtree_sub structure, one
- *									of super avl tree's root's node, an avl tree;
+ *		struct AVLtree* tree:	a pointer to an AVLtree structure, a super avl tree,
+ *								properly created with avl_createTree() function;
+ *
+ *		char type:				which root to load into, as given by avl_getKeyType();
+ *
+ *		const void* keys:		array of n identifiers, all of the same primitive
+ *								type, or of n strings, in ascending order;
  *
- *		? id:						identifier to search for in the avl tree,
- *									such as 5, or "scarf";
+ *		size_t width:			size of each identifier in keys, in bytes;
  *
- *		char type:					to identify what root type it refers to.
- *									'c' to string root, 'a' otherwise.
+ *		void** data:			array of n pointers to the datas to be stored, each
+ *								one along with the identifier at the same index.
+ *								May be NULL, if there's no data;
+ *
+ *		long n:					how many identifiers there are;
+ *
+ *		struct AVLpool* pool:	a thread pool, as given by avl_createPool(), running
+ *								no other job.
  *
  *	@Return
- *		None, since it's a macro function, but alters what
- *		node argument points to, when called
- *
- */
-#define avl_forward(node, id, type)								\
-		do {													\
-																\
-			/* If id is a string, uses strcmp for comparison */	\
-			if(type == 'c'){									\
-				if(strcmp(id, (char*)node->ID) > 0){			\
-					avl_checkChild(node, 'r');					\
-					node = node->Rchild;						\
-				} else {										\
-					avl_checkChild(node, 'l');					\
-					node = node->Lchild;						\
-				}												\
-				break;											\
-			}                                               	\
-																\
-																\
-			/* 	If id is not a string, casts node ID to id's	\
-				type and compares it directly */				\
-			if(id > *(typeof(id)*)node->ID){               		\
-				avl_checkChild(node, 'r');                  	\
-				node = node->Rchild;                        	\
-			} else {                                        	\
-				avl_checkChild(node, 'l');                  	\
-				node = node->Lchild;                        	\
-			}                                               	\
-																\
-																\
-		} while(0)
-
-
+ *		Unconditionally:	how many identifiers were loaded
+ *
+ */
+long avl_parallelBulkLoadKeys(struct AVLtree* tree, char type, const void* keys, size_t width, void** data, long n, struct AVLpool* pool);
 
 
 
 /**	@Functionality
- *		Inserts identifier and data into an avl tree.
- *		The identifier is copied into avl tree, but
- *		data member just points to data passed as
- *		argument.
+ *		Searches an identifier, already converted into
+ *		an AVLkey, into one of a super avl tree's roots,
+ *		or into its hash index, if it has one.
  *
- *		Identifier may be stack allocated, but data must be
- *		heap allocated and shall not be freed anywhere else.
- *
- *		It is a macro function because otherwise,
- *		'id' would need to be a void* to support a
- *		generic type when calling the function,
- *		and so typeof() function would not work to
- *		dinamically cast node's ID to id's type.
+ *		This is a helper function of avl_search()
+ *		and avl_remove() macro functions.
  *
  *	@Arguments
- *		struct AVLtree_sub* root:	pointer to an AVLtree_sub structure, one
- *									of super avl tree's root, an avl tree;
+ *		struct AVLtree* tree:	a pointer to an AVLtree structure, a super avl tree,
+ *								properly created with avl_createTree() function;
  *
- *		? DATA:						pointer to the data to be stored into
- *									the avl tree. Must be heap allocated
- *									and shall not be freed anywhere else
- *									apart from avl_free() function;
+ *		char type:				which root to search into, as given by avl_getKeyType();
  *
- *		? id:						identifier used to search for this node's
- *									data inside the avl tree, such as 5, or
- *									"scarf". It may be stack allocated, since
- *									it's copied and heap allocated internally.
+ *		union AVLkey key:		the identifier, as given by avl_toKey().
  *
  *	@Return
- *		None
+ *		On success:	a pointer to the node that holds the identifier
+ *
+ *		On failure:	NULL (if there's no such identifier)
  *
  */
-#define avl_insert(root, DATA, id)										\
-		do {															\
-																		\
-			/* Gets super avl tree's root depending on id */			\
-			char type;													\
-			struct AVLtree_sub *node;									\
-			if(!(node = avl_getRootType(root, id))) break;				\
-																		\
-																		\
-			/* 	Runs through the root until								\
-				it finds a node thas is a leaf	*/						\
-			type = (root->string_root == node) ? 'c' : 'a';				\
-			while(!node->isLeaf) avl_forward(node, id, type);			\
-																		\
-																		\
-			/* Copies id content into node's ID, heap allocated */		\
-			if(type == 'c')												\
-				node->ID = strcpy(calloc(strlen(id)+1, 1), id);			\
-			else {														\
-				node->ID = calloc(1, sizeof(typeof(id)));				\
-				memcpy(node->ID, id, sizeof(typeof(id)));				\
-			}															\
-																		\
-																		\
-			/* 	Node's data now points to DATA, this 					\
-				function's argument, and it's not a leaf anymore */		\
-			node->data = DATA;                                    		\
-			node->isLeaf = 0;                                     		\
-																		\
-																		\
-		} while(0)
-
-
+struct AVLtree_sub* avl_searchKey(struct AVLtree* tree, char type, union AVLkey key);
 
 
 
 /**	@Functionality
- *		Compares 'id' to node's ID: if it's bigger,
- *		sets current node auxiliary pointer to point
- *		to its right child, if it's lesser, points to
- *		its left child, if it's equal, set DATA to point
- *		to node's data.
+ *		Searches an identifier, already converted into
+ *		an AVLkey, into one of a super avl tree's roots,
+ *		whatever its engine, and gets its data.
  *
- *		It is a macro function because otherwise,
+ *		This is a helper function of avl_search() macro function.
+ *
+ *	@Arguments
+ *		struct AVLtree* tree:	a pointer to an AVLtree structure, a super avl tree,
+ *								properly created with avl_createTree() function;
+ *
+ *		char type:				which root to search into, as given by avl_getKeyType();
+ *
+ *		union AVLkey key:		the identifier, as given by avl_toKey().
+ *
+ *	@Return
+ *		On success:	the data stored along with the identifier
+ *
+ *		On failure:	NULL (if key is not found)
+ *
+ */
+void* avl_searchData(struct AVLtree* tree, char type, union AVLkey key);
+
+
+
+/**	@Functionality
+ *		Removes a node from a super avl tree,
+ *		freeing its ID and data members, as well as itself,
+ *		then rebalances its ancestors, if needed. On an RCU
+ *		tree, they're only freed once no reader may still
+ *		be going through the node. It leaves the root's hash
+ *		index as well, if it has one, and a durable tree logs
+ *		its removal.
+ *
+ *		This is a helper function of avl_remove() macro function.
+ *
+ *	@Arguments
+ *		struct AVLtree* tree:		a pointer to an AVLtree structure, a super avl tree,
+ *									properly created with avl_createTree() function;
+ *
+ *		struct AVLtree_sub* node:	which node to remove from whichever root type
+ *									of the super avl tree.
+ *
+ *	@Return
+ *		None
+ *
+ */
+void avl_removeNode(struct AVLtree* tree, struct AVLtree_sub* node);
+
+
+
+/**	@Functionality
+ *		Searches an identifier, already converted into
+ *		an AVLkey, into one of a super avl tree's roots,
+ *		whatever its engine, and removes it, if found,
+ *		freeing its ID and data.
+ *
+ *		This is a helper function of avl_remove() macro function.
+ *
+ *	@Arguments
+ *		struct AVLtree* tree:	a pointer to an AVLtree structure, a super avl tree,
+ *								properly created with avl_createTree() function;
+ *
+ *		char type:				which root to remove from, as given by avl_getKeyType();
+ *
+ *		union AVLkey key:		the identifier, as given by avl_toKey().
+ *
+ *	@Return
+ *		On success:	1
+ *
+ *		On failure:	0 (if key is not found)
+ *
+ */
+int avl_removeKey(struct AVLtree* tree, char type, union AVLkey key);
+
+
+
+/**	@Functionality
+ *		Searches an identifier, already converted into
+ *		an AVLkey, into one of a super avl tree's roots,
+ *		created with AVL_MULTIMAP, and gets up to n of
+ *		its datas, in the order they were inserted.
+ *
+ *		This is a helper function of avl_searchAll() and
+ *		avl_countKey() macro functions.
+ *
+ *	@Arguments
+ *		struct AVLtree* tree:	a pointer to an AVLtree structure, a super avl tree,
+ *								properly created with avl_createTreeEx() function;
+ *
+ *		char type:				which root to search into, as given by avl_getKeyType();
+ *
+ *		union AVLkey key:		the identifier, as given by avl_toKey();
+ *
+ *		void** data:			an array of at least n void pointers, that will
+ *								store datas, or NULL;
+ *
+ *		long n:					how many datas, at most, to get.
+ *
+ *	@Return
+ *		On success:	how many datas the identifier has, which may be more than n
+ *
+ *		On failure:	0 (if key is not found, or the tree wasn't created with AVL_MULTIMAP)
+ *
+ */
+long avl_searchValues(struct AVLtree* tree, char type, union AVLkey key, void** data, long n);
+
+
+
+/**	@Functionality
+ *		Searches an identifier, already converted into
+ *		an AVLkey, into one of a super avl tree's roots,
+ *		created with AVL_MULTIMAP, and removes one of its
+ *		datas, the one data points to, freeing it. Its node
+ *		is removed along with its last data.
+ *
+ *		This is a helper function of avl_removeOne() macro function.
+ *
+ *	@Arguments
+ *		struct AVLtree* tree:	a pointer to an AVLtree structure, a super avl tree,
+ *								properly created with avl_createTreeEx() function;
+ *
+ *		char type:				which root to remove from, as given by avl_getKeyType();
+ *
+ *		union AVLkey key:		the identifier, as given by avl_toKey();
+ *
+ *		void* data:				the data to remove, as inserted along with the
+ *								identifier.
+ *
+ *	@Return
+ *		On success:	1
+ *
+ *		On failure:	0 (if key is not found, or doesn't have data, or the tree
+ *					wasn't created with AVL_MULTIMAP)
+ *
+ */
+int avl_removeValue(struct AVLtree* tree, char type, union AVLkey key, void* data);
+
+
+
+/**	@Functionality
+ *		Rotates node to the left ('l') or to the right ('r'),
+ *		so its right or left child, respectively, takes its
+ *		place. Updates both nodes' balances, their parents
+ *		and, if node was a root, the super avl tree's root.
+ *
+ *		This is a helper function of avl_rebalance() function.
+ *
+ *	@Arguments
+ *		struct AVLtree* tree:		a pointer to an AVLtree structure, a super avl tree,
+ *									properly created with avl_createTree() function;
+ *
+ *		struct AVLtree_sub* node:	a pointer to an avl tree node, which must have
+ *									a right child if rotating left, or a left child
+ *									if rotating right;
+ *
+ *		char direction:				rotation direction ('l' if left, 'r' if right).
+ *
+ *	@Return
+ *		Unconditionally:	a pointer to the node that took node's place
+ *
+ */
+struct AVLtree_sub* avl_rotate(struct AVLtree* tree, struct AVLtree_sub* node, char direction);
+
+
+
+/**	@Functionality
+ *		If node's balance is -2 or 2, restores it
+ *		with a single or a double rotation.
+ *
+ *		This is a helper function of avl_balanceInsert()
+ *		and avl_balanceRemove() functions.
+ *
+ *	@Arguments
+ *		struct AVLtree* tree:		a pointer to an AVLtree structure, a super avl tree,
+ *									properly created with avl_createTree() function;
+ *
+ *		struct AVLtree_sub* node:	a pointer to an avl tree node, possibly unbalanced.
+ *
+ *	@Return
+ *		Unconditionally:	a pointer to the node that is now on
+ *							node's place, node itself if it was
+ *							already balanced
+ *
+ */
+struct AVLtree_sub* avl_rebalance(struct AVLtree* tree, struct AVLtree_sub* node);
+
+
+
+/**	@Functionality
+ *		Walks from a freshly inserted node up to
+ *		the root, updating ancestors' balances, and
+ *		rotates the first one that gets unbalanced.
+ *
+ *		This is a helper function of avl_insert() macro function.
+ *
+ *	@Arguments
+ *		struct AVLtree* tree:		a pointer to an AVLtree structure, a super avl tree,
+ *									properly created with avl_createTree() function;
+ *
+ *		struct AVLtree_sub* node:	a pointer to the avl tree node just inserted.
+ *
+ *	@Return
+ *		None
+ *
+ */
+void avl_balanceInsert(struct AVLtree* tree, struct AVLtree_sub* node);
+
+
+
+/**	@Functionality
+ *		Walks from node up to the root, after one of
+ *		its subtrees lost one level of height, updating
+ *		ancestors' balances and rotating unbalanced ones
+ *		until the subtree height stops changing.
+ *
+ *		This is a helper function of avl_removeNode() function.
+ *
+ *	@Arguments
+ *		struct AVLtree* tree:		a pointer to an AVLtree structure, a super avl tree,
+ *									properly created with avl_createTree() function;
+ *
+ *		struct AVLtree_sub* node:	a pointer to the avl tree node whose subtree shrank;
+ *
+ *		char c_type:				which subtree shrank ('r' if right, 'l' if left).
+ *
+ *	@Return
+ *		None
+ *
+ */
+void avl_balanceRemove(struct AVLtree* tree, struct AVLtree_sub* node, char c_type);
+
+
+
+/**	@Functionality
+ *		Recursively checks that an avl tree, normally a
+ *		root, holds the avl properties: every node's
+ *		balance matches its subtrees' heights and lies
+ *		between -1 and 1, every node's size matches its
+ *		subtrees' sizes, and every child points back
+ *		to its parent.
+ *
+ *		It's meant to be called by tests after a workload,
+ *		e.g. random, ascending or descending insertions
+ *		and removals.
+ *
+ *	@Argument
+ *		struct AVLtree_sub* node:	a pointer to an avl tree node, normally a root.
+ *
+ *	@Return
+ *		On success:	the height of the avl tree, 0 if it's empty (NULL)
+ *
+ *		On failure:	-1 (if any avl property is violated)
+ *
+ */
+long avl_verify(struct AVLtree_sub* node);
+
+
+
+/**	@Functionality
+ *		Searches n identifiers, from an array of any
+ *		primitive type or of strings, into one of a super
+ *		avl tree's roots, all at once.
+ *
+ *		Instead of one search after another, it walks up
+ *		to AVL_BATCH_LANES of them interleaved, one level
+ *		of each at a time, and prefetches the next child of
+ *		each one, so while one search waits for memory, the
+ *		others keep going.
+ *
+ *		This is a helper function of avl_searchBatch() macro function.
+ *
+ *	@Arguments
+ *		struct AVLtree* tree:	a pointer to an AVLtree structure, a super avl tree,
+ *								properly created with avl_createTree() function;
+ *
+ *		char type:				which root to search into, as given by avl_getKeyType();
+ *
+ *		const void* keys:		array of n identifiers, all of the same primitive
+ *								type, or of n strings;
+ *
+ *		size_t width:			size of each identifier in keys, in bytes;
+ *
+ *		long n:					how many identifiers there are;
+ *
+ *		void** data:			array of n pointers, each one set to the data stored
+ *								along with the identifier at the same index, or
+ *								NULL if it wasn't found.
+ *
+ *	@Return
+ *		Unconditionally:	how many identifiers were found
+ *
+ */
+long avl_searchBatchKeys(struct AVLtree* tree, char type, const void* keys, size_t width, long n, void** data);
+
+
+
+/**	@Functionality
+ *		Gets IDs and datas from an avl tree, starting from its
+ *		smallest ID, in ascending order, into preallocated ID
+ *		and data arrays, up to n of them.
+ *
+ *		It walks through the tree in a single pass, keeping
+ *		the nodes whose left side is being visited in a small
+ *		array on stack, so it takes neither recursion nor any
+ *		allocation.
+ *
+ *		Arrays' contents just point to those of the nodes, they're
+ *		not copies on heap. Each ID points to node's string, if it's
+ *		a string root, or to node's long long, unsigned long long or
+ *		long double identifier, otherwise.
+ *
+ *		This is a helper function of avl_traverseRoot() function.
+ *
+ *	@Arguments
+ *		void** ID:					array of at least n void pointers, which will have
+ *									IDs pointers inside the avl tree. May be NULL, if
+ *									only datas are wanted;
+ *
+ *		void** data:				array of at least n void pointers, which will have
+ *									datas pointers inside the avl tree. May be NULL, if
+ *									only IDs are wanted;
+ *
+ *		long n:						how many IDs and datas, at most, to get;
+ *
+ *		struct AVLtree_sub* node:	a pointer to an avl tree root.
+ *
+ *	@Return
+ *		Unconditionally:	how many IDs and datas were put into the arrays
+ *
+ */
+long avl_tTraverse(void** ID, void** data, long n, struct AVLtree_sub* node);
+
+
+
+/**	@Functionality
+ *		Gets up to n IDs and datas of one of a super avl
+ *		tree's roots, whatever its engine, in ascending
+ *		order, into preallocated ID and data arrays.
+ *
+ *		This is a helper function of avl_traverse() and
+ *		avl_traverseInto() macro functions.
+ *
+ *	@Arguments
+ *		struct AVLtree* tree:	a pointer to an AVLtree structure, a super avl tree,
+ *								properly created with avl_createTree() function;
+ *
+ *		char type:				which root to traverse, as given by avl_getKeyType();
+ *
+ *		void** ID:				array of at least n void pointers, or NULL;
+ *
+ *		void** data:			array of at least n void pointers, or NULL;
+ *
+ *		long n:					how many IDs and datas, at most, to get.
+ *
+ *	@Return
+ *		Unconditionally:	how many IDs and datas were put into the arrays
+ *
+ */
+long avl_traverseRoot(struct AVLtree* tree, char type, void** ID, void** data, long n);
+
+
+
+/**	@Functionality
+ *		Gets up to n IDs and datas of one of a super avl
+ *		tree's roots, as avl_traverseRoot() does, with the
+ *		work split among a thread pool's workers: each one
+ *		goes through subtrees of its own, putting them at
+ *		offsets given by the sizes of the subtrees before.
+ *
+ *		A B+ tree or persistent engine's root is gone
+ *		through by the calling thread alone.
+ *
+ *		This is a helper function of avl_parallelTraverse() macro function.
+ *
+ *	@Arguments
+ *		struct AVLtree* tree:	a pointer to an AVLtree structure, a super avl tree,
+ *								properly created with avl_createTree() function;
+ *
+ *		char type:				which root to traverse, as given by avl_getKeyType();
+ *
+ *		void** ID:				array of at least n void pointers, or NULL;
+ *
+ *		void** data:			array of at least n void pointers, or NULL;
+ *
+ *		long n:					how many IDs and datas, at most, to get;
+ *
+ *		struct AVLpool* pool:	a thread pool, as given by avl_createPool(), running
+ *								no other job.
+ *
+ *	@Return
+ *		Unconditionally:	how many IDs and datas were put into the arrays
+ *
+ */
+long avl_parallelTraverseRoot(struct AVLtree* tree, char type, void** ID, void** data, long n, struct AVLpool* pool);
+
+
+
+/**	@Functionality
+ *		Sets up a range of IDs, from lo to hi, both
+ *		inclusive, of one of a super avl tree's roots,
+ *		already converted into AVLkeys, pointing it to
+ *		the smallest node whose ID is not lesser than lo.
+ *
+ *		This is a helper function of avl_rangeBegin()
+ *		and avl_range() macro functions.
+ *
+ *	@Arguments
+ *		struct AVLtree* tree:		a pointer to an AVLtree structure, a super avl tree,
+ *									properly created with avl_createTree() function;
+ *
+ *		struct AVLrange* range:		a pointer to an AVLrange structure to set up;
+ *
+ *		char type:					which root to go through, as given by avl_getKeyType();
+ *
+ *		union AVLkey lo:			the range's smallest ID, as given by avl_toKey();
+ *
+ *		union AVLkey hi:			the range's greatest ID, as given by avl_toKey().
+ *
+ *	@Return
+ *		None
+ *
+ */
+void avl_rangeStart(struct AVLtree* tree, struct AVLrange* range, char type, union AVLkey lo, union AVLkey hi);
+
+
+
+/**	@Functionality
+ *		Pulls the next node of a range, in ascending
+ *		order of IDs, and moves the range on to the
+ *		node right after it, through nodes' parents.
+ *
+ *		ID and data just point to those of the node, they're
+ *		not copies on heap. ID points to node's string, if
+ *		it's a string root, or to node's long long, unsigned
+ *		long long or long double identifier, otherwise.
+ *
+ *	@Arguments
+ *		struct AVLrange* range:		a pointer to an AVLrange structure, properly
+ *									set up with avl_rangeBegin() macro function;
+ *
+ *		void** ID:					a pointer to a void pointer that will point to
+ *									node's ID. May be NULL, if it's not wanted;
+ *
+ *		void** data:				a pointer to a void pointer that will point to
+ *									node's data. May be NULL, if it's not wanted.
+ *
+ *	@Return
+ *		On success:	1, and ID and data point to those of the node
+ *
+ *		On failure:	0 (if the range is over)
+ *
+ */
+int avl_rangeNext(struct AVLrange* range, void** ID, void** data);
+
+
+
+/**	@Functionality
+ *		Calls callback for every node of a range, in
+ *		ascending order of IDs, until the range is over
+ *		or callback asks to stop.
+ *
+ *		Only the nodes on the way to lo and those inside
+ *		the range are visited, i.e. O(log(n) + k) of them.
+ *
+ *		This is a helper function of avl_range() macro function.
+ *
+ *	@Arguments
+ *		struct AVLtree* tree:		a pointer to an AVLtree structure, a super avl tree,
+ *									properly created with avl_createTree() function;
+ *
+ *		char type:					which root to go through, as given by avl_getKeyType();
+ *
+ *		union AVLkey lo:			the range's smallest ID, as given by avl_toKey();
+ *
+ *		union AVLkey hi:			the range's greatest ID, as given by avl_toKey();
+ *
+ *		int (*callback)(void*, void*, void*):
+ *									function called with each node's ID and data, just
+ *									like avl_rangeNext() gets them, and arg. Going through
+ *									the range stops if it returns anything but 0;
+ *
+ *		void* arg:					anything callback needs, passed as is to it.
+ *
+ *	@Return
+ *		Unconditionally:	how many nodes were passed to callback
+ *
+ */
+long avl_rangeKey(struct AVLtree* tree, char type, union AVLkey lo, union AVLkey hi,
+				  int (*callback)(void* ID, void* data, void* arg), void* arg);
+
+
+
+/**	@Functionality
+ *		Points an iterator to the smallest ('l') or to the
+ *		greatest ('r') node of an avl tree.
+ *
+ *		This is a helper function of avl_iterFirst()
+ *		and avl_iterLast() macro functions.
+ *
+ *	@Arguments
+ *		struct AVLiter* iter:		a pointer to an AVLiter structure;
+ *
+ *		struct AVLtree_sub* root:	a pointer to an avl tree root, or NULL if it's empty;
+ *
+ *		char side:					which end to go to ('l' if smallest, 'r' if greatest).
+ *
+ *	@Return
+ *		On success:	1, and iter points to that node
+ *
+ *		On failure:	0 (if the avl tree is empty)
+ *
+ */
+int avl_iterEdge(struct AVLiter* iter, struct AVLtree_sub* root, char side);
+
+
+
+/**	@Functionality
+ *		Points an iterator to the smallest node of one of
+ *		a super avl tree's roots whose ID is not lesser than
+ *		key, already converted into an AVLkey.
+ *
+ *		This is a helper function of avl_iterSeek() macro function.
+ *
+ *	@Arguments
+ *		struct AVLtree* tree:	a pointer to an AVLtree structure, a super avl tree,
+ *								properly created with avl_createTree() function;
+ *
+ *		struct AVLiter* iter:	a pointer to an AVLiter structure;
+ *
+ *		char type:				which root to go through, as given by avl_getKeyType();
+ *
+ *		union AVLkey key:		the identifier to seek, as given by avl_toKey().
+ *
+ *	@Return
+ *		On success:	1, and iter points to that node
+ *
+ *		On failure:	0 (if every ID is lesser than key)
+ *
+ */
+int avl_iterSeekKey(struct AVLtree* tree, struct AVLiter* iter, char type, union AVLkey key);
+
+
+
+/**	@Functionality
+ *		Moves an iterator to the node right after, or
+ *		right before, its current one, in order of IDs,
+ *		going through nodes' parents when needed, without
+ *		any recursion or allocation. Each step costs O(1),
+ *		amortized over a whole walk.
+ *
+ *	@Argument
+ *		struct AVLiter* iter:	a pointer to an AVLiter structure, properly set
+ *								up with avl_iterFirst(), avl_iterLast() or
+ *								avl_iterSeek() macro functions.
+ *
+ *	@Return
+ *		On success:	1, and iter points to the next, or previous, node
+ *
+ *		On failure:	0 (if iter has gone past the end)
+ *
+ */
+int avl_iterNext(struct AVLiter* iter);
+int avl_iterPrev(struct AVLiter* iter);
+
+
+
+/**	@Functionality
+ *		Gets ID and data of an iterator's current node.
+ *
+ *		ID and data just point to those of the node, they're
+ *		not copies on heap. ID points to node's string, if
+ *		it's a string root, or to node's long long, unsigned
+ *		long long or long double identifier, otherwise.
+ *
+ *	@Arguments
+ *		struct AVLiter* iter:	a pointer to an AVLiter structure;
+ *
+ *		void** ID:				a pointer to a void pointer that will point to
+ *								node's ID. May be NULL, if it's not wanted;
+ *
+ *		void** data:			a pointer to a void pointer that will point to
+ *								node's data. May be NULL, if it's not wanted.
+ *
+ *	@Return
+ *		On success:	1, and ID and data point to those of the node
+ *
+ *		On failure:	0 (if iter has gone past either end)
+ *
+ */
+int avl_iterGet(struct AVLiter* iter, void** ID, void** data);
+
+
+
+/**	@Functionality
+ *		Counts how many nodes of one of a super avl
+ *		tree's roots have an ID lesser than key, already
+ *		converted into an AVLkey, i.e. the position key
+ *		has, or would have, in ascending order.
+ *
+ *		It goes down the tree only once, adding up
+ *		left subtrees' sizes, so it costs O(log(n)).
+ *
+ *		This is a helper function of avl_rank() macro function.
+ *
+ *	@Arguments
+ *		struct AVLtree* tree:	a pointer to an AVLtree structure, a super avl tree,
+ *								properly created with avl_createTree() function;
+ *
+ *		char type:				which root to go through, as given by avl_getKeyType();
+ *
+ *		union AVLkey key:		the identifier to rank, as given by avl_toKey().
+ *
+ *	@Return
+ *		Unconditionally:	how many IDs are lesser than key
+ *
+ */
+long avl_rankKey(struct AVLtree* tree, char type, union AVLkey key);
+
+
+
+/**	@Functionality
+ *		Gets ID and data of the k-th smallest node of an
+ *		avl tree, starting from 0, going down the tree only
+ *		once, guided by subtrees' sizes, so it costs O(log(n)).
+ *
+ *		This is a helper function of avl_select() and
+ *		avl_percentile() macro functions.
+ *
+ *	@Arguments
+ *		struct AVLtree_sub* node:	a pointer to an avl tree root, or NULL if it's empty;
+ *
+ *		long k:						position of the node, in ascending order of IDs;
+ *
+ *		void** ID:					a pointer to a void pointer that will point to
+ *									node's ID, just like avl_iterGet() gets it. May
+ *									be NULL, if it's not wanted;
+ *
+ *		void** data:				a pointer to a void pointer that will point to
+ *									node's data. May be NULL, if it's not wanted.
+ *
+ *	@Return
+ *		On success:	1, and ID and data point to those of the node
+ *
+ *		On failure:	0 (if k is not lesser than the tree's size, or negative)
+ *
+ */
+int avl_selectNode(struct AVLtree_sub* node, long k, void** ID, void** data);
+
+
+
+/**	@Functionality
+ *		Gets ID and data of the node at percentile p of an
+ *		avl tree, by the nearest rank method: the smallest
+ *		node whose rank covers at least p of all nodes,
+ *		i.e. the ceil(p*n)-th smallest one. It costs O(log(n)).
+ *
+ *		This is a helper function of avl_percentile() macro function.
+ *
+ *	@Arguments
+ *		struct AVLtree_sub* node:	a pointer to an avl tree root, or NULL if it's empty;
+ *
+ *		double p:					the percentile, between 0 and 1, e.g. 0.99;
+ *
+ *		void** ID:					a pointer to a void pointer that will point to
+ *									node's ID. May be NULL, if it's not wanted;
+ *
+ *		void** data:				a pointer to a void pointer that will point to
+ *									node's data. May be NULL, if it's not wanted.
+ *
+ *	@Return
+ *		On success:	1, and ID and data point to those of the node
+ *
+ *		On failure:	0 (if the tree is empty)
+ *
+ */
+int avl_percentileNode(struct AVLtree_sub* node, double p, void** ID, void** data);
+
+
+
+/**	@Functionality
+ *		Takes one of a super avl tree's roots out of it,
+ *		leaving the root empty, and splits its nodes, by
+ *		an identifier already converted into an AVLkey,
+ *		into two avl trees: one of the IDs lesser than
+ *		key, and one of the IDs greater than key. Nodes
+ *		aren't copied, but relinked, in O(log(n)).
+ *
+ *		The nodes still belong to tree, which frees them
+ *		along with itself, and may be put back into it by
+ *		avl_joinRoot(), but never into another tree.
+ *		A durable tree saves a checkpoint without them.
+ *
+ *		This is a helper function of avl_split() macro function.
+ *
+ *	@Arguments
+ *		struct AVLtree* tree:			a pointer to an AVLtree structure, a super avl tree,
+ *										properly created with avl_createTree() function;
+ *
+ *		char type:						which root to split, as given by avl_getKeyType();
+ *
+ *		union AVLkey key:				the identifier to split the root by;
+ *
+ *		struct AVLtree_sub** left:		where to put the root of the avl tree of IDs lesser
+ *										than key, or NULL, if there's none;
+ *
+ *		struct AVLtree_sub** right:		where to put the root of the avl tree of IDs greater
+ *										than key, or NULL, if there's none.
+ *
+ *	@Return
+ *		Found:		the root of an avl tree of the nodes whose IDs are
+ *					equal to key, normally a single one
+ *
+ *		Not found:	NULL, as well as if the root is a B+ tree or persistent
+ *					engine's, which isn't split at all
+ *
+ */
+struct AVLtree_sub* avl_splitRoot(struct AVLtree* tree, char type, union AVLkey key, struct AVLtree_sub** left, struct AVLtree_sub** right);
+
+
+
+/**	@Functionality
+ *		Joins three avl trees of a super avl tree's nodes,
+ *		as given by avl_splitRoot(), into one of its roots,
+ *		which must be empty: every ID of left must be lesser
+ *		than or equal to every one of node's, and those to
+ *		every one of right's. Nodes aren't copied, but
+ *		relinked, in O(log(n)). A durable tree saves a
+ *		checkpoint with them.
+ *
+ *		This is a helper function of avl_join() macro function.
+ *
+ *	@Arguments
+ *		struct AVLtree* tree:		a pointer to an AVLtree structure, the super avl tree
+ *									the nodes were taken from;
+ *
+ *		char type:					which root to join them into, as given by avl_getKeyType();
+ *
+ *		struct AVLtree_sub* left:	root of the avl tree of the smallest IDs, or NULL;
+ *
+ *		struct AVLtree_sub* node:	root of the avl tree of the IDs in between, normally
+ *									a single node, or NULL;
+ *
+ *		struct AVLtree_sub* right:	root of the avl tree of the greatest IDs, or NULL.
+ *
+ *	@Return
+ *		Joined:		1
+ *
+ *		Not joined:	0, if the root wasn't empty or is a B+ tree or persistent
+ *					engine's
+ *
+ */
+int avl_joinRoot(struct AVLtree* tree, char type, struct AVLtree_sub* left, struct AVLtree_sub* node, struct AVLtree_sub* right);
+
+
+
+/**	@Functionality
+ *		Moves every ID of another super avl tree into a
+ *		super avl tree, root by root, along with its data,
+ *		unless tree already holds it: then other's ID and
+ *		data are freed. Other is freed along with them.
+ *
+ *		Nodes aren't copied: each root of the smaller tree
+ *		splits the other one, and each side is joined on its
+ *		own, taking O(m*log(n/m + 1)), m being the smaller
+ *		size, and tree takes all of other's slabs.
+ *
+ *		Other must not be used by any other thread, neither
+ *		then nor afterwards, for it's gone. A durable tree
+ *		saves a checkpoint right after, as union isn't logged.
+ *
+ *	@Arguments
+ *		struct AVLtree* tree:	a pointer to an AVLtree structure, a super avl tree,
+ *								properly created with avl_createTree() function;
+ *
+ *		struct AVLtree* other:	a pointer to another AVLtree structure, the super avl
+ *								tree to be moved into tree.
+ *
+ *	@Return
+ *		Joined:		1
+ *
+ *		Not joined:	0, if either tree has a B+ tree or persistent engine, or both are
+ *					the same, in which case none is changed
+ *
+ */
+int avl_union(struct AVLtree* tree, struct AVLtree* other);
+
+
+
+/**	@Functionality
+ *		Removes every ID of a super avl tree that another
+ *		super avl tree doesn't hold, root by root, freeing
+ *		it along with its data. Other isn't changed.
+ *
+ *		Nodes aren't copied: each node of other splits what
+ *		tree has of its subtree's IDs, taking O(m*log(n/m + 1)),
+ *		m being other's size. A durable tree saves a
+ *		checkpoint right after.
+ *
+ *	@Arguments
+ *		struct AVLtree* tree:	a pointer to an AVLtree structure, a super avl tree,
+ *								properly created with avl_createTree() function;
+ *
+ *		struct AVLtree* other:	a pointer to another AVLtree structure, a super avl
+ *								tree, whose IDs are the ones tree keeps.
+ *
+ *	@Return
+ *		Done:		1
+ *
+ *		Not done:	0, if either tree has a B+ tree or persistent engine, or both are
+ *					the same, in which case none is changed
+ *
+ */
+int avl_intersect(struct AVLtree* tree, struct AVLtree* other);
+
+
+
+/**	@Functionality
+ *		Removes every ID of a super avl tree that another
+ *		super avl tree holds, root by root, freeing it along
+ *		with its data. Other isn't changed.
+ *
+ *		Nodes aren't copied: each node of other splits what
+ *		tree has of its subtree's IDs, taking O(m*log(n/m + 1)),
+ *		m being other's size. A durable tree saves a
+ *		checkpoint right after.
+ *
+ *	@Arguments
+ *		struct AVLtree* tree:	a pointer to an AVLtree structure, a super avl tree,
+ *								properly created with avl_createTree() function;
+ *
+ *		struct AVLtree* other:	a pointer to another AVLtree structure, a super avl
+ *								tree, whose IDs are the ones tree removes.
+ *
+ *	@Return
+ *		Done:		1
+ *
+ *		Not done:	0, if either tree has a B+ tree or persistent engine, or both are
+ *					the same, in which case none is changed
+ *
+ */
+int avl_difference(struct AVLtree* tree, struct AVLtree* other);
+
+
+
+/**	@Functionality
+ *		Frees all data from an AVLtree structure,
+ *		a super avl tree, namely: all nodes' ID
+ *		and data. Instead of walking through every
+ *		root, it goes over its slabs sequentially,
+ *		freeing in use nodes' ID and data, then
+ *		frees the slabs and the AVLtree structure
+ *		itself.
+ *
+ *		If data is not a primitive type or string
+ *		and it has some members on heap, one shall
+ *		call avl_traverse function to get said members
+ *		and free them manually.
+ *
+ *		For example: a structure with two string members,
+ *		each heap allocated. In that case, there'll be
+ *		three variables on heap: the two strings and
+ *		the structure itself. If the avl_free function
+ *		is called without the avl_traverse function
+ *		and manual free of the two members beforehand,
+ *		the two strings will be leaked.
+ *
+ *		A tree created with AVL_PERSISTENT also frees the
+ *		IDs and datas its snapshots held, so every one of
+ *		them must be released beforehand.
+ *
+ *		A durable tree commits its log beforehand, then
+ *		closes it, leaving its files as they are.
+ *
+ *	@Argument
+ *		struct AVLtree* tree:	a pointer to an AVLtree structure,
+ *								the super avl tree to be freed.
+ *
+ *	@Return
+ *		None
+ *
+ */
+void avl_free(struct AVLtree* tree);
+
+
+
+/**	@Functionality
+ *		Frees a super avl tree, as avl_free() does, with
+ *		the work split among a thread pool's workers: each
+ *		one frees whole slabs of nodes, with their IDs and
+ *		datas, or whole B+ tree engine's roots.
+ *
+ *	@Arguments
+ *		struct AVLtree* tree:	a pointer to an AVLtree structure,
+ *								the super avl tree to be freed;
+ *
+ *		struct AVLpool* pool:	a thread pool, as given by avl_createPool(), running
+ *								no other job.
+ *
+ *	@Return
+ *		None
+ *
+ */
+void avl_parallelFree(struct AVLtree* tree, struct AVLpool* pool);
+
+
+
+/**	@Functionality
+ *		Frees node's ID and data, if it has any,
+ *		and gives the node back to the super avl
+ *		tree's free nodes, so it can be reused.
+ *		On an RCU tree, node is retired instead,
+ *		and freed two epochs later.
+ *
+ *		It doesn't touch node's children, so the
+ *		node must already be unlinked from its root.
+ *
+ *		This is a helper function of avl_removeNode() function.
+ *
+ *	@Arguments
+ *		struct AVLtree* tree:		a pointer to an AVLtree structure, the super
+ *									avl tree from which node was taken;
+ *
+ *		struct AVLtree_sub* node:	a pointer to an avl tree node, to be freed.
+ *
+ *	@Return
+ *		None
+ *
+ */
+void avl_freeNode(struct AVLtree* tree, struct AVLtree_sub* node);
+
+
+
+
+
+/**	@Functionality
+ *		Returns respective super avl tree's
+ *		root structure pointer, according
+ *		to 'id' primitive type.
+ *
+ *		It needs at least C11 to work, for it uses
+ *		_Generic() function.
+ *
+ *		It is a macro function because otherwise,
+ *		'id' would need to be a void* to support a
+ *		generic type when calling the function,
+ *		and so _Generic() would not work to
+ *		distinguish which root it should return.
+ *
+ *	@Arguments
+ *		struct AVLtree* sAVL:	a pointer to an AVLtree structure, a super avl tree,
+ *								properly created with avl_createTree() function;
+ *
+ *		? id:					a variable which primitive type identifies
+ *								to which root type it refers.
+ *
+ *	@Returns
+ *		On success:	a pointer to one of super avl tree's root,
+ *					depending on 'id' primitive type:	int_root	-> 	int, short int,
+ *																		char, signed char,
+ *																		long, long long;
+ *
+ *														uint_root	->	unsigned int, unsigned short int,
+ *																		unsigned char, unsigned long,
+ *																		unsigned long long;
+ *
+ *														double_root	->	float, double, long double;
+ *
+ *														string_root ->	char*;
+ *
+ *		On failure:	NULL (if 'id' is not a primitive type, or if its root is empty)
+ *
+ */
+#define avl_getRootType(sAVL, id) 																		\
+		_Generic((id),	int:			sAVL->int_root,		unsigned int:			sAVL->uint_root,	\
+						char:			sAVL->int_root,		unsigned char:			sAVL->uint_root,	\
+						long:			sAVL->int_root,		unsigned long:			sAVL->uint_root,	\
+						long long:		sAVL->int_root,		unsigned long long:		sAVL->uint_root,	\
+						short int:		sAVL->int_root,		unsigned short int:		sAVL->uint_root,	\
+						signed char: 	sAVL->int_root,		char*:					sAVL->string_root,	\
+						double: 		sAVL->double_root,	long double:			sAVL->double_root,	\
+						float:			sAVL->double_root,	default:				NULL				\
+				)
+
+
+
+
+
+/**	@Functionality
+ *		Returns which root type 'id' refers to, the
+ *		same way avl_getRootType() does, but as a
+ *		character, so it's known even if roots
+ *		are not.
+ *
+ *	@Argument
+ *		? id:	a variable which primitive type identifies
+ *				to which root type it refers.
+ *
+ *	@Returns
+ *		On success:	'i' for int_root, 'u' for uint_root,
+ *					'd' for double_root, 'c' for string_root
+ *
+ *		On failure:	0 (if 'id' is not a primitive type)
+ *
+ */
+#define avl_getKeyType(id) 																		\
+		_Generic((id),	int:			'i',				unsigned int:			'u',				\
+						char:			'i',				unsigned char:			'u',				\
+						long:			'i',				unsigned long:			'u',				\
+						long long:		'i',				unsigned long long:		'u',				\
+						short int:		'i',				unsigned short int:		'u',				\
+						signed char: 	'i',				char*:					'c',				\
+						double: 		'd',				long double:			'd',				\
+						float:			'd',				default:				0					\
+				)
+
+
+
+
+
+/**	@Functionality
+ *		Converts 'id' into an AVLkey, widening it to
+ *		the member of its root type. Strings are not
+ *		copied, the key just points to 'id' and holds
+ *		its prefix.
+ *
+ *		The avl_integerKey(), avl_uintegerKey(),
+ *		avl_realKey() and avl_stringKey() functions
+ *		do the conversion for each root type.
+ *
+ *	@Argument
+ *		? id:	a variable of any primitive type, or a string.
+ *
+ *	@Return
+ *		Unconditionally:	an AVLkey holding 'id'
+ *
+ */
+#define avl_toKey(id) 																					\
+		_Generic((id),	unsigned int:		avl_uintegerKey,	unsigned char:			avl_uintegerKey,	\
+						unsigned long:		avl_uintegerKey,	unsigned long long:		avl_uintegerKey,	\
+						unsigned short int:	avl_uintegerKey,	char*:					avl_stringKey,		\
+						double: 			avl_realKey,		long double:			avl_realKey,		\
+						float:				avl_realKey,		default:				avl_integerKey		\
+				)(id)
+
+static inline union AVLkey avl_integerKey(long long id){
+	return (union AVLkey){.integer = id};
+}
+
+static inline union AVLkey avl_uintegerKey(unsigned long long id){
+	return (union AVLkey){.uinteger = id};
+}
+
+static inline union AVLkey avl_realKey(long double id){
+	return (union AVLkey){.real = id};
+}
+
+static inline union AVLkey avl_stringKey(char* id){
+	
+	union AVLkey key = {.string = id};
+	int i;
+	
+	
+	/* Packs up to 8 first bytes, big endian, padding with zeroes after the end */
+	for(i = 0; i < 8 && id[i]; i++)
+		key.prefix |= (unsigned long long)(unsigned char)id[i] << (56 - 8*i);
+	
+	
+	return key;
+	
+}
+
+
+
+
+
+/**	@Functionality
+ *		Compares two keys of the same root type.
+ *		Strings are first compared through their
+ *		prefixes, and only if both are equal and
+ *		longer than 8 bytes, through strcmp().
+ *
+ *		This is a helper function of avl_insertKey()
+ *		and avl_searchKey() functions.
+ *
+ *	@Arguments
+ *		char type:					root type of both keys, as given by avl_getKeyType();
+ *
+ *		const union AVLkey* key:	the key to compare;
+ *
+ *		const union AVLkey* other:	the key to compare it to.
+ *
+ *	@Return
+ *		A negative number, zero, or a positive number if
+ *		key is lesser than, equal to, or greater than other
+ *
+ */
+static inline int avl_keyCompare(char type, const union AVLkey* key, const union AVLkey* other){
+	
+	switch(type){
+		
+		case 'i': return (key->integer > other->integer) - (key->integer < other->integer);
+		case 'u': return (key->uinteger > other->uinteger) - (key->uinteger < other->uinteger);
+		case 'd': return (key->real > other->real) - (key->real < other->real);
+		
+	}
+	
+	
+	/* 	Different prefixes already tell the order, and equal ones
+		ending before 8 bytes mean both strings are over */
+	if(key->prefix != other->prefix) return key->prefix > other->prefix ? 1 : -1;
+	if(!(key->prefix & 0xff)) return 0;
+	return strcmp(key->string + 8, other->string + 8);
+	
+}
+
+
+
+/**	@Functionality
+ *		Compares a string key to an interned one, as
+ *		avl_keyCompare() does, though only from the 'from'
+ *		byte on, when both are known to share that many
+ *		first bytes, and gets how many they actually share.
+ *		Prefixes still go first, with no string read at all
+ *		if they differ.
+ *
+ *		Interned strings start at multiples of 8 bytes and
+ *		are padded with zeros up to the next one, so both
+ *		strings are read 8 bytes at a time, as long as key's
+ *		length allows, for other can't end before key does
+ *		while they're equal.
+ *
+ *		Going down a root, every ID under a node shares
+ *		with key at least as many bytes as both IDs key is
+ *		between do, the last ones it went right and left
+ *		of, so bytes known to match aren't read again.
+ *
+ *		This is a helper function of avl_insertKey(),
+ *		avl_searchKey() and avl_rangeStart() functions.
+ *
+ *	@Arguments
+ *		const union AVLkey* key:	the string key to compare;
+ *
+ *		const union AVLkey* other:	the interned string key to compare it to;
+ *
+ *		size_t from:				how many first bytes both are known to share;
+ *
+ *		size_t length:				key's length;
+ *
+ *		size_t* common:				where to put how many first bytes they share,
+ *									unless they're equal.
+ *
+ *	@Return
+ *		A negative number, zero, or a positive number if
+ *		key is lesser than, equal to, or greater than other
+ *
+ */
+static inline int avl_stringCompare(const union AVLkey* key, const union AVLkey* other, size_t from, size_t length, size_t* common){
+	
+	const unsigned char *a, *b;
+	unsigned long long diff = key->prefix ^ other->prefix, x, y;
+	
+	
+	/* The first differing byte of prefixes is their highest differing one */
+	if(diff){
+		*common = __builtin_clzll(diff) / 8;
+		return key->prefix > other->prefix ? 1 : -1;
+	}
+	if(!(key->prefix & 0xff)) return 0;
+	
+	
+	/* 	Both go on past 8 bytes, so they're compared from the 8 bytes the
+		first one they may differ at is in, while key has 8 more bytes before
+		its '\0', then byte by byte, from the 8 they differ at, if any */
+	a = (const unsigned char*)key->string;
+	b = (const unsigned char*)other->string;
+	for(from = ((from > 8) ? from : 8) & ~(size_t)7; from + 8 <= length; from += 8){
+		memcpy(&x, a + from, 8);
+		memcpy(&y, b + from, 8);
+		if(x != y) break;
+	}
+	for(; a[from] == b[from] && a[from]; from++);
+	*common = from;
+	
+	
+	return (a[from] > b[from]) - (a[from] < b[from]);
+	
+}
+
+
+
+
+
+/**	@Functionality
+ *		Inserts identifier and data into an avl tree.
+ *		The identifier is copied into avl tree, but
+ *		data member just points to data passed as
+ *		argument.
+ *
+ *		Identifier may be stack allocated, but data must be
+ *		heap allocated and shall not be freed anywhere else.
+ *
+ *		It is a macro function because otherwise,
+ *		'id' would need to be a void* to support a
+ *		generic type when calling the function,
+ *		and so _Generic() would not work to
+ *		convert it into its root's key.
+ *
+ *	@Arguments
+ *		struct AVLtree_sub* root:	pointer to an AVLtree_sub structure, one
+ *									of super avl tree's root, an avl tree;
+ *
+ *		? DATA:						pointer to the data to be stored into
+ *									the avl tree. Must be heap allocated
+ *									and shall not be freed anywhere else
+ *									apart from avl_free() function;
+ *
+ *		? id:						identifier used to search for this node's
+ *									data inside the avl tree, such as 5, or
+ *									"scarf". It may be stack allocated, since
+ *									it's copied into the node, and strings are
+ *									copied and heap allocated internally.
+ *
+ *	@Return
+ *		None
+ *
+ */
+#define avl_insert(root, DATA, id)											\
+		do {																\
+																			\
+			/* 	Converts id into a key, then inserts it into				\
+				the super avl tree's root depending on id */				\
+			avl_insertKey(root, avl_getKeyType(id), avl_toKey(id), DATA);	\
+																			\
+																			\
+		} while(0)
+
+
+
+
+
+/**	@Functionality
+ *		Loads n identifiers and datas into an avl tree at
+ *		once. Into an empty root, keys sorted in ascending
+ *		order are loaded in O(n), with a single allocation
+ *		for all nodes; unsorted ones are sorted first.
+ *
+ *		Just like avl_insert(), identifiers are copied into
+ *		the avl tree, but datas just point to those passed
+ *		in data array.
+ *
+ *		It is a macro function because otherwise, 'keys'
+ *		would need to be a void* to support a generic type
+ *		when calling the function, and so _Generic() would
+ *		not be able to distinguish which root it refers to.
+ *
+ *	@Arguments
+ *		struct AVLtree* root:	a pointer to an AVLtree structure, a super avl tree;
+ *
+ *		? keys:					array of n identifiers of the same primitive type,
+ *								such as long long*, double* or char**;
+ *
+ *		void** data:			array of n pointers to the datas to be stored into
+ *								the avl tree, heap allocated, or NULL;
+ *
+ *		long n:					how many identifiers there are.
+ *
+ *	@Return
+ *		How many identifiers were loaded
+ *
+ */
+#define avl_bulkLoad(root, keys, data, n)										\
+		avl_bulkLoadKeys(root, avl_getKeyType(*(keys)), keys, sizeof(*(keys)), data, n)
+
+
+
+
+
+/**	@Functionality
+ *		Inserts n sorted identifiers into an empty avl
+ *		tree at once, as avl_bulkLoad() does, with the
+ *		work split among a thread pool's workers.
+ *
+ *	@Arguments
+ *		struct AVLtree* root:	a pointer to an AVLtree structure, a super avl tree;
+ *
+ *		? keys:					array of n identifiers of the same primitive type,
+ *								such as long long*, double* or char**, in
+ *								ascending order;
+ *
+ *		void** data:			array of n pointers to the datas to be stored into
+ *								the avl tree, heap allocated, or NULL;
+ *
+ *		long n:					how many identifiers there are;
+ *
+ *		struct AVLpool* pool:	a thread pool, as given by avl_createPool().
+ *
+ *	@Return
+ *		How many identifiers were loaded
+ *
+ */
+#define avl_parallelBulkLoad(root, keys, data, n, pool)							\
+		avl_parallelBulkLoadKeys(root, avl_getKeyType(*(keys)), keys, sizeof(*(keys)), data, n, pool)
+
+
+
+
+
+/**	@Functionality
+ *		Searches n identifiers into an avl tree at once,
+ *		setting data[i] to the data stored along with
+ *		keys[i], or to NULL if it wasn't found.
+ *
+ *		Much faster than n calls of avl_search() on trees
+ *		too big for the cache, for their memory accesses
+ *		overlap instead of waiting one for another.
+ *
+ *	@Arguments
+ *		struct AVLtree* root:	a pointer to an AVLtree structure, a super avl tree;
+ *
+ *		? keys:					array of n identifiers of the same primitive type,
+ *								such as long long*, double* or char**;
+ *
+ *		long n:					how many identifiers there are;
+ *
+ *		void** data:			array of n pointers to hold the found datas.
+ *
+ *	@Return
+ *		How many identifiers were found
+ *
+ */
+#define avl_searchBatch(root, keys, n, data)									\
+		avl_searchBatchKeys(root, avl_getKeyType(*(keys)), keys, sizeof(*(keys)), n, data)
+
+
+
+
+
+/**	@Functionality
+ *		Searches 'id' into one of the super avl tree's
+ *		roots, an avl tree, and retrives its data if
+ *		it finds it. If the tree was created with
+ *		AVL_MULTIMAP, it's the first data 'id' was
+ *		inserted with.
+ *
+ *		It is a macro function because otherwise,
  *		'id' would need to be a void* to support a
  *		generic type when calling the function,
- *		and so typeof() function would not work to
- *		dinamically cast node's ID to id's type.
+ *		and so avl_getRootType() would not work to
+ *		distinguish which root it should return.
+ *
+ *	@Arguments
+ *		struct AVLtree_sub* root:	pointer to an AVLtree_sub structure, one
+ *									of super avl tree's root, an avl tree;
+ *
+ *		? id:						the identifier to search for into the
+ *									avl tree;
+ *
+ *		? DATA:						a pointer to the data type expected to be
+ *									retrieved.
+ *
+ *	@Return
+ *		None, since it's a macro function, but alters what
+ *		DATA argument points to, when called
+ *
+ */
+#define avl_search(root, id, DATA)											\
+		do {																\
+																			\
+			/* 	Converts id into a key and searches for it into				\
+				the super avl tree's root depending on id,					\
+				retrieving its data if it's found */						\
+			DATA = avl_searchData(root, avl_getKeyType(id), avl_toKey(id));	\
+																			\
+																			\
+		} while(0)
+
+
+
+
+
+/**	@Functionality
+ *		Returns how many nodes one of the super avl
+ *		tree's roots holds, in constant time.
+ *
+ *		On a tree created with AVL_CONCURRENT, it takes
+ *		no lock, so it's only a snapshot, unless the
+ *		root's lock is held.
+ *
+ *		It is a macro function because otherwise, 'type'
+ *		would need to be a void* to support a generic type
+ *		when calling the function, and so _Generic() would
+ *		not be able to distinguish which root it should count.
+ *
+ *	@Arguments
+ *		struct AVLtree* sAVL:	a pointer to an AVLtree structure, a super avl tree,
+ *								properly created with avl_createTree() function;
+ *
+ *		? type:					a primitive type to identify which root
+ *								of the avl tree to count.
+ *
+ *	@Returns
+ *		On success:	how many nodes the root holds
+ *
+ *		On failure:	0 (if 'type' is not a primitive type)
+ *
+ */
+#define avl_count(sAVL, type) 																			\
+		_Generic((type),	int:			sAVL->int_size,		unsigned int:			sAVL->uint_size,	\
+							char:			sAVL->int_size,		unsigned char:			sAVL->uint_size,	\
+							long:			sAVL->int_size,		unsigned long:			sAVL->uint_size,	\
+							long long:		sAVL->int_size,		unsigned long long:		sAVL->uint_size,	\
+							short int:		sAVL->int_size,		unsigned short int:		sAVL->uint_size,	\
+							signed char: 	sAVL->int_size,		char*:					sAVL->string_size,	\
+							double: 		sAVL->double_size,	long double:			sAVL->double_size,	\
+							float:			sAVL->double_size,	default:				0L					\
+				)
+
+
+
+
+
+/**	@Functionality
+ *		Gets all IDs and datas currently into an avl tree,
+ *		in ascending order of IDs, into ID and data arrays,
+ *		heap allocated.
+ *
+ *		Since they're heap allocated, they must be freed
+ *		by the caller, but only the arrays, not their
+ *		content, because their content just point to those
+ *		of the nodes, they're not copied and heap allocated.
+ *
+ *		Both arrays are allocated once, with the root's size,
+ *		and filled in a single pass through the tree.
+ *
+ *		It is a macro function because otherwise, 'type'
+ *		would need to be a void* to support a generic type
+ *		when calling the function, and so avl_getRootType()
+ *		would not be able to distinguish which root it should return.
+ *
+ *	@Arguments
+ *		struct AVLtree_sub* root:	pointer to an AVLtree_sub structure, one
+ *									of super avl tree's root, an avl tree;
+ *
+ *		void*** ID:					a void triple pointer that will store
+ *									all node's IDs;
+ *
+ *		void*** data:				a void triple pointer that will store
+ *									all node's datas;
+ *
+ *		long* counter:				a pointer to a long, that will keep
+ *									track of how many nodes there are
+ *									in the avl tree, i.e. how many IDs
+ *									and datas were got;
+ *
+ *		? type:						a primitive type to identify which
+ *									root of the avl tree to traverse.
+ *
+ *	@Return
+ *		None, since it's a macro function, but populates
+ *		both ID and data arrays with IDs and datas from
+ *		the avl tree, allocating them on heap
+ *
+ */
+#define avl_traverse(root, ID, data, counter, type)								\
+		do {																	\
+																				\
+			/* 	Gets root's size and allocates memory							\
+				for ID and data arrays just once */								\
+			*counter = avl_count(root, type);									\
+			*ID = calloc(*counter+1, sizeof(void*));							\
+			*data = calloc(*counter+1, sizeof(void*));							\
+																				\
+																				\
+			/* 	Traverses through avl tree, getting node's ID and				\
+				datas, and keeps how many it got, which is fewer if				\
+				a concurrent tree lost some before it was locked */				\
+			*counter = avl_traverseRoot(root, avl_getKeyType(type), *ID, *data, *counter);	\
+																				\
+																				\
+		} while(0)
+
+
+
+
+
+/**	@Functionality
+ *		Gets up to n IDs and datas currently into an
+ *		avl tree, in ascending order of IDs, into ID
+ *		and data arrays preallocated by the caller.
+ *
+ *		Arrays' contents just point to those of the
+ *		nodes, they're not copied and heap allocated.
+ *
+ *		It is a macro function because otherwise, 'type'
+ *		would need to be a void* to support a generic type
+ *		when calling the function, and so avl_getRootType()
+ *		would not be able to distinguish which root it should return.
+ *
+ *	@Arguments
+ *		struct AVLtree_sub* root:	pointer to an AVLtree_sub structure, one
+ *									of super avl tree's root, an avl tree;
+ *
+ *		void** ID:					an array of at least n void pointers, that
+ *									will store node's IDs, or NULL;
+ *
+ *		void** data:				an array of at least n void pointers, that
+ *									will store node's datas, or NULL;
+ *
+ *		long n:						how many IDs and datas, at most, to get,
+ *									normally avl_count() of the same type;
+ *
+ *		? type:						a primitive type to identify which
+ *									root of the avl tree to traverse.
+ *
+ *	@Return
+ *		How many IDs and datas were put into the arrays
+ *
+ */
+#define avl_traverseInto(root, ID, data, n, type)							\
+		avl_traverseRoot(root, avl_getKeyType(type), ID, data, n)
+
+
+
+
+
+/**	@Functionality
+ *		Gets up to n IDs and datas of an avl tree, in
+ *		ascending order, into preallocated arrays, as
+ *		avl_traverseInto() does, with the work split
+ *		among a thread pool's workers.
  *
- *		This is a helper function of avl_search()
- *		and avl_remove() macro functions.
+ *	@Arguments
+ *		struct AVLtree_sub* root:	pointer to an AVLtree_sub structure, one
+ *									of super avl tree's root, an avl tree;
+ *
+ *		void** ID:					an array of at least n void pointers, that
+ *									will store node's IDs, or NULL;
+ *
+ *		void** data:				an array of at least n void pointers, that
+ *									will store node's datas, or NULL;
+ *
+ *		long n:						how many IDs and datas, at most, to get,
+ *									normally avl_count() of the same type;
+ *
+ *		? type:						a primitive type to identify which
+ *									root of the avl tree to traverse;
+ *
+ *		struct AVLpool* pool:		a thread pool, as given by avl_createPool().
+ *
+ *	@Return
+ *		How many IDs and datas were put into the arrays
+ *
+ */
+#define avl_parallelTraverse(root, ID, data, n, type, pool)				\
+		avl_parallelTraverseRoot(root, avl_getKeyType(type), ID, data, n, pool)
+
+
+
+
+
+/**	@Functionality
+ *		Sets up range to pull, with avl_rangeNext(), all
+ *		IDs and datas of an avl tree from lo to hi, both
+ *		inclusive, in ascending order of IDs.
+ *
+ *		It is a macro function because otherwise, 'lo' and
+ *		'hi' would need to be void* to support a generic type
+ *		when calling the function, and so _Generic() would
+ *		not work to convert them into their root's keys.
  *
  *	@Arguments
- *		struct AVLtree_sub* node:	pointer to an AVLtree_sub structure, one
- *									of super avl tree's root's node, an avl tree;
+ *		struct AVLtree* root:		a pointer to an AVLtree structure, a super avl tree;
  *
- *		void* DATA:					a void pointer that will point to node's
- *									data;
+ *		struct AVLrange* range:		a pointer to an AVLrange structure to set up;
  *
- *		? id:						the identifier to compare to that of the node;
+ *		? lo:						the smallest identifier of the range, such as 5,
+ *									or "scarf";
  *
- *		char type:					to identify what id type it refers to.
- *									'c' to string id, 'a' otherwise.
+ *		? hi:						the greatest identifier of the range, of the same
+ *									root type as lo.
  *
  *	@Return
- *		None, since it's a macro function, but alters what
- *		node argument points to, or DATA, when called
- *		
+ *		None
+ *
  */
-#define avl_compare(node, DATA, id, type)								\
-		do {															\
-																		\
-			/* Returns if node doesn't have ID */						\
-			if(!node->ID){                                              \
-				node = NULL;                                            \
-				break;                                                  \
-			}                                                           \
-																		\
-																		\
-			/* Uses strcmp to compare, if id is a string */				\
-			if(type == 'c'){                                            \
-				char eval = strcmp(id, (char*)node->ID);				\
-																		\
-				if(eval > 0) node = node->Rchild;                       \
-				else if(eval < 0) node = node->Lchild;                  \
-				else DATA = node->data;                                 \
-																		\
-				break;                                                  \
-			}                                                           \
-																		\
-																		\
-			/* Casts ID to id's type and compares directly */			\
-			if(id > *(typeof(id)*)node->ID)                             \
-				node = node->Rchild;                                    \
-			else if(id < *(typeof(id)*)node->ID)                        \
-				node = node->Lchild;                                    \
-			else if(id == *(typeof(id)*)node->ID)                       \
-				DATA = node->data;                                      \
-																		\
-																		\
-		} while(0)
+#define avl_rangeBegin(root, range, lo, hi)										\
+		avl_rangeStart(root, range, avl_getKeyType(lo), avl_toKey(lo), avl_toKey(hi))
 
 
 
 
 
 /**	@Functionality
- *		Searches 'id' into one of the super avl tree's
- *		roots, an avl tree, and retrives its data if
- *		it finds it.
+ *		Calls callback with ID, data and arg of every
+ *		node of an avl tree from lo to hi, both inclusive,
+ *		in ascending order of IDs, until callback returns
+ *		anything but 0.
+ *
+ *		It is a macro function because otherwise, 'lo' and
+ *		'hi' would need to be void* to support a generic type
+ *		when calling the function, and so _Generic() would
+ *		not work to convert them into their root's keys.
+ *
+ *	@Arguments
+ *		struct AVLtree* root:		a pointer to an AVLtree structure, a super avl tree;
+ *
+ *		? lo:						the smallest identifier of the range, such as 5,
+ *									or "scarf";
+ *
+ *		? hi:						the greatest identifier of the range, of the same
+ *									root type as lo;
+ *
+ *		int (*callback)(void*, void*, void*):
+ *									function to call with each node's ID, data and arg;
+ *
+ *		void* arg:					anything callback needs, passed as is to it.
+ *
+ *	@Return
+ *		How many nodes were passed to callback
+ *
+ */
+#define avl_range(root, lo, hi, callback, arg)									\
+		avl_rangeKey(root, avl_getKeyType(lo), avl_toKey(lo), avl_toKey(hi), callback, arg)
+
+
+
+
+
+/**	@Functionality
+ *		Points iter to the smallest, or to the greatest,
+ *		node of one of the super avl tree's roots.
+ *
+ *		They are macro functions because otherwise, 'type'
+ *		would need to be a void* to support a generic type
+ *		when calling the function, and so avl_getRootType()
+ *		would not be able to distinguish which root it should return.
+ *
+ *	@Arguments
+ *		struct AVLtree* root:	a pointer to an AVLtree structure, a super avl tree;
+ *
+ *		struct AVLiter* iter:	a pointer to an AVLiter structure;
+ *
+ *		? type:					a primitive type to identify which
+ *								root of the avl tree to go through.
+ *
+ *	@Return
+ *		1 if iter points to a node, 0 if the root is empty
+ *
+ */
+#define avl_iterFirst(root, iter, type)											\
+		avl_iterEdge(iter, avl_getRootType(root, type), 'l')
+
+#define avl_iterLast(root, iter, type)											\
+		avl_iterEdge(iter, avl_getRootType(root, type), 'r')
+
+
+
+
+
+/**	@Functionality
+ *		Points iter to the smallest node of one of the
+ *		super avl tree's roots whose ID is not lesser
+ *		than 'id', i.e. 'id' itself, if it's there.
  *
  *		It is a macro function because otherwise,
  *		'id' would need to be a void* to support a
  *		generic type when calling the function,
- *		and so avl_getRootType() would not work to
- *		distinguish which root it should return.
+ *		and so _Generic() would not work to
+ *		convert it into its root's key.
  *
  *	@Arguments
- *		struct AVLtree_sub* root:	pointer to an AVLtree_sub structure, one
- *									of super avl tree's root, an avl tree;
+ *		struct AVLtree* root:	a pointer to an AVLtree structure, a super avl tree;
  *
- *		? id:						the identifier to search for into the
- *									avl tree;
+ *		struct AVLiter* iter:	a pointer to an AVLiter structure;
  *
- *		? DATA:						a pointer to the data type expected to be
- *									retrieved.
+ *		? id:					the identifier to seek, such as 5, or "scarf".
  *
  *	@Return
- *		None, since it's a macro function, but alters what
- *		DATA argument points to, when called
+ *		1 if iter points to a node, 0 if every ID is lesser than 'id'
  *
  */
-#define avl_search(root, id, DATA)										\
-		do {                                                            \
-																		\
-			/* Gets super avl tree's root depending on id */			\
-			char type;													\
-			DATA = NULL;                                                \
-			struct AVLtree_sub *node;                                 	\
-			if(!(node = avl_getRootType(root, id))) break;            	\
-																		\
-																		\
-			/* Calls avl_compare until DATA is found, or node is NULL */\
-			type = (root->string_root == node) ? 'c' : 'a';				\
-			while(!DATA && node)										\
-				avl_compare(node, DATA, id, type);						\
-																		\
-																		\
-		} while(0)
+#define avl_iterSeek(root, iter, id)											\
+		avl_iterSeekKey(root, iter, avl_getKeyType(id), avl_toKey(id))
 
 
 
 
 
 /**	@Functionality
- *		Gets all IDs and datas currently into an avl tree,
- *		normally starting from the root, into ID and data
- *		arrays, heap allocated.
+ *		Returns how many IDs of one of the super avl
+ *		tree's roots are lesser than 'id', i.e. the
+ *		position, starting from 0, that 'id' has, or
+ *		would have, in ascending order.
  *
- *		Since they're heap allocated, they must be freed
- *		by the caller, but only the arrays, not their
- *		content, because their content just point to those
- *		of the nodes, they're not copied and heap allocated.
+ *		It is a macro function because otherwise,
+ *		'id' would need to be a void* to support a
+ *		generic type when calling the function,
+ *		and so _Generic() would not work to
+ *		convert it into its root's key.
  *
- *		It is a macro function because otherwise, 'type'
+ *	@Arguments
+ *		struct AVLtree* root:	a pointer to an AVLtree structure, a super avl tree;
+ *
+ *		? id:					the identifier to rank, such as 5, or "scarf".
+ *
+ *	@Return
+ *		How many IDs are lesser than 'id'
+ *
+ */
+#define avl_rank(root, id)														\
+		avl_rankKey(root, avl_getKeyType(id), avl_toKey(id))
+
+
+
+
+
+/**	@Functionality
+ *		Gets ID and data of the k-th smallest node,
+ *		starting from 0, or of the node at percentile p,
+ *		between 0 and 1, of one of the super avl tree's roots.
+ *
+ *		They are macro functions because otherwise, 'type'
  *		would need to be a void* to support a generic type
  *		when calling the function, and so avl_getRootType()
  *		would not be able to distinguish which root it should return.
  *
  *	@Arguments
- *		struct AVLtree_sub* root:	pointer to an AVLtree_sub structure, one
- *									of super avl tree's root, an avl tree;
+ *		struct AVLtree* root:	a pointer to an AVLtree structure, a super avl tree;
  *
- *		void*** ID:					a void triple pointer that will store
- *									all node's IDs;
+ *		? type:					a primitive type to identify which
+ *								root of the avl tree to go through;
  *
- *		void*** data:				a void triple pointer that will store
- *									all node's datas;
+ *		long k / double p:		the node's position, or percentile;
  *
- *		int* counter:				a pointer to an int, that will keep
- *									track of how many nodes there are
- *									in the avl tree;
+ *		void** ID:				a pointer to a void pointer that will point to
+ *								node's ID, or NULL;
  *
- *		? type:						a primitive type to identify which
- *									root of the avl tree to traverse.
+ *		void** data:			a pointer to a void pointer that will point to
+ *								node's data, or NULL.
  *
  *	@Return
- *		None, since it's a macro function, but populates
- *		both ID and data arrays with IDs and datas from
- *		the avl tree, reallocing them on heap, when necessary
+ *		1 if there's such a node, 0 otherwise
  *
  */
-#define avl_traverse(root, ID, data, counter, type)							\
-		do {																\
-																			\
-			/* 	Zeroes counter and allocates memory							\
-				for ID and data arrays */									\
-			*counter = 0;													\
-			*ID = calloc(1, sizeof(void*));									\
-			*data = calloc(1, sizeof(void*));								\
-																			\
-																			\
-			/* 	Traverses through avl tree, getting							\
-				node's ID and datas */										\
-			avl_tTraverse(ID, data, counter, avl_getRootType(root, type));	\
-																			\
-																			\
-		} while(0)
+#define avl_select(root, type, k, ID, data)										\
+		avl_selectNode(avl_getRootType(root, type), k, ID, data)
+
+#define avl_percentile(root, type, p, ID, data)									\
+		avl_percentileNode(avl_getRootType(root, type), p, ID, data)
 
 
 
@@ -636,28 +2576,238 @@ void avl_freeNode(struct AVLtree_sub* node);
  *		None
  *
  */
-#define avl_remove(root, id)											\
-		do {                                                            \
-																		\
-			/* Gets super avl tree's root depending on id */			\
-			char type;													\
-			void *DATA = NULL;                                          \
-			struct AVLtree_sub *node;                                 	\
-			if(!(node = avl_getRootType(root, id))) break;            	\
-																		\
-																		\
-			/* Calls avl_compare until DATA is found, or node is NULL */\
-			type = (root->string_root == node) ? 'c' : 'a';				\
-			while(!DATA && node) avl_compare(node, DATA, id, type);		\
-																		\
-																		\
-			/* If node is found, removes it */							\
-			if(!node) break;                                          	\
-			avl_removeNode(root, node);									\
-																		\
-																		\
+#define avl_remove(root, id)												\
+		do {																\
+																			\
+			/* 	Converts id into a key and searches for it into				\
+				the super avl tree's root depending on id,					\
+				removing it if it's found */								\
+			avl_removeKey(root, avl_getKeyType(id), avl_toKey(id));			\
+																			\
+																			\
 		} while(0)
 
 
 
-#endif
\ No newline at end of file
+
+
+/**	@Functionality
+ *		Searches 'id' into one of the super avl tree's
+ *		roots, created with AVL_MULTIMAP, and gets up to
+ *		n of its datas, in the order they were inserted.
+ *
+ *	@Arguments
+ *		struct AVLtree* root:	a pointer to an AVLtree structure, a super avl tree;
+ *
+ *		? id:					the identifier to search for;
+ *
+ *		void** data:			an array of at least n void pointers, that will
+ *								store datas;
+ *
+ *		long n:					how many datas, at most, to get.
+ *
+ *	@Return
+ *		How many datas 'id' has, which may be more than n, or 0
+ *		if it's not found
+ *
+ */
+#define avl_searchAll(root, id, data, n)										\
+		avl_searchValues(root, avl_getKeyType(id), avl_toKey(id), data, n)
+
+
+
+
+
+/**	@Functionality
+ *		Returns how many datas 'id' has in one of the
+ *		super avl tree's roots, created with AVL_MULTIMAP,
+ *		in O(log n), however many they are.
+ *
+ *	@Arguments
+ *		struct AVLtree* root:	a pointer to an AVLtree structure, a super avl tree;
+ *
+ *		? id:					the identifier to count datas of.
+ *
+ *	@Return
+ *		How many datas 'id' has, or 0 if it's not found
+ *
+ */
+#define avl_countKey(root, id)													\
+		avl_searchValues(root, avl_getKeyType(id), avl_toKey(id), NULL, 0)
+
+
+
+
+
+/**	@Functionality
+ *		Searches for 'id' into one of the super avl tree's
+ *		roots, created with AVL_MULTIMAP, and removes only
+ *		'data' out of its datas, freeing it. 'id' itself
+ *		is removed along with its last data.
+ *
+ *	@Arguments
+ *		struct AVLtree* root:	a pointer to an AVLtree structure, a super avl tree;
+ *
+ *		? id:					the identifier to search for;
+ *
+ *		void* data:				the data to remove, as inserted along with 'id'.
+ *
+ *	@Return
+ *		1 if it was removed, 0 otherwise
+ *
+ */
+#define avl_removeOne(root, id, data)											\
+		avl_removeValue(root, avl_getKeyType(id), avl_toKey(id), data)
+
+
+
+
+
+/**	@Functionality
+ *		Takes the root of 'id' primitive type out of
+ *		a super avl tree, leaving it empty, and splits
+ *		it into an avl tree of IDs lesser than id, and
+ *		one of IDs greater than id, by relinking nodes.
+ *
+ *		It is a macro function because otherwise, 'id'
+ *		would need to be a void* to support a generic type
+ *		when calling the function, and so _Generic() would
+ *		not work to convert it into its root's key.
+ *
+ *	@Arguments
+ *		struct AVLtree* root:		a pointer to an AVLtree structure, a super avl tree;
+ *
+ *		? id:						the identifier to split the root by;
+ *
+ *		struct AVLtree_sub** left:	where to put the avl tree of IDs lesser than id;
+ *
+ *		struct AVLtree_sub** right:	where to put the avl tree of IDs greater than id.
+ *
+ *	@Return
+ *		The avl tree of nodes whose IDs are equal to id,
+ *		or NULL if there's none
+ *
+ */
+#define avl_split(root, id, left, right)										\
+		avl_splitRoot(root, avl_getKeyType(id), avl_toKey(id), left, right)
+
+/**	@Functionality
+ *		Joins avl trees left, node and right, as given
+ *		by avl_split(), back into the empty root of a
+ *		super avl tree of 'type' primitive type.
+ *
+ *	@Arguments
+ *		struct AVLtree* root:		a pointer to an AVLtree structure, the super avl tree
+ *									the nodes were split from;
+ *
+ *		? type:						a primitive type to identify which root to join into;
+ *
+ *		struct AVLtree_sub* left:	the avl tree of the smallest IDs, or NULL;
+ *
+ *		struct AVLtree_sub* node:	the avl tree of the IDs in between, or NULL;
+ *
+ *		struct AVLtree_sub* right:	the avl tree of the greatest IDs, or NULL.
+ *
+ *	@Return
+ *		1 if they were joined, 0 if the root wasn't empty
+ *
+ */
+#define avl_join(root, type, left, node, right)									\
+		avl_joinRoot(root, avl_getKeyType(type), left, node, right)
+
+
+
+/**	@Functionality
+ *		Locks one of the super avl tree's roots for
+ *		reading, shared with other readers, so it can't
+ *		change while an iterator or a range goes through
+ *		it, or while avl_select() and avl_percentile()
+ *		run. Does nothing if the tree isn't concurrent.
+ *
+ *		On an RCU tree's avl root, it takes no lock, but
+ *		keeps nodes, and datas found, from being freed
+ *		until it's unlocked, while the root may change.
+ *
+ *	@Arguments
+ *		struct AVLtree* root:	a pointer to an AVLtree structure, a super avl tree;
+ *
+ *		? type:					a primitive type to identify which root to lock.
+ *
+ *	@Return
+ *		None
+ *
+ */
+#define avl_readLock(root, type)												\
+		avl_lockRoot(root, avl_getKeyType(type), 'r')
+
+
+
+
+
+/**	@Functionality
+ *		Locks one of the super avl tree's roots against
+ *		writers, which wait until it's unlocked, so it
+ *		stays the same while iterators, ranges,
+ *		avl_select() and avl_percentile() go through it.
+ *		Readers still go on. Does nothing if the tree
+ *		isn't concurrent.
+ *
+ *	@Arguments
+ *		struct AVLtree* root:	a pointer to an AVLtree structure, a super avl tree;
+ *
+ *		? type:					a primitive type to identify which root to lock.
+ *
+ *	@Return
+ *		None
+ *
+ */
+#define avl_stableLock(root, type)												\
+		avl_lockRoot(root, avl_getKeyType(type), 'x')
+
+
+
+
+
+/**	@Functionality
+ *		Locks one of the super avl tree's roots for
+ *		writing, all for the calling thread, so nodes
+ *		found through an iterator may be removed with
+ *		avl_removeNode() meanwhile. Does nothing if the
+ *		tree isn't concurrent. On a durable one, it keeps
+ *		checkpoints out as well, until it's unlocked.
+ *
+ *	@Arguments
+ *		struct AVLtree* root:	a pointer to an AVLtree structure, a super avl tree;
+ *
+ *		? type:					a primitive type to identify which root to lock.
+ *
+ *	@Return
+ *		None
+ *
+ */
+#define avl_writeLock(root, type)												\
+		avl_lockRoot(root, avl_getKeyType(type), 'w')
+
+
+
+
+
+/**	@Functionality
+ *		Unlocks one of the super avl tree's roots, locked
+ *		by avl_readLock(), avl_stableLock() or avl_writeLock().
+ *
+ *	@Arguments
+ *		struct AVLtree* root:	a pointer to an AVLtree structure, a super avl tree;
+ *
+ *		? type:					a primitive type to identify which root to unlock.
+ *
+ *	@Return
+ *		None
+ *
+ */
+#define avl_unlock(root, type)													\
+		avl_unlockRoot(root, avl_getKeyType(type))
+
+
+
+#endif
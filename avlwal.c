@@ -0,0 +1,585 @@
+/* fdatasync(), ftruncate() and the log gate's read-write lock need POSIX, not just C11 */
+#define _XOPEN_SOURCE 700
+
+#include <stdio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "avlwal.h"
+#include "avlmapped.h"
+
+
+
+/* FNV-1a hash of length bytes, going on from hash, to tell records cut short or torn */
+static unsigned int avl_walHash(unsigned int hash, const void* bytes, size_t length){
+	
+	const unsigned char *byte = bytes;
+	
+	
+	while(length--) hash = (hash ^ *byte++) * 16777619u;
+	return hash;
+	
+}
+
+
+
+/* Gets a record's checksum: its hash, with the checksum member as 0, and its payload's */
+static unsigned int avl_walChecksum(struct AVLwalRecord record, const char* payload){
+	
+	record.checksum = 0;
+	return avl_walHash(avl_walHash(2166136261u, &record, sizeof(struct AVLwalRecord)), payload, record.length + record.width);
+	
+}
+
+
+
+/* 	Writes length bytes into the log's file, unless a crash is injected before they're
+	all written, which writes only those it allows. Returns 0 on failure, or on crash */
+static int avl_walWrite(struct AVLwal* wal, int fd, const char* bytes, size_t length){
+	
+	ssize_t written;
+	int crashed = 0;
+	
+	
+	if(wal->crash >= 0 && (size_t)wal->crash < length){
+		length = wal->crash;
+		crashed = 1;
+	}
+	if(wal->crash >= 0) wal->crash -= length;
+	
+	
+	while(length){
+		if((written = write(fd, bytes, length)) < 0){
+			if(errno == EINTR) continue;
+			return 0;
+		}
+		bytes += written;
+		length -= written;
+	}
+	
+	
+	return !crashed;
+	
+}
+
+
+
+/* 	Writes the records not yet written into the log's file, and syncs it if sync is set. Called
+	with the lock held, which is released meanwhile, so writers go on appending into the other
+	buffer, while committers wait for this write, which may already cover them. Returns 0 on failure */
+static int avl_walFlush(struct AVLwal* wal, int sync){
+	
+	unsigned long long target = wal->sequence, upto;
+	size_t used, size;
+	char *buffer;
+	int written;
+	
+	
+	/* Waits for the write in progress, which makes this one needless if it got every record wanted */
+	while(wal->flushing) pthread_cond_wait(&wal->flushed, &wal->lock);
+	if(wal->failed) return 0;
+	if(sync ? wal->durable >= target : !wal->used) return 1;
+	
+	
+	/* Takes the buffer, leaving the spare one for writers, and writes it alone */
+	buffer = wal->buffer;
+	size = wal->size;
+	used = wal->used;
+	upto = wal->sequence;
+	wal->buffer = wal->spare;
+	wal->size = wal->spareSize;
+	wal->spare = buffer;
+	wal->spareSize = size;
+	wal->used = 0;
+	if(sync) wal->pending = 0;
+	wal->flushing = 1;
+	pthread_mutex_unlock(&wal->lock);
+	
+	written = avl_walWrite(wal, wal->fd, buffer, used) && (!sync || !fdatasync(wal->fd));
+	
+	pthread_mutex_lock(&wal->lock);
+	if(written && sync) wal->durable = upto;
+	if(!written){
+		wal->failed = 1;
+		wal->used = 0;
+	}
+	wal->flushing = 0;
+	pthread_cond_broadcast(&wal->flushed);
+	
+	
+	return written;
+	
+}
+
+
+
+/* 	Starts a log over, empty but for its header, in a new file beside it renamed over it,
+	then made its log's file. The old one is kept if the new one can't be written */
+static int avl_walRestart(struct AVLwal* wal){
+	
+	struct AVLwalHeader header = {AVL_WAL_MAGIC, wal->width};
+	char *temporary = malloc(strlen(wal->log) + 5);
+	int fd, written;
+	
+	
+	sprintf(temporary, "%s.tmp", wal->log);
+	if((fd = open(temporary, O_WRONLY | O_CREAT | O_TRUNC, 0644)) < 0){
+		free(temporary);
+		return 0;
+	}
+	written = avl_walWrite(wal, fd, (const char*)&header, sizeof(struct AVLwalHeader)) && !fsync(fd) && !rename(temporary, wal->log);
+	
+	
+	if(written){
+		close(wal->fd);
+		wal->fd = fd;
+	} else {
+		close(fd);
+		remove(temporary);
+	}
+	free(temporary);
+	
+	
+	return written;
+	
+}
+
+
+
+/* 	Saves a durable tree's image over its checkpoint, then starts its log over. Called with
+	the gate held alone, so no change is halfway through, and marked as a write in progress,
+	so no commit writes into the old log meanwhile. Returns 0 on failure */
+static int avl_walCheckpoint(struct AVLtree* tree){
+	
+	struct AVLwal *wal = tree->wal;
+	int saved;
+	
+	
+	pthread_mutex_lock(&wal->lock);
+	while(wal->flushing) pthread_cond_wait(&wal->flushed, &wal->lock);
+	if(wal->failed){
+		pthread_mutex_unlock(&wal->lock);
+		return 0;
+	}
+	wal->flushing = 1;
+	pthread_mutex_unlock(&wal->lock);
+	
+	
+	/* 	The image holds every record so far, so the log's are all dropped, unless
+		it can't be saved, or the log restarted, when they're left for the next commit */
+	saved = avl_save(tree, wal->path, wal->width) && avl_walRestart(wal);
+	
+	pthread_mutex_lock(&wal->lock);
+	if(saved){
+		wal->used = 0;
+		wal->pending = 0;
+		wal->durable = wal->checkpointed = wal->sequence;
+	}
+	wal->flushing = 0;
+	pthread_cond_broadcast(&wal->flushed);
+	pthread_mutex_unlock(&wal->lock);
+	
+	
+	return saved;
+	
+}
+
+
+
+void avl_walLog(struct AVLwal* wal, char op, char type, union AVLkey key, void* data){
+	
+	struct AVLwalRecord record = {0};
+	const char *bytes = (type == 'c') ? key.string : (const char*)&key;
+	char *payload;
+	
+	
+	record.op = op;
+	record.type = type;
+	record.length = (type == 'c') ? strlen(key.string) + 1 : sizeof(union AVLkey);
+	record.width = (op != 'r' && data) ? wal->width : 0;
+	
+	
+	/* 	A failed log takes no more records, which would never reach its file,
+		so its buffer doesn't grow with every change from then on */
+	pthread_mutex_lock(&wal->lock);
+	if(wal->failed){
+		pthread_mutex_unlock(&wal->lock);
+		return;
+	}
+	
+	
+	/* Makes room for the record at the end of the buffer, doubling it as needed */
+	while(wal->used + sizeof(struct AVLwalRecord) + record.length + record.width > wal->size){
+		wal->size *= 2;
+		wal->buffer = realloc(wal->buffer, wal->size);
+	}
+	
+	
+	/* Copies the record, its identifier and data after it, then hashes them all */
+	payload = wal->buffer + wal->used + sizeof(struct AVLwalRecord);
+	memcpy(payload, bytes, record.length);
+	if(record.width) memcpy(payload + record.length, data, record.width);
+	record.sequence = ++wal->sequence;
+	record.checksum = avl_walChecksum(record, payload);
+	memcpy(wal->buffer + wal->used, &record, sizeof(struct AVLwalRecord));
+	
+	wal->used += sizeof(struct AVLwalRecord) + record.length + record.width;
+	wal->pending++;
+	pthread_mutex_unlock(&wal->lock);
+	
+}
+
+
+
+void avl_walLeave(struct AVLtree* tree){
+	
+	struct AVLwal *wal = tree->wal;
+	int sync, flush, checkpoint;
+	pthread_rwlock_unlock(&wal->gate);
+	
+	
+	/* Sees whether it's time to commit, to write a full buffer out, or to checkpoint */
+	pthread_mutex_lock(&wal->lock);
+	sync = wal->group && wal->pending >= wal->group;
+	flush = wal->used >= AVL_WAL_BUFFER;
+	checkpoint = !wal->failed && wal->interval && wal->sequence - wal->checkpointed >= (unsigned long long)wal->interval;
+	
+	
+	/* 	A checkpoint keeps changes out, which some other writer may already have
+		done meanwhile, so it's only written if it's still due once they are */
+	if(checkpoint){
+		pthread_mutex_unlock(&wal->lock);
+		pthread_rwlock_wrlock(&wal->gate);
+		if(wal->sequence - wal->checkpointed >= (unsigned long long)wal->interval) avl_walCheckpoint(tree);
+		pthread_rwlock_unlock(&wal->gate);
+		return;
+	}
+	
+	if(sync || flush) avl_walFlush(wal, sync);
+	pthread_mutex_unlock(&wal->lock);
+	
+}
+
+
+
+int avl_walCommit(struct AVLtree* tree){
+	
+	struct AVLwal *wal = tree->wal;
+	int committed;
+	if(!wal) return 0;
+	
+	
+	pthread_mutex_lock(&wal->lock);
+	committed = avl_walFlush(wal, 1);
+	pthread_mutex_unlock(&wal->lock);
+	
+	
+	return committed;
+	
+}
+
+
+
+int avl_checkpoint(struct AVLtree* tree){
+	
+	struct AVLwal *wal = tree->wal;
+	int saved;
+	if(!wal) return 0;
+	
+	
+	pthread_rwlock_wrlock(&wal->gate);
+	saved = avl_walCheckpoint(tree);
+	pthread_rwlock_unlock(&wal->gate);
+	
+	
+	return saved;
+	
+}
+
+
+
+int avl_walResume(struct AVLtree* tree){
+	
+	struct AVLwal *wal = tree->wal;
+	int saved = avl_walCheckpoint(tree);
+	
+	
+	/* 	Records logged past a change the image lacks would be replayed without
+		it, so none does once it can't be saved */
+	if(!saved){
+		pthread_mutex_lock(&wal->lock);
+		wal->failed = 1;
+		wal->used = 0;
+		pthread_mutex_unlock(&wal->lock);
+	}
+	pthread_rwlock_unlock(&wal->gate);
+	
+	
+	return saved;
+	
+}
+
+
+
+void avl_walCrash(struct AVLtree* tree, long bytes){
+	
+	if(!tree->wal) return;
+	
+	pthread_mutex_lock(&tree->wal->lock);
+	tree->wal->crash = bytes;
+	pthread_mutex_unlock(&tree->wal->lock);
+	
+}
+
+
+
+/* 	Loads every root of a checkpoint into an empty tree, in order, each one all at once,
+	with datas copied into heap. Returns the sequence the checkpoint holds, or -1 on failure */
+static long long avl_walLoad(struct AVLtree* tree, const char* path, size_t width){
+	
+	struct AVLmapped *mapped;
+	union AVLkey *keys;
+	const char *types = "iudc";
+	void **ID, **data;
+	long long sequence;
+	long j, n;
+	int i;
+	
+	
+	/* No checkpoint at all is an empty tree, but one that can't be mapped is a failure */
+	if(access(path, F_OK)) return (errno == ENOENT) ? 0 : -1;
+	if(!(mapped = avl_openMapped(path))) return -1;
+	if(mapped->width != width){
+		avl_closeMapped(mapped);
+		return -1;
+	}
+	
+	
+	for(i = 0; i < 4; i++){
+		n = avl_mappedRoot(mapped, types[i])->size;
+		ID = malloc((n+1)*sizeof(void*));
+		data = malloc((n+1)*sizeof(void*));
+		keys = malloc((n+1)*sizeof(union AVLkey));
+		avl_mappedTraverse(mapped, types[i], ID, data, n);
+	
+		for(j = 0; j < n; j++){
+			keys[j] = (types[i] == 'c') ? avl_stringKey(ID[j]) : *(union AVLkey*)ID[j];
+			data[j] = width ? memcpy(malloc(width), data[j], width) : NULL;
+		}
+		avl_bulkLoadKeys(tree, types[i], keys, sizeof(union AVLkey), data, n);
+	
+		free(ID);
+		free(data);
+		free(keys);
+	}
+	
+	
+	sequence = ((struct AVLimage*)mapped->image)->sequence;
+	avl_closeMapped(mapped);
+	
+	
+	return sequence;
+	
+}
+
+
+
+/* 	Removes, from a multimap, the first data of key whose width bytes are those logged,
+	or the first NULL one, if none were, since the ones it was inserted with are copies */
+static void avl_walRemoveOne(struct AVLtree* tree, char type, union AVLkey key, const char* bytes, size_t width){
+	
+	struct AVLtree_sub *node = avl_searchKey(tree, type, key);
+	struct AVLvalues *values;
+	long i;
+	if(!node || !(tree->options & AVL_MULTIMAP)) return;
+	
+	
+	values = node->data;
+	for(i = 0; i < values->count; i++)
+		if(bytes ? values->data[i] && !memcmp(values->data[i], bytes, width) : !values->data[i]) break;
+	
+	if(i < values->count) avl_removeValue(tree, type, key, values->data[i]);
+	
+}
+
+
+
+/* 	Replays onto tree every record of a log, from offset on, past sequence, up to the
+	first one cut short or torn. Returns the offset right after the last whole record */
+static size_t avl_walReplay(struct AVLtree* tree, struct AVLwal* wal, const char* log, size_t length, size_t offset){
+	
+	struct AVLwalRecord record;
+	const char *payload;
+	union AVLkey key;
+	unsigned long long last = 0;
+	
+	
+	while(length - offset >= sizeof(struct AVLwalRecord)){
+	
+		/* A record must be whole, hash right and come right after the previous one */
+		memcpy(&record, log + offset, sizeof(struct AVLwalRecord));
+		payload = log + offset + sizeof(struct AVLwalRecord);
+		if(record.length > length - offset - sizeof(struct AVLwalRecord)
+		   || record.width > length - offset - sizeof(struct AVLwalRecord) - record.length
+		   || record.checksum != avl_walChecksum(record, payload)
+		   || (last && record.sequence != last+1)
+		   || (record.width && record.width != wal->width)
+		   || !memchr("iro", record.op, 3)
+		   || !memchr("iudc", record.type, 4)
+		   || (record.type == 'c' ? !record.length || payload[record.length-1] : record.length != sizeof(union AVLkey)))
+			break;
+		last = record.sequence;
+		offset += sizeof(struct AVLwalRecord) + record.length + record.width;
+	
+	
+		/* Records the checkpoint already holds are skipped */
+		if(record.sequence <= wal->sequence) continue;
+		wal->sequence = record.sequence;
+	
+		if(record.type == 'c') key = avl_stringKey((char*)payload);
+		else memcpy(&key, payload, sizeof(union AVLkey));
+	
+		if(record.op == 'i')
+			avl_insertKey(tree, record.type, key, record.width ? memcpy(malloc(record.width), payload + record.length, record.width) : NULL);
+		else if(record.op == 'o')
+			avl_walRemoveOne(tree, record.type, key, record.width ? payload + record.length : NULL, record.width);
+		else avl_removeKey(tree, record.type, key);
+	
+	}
+	
+	
+	return offset;
+	
+}
+
+
+
+/* Reads the whole log's file into heap. Returns NULL on failure */
+static char* avl_walRead(int fd, size_t* length){
+	
+	struct stat status;
+	ssize_t r;
+	size_t c = 0;
+	char *log;
+	
+	
+	if(fstat(fd, &status)) return NULL;
+	*length = status.st_size;
+	log = malloc(*length + 1);
+	
+	while(c < *length){
+		if((r = read(fd, log + c, *length - c)) <= 0){
+			if(r < 0 && errno == EINTR) continue;
+			free(log);
+			return NULL;
+		}
+		c += r;
+	}
+	
+	
+	return log;
+	
+}
+
+
+
+struct AVLtree* avl_openDurable(const char* path, int options, size_t width, long group, long interval){
+	
+	struct AVLtree *tree = avl_createTreeEx(options);
+	struct AVLwalHeader header = {AVL_WAL_MAGIC, width};
+	struct AVLwal *wal = calloc(1, sizeof(struct AVLwal));
+	pthread_rwlockattr_t attr;
+	long long sequence;
+	size_t length, end;
+	char *log = NULL;
+	
+	
+	wal->path = strcpy(malloc(strlen(path) + 1), path);
+	wal->log = malloc(strlen(path) + 5);
+	sprintf(wal->log, "%s.log", path);
+	wal->width = width;
+	wal->group = group;
+	wal->interval = interval;
+	wal->crash = -1;
+	wal->fd = -1;
+	
+	
+	/* 	Loads the checkpoint, if any, then reads the log, if any, writing its header into
+		a new one. An existing one must have been written with the same width */
+	if((sequence = avl_walLoad(tree, path, width)) < 0
+	   || (wal->fd = open(wal->log, O_RDWR | O_CREAT, 0644)) < 0
+	   || !(log = avl_walRead(wal->fd, &length))
+	   || (!length && !avl_walWrite(wal, wal->fd, (const char*)&header, sizeof(struct AVLwalHeader)))
+	   || (length && (length < sizeof(struct AVLwalHeader) || memcmp(log, &header, sizeof(struct AVLwalHeader))))){
+		if(wal->fd >= 0) close(wal->fd);
+		free(log);
+		free(wal->path);
+		free(wal->log);
+		free(wal);
+		avl_free(tree);
+		return NULL;
+	}
+	
+	
+	/* 	Replays the log past the checkpoint, then cuts off whatever a crash left
+		after its last whole record, so new records are appended right after it */
+	wal->sequence = sequence;
+	if(length){
+		end = avl_walReplay(tree, wal, log, length, sizeof(struct AVLwalHeader));
+		if(end < length && ftruncate(wal->fd, end)) wal->failed = 1;
+		lseek(wal->fd, end, SEEK_SET);
+	}
+	free(log);
+	wal->durable = wal->sequence;
+	wal->checkpointed = sequence;
+	
+	
+	/* Buffers start small and grow as needed */
+	wal->size = wal->spareSize = 4096;
+	wal->buffer = malloc(wal->size);
+	wal->spare = malloc(wal->spareSize);
+	pthread_mutex_init(&wal->lock, NULL);
+	pthread_cond_init(&wal->flushed, NULL);
+	
+	
+	/* 	Checkpoints go first, so a stream of changes can't keep them waiting forever */
+	pthread_rwlockattr_init(&attr);
+#ifdef __GLIBC__
+	pthread_rwlockattr_setkind_np(&attr, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+#endif
+	pthread_rwlock_init(&wal->gate, &attr);
+	pthread_rwlockattr_destroy(&attr);
+	
+	
+	/* Changes are only logged from now on, so replaying didn't log them again */
+	tree->wal = wal;
+	
+	
+	return tree;
+	
+}
+
+
+
+void avl_walClose(struct AVLwal* wal){
+	
+	if(!wal) return;
+	
+	
+	pthread_mutex_lock(&wal->lock);
+	avl_walFlush(wal, 1);
+	pthread_mutex_unlock(&wal->lock);
+	
+	close(wal->fd);
+	pthread_mutex_destroy(&wal->lock);
+	pthread_cond_destroy(&wal->flushed);
+	pthread_rwlock_destroy(&wal->gate);
+	free(wal->buffer);
+	free(wal->spare);
+	free(wal->path);
+	free(wal->log);
+	free(wal);
+	
+}
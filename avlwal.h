@@ -0,0 +1,429 @@
+#ifndef __AVL_WAL__
+#define __AVL_WAL__
+
+
+
+#include <pthread.h>
+
+#include "avltree.h"
+
+
+
+/* First 8 bytes of a durable super avl tree's log, "AVLWAL01", which tell it from anything else */
+#define AVL_WAL_MAGIC	0x31304c41574c5641ULL
+
+/* Bytes of records a log keeps in memory before writing them into its file, even with no commit */
+#define AVL_WAL_BUFFER	65536
+
+
+
+
+
+/**	@Description
+ *		This structure is the header of a durable super
+ *		avl tree's log, at the very start of its file.
+ *
+ *	@Members
+ *		unsigned long long magic:	AVL_WAL_MAGIC;
+ *
+ *		unsigned long long width:	how many bytes of each data its records hold.
+ *
+ */
+struct AVLwalHeader{
+	
+	unsigned long long magic;
+	unsigned long long width;
+	
+};
+
+
+/**	@Description
+ *		This structure is a record of a durable super avl
+ *		tree's log: one insertion or removal, followed by
+ *		the identifier, then the data, if any.
+ *
+ *		Records are only ever appended, so a crash may at
+ *		most leave the last ones cut short, which their
+ *		checksums tell, and recovery stops right before.
+ *
+ *	@Members
+ *		unsigned long long sequence:	the change's number, one more than the previous
+ *										record's, counting from the tree's creation;
+ *
+ *		unsigned int checksum:			FNV-1a hash of the record, with this member as 0,
+ *										and of what follows it;
+ *
+ *		unsigned int length:			how many bytes the identifier takes: a whole
+ *										AVLkey union for numbers, or the string along
+ *										with its terminating '\0';
+ *
+ *		unsigned int width:				how many bytes the data takes, the log's width,
+ *										or 0 for removals and NULL datas;
+ *
+ *		char op:						'i' for an insertion, 'r' for a removal, 'o'
+ *										for a removal of one of a multimap's datas,
+ *										told apart by its bytes;
+ *
+ *		char type:						root type, as given by avl_getKeyType();
+ *
+ *		char padding[2]:				zeros.
+ *
+ */
+struct AVLwalRecord{
+	
+	unsigned long long sequence;
+	unsigned int checksum;
+	unsigned int length;
+	unsigned int width;
+	char op;
+	char type;
+	char padding[2];
+	
+};
+
+
+/**	@Description
+ *		This structure is the write-ahead log of a durable
+ *		super avl tree, opened by avl_openDurable(): a file
+ *		records are appended to, along with a checkpoint, an
+ *		image saved by avl_save(), so the tree is recovered
+ *		by mapping the image and replaying whatever the log
+ *		holds past it.
+ *
+ *		Records are put into a buffer under the root's lock,
+ *		so they're in the same order as the changes they
+ *		stand for, and written into the file by whichever
+ *		thread commits first, while others wait for it and
+ *		append into a second buffer meanwhile: a single
+ *		fsync() then makes every record of every thread that
+ *		was waiting durable at once, i.e. group commit.
+ *
+ *	@Members
+ *		char* path:							the checkpoint's file, allocated on heap;
+ *
+ *		char* log:							the log's file, path with ".log" appended,
+ *											allocated on heap;
+ *
+ *		int fd:								the log's file descriptor;
+ *
+ *		size_t width:						how many bytes of each data are logged;
+ *
+ *		long group:							how many records a writer lets pile up before
+ *											committing them itself, 0 for only avl_walCommit();
+ *
+ *		long interval:						how many records a writer lets pile up past the
+ *											checkpoint before writing a new one, 0 for only
+ *											avl_checkpoint();
+ *
+ *		char* buffer:						records not yet written, allocated on heap;
+ *
+ *		size_t used:						how many bytes of buffer they take;
+ *
+ *		size_t size:						how many bytes buffer holds;
+ *
+ *		char* spare:						the other buffer, being written by a commit
+ *											while records go into buffer;
+ *
+ *		size_t spareSize:					how many bytes spare holds;
+ *
+ *		unsigned long long sequence:		the last record's sequence;
+ *
+ *		unsigned long long durable:			the last sequence whose record, or the
+ *											checkpoint holding it, reached the disk;
+ *
+ *		unsigned long long checkpointed:	the last sequence the checkpoint holds;
+ *
+ *		long pending:						records put into buffer since the last commit;
+ *
+ *		int flushing:						whether a commit or checkpoint is writing;
+ *
+ *		int failed:							whether a write failed, or a crash was injected.
+ *											Nothing reaches the file afterwards, nor the
+ *											buffer;
+ *
+ *		long crash:							how many bytes may still be written before an
+ *											injected crash, or -1 if none is;
+ *
+ *		pthread_mutex_t lock:				protects everything above;
+ *
+ *		pthread_cond_t flushed:				signaled whenever a commit is over;
+ *
+ *		pthread_rwlock_t gate:				taken shared by every change being logged, and
+ *											alone by checkpoints, so no change is halfway
+ *											through while one is saved.
+ *
+ */
+struct AVLwal{
+	
+	char *path;
+	char *log;
+	int fd;
+	size_t width;
+	long group;
+	long interval;
+	char *buffer;
+	size_t used;
+	size_t size;
+	char *spare;
+	size_t spareSize;
+	unsigned long long sequence;
+	unsigned long long durable;
+	unsigned long long checkpointed;
+	long pending;
+	int flushing;
+	int failed;
+	long crash;
+	pthread_mutex_t lock;
+	pthread_cond_t flushed;
+	pthread_rwlock_t gate;
+	
+};
+
+
+
+
+
+/**	@Functionality
+ *		Opens a durable super avl tree, created with the
+ *		given options: maps the checkpoint at path, if
+ *		there's any, loads its roots, and replays on them
+ *		every change of the log at path.log after it, up
+ *		to its first cut short record, which a crash left,
+ *		and which is dropped along with whatever follows.
+ *		With neither file, the tree starts empty.
+ *
+ *		From then on, every insertion and removal through
+ *		avl_insert(), avl_remove() and avl_removeOne(),
+ *		bulk loads included, is appended to the log, though
+ *		only made durable by a commit: avl_walCommit(), or
+ *		every group records.
+ *		Every interval records, a checkpoint is written and
+ *		the log starts over, so it never takes long to replay.
+ *
+ *		Every node avl_removeNode() removes, such as an
+ *		iterator's, is logged as well, and avl_writeLock()
+ *		on a concurrent tree keeps checkpoints out until
+ *		it's unlocked.
+ *		Splits, joins and set operations aren't logged, but
+ *		keep every other change out while they're done, and
+ *		save a checkpoint right after, before they return.
+ *
+ *		Datas are opaque to the tree, so the first width
+ *		bytes each one points to are logged, and recovered
+ *		into heap allocated copies, as the tree frees them.
+ *		With width 0, datas are recovered as NULL.
+ *
+ *		The tree is freed as usual, with avl_free(), which
+ *		commits its log beforehand.
+ *
+ *	@Arguments
+ *		const char* path:	the checkpoint's file, beside which the log is kept;
+ *
+ *		int options:		options to create the tree with, as avl_createTreeEx();
+ *
+ *		size_t width:		how many bytes of each data are logged, which must be
+ *							the same the files were written with;
+ *
+ *		long group:			records to commit at once, 0 for only avl_walCommit();
+ *
+ *		long interval:		records between checkpoints, 0 for only avl_checkpoint().
+ *
+ *	@Return
+ *		On success:	a pointer to an AVLtree structure, a super avl tree, allocated on heap
+ *
+ *		On failure:	NULL (if the files can't be opened, or weren't written
+ *					with the same width, or by this kind of machine)
+ *
+ */
+struct AVLtree* avl_openDurable(const char* path, int options, size_t width, long group, long interval);
+
+
+
+/**	@Functionality
+ *		Makes every change logged so far durable, waiting
+ *		for it. Threads committing at once share the same
+ *		write and fsync(), whichever goes first doing it
+ *		for the others.
+ *
+ *	@Argument
+ *		struct AVLtree* tree:	a pointer to an AVLtree structure, as given by
+ *								avl_openDurable().
+ *
+ *	@Return
+ *		On success:	1
+ *
+ *		On failure:	0 (if the tree isn't durable, or its log couldn't be written)
+ *
+ */
+int avl_walCommit(struct AVLtree* tree);
+
+
+
+/**	@Functionality
+ *		Saves a durable super avl tree's whole image, by
+ *		avl_save(), over its checkpoint, then starts its
+ *		log over. Changes wait for it to be over, while
+ *		searches go on.
+ *
+ *		A crash before the image is renamed over the old
+ *		one recovers from the old one and the old log; one
+ *		after recovers from the new one, skipping whatever
+ *		records of the old log it already holds.
+ *
+ *	@Argument
+ *		struct AVLtree* tree:	a pointer to an AVLtree structure, as given by
+ *								avl_openDurable().
+ *
+ *	@Return
+ *		On success:	1
+ *
+ *		On failure:	0 (if the tree isn't durable, or the files couldn't be written)
+ *
+ */
+int avl_checkpoint(struct AVLtree* tree);
+
+
+
+/**	@Functionality
+ *		Injects a crash into a durable super avl tree's log,
+ *		for testing: once bytes more bytes are written, the
+ *		write in progress is cut short and nothing else
+ *		reaches the files, as if the machine lost power.
+ *		Commits and checkpoints fail from then on.
+ *
+ *		Freeing the tree, then opening it again, recovers
+ *		whatever was durable.
+ *
+ *	@Arguments
+ *		struct AVLtree* tree:	a pointer to an AVLtree structure, as given by
+ *								avl_openDurable();
+ *
+ *		long bytes:				how many bytes of records may still be written.
+ *
+ *	@Return
+ *		None
+ *
+ */
+void avl_walCrash(struct AVLtree* tree, long bytes);
+
+
+
+/**	@Functionality
+ *		Appends a record of an insertion or removal to a
+ *		durable super avl tree's log, in memory only. It's
+ *		called with the root's lock held, so records keep
+ *		the same order as changes do.
+ *
+ *		This is a helper function of avl_insertKey(),
+ *		avl_bulkLoadKeys(), avl_removeKey() and
+ *		avl_removeValue() functions.
+ *
+ *	@Arguments
+ *		struct AVLwal* wal:		a pointer to an AVLwal structure;
+ *
+ *		char op:				'i' for an insertion, 'r' for a removal, 'o' for
+ *								a removal of one of a multimap's datas;
+ *
+ *		char type:				root type, as given by avl_getKeyType();
+ *
+ *		union AVLkey key:		the identifier, as given by avl_toKey();
+ *
+ *		void* data:				pointer to the data inserted along with it, or NULL.
+ *
+ *	@Return
+ *		None
+ *
+ */
+void avl_walLog(struct AVLwal* wal, char op, char type, union AVLkey key, void* data);
+
+
+
+/**	@Functionality
+ *		Lets a change out of a durable super avl tree's
+ *		gate, taken before its root's lock, then commits
+ *		and checkpoints, if it's due, with no lock held.
+ *
+ *		This is a helper function of avl_insertKey(),
+ *		avl_bulkLoadKeys(), avl_removeKey() and
+ *		avl_removeValue() functions.
+ *
+ *	@Argument
+ *		struct AVLtree* tree:	a pointer to an AVLtree structure, whose log
+ *								gate is held shared.
+ *
+ *	@Return
+ *		None
+ *
+ */
+void avl_walLeave(struct AVLtree* tree);
+
+
+
+/**	@Functionality
+ *		Saves a checkpoint of a durable super avl tree
+ *		after a change that isn't logged, then lets other
+ *		changes in again, out of the gate avl_walExclude()
+ *		kept them out with.
+ *		If it can't be saved, nothing else reaches the log
+ *		either, so whatever it recovers is still some state
+ *		the tree went through.
+ *
+ *		This is a helper function of avl_splitRoot(),
+ *		avl_joinRoot(), avl_union(), avl_intersect() and
+ *		avl_difference() functions.
+ *
+ *	@Argument
+ *		struct AVLtree* tree:	a pointer to an AVLtree structure, whose log
+ *								gate is held alone, and none of its roots.
+ *
+ *	@Return
+ *		On success:	1
+ *
+ *		On failure:	0 (if the checkpoint couldn't be written)
+ *
+ */
+int avl_walResume(struct AVLtree* tree);
+
+
+
+/**	@Functionality
+ *		Commits a durable super avl tree's log, then closes
+ *		and frees it. The tree itself is left untouched.
+ *
+ *		This is a helper function of avl_free() function.
+ *
+ *	@Argument
+ *		struct AVLwal* wal:	a pointer to an AVLwal structure, or NULL.
+ *
+ *	@Return
+ *		None
+ *
+ */
+void avl_walClose(struct AVLwal* wal);
+
+
+
+
+
+/* Lets a change of a durable super avl tree into its log's gate, keeping checkpoints out until it leaves */
+static inline void avl_walEnter(struct AVLwal* wal){
+	pthread_rwlock_rdlock(&wal->gate);
+}
+
+
+
+/* Lets a change of a durable super avl tree out of its log's gate, leaving commits and checkpoints to others */
+static inline void avl_walExit(struct AVLwal* wal){
+	pthread_rwlock_unlock(&wal->gate);
+}
+
+
+
+/* Keeps every other change of a durable super avl tree out of its log's gate, as a checkpoint does */
+static inline void avl_walExclude(struct AVLwal* wal){
+	pthread_rwlock_wrlock(&wal->gate);
+}
+
+
+
+#endif
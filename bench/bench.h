@@ -0,0 +1,73 @@
+#ifndef __AVL_BENCH__
+#define __AVL_BENCH__
+
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+
+
+/* Gets the seconds passed since some fixed point, monotonically, to time runs by */
+static inline double avl_benchNow(void){
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec + now.tv_nsec/1e9;
+}
+
+
+
+/* Gets the next pseudo random number of a xorshift state, which must not start at 0, so runs can be repeated */
+static inline unsigned long long avl_benchRandom(unsigned long long* state){
+	*state ^= *state << 13;
+	*state ^= *state >> 7;
+	*state ^= *state << 17;
+	return *state;
+}
+
+
+
+/* Gets the benchmark's i-th argument as a count, or fallback if it wasn't given */
+static inline long avl_benchArgument(int argc, char** argv, int i, long fallback){
+	return (i < argc) ? atol(argv[i]) : fallback;
+}
+
+
+
+/**	@Functionality
+ *		Gets n distinct long long identifiers, 0 to n - 1,
+ *		in random order, so trees are loaded and searched
+ *		the same way every run.
+ *
+ *	@Arguments
+ *		long n:						how many identifiers to get;
+ *
+ *		unsigned long long seed:	the xorshift state to shuffle them with, not 0.
+ *
+ *	@Return
+ *		An array of n long long identifiers, allocated on heap
+ *
+ */
+static inline long long* avl_benchKeys(long n, unsigned long long seed){
+	
+	long long *keys = malloc(n*sizeof(long long)), swap;
+	long i, j;
+	
+	
+	for(i = 0; i < n; i++) keys[i] = i;
+	for(i = n - 1; i > 0; i--){
+		j = avl_benchRandom(&seed) % (i + 1);
+		swap = keys[i];
+		keys[i] = keys[j];
+		keys[j] = swap;
+	}
+	
+	
+	return keys;
+	
+}
+
+
+
+#endif
@@ -0,0 +1,132 @@
+/* Barriers and clock_gettime() are POSIX, which strict C11 headers leave out */
+#define _XOPEN_SOURCE 700
+
+#include <pthread.h>
+
+#include "../avltree.h"
+#include "bench.h"
+
+
+
+/* Most threads run at once, doubling from 1 */
+#define THREADS	32
+
+
+
+/* A thread searching and changing a shared tree, all of them started at once */
+struct Worker{
+	
+	struct AVLtree *tree;
+	pthread_barrier_t *start;
+	long index;
+	long threads;
+	long keys;
+	long ops;
+	int writes;
+	
+};
+
+
+
+/* 	Does worker's ops, writes percent of them changes, the rest searches for random IDs.
+	A change removes one of the IDs only this worker changes, and inserts it right back,
+	so the tree keeps its size, and no two workers ever insert the same ID */
+static void* work(void* arg){
+	
+	struct Worker *worker = arg;
+	unsigned long long state = 0x9e3779b97f4a7c15ULL*(worker->index + 1);
+	long long key;
+	long i, share = worker->keys/worker->threads;
+	void *data;
+	
+	
+	pthread_barrier_wait(worker->start);
+	for(i = 0; i < worker->ops; i++){
+		if((long)(avl_benchRandom(&state) % 100) < worker->writes){
+			key = worker->index + worker->threads*(long long)(avl_benchRandom(&state) % share);
+			avl_remove(worker->tree, key);
+			avl_insert(worker->tree, NULL, key);
+		} else {
+			key = avl_benchRandom(&state) % worker->keys;
+			avl_search(worker->tree, key, data);
+		}
+	}
+	
+	
+	(void)data;
+	return NULL;
+	
+}
+
+
+
+/* Runs threads workers at once on tree, and gets how many millions of operations they did per second */
+static double run(struct AVLtree* tree, long threads, long keys, long ops, int writes){
+	
+	struct Worker workers[THREADS];
+	pthread_t ids[THREADS];
+	pthread_barrier_t start;
+	double begin;
+	long i;
+	
+	
+	pthread_barrier_init(&start, NULL, threads + 1);
+	for(i = 0; i < threads; i++){
+		workers[i] = (struct Worker){tree, &start, i, threads, keys, ops, writes};
+		pthread_create(&ids[i], NULL, work, &workers[i]);
+	}
+	
+	pthread_barrier_wait(&start);
+	begin = avl_benchNow();
+	for(i = 0; i < threads; i++) pthread_join(ids[i], NULL);
+	pthread_barrier_destroy(&start);
+	
+	
+	return threads*ops/(avl_benchNow() - begin)/1e6;
+	
+}
+
+
+
+/* 	Throughput of a concurrent tree's engines, read only, read mostly and mixed, from 1 to
+	THREADS threads: ./concurrent [keys] [operations per thread] */
+int main(int argc, char** argv){
+	
+	const char *names[] = {"avl", "rcu", "btree"};
+	const int options[] = {AVL_CONCURRENT, AVL_RCU, AVL_ENGINE_BTREE | AVL_CONCURRENT};
+	const int writes[] = {0, 5, 50};
+	long keys = avl_benchArgument(argc, argv, 1, 1000000);
+	long ops = avl_benchArgument(argc, argv, 2, 400000);
+	long long *loaded = avl_benchKeys(keys, 1);
+	struct AVLtree *tree;
+	long threads;
+	int i, j;
+	
+	
+	printf("%ld keys, %ld random ops per thread, Mops/s at 1 to %d threads\n\n", keys, ops, THREADS);
+	printf("%-6s %7s", "engine", "writes");
+	for(threads = 1; threads <= THREADS; threads *= 2) printf(" %6ld", threads);
+	printf("\n");
+	
+	
+	/* Each mix gets a freshly loaded tree, whose size its writers keep from run to run */
+	for(i = 0; i < 3; i++){
+		for(j = 0; j < 3; j++){
+			tree = avl_createTreeEx(options[i]);
+			avl_bulkLoad(tree, loaded, NULL, keys);
+	
+			printf("%-6s %6d%%", names[i], writes[j]);
+			for(threads = 1; threads <= THREADS; threads *= 2){
+				printf(" %6.2f", run(tree, threads, keys, ops, writes[j]));
+				fflush(stdout);
+			}
+			printf("\n");
+			avl_free(tree);
+		}
+	}
+	
+	
+	free(loaded);
+	return 0;
+	
+}
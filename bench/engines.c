@@ -0,0 +1,77 @@
+/* clock_gettime() is POSIX, which strict C11 headers leave out */
+#define _XOPEN_SOURCE 700
+
+#include "../avltree.h"
+#include "bench.h"
+
+
+
+/* Operations timed at least, so small trees are built, searched and traversed over and over */
+#define MINIMUM	1000000
+
+
+
+/* 	Times inserting n random long long keys one by one into a tree of the given engine,
+	searching as many random ones, and traversing it whole, and prints nanoseconds each
+	operation took, per key for traversals. Small trees are timed over several rounds */
+static void measure(const char* name, int engine, const long long* keys, long n){
+	
+	struct AVLtree *tree = NULL;
+	unsigned long long state = 2;
+	long i, round, rounds = (n < MINIMUM) ? MINIMUM/n : 1;
+	void **ID = malloc(n*sizeof(void*)), *data;
+	double insert = 0, search, traverse, begin;
+	
+	
+	for(round = 0; round < rounds; round++){
+		if(tree) avl_free(tree);
+		tree = avl_createTreeEx(engine);
+		begin = avl_benchNow();
+		for(i = 0; i < n; i++) avl_insert(tree, NULL, keys[i]);
+		insert += avl_benchNow() - begin;
+	}
+	
+	begin = avl_benchNow();
+	for(i = 0; i < rounds*n; i++) avl_search(tree, (long long)(avl_benchRandom(&state) % n), data);
+	search = avl_benchNow() - begin;
+	
+	begin = avl_benchNow();
+	for(round = 0; round < rounds; round++) avl_traverseRoot(tree, 'i', ID, NULL, n);
+	traverse = avl_benchNow() - begin;
+	
+	
+	printf("%-10ld %-6s %8.1f %8.1f %9.1f\n", n, name, insert*1e9/(rounds*n), search*1e9/(rounds*n), traverse*1e9/(rounds*n));
+	fflush(stdout);
+	avl_free(tree);
+	free(ID);
+	(void)data;
+	
+}
+
+
+
+/* 	Compares the avl and B+ tree engines on random long long keys, in ns/op, at each
+	size given, 1K, 1M and 50M keys by default: ./engines [keys...] */
+int main(int argc, char** argv){
+	
+	const long sizes[] = {1000, 1000000, 50000000};
+	long long *keys;
+	long n;
+	int i, count = (argc > 1) ? argc - 1 : 3;
+	
+	
+	printf("%-10s %-6s %8s %8s %9s\n", "keys", "engine", "insert", "search", "traverse");
+	for(i = 0; i < count; i++){
+		n = (argc > 1) ? avl_benchArgument(argc, argv, i + 1, 0) : sizes[i];
+		if(n <= 0) continue;
+	
+		keys = avl_benchKeys(n, 1);
+		measure("avl", AVL_ENGINE_AVL, keys, n);
+		measure("btree", AVL_ENGINE_BTREE, keys, n);
+		free(keys);
+	}
+	
+	
+	return 0;
+	
+}
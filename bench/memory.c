@@ -0,0 +1,145 @@
+/* clock_gettime() is POSIX, which strict C11 headers leave out */
+#define _XOPEN_SOURCE 700
+
+#include <malloc.h>
+#include <string.h>
+
+#include "../avltree.h"
+#include "bench.h"
+
+
+
+/* Gets how many bytes of heap are in use, mapped blocks included, as glibc's mallinfo2() tells */
+static size_t heap(void){
+	struct mallinfo2 info = mallinfo2();
+	return info.uordblks + info.hblkhd;
+}
+
+
+
+/* 	A node as avl trees had them before they were taken from slabs and kept IDs within:
+	a heap block of its own, its ID in another one, and an empty leaf node for each root */
+struct AVLbaseline{
+	
+	void *ID;
+	void *data;
+	char isLeaf;
+	char balance;
+	struct AVLbaseline *Lchild;
+	struct AVLbaseline *Rchild;
+	struct AVLbaseline *parent;
+	
+};
+
+
+
+/* 	Makes the heap blocks the baseline layout took for n keys, as strings if strings isn't
+	NULL, then frees every other one, and prints bytes per entry as measure() does. Since
+	links don't change what's allocated, nodes aren't linked into a tree */
+static void baseline(const char* name, const long long* keys, char** strings, long n){
+	
+	struct AVLbaseline **nodes = malloc(n*sizeof(struct AVLbaseline*)), *roots[4];
+	size_t before = heap();
+	double full;
+	long i;
+	
+	
+	for(i = 0; i < 4; i++){
+		roots[i] = calloc(1, sizeof(struct AVLbaseline));
+		roots[i]->isLeaf = 1;
+		roots[i]->parent = roots[i];
+	}
+	for(i = 0; i < n; i++){
+		nodes[i] = calloc(1, sizeof(struct AVLbaseline));
+		if(strings) nodes[i]->ID = strcpy(calloc(strlen(strings[i])+1, 1), strings[i]);
+		else nodes[i]->ID = memcpy(calloc(1, sizeof(long long)), &keys[i], sizeof(long long));
+	}
+	full = (double)(heap() - before)/n;
+	
+	for(i = 0; i < n; i += 2){
+		free(nodes[i]->ID);
+		free(nodes[i]);
+	}
+	
+	
+	printf("%-14s %8.1f %8.1f\n", name, full, (double)(heap() - before)/(n/2));
+	fflush(stdout);
+	for(i = 1; i < n; i += 2){
+		free(nodes[i]->ID);
+		free(nodes[i]);
+	}
+	for(i = 0; i < 4; i++) free(roots[i]);
+	free(nodes);
+	
+}
+
+
+
+/* 	Inserts n keys one by one into a tree created with options, as strings if strings
+	isn't NULL, then removes every other one, and prints how many bytes of heap the tree
+	takes per entry it holds each time, IDs and all, though no data */
+static void measure(const char* name, int options, const long long* keys, char** strings, long n){
+	
+	struct AVLtree *tree;
+	size_t before = heap();
+	double full;
+	long i;
+	
+	
+	tree = avl_createTreeEx(options);
+	for(i = 0; i < n; i++){
+		if(strings) avl_insert(tree, NULL, strings[i]);
+		else avl_insert(tree, NULL, keys[i]);
+	}
+	full = (double)(heap() - before)/n;
+	
+	for(i = 0; i < n; i += 2){
+		if(strings) avl_remove(tree, strings[i]);
+		else avl_remove(tree, keys[i]);
+	}
+	
+	
+	printf("%-14s %8.1f %8.1f\n", name, full, (double)(heap() - before)/(n/2));
+	fflush(stdout);
+	avl_free(tree);
+	
+}
+
+
+
+/* 	Heap bytes per entry of each engine and index, and of the baseline layout, for random
+	long long keys and for strings of 24 bytes, 1M of them by default: ./memory [keys] */
+int main(int argc, char** argv){
+	
+	long n = avl_benchArgument(argc, argv, 1, 1000000);
+	long long *keys;
+	char **strings;
+	long i;
+	if(n < 2) return 1;
+	
+	
+	keys = avl_benchKeys(n, 1);
+	strings = malloc(n*sizeof(char*));
+	for(i = 0; i < n; i++){
+		strings[i] = malloc(32);
+		sprintf(strings[i], "item/%019lld", keys[i]);
+	}
+	
+	printf("%ld keys, heap bytes per entry\n\n", n);
+	printf("%-14s %8s %8s\n", "", "full", "halved");
+	baseline("baseline", keys, NULL, n);
+	measure("avl", AVL_ENGINE_AVL, keys, NULL, n);
+	measure("btree", AVL_ENGINE_BTREE, keys, NULL, n);
+	measure("avl hashed", AVL_HASH_INDEX, keys, NULL, n);
+	baseline("base strings", NULL, strings, n);
+	measure("avl strings", AVL_ENGINE_AVL, NULL, strings, n);
+	measure("arena strings", AVL_STRING_ARENA, NULL, strings, n);
+	printf("\navl node: %zu bytes, baseline node: %zu bytes\n", sizeof(struct AVLtree_sub), sizeof(struct AVLbaseline));
+	
+	
+	for(i = 0; i < n; i++) free(strings[i]);
+	free(strings);
+	free(keys);
+	return 0;
+	
+}
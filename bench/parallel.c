@@ -0,0 +1,75 @@
+/* clock_gettime() is POSIX, which strict C11 headers leave out */
+#define _XOPEN_SOURCE 700
+
+#include "../avlpool.h"
+#include "../avltree.h"
+#include "bench.h"
+
+
+
+/* Most workers a pool is given, doubling from 1 */
+#define WORKERS	8
+
+
+
+/* 	Times loading n sorted keys into an empty tree, traversing it whole, then freeing it,
+	sequentially if pool is NULL, or among its workers otherwise, and prints milliseconds
+	each one took */
+static void measure(const char* name, const long long* keys, long n, struct AVLpool* pool){
+	
+	struct AVLtree *tree = avl_createTree();
+	void **ID = malloc(n*sizeof(void*));
+	double load, traverse, begin;
+	
+	
+	begin = avl_benchNow();
+	if(pool) avl_parallelBulkLoad(tree, keys, NULL, n, pool);
+	else avl_bulkLoad(tree, keys, NULL, n);
+	load = avl_benchNow() - begin;
+	
+	begin = avl_benchNow();
+	if(pool) avl_parallelTraverse(tree, ID, NULL, n, (long long)0, pool);
+	else avl_traverseRoot(tree, 'i', ID, NULL, n);
+	traverse = avl_benchNow() - begin;
+	
+	begin = avl_benchNow();
+	if(pool) avl_parallelFree(tree, pool);
+	else avl_free(tree);
+	
+	
+	printf("%-12s %8.0f %9.0f %6.0f\n", name, load*1e3, traverse*1e3, (avl_benchNow() - begin)*1e3);
+	fflush(stdout);
+	free(ID);
+	
+}
+
+
+
+/* 	Scaling of the thread pool's bulk load, traversal and free, on sorted long long keys,
+	4M by default, from 1 to WORKERS workers, next to the sequential ones: ./parallel [keys] */
+int main(int argc, char** argv){
+	
+	long i, n = avl_benchArgument(argc, argv, 1, 4000000);
+	long long *keys = malloc(n*sizeof(long long));
+	struct AVLpool *pool;
+	char name[32];
+	int workers;
+	
+	
+	for(i = 0; i < n; i++) keys[i] = i;
+	printf("%ld sorted keys, ms\n\n", n);
+	printf("%-12s %8s %9s %6s\n", "", "load", "traverse", "free");
+	measure("sequential", keys, n, NULL);
+	
+	for(workers = 1; workers <= WORKERS; workers *= 2){
+		pool = avl_createPool(workers);
+		sprintf(name, "%d worker%s", workers, workers > 1 ? "s" : "");
+		measure(name, keys, n, pool);
+		avl_freePool(pool);
+	}
+	
+	
+	free(keys);
+	return 0;
+	
+}
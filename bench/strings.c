@@ -0,0 +1,74 @@
+/* clock_gettime() is POSIX, which strict C11 headers leave out */
+#define _XOPEN_SOURCE 700
+
+#include <string.h>
+
+#include "../avltree.h"
+#include "bench.h"
+
+
+
+/* Prefix every key shares, 60 bytes long, as URLs of the same site's section do */
+#define PREFIX	"https://www.example.com/catalogue/products/department/items/"
+
+
+
+/* 	Times inserting n string keys one by one into a tree created with options, then
+	searching lookups random ones, and prints how long each took, all insertions in
+	milliseconds and each search in nanoseconds */
+static void measure(const char* name, int options, char** keys, long n, long lookups){
+	
+	struct AVLtree *tree = avl_createTreeEx(options);
+	unsigned long long state = 2;
+	double insert, search, begin;
+	void *data;
+	long i;
+	
+	
+	begin = avl_benchNow();
+	for(i = 0; i < n; i++) avl_insert(tree, NULL, keys[i]);
+	insert = avl_benchNow() - begin;
+	
+	begin = avl_benchNow();
+	for(i = 0; i < lookups; i++) avl_search(tree, keys[avl_benchRandom(&state) % n], data);
+	search = avl_benchNow() - begin;
+	
+	
+	printf("%-8s %10.1f %10.1f\n", name, insert*1e3, search*1e9/lookups);
+	fflush(stdout);
+	avl_free(tree);
+	(void)data;
+	
+}
+
+
+
+/* 	Plain string keys against interned ones, all sharing a long prefix, 20K keys
+	and 1M lookups by default: ./strings [keys] [lookups] */
+int main(int argc, char** argv){
+	
+	long n = avl_benchArgument(argc, argv, 1, 20000);
+	long lookups = avl_benchArgument(argc, argv, 2, 1000000);
+	long long *order = avl_benchKeys(n, 1);
+	char **keys = malloc(n*sizeof(char*));
+	long i;
+	
+	
+	/* Keys are numbered past the prefix, and inserted in random order */
+	for(i = 0; i < n; i++){
+		keys[i] = malloc(sizeof(PREFIX) + 16);
+		sprintf(keys[i], PREFIX "%010lld", order[i]);
+	}
+	
+	printf("%ld keys of %zu bytes, %ld lookups\n\n", n, strlen(PREFIX) + 10, lookups);
+	printf("%-8s %10s %10s\n", "", "insert ms", "search ns");
+	measure("plain", 0, keys, n, lookups);
+	measure("arena", AVL_STRING_ARENA, keys, n, lookups);
+	
+	
+	for(i = 0; i < n; i++) free(keys[i]);
+	free(keys);
+	free(order);
+	return 0;
+	
+}
@@ -0,0 +1,162 @@
+#include <string.h>
+
+#include "../avltree.h"
+#include "test.h"
+
+
+
+/* 	Even IDs the tree holds, 0 to 2*KEYS - 2, each up to COPIES times, so odd ones miss,
+	which is well past the size avl_searchBatch() searches key by key, and how many batches
+	are sought each time, none bigger than BATCH */
+#define KEYS	20000
+#define COPIES	3
+#define BATCHES	200
+#define BATCH	100
+
+
+
+/* 	Seeks batches of random IDs, odd and even ones, out of bounds ones, repeats, unsorted,
+	of any size up to BATCH, and a whole sorted one, checking what's found against model */
+static void seeks(struct AVLtree* tree, const int* model, unsigned long long* state){
+	
+	long long keys[2*KEYS];
+	void *data[2*KEYS];
+	long i, j, n, found;
+	
+	
+	for(j = 0; j <= BATCHES; j++){
+		n = (j < BATCHES) ? (long)(avl_testRandom(state) % (BATCH + 1)) : 2*KEYS;
+		for(i = 0; i < n; i++){
+			keys[i] = (j < BATCHES) ? (long long)(avl_testRandom(state) % (2*KEYS + 20)) - 10 : i;
+			if(i && j % 4 == 0) keys[i] = keys[avl_testRandom(state) % i];
+			data[i] = data;
+		}
+	
+		/* Every key found gets its own value as data, and every one missing NULL */
+		found = avl_searchBatch(tree, keys, n, data);
+		for(i = 0; i < n; i++){
+			if(keys[i] >= 0 && keys[i] < 2*KEYS && !(keys[i] % 2) && model[keys[i]/2]){
+				avl_check(data[i] && *(long*)data[i] == keys[i]);
+				found--;
+			} else avl_check(!data[i]);
+		}
+		avl_check(!found);
+	}
+	
+	
+	/* No batch at all has nothing to find, nor any data to set */
+	data[0] = data;
+	avl_check(avl_searchBatch(tree, keys, 0, data) == 0 && data[0] == data);
+	avl_check(avl_searchBatch(tree, keys, -1, data) == 0 && data[0] == data);
+	
+}
+
+
+
+/* 	Fills tree with every even ID, each up to COPIES times, in an order of no use to it,
+	seeking batches as it grows, then takes a third of them out, and at last every one */
+static void batches(int options){
+	
+	struct AVLtree *tree = avl_createTreeEx(options);
+	unsigned long long state = 88172645463325252ull;
+	int model[KEYS] = {0};
+	long long id, i;
+	int c;
+	
+	
+	/* An empty root has nothing to find */
+	seeks(tree, model, &state);
+	
+	for(i = 0; i < KEYS; i++){
+		id = (i * 7919) % KEYS;
+		for(c = 0; c <= i % COPIES; c++) avl_insert(tree, avl_testData(2*id), 2*id);
+		model[id] = c;
+		if(i == 100 || i == KEYS/2) seeks(tree, model, &state);
+	}
+	seeks(tree, model, &state);
+	
+	for(i = 0; i < KEYS; i += 3)
+		for(; model[i]; model[i]--) avl_remove(tree, 2*i);
+	seeks(tree, model, &state);
+	
+	for(i = 0; i < KEYS; i++)
+		for(; model[i]; model[i]--) avl_remove(tree, 2*i);
+	seeks(tree, model, &state);
+	
+	
+	avl_free(tree);
+	
+}
+
+
+
+/* Checks a batch found even keys, below 2*KEYS, with their own values as datas, and no others */
+static void hit(const unsigned long long* keys, void** data){
+	
+	long i;
+	for(i = 0; i < BATCH; i++)
+		avl_check((keys[i] % 2 || keys[i] >= 2*KEYS) ? !data[i] : *(long*)data[i] == (long)keys[i]);
+	
+}
+
+
+
+/* Unsigned, real and string batches go through their own roots, alike */
+static void others(int options){
+	
+	struct AVLtree *tree = avl_createTreeEx(options);
+	unsigned long long ukeys[BATCH];
+	double dkeys[BATCH];
+	char *skeys[BATCH], strings[BATCH][32];
+	void *data[BATCH];
+	char key[32];
+	long i, n, hits = 0;
+	
+	
+	for(i = 0; i < KEYS; i++){
+		n = (i * 7919) % KEYS;
+		sprintf(key, "https://example.com/%06ld", 2*n);
+		avl_insert(tree, avl_testData(2*n), (unsigned long long)(2*n));
+		avl_insert(tree, avl_testData(2*n), (double)(2*n) / 4);
+		avl_insert(tree, avl_testData(2*n), key);
+	}
+	
+	for(i = 0; i < BATCH; i++){
+		n = (i * 4217) % (2*KEYS + 2);
+		ukeys[i] = n;
+		dkeys[i] = (double)n / 4;
+		sprintf(strings[i], "https://example.com/%06ld", n);
+		skeys[i] = strings[i];
+		hits += !(n % 2) && n < 2*KEYS;
+	}
+	
+	avl_check(avl_searchBatch(tree, ukeys, BATCH, data) == hits);
+	hit(ukeys, data);
+	avl_check(avl_searchBatch(tree, dkeys, BATCH, data) == hits);
+	hit(ukeys, data);
+	avl_check(avl_searchBatch(tree, skeys, BATCH, data) == hits);
+	hit(ukeys, data);
+	
+	
+	avl_free(tree);
+	
+}
+
+
+
+int main(void){
+	
+	const int options[] = {0, AVL_CONCURRENT, AVL_RCU, AVL_HASH_INDEX, AVL_STRING_ARENA, AVL_MULTIMAP, AVL_PERSISTENT, AVL_ENGINE_BTREE};
+	int i;
+	
+	
+	for(i = 0; i < (int)(sizeof(options)/sizeof(int)); i++){
+		batches(options[i]);
+		others(options[i]);
+	}
+	
+	
+	puts("batch: ok");
+	return 0;
+	
+}
@@ -0,0 +1,86 @@
+#include <limits.h>
+
+#include "../avlbtree.h"
+#include "test.h"
+
+
+
+/* How many random sets of leads every kernel ranks */
+#define ROUNDS	20000
+
+
+
+/* Gets a random lead: around 0 mostly, so many are equal, and at times at either end of the range */
+static long long pick(unsigned long long* state){
+	
+	unsigned long long r = avl_testRandom(state);
+	switch(r % 8){
+		case 0: return LLONG_MIN + (long long)(r >> 60);
+		case 1: return LLONG_MAX - (long long)(r >> 60);
+		case 2: return (long long)r;
+	}
+	return (long long)(r >> 3) % 9 - 4;
+	
+}
+
+
+
+/* 	Ranks leads sorted as a node's, and unsorted, with slots past count holding
+	anything, by every kernel this CPU runs, which must agree with the scalar one,
+	and the scalar one with counting them here */
+static void kernels(void){
+	
+	_Alignas(64) long long leads[AVL_BTREE_ORDER];
+	unsigned long long state = 88172645463325252ull;
+	long long lead, swap;
+	long r;
+	int count, i, j, k, lt, le, klt, kle;
+	const char *wide = "xa";
+	
+	
+	for(r = 0; r < ROUNDS; r++){
+		count = avl_testRandom(&state) % (AVL_BTREE_ORDER + 1);
+		for(i = 0; i < AVL_BTREE_ORDER; i++) leads[i] = pick(&state);
+	
+		if(r % 2)
+			for(i = 1; i < count; i++)
+				for(j = i; j > 0 && leads[j-1] > leads[j]; j--){
+					swap = leads[j];
+					leads[j] = leads[j-1];
+					leads[j-1] = swap;
+				}
+	
+		lead = (count && r % 3) ? leads[avl_testRandom(&state) % count] : pick(&state);
+		if(r % 3 == 2 && lead > LLONG_MIN) lead--;
+		avl_check(avl_btreeRank('s', leads, count, lead, &lt, &le));
+	
+		for(klt = kle = i = 0; i < count; i++){
+			klt += leads[i] < lead;
+			kle += leads[i] <= lead;
+		}
+		avl_check(lt == klt && le == kle);
+	
+		for(k = 0; k < 2; k++){
+			if(!avl_btreeRank(wide[k], leads, count, lead, &klt, &kle)) continue;
+			avl_check(lt == klt && le == kle);
+		}
+	}
+	
+	
+	/* No kernel goes by another name, nor ranks more leads than a node holds */
+	avl_check(!avl_btreeRank('?', leads, 0, 0, &lt, &le));
+	avl_check(!avl_btreeRank('s', leads, AVL_BTREE_ORDER + 1, 0, &lt, &le));
+	
+}
+
+
+
+int main(void){
+	
+	kernels();
+	
+	
+	puts("btree: ok");
+	return 0;
+	
+}
@@ -0,0 +1,168 @@
+#include <math.h>
+#include <string.h>
+
+#include "../avltree.h"
+#include "test.h"
+
+
+
+/* How many IDs the biggest loads hold, each from 0 to KEYS - 1 */
+#define COUNT	20000
+#define KEYS	5000
+
+
+
+/* Orders IDs for qsort(), ascending */
+static int ascending(const void* a, const void* b){
+	return (*(long long*)a > *(long long*)b) - (*(long long*)a < *(long long*)b);
+}
+
+
+
+/* Fills keys with n random IDs from 0 to KEYS - 1, repeats included, then sorts them if 'a'scending or 'd'escending */
+static void fill(long long* keys, long n, char order){
+	
+	unsigned long long state = 88172645463325252ull + n;
+	long long swap;
+	long i;
+	
+	
+	for(i = 0; i < n; i++) keys[i] = avl_testRandom(&state) % KEYS;
+	if(order == 'r') return;
+	
+	qsort(keys, n, sizeof(long long), ascending);
+	for(i = 0; order == 'd' && i < n/2; i++){
+		swap = keys[i];
+		keys[i] = keys[n-1-i];
+		keys[n-1-i] = swap;
+	}
+	
+}
+
+
+
+/* 	Checks tree's int root holds exactly model's IDs, as many times each, balanced, in
+	ascending order, with their own values as datas, or NULL ones if 'bare' is set. A
+	multimap holds each ID once, with all its datas together, which only searches get */
+static void holds(struct AVLtree* tree, const int* model, int bare){
+	
+	void **ID = malloc((COUNT*2 + 1)*sizeof(void*)), **data = malloc((COUNT*2 + 1)*sizeof(void*));
+	long long i;
+	long n = 0, c, *found;
+	
+	
+	for(i = 0; i < KEYS; i++){
+		n += (tree->options & AVL_MULTIMAP) ? model[i] > 0 : model[i];
+		if(tree->options & AVL_MULTIMAP) avl_check(avl_countKey(tree, i) == model[i]);
+	
+		found = avl_searchData(tree, 'i', avl_integerKey(i));
+		avl_check((model[i] && !bare) ? found && *found == i : !found);
+		avl_check(!avl_searchKey(tree, 'i', avl_integerKey(i)) == (!model[i] || tree->btree || tree->persist));
+	}
+	avl_check(tree->int_size == n);
+	if(!tree->btree && !tree->persist) avl_check(avl_verify(tree->int_root) >= 0);
+	
+	avl_check((c = avl_traverseRoot(tree, 'i', ID, data, n + 1)) == n);
+	for(i = 0; i < c; i++){
+		if(!(tree->options & AVL_MULTIMAP)) avl_check(bare ? !data[i] : *(long*)data[i] == *(long long*)ID[i]);
+		if(i) avl_check(*(long long*)ID[i-1] <= *(long long*)ID[i]);
+	}
+	
+	
+	free(ID);
+	free(data);
+	
+}
+
+
+
+/* 	Loads n keys in 'order' into an empty root of a tree with options, then the same
+	keys again into the root it filled, which takes them one by one, checking both */
+static void loads(int options, long n, char order, int bare){
+	
+	struct AVLtree *tree = avl_createTreeEx(options);
+	long long *keys = malloc((n+1)*sizeof(long long));
+	void **data = malloc((n+1)*sizeof(void*));
+	int model[KEYS] = {0}, round;
+	long i;
+	
+	
+	fill(keys, n, order);
+	for(round = 0; round < 2; round++){
+		for(i = 0; i < n; i++){
+			data[i] = bare ? NULL : avl_testData(keys[i]);
+			model[keys[i]]++;
+		}
+		avl_check(avl_bulkLoad(tree, keys, bare ? NULL : data, n) == n);
+		holds(tree, model, bare);
+	}
+	
+	
+	free(keys);
+	free(data);
+	avl_free(tree);
+	
+}
+
+
+
+/* Reals and strings, unsorted, are sorted by their root's own order */
+static void others(int options){
+	
+	struct AVLtree *tree = avl_createTreeEx(options);
+	double reals[COUNT];
+	char **strings = malloc(COUNT*sizeof(char*));
+	void **ID = malloc(COUNT*sizeof(void*));
+	long i;
+	
+	
+	for(i = 0; i < COUNT; i++){
+		reals[i] = ((i * 7919) % COUNT - COUNT/2) * 0.25;
+		strings[i] = malloc(32);
+		sprintf(strings[i], "https://example.com/%06ld", (i * 7919) % COUNT);
+	}
+	
+	avl_check(avl_bulkLoad(tree, reals, NULL, COUNT) == COUNT);
+	avl_check(tree->double_size == COUNT);
+	avl_check(avl_traverseRoot(tree, 'd', ID, NULL, COUNT) == COUNT);
+	for(i = 0; i < COUNT; i++) avl_check(*(long double*)ID[i] == (i - COUNT/2) * 0.25L);
+	
+	avl_check(avl_bulkLoad(tree, strings, NULL, COUNT) == COUNT);
+	avl_check(tree->string_size == COUNT);
+	avl_check(avl_traverseRoot(tree, 'c', ID, NULL, COUNT) == COUNT);
+	for(i = 1; i < COUNT; i++) avl_check(strcmp(ID[i-1], ID[i]) < 0);
+	for(i = 0; i < COUNT; i++){
+		avl_check(avl_searchKey(tree, 'c', avl_stringKey(strings[i])) || tree->btree || tree->persist);
+		free(strings[i]);
+	}
+	if(!tree->btree && !tree->persist) avl_check(avl_verify(tree->double_root) >= 0 && avl_verify(tree->string_root) >= 0);
+	
+	
+	free(strings);
+	free(ID);
+	avl_free(tree);
+	
+}
+
+
+
+int main(void){
+	
+	const int options[] = {0, AVL_HASH_INDEX, AVL_STRING_ARENA, AVL_RCU, AVL_MULTIMAP, AVL_PERSISTENT, AVL_ENGINE_BTREE};
+	const long sizes[] = {0, 1, 2, 3, 100, COUNT};
+	const char *orders = "adr";
+	int i, j, k;
+	
+	
+	/* Every size, sorted or not, with datas or none, into every kind of root */
+	for(i = 0; i < (int)(sizeof(options)/sizeof(int)); i++){
+		for(j = 0; j < (int)(sizeof(sizes)/sizeof(long)); j++)
+			for(k = 0; k < 3; k++) loads(options[i], sizes[j], orders[k], k == 2 && j % 2);
+		others(options[i]);
+	}
+	
+	
+	puts("bulk: ok");
+	return 0;
+	
+}
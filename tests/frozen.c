@@ -0,0 +1,225 @@
+#include <string.h>
+
+#include "../avlfrozen.h"
+#include "test.h"
+
+
+
+/* 	IDs the tree may hold, 0 to KEYS - 1, each up to COPIES times, how many random
+	insertions and removals each workload does, and after how many the tree is frozen */
+#define KEYS	500
+#define COPIES	3
+#define ROUNDS	20000
+#define CHECK	1000
+
+
+
+/* Counts the IDs a callback is passed, asking to stop once there are as many as arg holds */
+static int stops(void* ID, void* data, void* arg){
+	
+	long *left = arg;
+	avl_check(*(long*)data == *(long long*)ID);
+	return !--*left;
+	
+}
+
+
+
+/* 	Checks frozen holds model's sorted IDs, n of them: walking it with avl_frozenNext()
+	from its first one, getting the first copy of the one not lesser than any ID, and
+	whether it's there, and ranges of them, reversed ones too, stopped halfway or not */
+static void frozen(struct AVLfrozen* frozen, const long long* sorted, long n, unsigned long long* state){
+	
+	long long lo, hi, id;
+	long i, j, k, index, left;
+	long *data;
+	
+	
+	avl_check(frozen->size == n && frozen->type == 'i');
+	index = avl_frozenLowerBound(frozen, avl_integerKey(-1));
+	for(i = 0; i < n; i++, index = avl_frozenNext(frozen, index)){
+		avl_check(index >= 1 && index <= n);
+		avl_check(frozen->keys[index].integer == sorted[i] && *(long*)frozen->data[index] == sorted[i]);
+	}
+	avl_check(!index);
+	
+	
+	/* The first copy of an ID is followed by the others, then by the next ID */
+	for(id = -2, i = 0; id < KEYS + 2; id++){
+		for(; i < n && sorted[i] < id; i++);
+		index = avl_frozenLowerBound(frozen, avl_integerKey(id));
+		avl_check(!index == (i == n));
+		for(j = i; j < n && index; j++, index = avl_frozenNext(frozen, index)) avl_check(frozen->keys[index].integer == sorted[j]);
+		avl_check(j == n && !index);
+	
+		avl_frozenSearch(frozen, id, data);
+		avl_check((i < n && sorted[i] == id) ? data && *data == id : !data);
+		avl_check(!avl_frozenSearchKey(frozen, avl_integerKey(id)) == !(i < n && sorted[i] == id));
+	}
+	
+	
+	/* Ranges hold every copy of their IDs, none of a reversed one */
+	for(k = 0; k < 50; k++){
+		lo = (long long)(avl_testRandom(state) % (KEYS + 20)) - 10;
+		hi = (k % 5) ? lo + (long long)(avl_testRandom(state) % 100) : lo - 1;
+		for(i = j = 0; i < n; i++) j += sorted[i] >= lo && sorted[i] <= hi;
+	
+		left = -1;
+		avl_check(avl_frozenRange(frozen, lo, hi, stops, &left) == j);
+		left = j/2 + 1;
+		avl_check(avl_frozenRange(frozen, lo, hi, stops, &left) == (j ? j/2 + 1 : 0));
+	}
+	
+}
+
+
+
+/* 	Inserts and removes IDs at random, each up to COPIES times, freezing the tree now
+	and then, and checking the copy against a model, as well as after the tree changes */
+static void workload(int options){
+	
+	struct AVLtree *tree = avl_createTreeEx(options);
+	struct AVLfrozen *copy;
+	unsigned long long state = 88172645463325252ull;
+	int model[KEYS] = {0};
+	long long sorted[KEYS * COPIES], id, i;
+	long n = 0;
+	int c;
+	
+	
+	for(i = 1; i <= ROUNDS; i++){
+		id = avl_testRandom(&state) % KEYS;
+		if(model[id] < COPIES && avl_testRandom(&state) % 3){
+			avl_insert(tree, avl_testData(id), id);
+			model[id]++;
+		} else if(model[id]){
+			avl_removeKey(tree, 'i', avl_integerKey(id));
+			model[id]--;
+		}
+		if(i % CHECK && i > 1) continue;
+	
+		for(id = n = 0; id < KEYS; id++)
+			for(c = 0; c < model[id]; c++) sorted[n++] = id;
+		copy = avl_freeze(tree, (long long)0);
+		frozen(copy, sorted, n, &state);
+	
+		/* The copy stays as it was, whatever the tree does afterwards */
+		avl_insert(tree, avl_testData(KEYS), (long long)KEYS);
+		frozen(copy, sorted, n, &state);
+		avl_removeKey(tree, 'i', avl_integerKey(KEYS));
+		avl_frozenFree(copy);
+	}
+	
+	
+	avl_free(tree);
+	
+}
+
+
+
+/* 	Freezes a root at every size up to a few full levels, so the last level is each
+	time filled a bit more, seeking every ID it holds and those past its ends */
+static void sizes(int options){
+	
+	struct AVLtree *tree = avl_createTreeEx(options);
+	struct AVLfrozen *copy;
+	unsigned long long state = 88172645463325252ull;
+	long long sorted[300];
+	long n;
+	
+	
+	for(n = 0; n < 300; n++){
+		copy = avl_freeze(tree, (long long)0);
+		frozen(copy, sorted, n, &state);
+		avl_frozenFree(copy);
+	
+		sorted[n] = n;
+		avl_insert(tree, avl_testData(n), (long long)n);
+	}
+	
+	
+	avl_free(tree);
+	
+}
+
+
+
+/* Checks the strings a callback is passed go up, with no datas */
+static int strings(void* ID, void* data, void* arg){
+	
+	char *last = arg;
+	avl_check(strcmp(last, ID) < 0 && !data);
+	strcpy(last, ID);
+	return 0;
+	
+}
+
+
+
+/* Other roots are frozen in their own order, strings with copies of their own, and nothing else is */
+static void others(int options){
+	
+	struct AVLtree *tree = avl_createTreeEx(options);
+	struct AVLfrozen *copy;
+	char key[32], last[32] = "";
+	long i, index;
+	void *data;
+	
+	
+	for(i = 0; i < KEYS; i++){
+		sprintf(key, "https://example.com/%05ld", (i * 7919) % KEYS);
+		avl_insert(tree, NULL, key);
+		avl_insert(tree, avl_testData((i * 7919) % KEYS), (double)((i * 7919) % KEYS) / 4 - 10);
+	}
+	
+	copy = avl_freeze(tree, "");
+	avl_remove(tree, "https://example.com/00100");
+	avl_check(copy->size == KEYS && copy->type == 'c');
+	avl_check(avl_frozenRange(copy, "https://example.com/001", "https://example.com/002", strings, last) == 100);
+	avl_check(!strcmp(last, "https://example.com/00199"));
+	avl_check(avl_frozenRange(copy, "https://example.com/002", "https://example.com/001", strings, last) == 0);
+	avl_check(avl_frozenSearchKey(copy, avl_stringKey("https://example.com/00100")));
+	avl_check(!avl_frozenSearchKey(copy, avl_stringKey("https://example.com/0010")));
+	avl_frozenFree(copy);
+	
+	copy = avl_freeze(tree, 0.0);
+	avl_check(copy->size == KEYS && copy->type == 'd');
+	for(i = 0, index = avl_frozenLowerBound(copy, avl_realKey(-1e9)); index; i++, index = avl_frozenNext(copy, index))
+		avl_check(copy->keys[index].real == (long double)i / 4 - 10);
+	avl_check(i == KEYS);
+	avl_frozenSearch(copy, 0.25, data);
+	avl_check(data && *(long*)data == 41);
+	avl_frozenSearch(copy, 0.3, data);
+	avl_check(!data);
+	avl_frozenFree(copy);
+	
+	copy = avl_freeze(tree, (unsigned int)0);
+	avl_check(copy->size == 0 && !avl_frozenLowerBound(copy, avl_uintegerKey(0)));
+	avl_frozenFree(copy);
+	avl_check(!avl_freezeRoot(tree, 'x'));
+	avl_frozenFree(NULL);
+	
+	
+	avl_free(tree);
+	
+}
+
+
+
+int main(void){
+	
+	const int options[] = {0, AVL_RCU, AVL_HASH_INDEX, AVL_STRING_ARENA, AVL_PERSISTENT, AVL_ENGINE_BTREE};
+	int i;
+	
+	
+	for(i = 0; i < (int)(sizeof(options)/sizeof(int)); i++){
+		workload(options[i]);
+		sizes(options[i]);
+		others(options[i]);
+	}
+	
+	
+	puts("frozen: ok");
+	return 0;
+	
+}
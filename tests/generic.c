@@ -0,0 +1,252 @@
+#include <string.h>
+
+#include "../avlgeneric.h"
+#include "test.h"
+
+
+
+/* 	IDs the tree may hold, 0 to KEYS - 1, each up to COPIES times, how many random
+	insertions and removals each workload does, and after how many the tree is checked */
+#define KEYS	500
+#define COPIES	3
+#define ROUNDS	20000
+#define CHECK	1000
+
+
+
+/* 	A composite key, ordered by major then minor, as ID / 10 and ID % 10 - 5, so some
+	are negative. Its serial, which says which insertion it came from, isn't compared,
+	so keys equal to each other can still be told apart */
+struct pair{
+	
+	int major;
+	short minor;
+	long serial;
+	
+};
+
+/* Orders pairs by major, then by minor */
+static inline int order(const struct pair* a, const struct pair* b){
+	return (a->major != b->major) ? (a->major > b->major) - (a->major < b->major) : (a->minor > b->minor) - (a->minor < b->minor);
+}
+
+/* Orders pairs as the generic tree's comparator, through void pointers */
+static int compare(const void* a, const void* b){
+	return order(a, b);
+}
+
+AVL_GENERIC_DEFINE(pair, struct pair, order)
+
+
+
+/* 	The model: for each ID, the serials of its copies, in the order the tree must hold
+	them, i.e. the newest first, since a key is inserted before any equal one */
+struct model{
+	
+	int count[KEYS];
+	long serials[KEYS][COPIES];
+	
+};
+
+
+
+/* Gets the pair of an ID, with a serial */
+static struct pair key(long long id, long serial){
+	
+	struct pair pair = {(int)(id / 10), (short)(id % 10 - 5), serial};
+	return pair;
+	
+}
+
+
+
+/* Gets the ID of a pair, which may have none if it's out of bounds */
+static long long id(const struct pair* pair){
+	return (long long)pair->major * 10 + pair->minor + 5;
+}
+
+
+
+/* Checks every node under node links back to its parent, and is balanced as it says. Returns its height */
+static int height(struct AVLgnode* node){
+	
+	int l, r;
+	if(!node) return 0;
+	
+	avl_check(!node->Lchild || node->Lchild->parent == node);
+	avl_check(!node->Rchild || node->Rchild->parent == node);
+	l = height(node->Lchild);
+	r = height(node->Rchild);
+	avl_check(node->balance == r - l && r - l >= -1 && r - l <= 1);
+	
+	
+	return (l > r ? l : r) + 1;
+	
+}
+
+
+
+/* 	Checks tree holds model's keys, each ID's copies in its order, balanced, walking
+	it in order, and where lower bounds and searches of every ID, and beyond, land */
+static void holds(struct AVLgtree* tree, const struct model* model){
+	
+	struct AVLgnode *node;
+	struct pair pair;
+	long long i;
+	long n = 0;
+	int c;
+	
+	
+	avl_check(tree->width == sizeof(struct pair) && height(tree->root) >= 0);
+	avl_check(!tree->root || tree->root->parent == tree->root);
+	
+	node = avl_genericFirst(tree);
+	for(i = 0; i < KEYS; i++)
+		for(c = 0; c < model->count[i]; c++, n++, node = avl_genericNext(node)){
+			avl_check(node && id((struct pair*)node->key) == i);
+			avl_check(((struct pair*)node->key)->serial == model->serials[i][c] && *(long*)node->data == model->serials[i][c]);
+		}
+	avl_check(!node && tree->size == n);
+	
+	
+	/* The lower bound of an ID is its newest copy, or the newest of the next ID's */
+	for(i = -12; i < KEYS + 12; i++){
+		pair = key(i, -1);
+		node = avl_genericLowerBound(tree, &pair);
+		avl_check(node == pairLowerBound(tree, pair));
+	
+		for(c = (i > 0) ? i : 0; c < KEYS && !model->count[c]; c++);
+		if(c < KEYS) avl_check(node && id((struct pair*)node->key) == c && ((struct pair*)node->key)->serial == model->serials[c][0]);
+		else avl_check(!node);
+	
+		node = avl_genericSearch(tree, &pair);
+		avl_check(!node == (i < 0 || i >= KEYS || !model->count[i]));
+		avl_check(!node || !order((struct pair*)node->key, &pair));
+		avl_check(!pairSearch(tree, pair) == !node);
+	}
+	
+}
+
+
+
+/* 	Removes a copy of id, with avl_genericRemove() or the variant's Remove(), which
+	may take any of them, and takes out of model whichever is missing afterwards */
+static void removes(struct AVLgtree* tree, struct model* model, long long i, int inlined){
+	
+	struct AVLgnode *node;
+	struct pair pair = key(i, -1);
+	long serials[COPIES];
+	int c, n = 0;
+	
+	
+	avl_check((inlined ? pairRemove(tree, pair) : avl_genericRemove(tree, &pair)) == (model->count[i] > 0));
+	for(node = avl_genericLowerBound(tree, &pair); node && !order((struct pair*)node->key, &pair); node = avl_genericNext(node)){
+		avl_check(n < model->count[i]);
+		serials[n++] = ((struct pair*)node->key)->serial;
+	}
+	if(!model->count[i]) return;
+	
+	
+	/* The copies left keep their order */
+	avl_check(n == model->count[i] - 1);
+	for(c = 0; c < n && serials[c] == model->serials[i][c]; c++);
+	for(model->count[i]--; c < n; c++){
+		avl_check(serials[c] == model->serials[i][c+1]);
+		model->serials[i][c] = serials[c];
+	}
+	
+}
+
+
+
+/* 	Inserts and removes keys at random, each up to COPIES times, through the generic
+	functions, or the variant's inlined ones, checking the tree against a model now and
+	then, and removing the newest copy of some by their node, then every copy of half the IDs */
+static void workload(int inlined){
+	
+	struct AVLgtree *tree = inlined ? pairCreate() : avl_createGeneric(sizeof(struct pair), compare);
+	struct AVLgnode *node;
+	static struct model model;
+	unsigned long long state = 88172645463325252ull;
+	struct pair pair;
+	long long i, j;
+	int c;
+	
+	
+	/* An empty tree has no node at all, and nothing to remove */
+	memset(&model, 0, sizeof(model));
+	holds(tree, &model);
+	removes(tree, &model, 0, inlined);
+	avl_check(!avl_genericFirst(tree) && !tree->root && !tree->size);
+	
+	for(i = 1; i <= ROUNDS; i++){
+		j = avl_testRandom(&state) % KEYS;
+		if(model.count[j] < COPIES && avl_testRandom(&state) % 3){
+			pair = key(j, i);
+			if(inlined) pairInsert(tree, pair, avl_testData(i));
+			else avl_genericInsert(tree, &pair, avl_testData(i));
+			memmove(model.serials[j] + 1, model.serials[j], model.count[j]*sizeof(long));
+			model.serials[j][0] = i;
+			model.count[j]++;
+		} else if(i % 2) removes(tree, &model, j, inlined);
+		else if(model.count[j]){
+			pair = key(j, -1);
+			node = avl_genericLowerBound(tree, &pair);
+			avl_genericRemoveNode(tree, node);
+			model.count[j]--;
+			memmove(model.serials[j], model.serials[j] + 1, model.count[j]*sizeof(long));
+		}
+		if(!(i % CHECK)) holds(tree, &model);
+	}
+	
+	
+	/* Removing half of them leaves the others, which avl_genericFree() frees */
+	for(i = 0; i < KEYS; i += 2)
+		for(c = model.count[i]; c >= 0; c--) removes(tree, &model, i, inlined);
+	holds(tree, &model);
+	
+	
+	avl_genericFree(tree);
+	
+}
+
+
+
+/* Primitive variants keep keys at their own width, in their own order */
+static void primitives(void){
+	
+	struct AVLgtree *shorts = avl_shortCreate(), *doubles = avl_doubleCreate();
+	long i;
+	
+	
+	for(i = 0; i < KEYS; i++){
+		avl_shortInsert(shorts, (short)((i * 7919) % KEYS - KEYS/2), NULL);
+		avl_doubleInsert(doubles, ((i * 7919) % KEYS) / 4.0, avl_testData(i));
+	}
+	avl_check(shorts->width == sizeof(short) && shorts->size == KEYS && height(shorts->root) >= 0);
+	avl_check(*avl_shortKey(avl_shortLowerBound(shorts, -KEYS)) == -KEYS/2);
+	avl_check(!avl_shortLowerBound(shorts, KEYS/2) && avl_shortSearch(shorts, KEYS/2 - 1));
+	
+	avl_check(avl_doubleRemove(doubles, 0.25) && !avl_doubleRemove(doubles, 0.25) && !avl_doubleRemove(doubles, 0.3));
+	avl_check(*avl_doubleKey(avl_doubleLowerBound(doubles, 0.1)) == 0.5);
+	avl_check(doubles->size == KEYS - 1 && height(doubles->root) >= 0);
+	
+	
+	avl_genericFree(shorts);
+	avl_genericFree(doubles);
+	
+}
+
+
+
+int main(void){
+	
+	workload(0);
+	workload(1);
+	primitives();
+	
+	
+	puts("generic: ok");
+	return 0;
+	
+}
@@ -0,0 +1,190 @@
+#include "../avltree.h"
+#include "test.h"
+
+
+
+/* 	IDs the tree may hold, 0 to KEYS - 1, each up to COPIES times, how many random
+	insertions and removals each workload does, and after how many the tree is walked */
+#define KEYS	500
+#define COPIES	3
+#define ROUNDS	20000
+#define CHECK	1000
+
+
+
+/* Puts model's IDs, as many times each as it counts them, into sorted, in ascending order. Returns how many there are */
+static long expand(const int* model, long long* sorted){
+	
+	long long i;
+	long n = 0;
+	int c;
+	
+	
+	for(i = 0; i < KEYS; i++)
+		for(c = 0; c < model[i]; c++) sorted[n++] = i;
+	
+	
+	return n;
+	
+}
+
+
+
+/* Checks iter is on a node whose ID is id, with its own value as data */
+static void at(struct AVLiter* iter, long long id){
+	
+	long long *ID;
+	long *data;
+	
+	
+	avl_check(iter->node);
+	avl_check(avl_iterGet(iter, (void**)&ID, (void**)&data));
+	avl_check(*ID == id && *data == id);
+	
+}
+
+
+
+/* 	Walks the whole tree both ways, and from where random IDs are sought, checking each
+	step against model's sorted IDs, and that iterators past either end stay there */
+static void walks(struct AVLtree* tree, const int* model, unsigned long long* state){
+	
+	struct AVLiter iter;
+	long long sorted[KEYS * COPIES], id;
+	long n = expand(model, sorted), i, j;
+	
+	
+	avl_check(avl_iterFirst(tree, &iter, (long long)0) == (n > 0));
+	for(i = 0; i < n; i++, avl_iterNext(&iter)) at(&iter, sorted[i]);
+	avl_check(!iter.node && !avl_iterGet(&iter, NULL, NULL));
+	avl_check(!avl_iterNext(&iter) && !avl_iterPrev(&iter));
+	
+	avl_check(avl_iterLast(tree, &iter, (long long)0) == (n > 0));
+	for(i = n-1; i >= 0; i--, avl_iterPrev(&iter)) at(&iter, sorted[i]);
+	avl_check(!iter.node && !avl_iterGet(&iter, NULL, NULL));
+	
+	
+	/* A seek lands on the first copy of the smallest ID not lesser than the one sought */
+	for(j = 0; j < 50; j++){
+		id = (long long)(avl_testRandom(state) % (KEYS + 10)) - 5;
+		for(i = 0; i < n && sorted[i] < id; i++);
+	
+		avl_check(avl_iterSeek(tree, &iter, id) == (i < n));
+		if(i < n){
+			at(&iter, sorted[i]);
+			avl_check(avl_iterNext(&iter) == (i+1 < n));
+			if(i+1 < n) at(&iter, sorted[i+1]);
+	
+			avl_iterSeek(tree, &iter, id);
+			avl_check(avl_iterPrev(&iter) == (i > 0));
+			if(i > 0) at(&iter, sorted[i-1]);
+		} else avl_check(!iter.node);
+	}
+	
+}
+
+
+
+/* 	Inserts and removes IDs at random, each up to COPIES times, walking the tree with
+	iterators now and then, then keeps an iterator on an ID while others come and go,
+	which must go on from it to whichever IDs are its neighbours by then */
+static void iterators(int options){
+	
+	struct AVLtree *tree = avl_createTreeEx(options);
+	struct AVLiter iter;
+	unsigned long long state = 88172645463325252ull;
+	int model[KEYS] = {0};
+	long long id, kept = KEYS/2, i, j;
+	
+	
+	/* An empty root has no node at either end, nor any to seek */
+	walks(tree, model, &state);
+	avl_check(!avl_iterSeek(tree, &iter, (long long)0) && !iter.node);
+	
+	for(i = 1; i <= ROUNDS; i++){
+		id = avl_testRandom(&state) % KEYS;
+		if(model[id] < COPIES && avl_testRandom(&state) % 3){
+			avl_insert(tree, avl_testData(id), id);
+			model[id]++;
+		} else if(model[id]){
+			avl_remove(tree, id);
+			model[id]--;
+		}
+		if(!(i % CHECK)) walks(tree, model, &state);
+	}
+	
+	
+	/* kept, with a single copy, stays where its iterator is, while the tree changes around it */
+	while(model[kept]){
+		avl_remove(tree, kept);
+		model[kept]--;
+	}
+	avl_insert(tree, avl_testData(kept), kept);
+	model[kept] = 1;
+	avl_check(avl_iterSeek(tree, &iter, kept));
+	
+	for(i = 0; i < ROUNDS; i++){
+		id = avl_testRandom(&state) % KEYS;
+		if(id == kept) continue;
+		if(model[id] < COPIES && avl_testRandom(&state) % 2){
+			avl_insert(tree, avl_testData(id), id);
+			model[id]++;
+		} else if(model[id]){
+			avl_remove(tree, id);
+			model[id]--;
+		}
+		if(i % CHECK) continue;
+	
+		at(&iter, kept);
+		for(j = kept + 1; j < KEYS && !model[j]; j++);
+		avl_check(avl_iterNext(&iter) == (j < KEYS));
+		if(j < KEYS) at(&iter, j);
+	
+		avl_check(avl_iterSeek(tree, &iter, kept));
+		for(j = kept - 1; j >= 0 && !model[j]; j--);
+		avl_check(avl_iterPrev(&iter) == (j >= 0));
+		if(j >= 0) at(&iter, j);
+		avl_check(avl_iterSeek(tree, &iter, kept));
+	}
+	walks(tree, model, &state);
+	
+	
+	avl_free(tree);
+	
+}
+
+
+
+/* Engines whose roots aren't avl trees have no node for iterators to go through */
+static void engines(int options){
+	
+	struct AVLtree *tree = avl_createTreeEx(options);
+	struct AVLiter iter;
+	long long i;
+	
+	
+	for(i = 0; i < 100; i++) avl_insert(tree, avl_testData(i), i);
+	avl_check(!avl_iterFirst(tree, &iter, (long long)0) && !iter.node);
+	avl_check(!avl_iterLast(tree, &iter, (long long)0) && !iter.node);
+	avl_check(!avl_iterSeek(tree, &iter, (long long)0) && !iter.node);
+	
+	
+	avl_free(tree);
+	
+}
+
+
+
+int main(void){
+	
+	iterators(0);
+	iterators(AVL_CONCURRENT);
+	iterators(AVL_HASH_INDEX);
+	engines(AVL_ENGINE_BTREE);
+	engines(AVL_PERSISTENT);
+	
+	
+	puts("iter: ok");
+	return 0;
+	
+}
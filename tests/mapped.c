@@ -0,0 +1,148 @@
+#include <limits.h>
+
+#include "../avlmapped.h"
+#include "test.h"
+
+
+
+/* How many IDs of each type the saved tree holds */
+#define COUNT	5000
+
+/* Where images are saved, corrupted and mapped back */
+#define IMAGE	"mapped.test.img"
+#define BROKEN	"mapped.test.broken"
+
+
+
+/* Reads a whole file into heap, along with how many bytes it takes */
+static char* readAll(const char* path, long* length){
+	
+	FILE *file = fopen(path, "rb");
+	char *bytes;
+	
+	
+	avl_check(file);
+	fseek(file, 0, SEEK_END);
+	*length = ftell(file);
+	rewind(file);
+	bytes = malloc(*length);
+	avl_check(fread(bytes, 1, *length, file) == (size_t)*length);
+	fclose(file);
+	
+	
+	return bytes;
+	
+}
+
+
+
+/* Writes length bytes as the image at BROKEN, and checks avl_openMapped() turns it down */
+static void rejected(const char* bytes, long length){
+	
+	FILE *file = fopen(BROKEN, "wb");
+	
+	
+	avl_check(file && fwrite(bytes, 1, length, file) == (size_t)length);
+	fclose(file);
+	avl_check(!avl_openMapped(BROKEN));
+	
+}
+
+
+
+int main(void){
+	
+	struct AVLtree *tree = avl_createTree();
+	struct AVLmapped *mapped;
+	struct AVLimage *header;
+	struct AVLimageRoot root;
+	union AVLkey *keys, saved;
+	char ID[40], *bytes;
+	long i, length, *data;
+	
+	
+	/* A whole image maps back with every ID */
+	for(i = 0; i < COUNT; i++){
+		sprintf(ID, "https://example.com/item/%08ld", i);
+		avl_insert(tree, avl_testData(i), ID);
+		avl_insert(tree, avl_testData(-i), (long long)i);
+	}
+	avl_check(avl_save(tree, IMAGE, sizeof(long)));
+	avl_free(tree);
+	
+	avl_check((mapped = avl_openMapped(IMAGE)));
+	for(i = 0; i < COUNT; i++){
+		sprintf(ID, "https://example.com/item/%08ld", i);
+		avl_mappedSearch(mapped, ID, data);
+		avl_check(data && *data == i);
+		avl_mappedSearch(mapped, (long long)i, data);
+		avl_check(data && *data == -i);
+	}
+	avl_mappedSearch(mapped, "https://example.com/item/", data);
+	avl_check(!data);
+	avl_closeMapped(mapped);
+	
+	
+	/* 	Truncated images, and images whose string entries point out of the
+		image, before the strings, past a string's end or to another string */
+	bytes = readAll(IMAGE, &length);
+	header = (struct AVLimage*)bytes;
+	keys = (union AVLkey*)(bytes + header->roots[3].keys);
+	
+	rejected(bytes, length/2);
+	rejected(bytes, sizeof(struct AVLimage) - 1);
+	
+	for(i = 1; i <= COUNT; i += COUNT/7){
+		saved = keys[i];
+	
+		keys[i].string = (char*)(size_t)(length + 4096);
+		rejected(bytes, length);
+		keys[i].string = (char*)(size_t)(length - 1);
+		rejected(bytes, length);
+		keys[i].string = (char*)(size_t)header->roots[3].keys;
+		rejected(bytes, length);
+		keys[i].string = saved.string + 8;
+		rejected(bytes, length);
+		keys[i].prefix ^= 1ULL << 40;
+		keys[i].string = saved.string;
+		rejected(bytes, length);
+	
+		keys[i] = saved;
+	}
+	
+	
+	/* 	Roots claiming more IDs than the image has room for, so many that
+		size+1 wraps around, or whose sections aren't aligned */
+	for(i = 0; i < 4; i++){
+		root = header->roots[i];
+		header->roots[i].size = ULLONG_MAX;
+		rejected(bytes, length);
+		header->roots[i].size = length/sizeof(union AVLkey);
+		rejected(bytes, length);
+		header->roots[i].size = root.size;
+		
+		header->roots[i].keys += 8;
+		rejected(bytes, length);
+		header->roots[i].keys = root.keys;
+		header->roots[i].data += 16;
+		rejected(bytes, length);
+		header->roots[i].data = root.data;
+		header->roots[i].strings += 8;
+		rejected(bytes, length);
+		header->roots[i].strings = root.strings;
+	}
+	
+	rejected(bytes, length - 1);
+	bytes[length-1] = 'x';
+	keys[1].string = (char*)(size_t)(length - 1);
+	keys[1].prefix = avl_stringKey("x").prefix;
+	rejected(bytes, length);
+	
+	
+	free(bytes);
+	remove(IMAGE);
+	remove(BROKEN);
+	puts("mapped: ok");
+	return 0;
+	
+}
@@ -0,0 +1,229 @@
+/* unlink() is POSIX, which strict C11 headers leave out */
+#define _XOPEN_SOURCE 700
+
+#include <string.h>
+#include <unistd.h>
+
+#include "../avlmapped.h"
+#include "../avlwal.h"
+#include "test.h"
+
+
+
+/* IDs the multimap may hold, 0 to KEYS - 1, each with up to VALUES datas */
+#define KEYS	200
+#define VALUES	32
+
+/* How many random insertions and removals each workload does */
+#define ROUNDS	20000
+
+/* Where the multimap is saved, and where a durable one keeps its log */
+#define IMAGE	"multimap.test.img"
+#define LOG		"multimap.test.img.log"
+
+
+
+/* What a multimap must hold: each ID's values, in the order they were inserted */
+struct model{
+	
+	long count[KEYS];
+	long value[KEYS][VALUES];
+	
+};
+
+
+
+/* Checks tree holds exactly the IDs and values model does, each ID's datas in the order they were inserted */
+static void matches(struct AVLtree* tree, const struct model* model){
+	
+	void *data[VALUES];
+	long long i;
+	long j, n = 0, *first;
+	
+	
+	for(i = 0; i < KEYS; i++){
+		avl_check(avl_countKey(tree, i) == model->count[i]);
+		avl_check(avl_searchAll(tree, i, data, VALUES) == model->count[i]);
+		for(j = 0; j < model->count[i]; j++) avl_check(*(long*)data[j] == model->value[i][j]);
+	
+		avl_search(tree, i, first);
+		avl_check(model->count[i] ? first && *first == model->value[i][0] : !first);
+		n += model->count[i] > 0;
+	}
+	avl_check(tree->int_size == n);
+	avl_check(avl_verify(tree->int_root) >= 0);
+	
+}
+
+
+
+/* 	Inserts a value into tree, or removes one of an ID's values, or at times the whole
+	ID, at random, doing the same to model. Returns the next value to insert */
+static long change(struct AVLtree* tree, struct model* model, unsigned long long* state, long next){
+	
+	void *data[VALUES];
+	long long id = avl_testRandom(state) % KEYS;
+	long j, roll = avl_testRandom(state) % 16, *count = &model->count[id];
+	
+	
+	if(!roll){
+		avl_remove(tree, id);
+		*count = 0;
+	} else if(roll < 9 && *count < VALUES){
+		avl_insert(tree, avl_testData(next), id);
+		model->value[id][(*count)++] = next++;
+	} else if(*count){
+		j = avl_testRandom(state) % *count;
+		avl_check(avl_searchAll(tree, id, data, VALUES) == *count);
+		avl_check(avl_removeOne(tree, id, data[j]));
+		(*count)--;
+		memmove(model->value[id] + j, model->value[id] + j + 1, (*count - j)*sizeof(long));
+	} else avl_check(!avl_removeOne(tree, id, NULL));
+	
+	
+	return next;
+	
+}
+
+
+
+/* 	Random insertions and removals, checked against the model now and then, then
+	an ID's values removed one by one, which takes its node only with the last one */
+static void changes(void){
+	
+	struct AVLtree *tree = avl_createTreeEx(AVL_MULTIMAP);
+	struct model model = {{0}, {{0}}};
+	unsigned long long state = 88172645463325252ull;
+	void *data[3];
+	long long id = KEYS - 1;
+	long i, next = 0, size, *value;
+	
+	
+	avl_check(!avl_countKey(tree, id));
+	avl_check(!avl_searchAll(tree, id, data, 3));
+	
+	for(i = 0; i < ROUNDS; i++){
+		next = change(tree, &model, &state, next);
+		if(!(i % 1000)) matches(tree, &model);
+	}
+	matches(tree, &model);
+	
+	
+	/* An ID of three values keeps its node until its last one is removed */
+	avl_remove(tree, id);
+	size = tree->int_size;
+	for(i = 0; i < 3; i++) avl_insert(tree, avl_testData(i), id);
+	avl_check(tree->int_size == size + 1 && avl_countKey(tree, id) == 3);
+	
+	avl_check(avl_searchAll(tree, id, data, 3) == 3);
+	avl_check(!avl_removeOne(tree, id, &next));
+	avl_check(avl_removeOne(tree, id, data[1]));
+	avl_check(avl_searchAll(tree, id, data, 3) == 2);
+	avl_check(*(long*)data[0] == 0 && *(long*)data[1] == 2);
+	avl_check(avl_removeOne(tree, id, data[0]));
+	avl_check(tree->int_size == size + 1 && avl_countKey(tree, id) == 1);
+	
+	avl_search(tree, id, value);
+	avl_check(value && *value == 2);
+	avl_check(avl_removeOne(tree, id, value));
+	avl_check(tree->int_size == size && !avl_countKey(tree, id));
+	avl_search(tree, id, value);
+	avl_check(!value);
+	avl_check(!avl_removeOne(tree, id, data[0]));
+	avl_check(avl_verify(tree->int_root) >= 0);
+	
+	
+	avl_free(tree);
+	
+}
+
+
+
+/* Collects values of a mapped range into arg, checking their IDs are all the same */
+static int collect(void* ID, void* data, void* arg){
+	
+	long *values = arg;
+	avl_check(*(long long*)ID == values[0]);
+	values[++values[1] + 1] = *(long*)data;
+	return 0;
+	
+}
+
+
+
+/* Saves a multimap, whose IDs are each saved once per value, and maps it back */
+static void saved(void){
+	
+	struct AVLtree *tree = avl_createTreeEx(AVL_MULTIMAP);
+	struct AVLmapped *mapped;
+	struct model model = {{0}, {{0}}};
+	unsigned long long state = 2463534242ull;
+	long long i;
+	long j, next = 0, total = 0, values[VALUES + 2], *data;
+	
+	
+	for(j = 0; j < ROUNDS; j++) next = change(tree, &model, &state, next);
+	avl_check(avl_save(tree, IMAGE, sizeof(long)));
+	avl_free(tree);
+	
+	avl_check((mapped = avl_openMapped(IMAGE)));
+	for(i = 0; i < KEYS; i++){
+		values[0] = i;
+		values[1] = 0;
+		avl_check(avl_mappedRange(mapped, i, i, collect, values) == model.count[i]);
+		for(j = 0; j < model.count[i]; j++) avl_check(values[j + 2] == model.value[i][j]);
+	
+		avl_mappedSearch(mapped, i, data);
+		avl_check(model.count[i] ? data && *data == model.value[i][0] : !data);
+		total += model.count[i];
+	}
+	avl_check(avl_mappedCount(mapped, (long long)0) == total);
+	avl_closeMapped(mapped);
+	unlink(IMAGE);
+	
+}
+
+
+
+/* 	A durable multimap logs each removed value, so opening it again, from its
+	checkpoint and its log, gets back each ID with the values it had left */
+static void durable(void){
+	
+	struct AVLtree *tree;
+	struct model model = {{0}, {{0}}};
+	unsigned long long state = 1181783497276652981ull;
+	long i, next = 0;
+	
+	
+	unlink(IMAGE);
+	unlink(LOG);
+	avl_check((tree = avl_openDurable(IMAGE, AVL_MULTIMAP, sizeof(long), 0, 0)));
+	for(i = 0; i < ROUNDS/4; i++) next = change(tree, &model, &state, next);
+	avl_check(avl_walCommit(tree));
+	avl_check(avl_checkpoint(tree));
+	
+	for(i = 0; i < ROUNDS/4; i++) next = change(tree, &model, &state, next);
+	avl_check(avl_walCommit(tree));
+	avl_free(tree);
+	
+	avl_check((tree = avl_openDurable(IMAGE, AVL_MULTIMAP, sizeof(long), 0, 0)));
+	matches(tree, &model);
+	avl_free(tree);
+	unlink(IMAGE);
+	unlink(LOG);
+	
+}
+
+
+
+int main(void){
+	
+	changes();
+	saved();
+	durable();
+	
+	
+	puts("multimap: ok");
+	return 0;
+	
+}
@@ -0,0 +1,162 @@
+#include <math.h>
+#include <string.h>
+
+#include "../avlbtree.h"
+#include "../avlpool.h"
+#include "test.h"
+
+
+
+/* How many IDs the biggest loads hold, and with how many workers pools are created, 0 being as many as CPUs */
+#define COUNT	100003
+
+static const int workers[] = {1, 2, 7, 0};
+
+
+
+/* Fills keys with n IDs from 0 up, each one 'repeat' times, in 'a'scending, 'd'escending or 'r'andom order */
+static void fill(long long* keys, long n, int repeat, char order){
+	
+	unsigned long long state = 88172645463325252ull;
+	long long swap;
+	long i, j;
+	
+	
+	for(i = 0; i < n; i++) keys[i] = ((order == 'd') ? n-1 - i : i) / repeat;
+	
+	if(order == 'r')
+		for(i = n-1; i > 0; i--){
+			j = avl_testRandom(&state) % (i+1);
+			swap = keys[i];
+			keys[i] = keys[j];
+			keys[j] = swap;
+		}
+	
+}
+
+
+
+/* 	Checks root holds n IDs, balanced, as a parallel traversal gets them: in ascending
+	order, each with its own value as data, and just the first ones if fewer are asked */
+static void check(struct AVLtree* tree, long n, struct AVLpool* pool){
+	
+	void **ID = malloc((n+1)*sizeof(void*)), **data = malloc((n+1)*sizeof(void*));
+	long height = tree->btree ? avl_btreeVerify(tree->btree->int_root) : avl_verify(tree->int_root), i;
+	
+	
+	avl_check(tree->int_size == n);
+	avl_check(height >= 0 && (tree->btree || height <= 1.4405*log2(n+2)));
+	avl_check(avl_parallelTraverse(tree, ID, data, n+1, (long long)0, pool) == n);
+	for(i = 0; i < n; i++){
+		avl_check(*(long*)data[i] == *(long long*)ID[i]);
+		if(i) avl_check(*(long long*)ID[i-1] <= *(long long*)ID[i]);
+	}
+	
+	memset(ID, 0, (n+1)*sizeof(void*));
+	avl_check(avl_parallelTraverse(tree, ID, NULL, n/2, (long long)0, pool) == n/2);
+	avl_check(!ID[n/2]);
+	for(i = 1; i < n/2; i++) avl_check(*(long long*)ID[i-1] <= *(long long*)ID[i]);
+	
+	
+	free(ID);
+	free(data);
+	
+}
+
+
+
+/* Loads n keys in parallel into a new tree with options, checks it and frees it in parallel */
+static void load(int options, const long long* keys, long n, struct AVLpool* pool){
+	
+	struct AVLtree *tree = avl_createTreeEx(options);
+	void **data = malloc((n+1)*sizeof(void*));
+	long i;
+	
+	
+	for(i = 0; i < n; i++) data[i] = avl_testData(keys[i]);
+	avl_check(avl_parallelBulkLoad(tree, keys, data, n, pool) == n);
+	check(tree, n, pool);
+	
+	avl_parallelFree(tree, pool);
+	free(data);
+	
+}
+
+
+
+/* 	Loads sorted, descending, shuffled and repeated keys of many sizes, with a pool of
+	each number of workers, then into a root holding IDs already, and string IDs as well */
+static void loads(void){
+	
+	static const long sizes[] = {0, 1, 2, 3, 17, 1000, COUNT};
+	long long *keys = malloc(COUNT*sizeof(long long));
+	char **strings = malloc(COUNT*sizeof(char*)), **ID = malloc(COUNT*sizeof(char*));
+	struct AVLpool *pool;
+	struct AVLtree *tree;
+	void **data = malloc(COUNT*sizeof(void*));
+	unsigned w, s, i;
+	
+	
+	for(i = 0; i < COUNT; i++){
+		strings[i] = malloc(16);
+		sprintf(strings[i], "id%07u", i);
+	}
+	
+	for(w = 0; w < sizeof(workers)/sizeof(*workers); w++){
+		pool = avl_createPool(workers[w]);
+	
+		for(s = 0; s < sizeof(sizes)/sizeof(*sizes); s++){
+			fill(keys, sizes[s], 1, 'a');
+			load(AVL_ENGINE_AVL, keys, sizes[s], pool);
+			load(AVL_CONCURRENT, keys, sizes[s], pool);
+			load(AVL_ENGINE_BTREE, keys, sizes[s], pool);
+			fill(keys, sizes[s], 1, 'd');
+			load(AVL_ENGINE_AVL, keys, sizes[s], pool);
+			fill(keys, sizes[s], 1, 'r');
+			load(AVL_ENGINE_AVL, keys, sizes[s], pool);
+			fill(keys, sizes[s], 3, 'a');
+			load(AVL_ENGINE_AVL, keys, sizes[s], pool);
+		}
+	
+	
+		/* A root with IDs already takes keys one by one */
+		tree = avl_createTree();
+		for(i = 0; i < 100; i++) avl_insert(tree, avl_testData(2*i + 1), (long long)(2*i + 1));
+		for(i = 0; i < 100; i++) data[i] = avl_testData(2*i);
+		for(i = 0; i < 100; i++) keys[i] = 2*i;
+		avl_check(avl_parallelBulkLoad(tree, keys, data, 100, pool) == 100);
+		check(tree, 200, pool);
+		avl_parallelFree(tree, pool);
+	
+	
+		/* Strings are copied into their nodes, in strcmp() order */
+		tree = avl_createTree();
+		avl_check(avl_parallelBulkLoad(tree, strings, NULL, COUNT, pool) == COUNT);
+		avl_check(tree->string_size == COUNT && avl_verify(tree->string_root) >= 0);
+		avl_check(avl_parallelTraverse(tree, (void**)ID, NULL, COUNT, "", pool) == COUNT);
+		for(i = 0; i < COUNT; i++) avl_check(ID[i] != strings[i] && !strcmp(ID[i], strings[i]));
+		avl_parallelFree(tree, pool);
+	
+		avl_freePool(pool);
+	}
+	
+	
+	for(i = 0; i < COUNT; i++) free(strings[i]);
+	free(strings);
+	free(ID);
+	free(keys);
+	free(data);
+	
+}
+
+
+
+int main(void){
+	
+	loads();
+	
+	
+	puts("parallel: ok");
+	return 0;
+	
+}
@@ -0,0 +1,164 @@
+#include <string.h>
+
+#include "../avltree.h"
+#include "test.h"
+
+
+
+/* 	IDs the tree may hold, 0 to KEYS - 1, each up to COPIES times, how many random
+	insertions and removals each workload does, and how many ranges follow every CHECK of them */
+#define KEYS	500
+#define COPIES	3
+#define ROUNDS	20000
+#define CHECK	500
+#define RANGES	50
+
+
+
+/* Counts the IDs a callback is passed, asking to stop once there are as many as arg holds */
+static int stops(void* ID, void* data, void* arg){
+	
+	long *left = arg;
+	avl_check(*(long*)data == *(long long*)ID);
+	return !--*left;
+	
+}
+
+
+
+/* 	Pulls the IDs from lo to hi out of tree, which must be just those model counts, as many
+	times each, in ascending order, then passes them to a callback stopping halfway */
+static void pulls(struct AVLtree* tree, const int* model, long long lo, long long hi){
+	
+	struct AVLrange range;
+	int seen[KEYS] = {0};
+	long long *ID, last = lo, i;
+	long *data, n = 0, left;
+	
+	
+	avl_rangeBegin(tree, &range, lo, hi);
+	while(avl_rangeNext(&range, (void**)&ID, (void**)&data)){
+		avl_check(*ID >= last && *ID <= hi && *ID >= 0 && *ID < KEYS);
+		avl_check(*data == *ID);
+		last = *ID;
+		seen[*ID]++;
+	}
+	avl_check(!avl_rangeNext(&range, NULL, NULL));
+	
+	for(i = 0; i < KEYS; i++){
+		avl_check(seen[i] == ((i >= lo && i <= hi) ? model[i] : 0));
+		n += seen[i];
+	}
+	
+	left = n/2 + 1;
+	avl_check(avl_range(tree, lo, hi, stops, &left) == (n ? n/2 + 1 : 0));
+	avl_check(left == (n ? 0 : 1));
+	
+}
+
+
+
+/* 	Inserts and removes IDs at random, each up to COPIES times, and pulls random ranges
+	out of the tree, reversed or out of bounds ones as well, checking them against a model */
+static void ranges(int options){
+	
+	struct AVLtree *tree = avl_createTreeEx(options);
+	struct AVLrange range;
+	unsigned long long state = 88172645463325252ull;
+	int model[KEYS] = {0};
+	long long id, lo, hi;
+	long i, j, n = 0;
+	
+	
+	/* An empty root has nothing to pull, whatever the range */
+	pulls(tree, model, 0, KEYS - 1);
+	pulls(tree, model, KEYS, -1);
+	
+	for(i = 1; i <= ROUNDS; i++){
+		id = avl_testRandom(&state) % KEYS;
+		if(model[id] < COPIES && avl_testRandom(&state) % 3){
+			avl_insert(tree, avl_testData(id), id);
+			model[id]++;
+			n++;
+		} else if(model[id]){
+			avl_remove(tree, id);
+			model[id]--;
+			n--;
+		}
+		if(i % CHECK) continue;
+	
+		avl_check(tree->int_size == n);
+		for(j = 0; j < RANGES; j++){
+			lo = (long long)(avl_testRandom(&state) % (KEYS + 20)) - 10;
+			hi = (j % 5) ? lo + (long long)(avl_testRandom(&state) % 100) : lo - 1;
+			pulls(tree, model, lo, hi);
+		}
+		pulls(tree, model, -100, KEYS + 100);
+		pulls(tree, model, id, id);
+	}
+	
+	
+	/* Other roots stay empty */
+	avl_rangeBegin(tree, &range, 0.0, 1e9);
+	avl_check(!avl_rangeNext(&range, NULL, NULL));
+	avl_rangeBegin(tree, &range, "", "~");
+	avl_check(!avl_rangeNext(&range, NULL, NULL));
+	
+	
+	avl_free(tree);
+	
+}
+
+
+
+/* String ranges go in strcmp() order, bounds included or not, whether they're IDs or not */
+static void strings(int options){
+	
+	struct AVLtree *tree = avl_createTreeEx(options);
+	struct AVLrange range;
+	char key[32], last[32] = "", *ID;
+	long i;
+	
+	
+	for(i = 0; i < KEYS; i++){
+		sprintf(key, "https://example.com/%05ld", (i * 7919) % KEYS);
+		avl_insert(tree, NULL, key);
+	}
+	
+	avl_rangeBegin(tree, &range, "https://example.com/00100", "https://example.com/00199");
+	for(i = 0; avl_rangeNext(&range, (void**)&ID, NULL); i++){
+		avl_check(strcmp(ID, last) > 0);
+		strcpy(last, ID);
+	}
+	avl_check(i == 100 && !strcmp(last, "https://example.com/00199"));
+	
+	avl_rangeBegin(tree, &range, "https://example.com/001", "https://example.com/002");
+	for(i = 0; avl_rangeNext(&range, NULL, NULL); i++);
+	avl_check(i == 100);
+	
+	avl_rangeBegin(tree, &range, "https://example.com/00200", "https://example.com/00100");
+	avl_check(!avl_rangeNext(&range, NULL, NULL));
+	
+	
+	avl_free(tree);
+	
+}
+
+
+
+int main(void){
+	
+	const int options[] = {0, AVL_CONCURRENT, AVL_RCU, AVL_HASH_INDEX, AVL_STRING_ARENA, AVL_ENGINE_BTREE};
+	int i;
+	
+	
+	for(i = 0; i < (int)(sizeof(options)/sizeof(int)); i++){
+		ranges(options[i]);
+		strings(options[i]);
+	}
+	
+	
+	puts("range: ok");
+	return 0;
+	
+}
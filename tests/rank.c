@@ -0,0 +1,159 @@
+#include <math.h>
+
+#include "../avltree.h"
+#include "test.h"
+
+
+
+/* 	IDs the tree may hold, 0 to KEYS - 1, each up to COPIES times, how many random
+	insertions and removals each workload does, and after how many the tree is checked */
+#define KEYS	500
+#define COPIES	3
+#define ROUNDS	20000
+#define CHECK	1000
+
+
+
+/* Checks the k-th smallest ID of tree, as avl_select() gets it, is id, with its own value as data, or that there's none if id is negative */
+static void selects(struct AVLtree* tree, long k, long long id){
+	
+	long long *ID = NULL;
+	long *data = NULL;
+	
+	
+	avl_check(avl_select(tree, (long long)0, k, (void**)&ID, (void**)&data) == (id >= 0));
+	if(id >= 0) avl_check(*ID == id && *data == id);
+	else avl_check(!ID && !data);
+	
+}
+
+
+
+/* Checks tree's ID at percentile p, as avl_percentile() gets it, is id, or that there's none if id is negative */
+static void percentiles(struct AVLtree* tree, double p, long long id){
+	
+	long long *ID = NULL;
+	
+	
+	avl_check(avl_percentile(tree, (long long)0, p, (void**)&ID, NULL) == (id >= 0));
+	if(id >= 0) avl_check(*ID == id);
+	else avl_check(!ID);
+	
+}
+
+
+
+/* 	Ranks every ID, and those past either end, selects every position, and those
+	out of the tree, and gets percentiles by the nearest rank, all against model */
+static void ranks(struct AVLtree* tree, const int* model, unsigned long long* state){
+	
+	long long sorted[KEYS * COPIES], i, below = 0;
+	long n = 0, k;
+	double p;
+	int c;
+	
+	
+	for(i = 0; i < KEYS; i++)
+		for(c = 0; c < model[i]; c++) sorted[n++] = i;
+	avl_check(tree->int_size == n);
+	
+	
+	/* An ID's rank counts the IDs lesser than it, whether it's there or not */
+	for(i = -2; i < KEYS + 2; i++){
+		avl_check(avl_rank(tree, i) == below);
+		if(i >= 0 && i < KEYS) below += model[i];
+	}
+	
+	for(k = -2; k < n + 2; k++) selects(tree, k, (k >= 0 && k < n) ? sorted[k] : -1);
+	
+	
+	/* The p-th percentile is the ceil(p*n)-th smallest ID, the first for p <= 0 and the last for p >= 1 */
+	percentiles(tree, -0.5, n ? sorted[0] : -1);
+	percentiles(tree, 0, n ? sorted[0] : -1);
+	percentiles(tree, 1, n ? sorted[n-1] : -1);
+	percentiles(tree, 1.5, n ? sorted[n-1] : -1);
+	for(c = 0; c < 50; c++){
+		p = (avl_testRandom(state) % 10001) / 10000.0;
+		k = (long)ceil(p*n) - 1;
+		percentiles(tree, p, n ? sorted[k < 0 ? 0 : k] : -1);
+	}
+	
+}
+
+
+
+/* 	Inserts and removes IDs at random, each up to COPIES times, checking ranks, selections
+	and percentiles against a model now and then, down to an empty tree at last */
+static void workload(int options){
+	
+	struct AVLtree *tree = avl_createTreeEx(options);
+	unsigned long long state = 88172645463325252ull;
+	int model[KEYS] = {0};
+	long long id, i;
+	
+	
+	ranks(tree, model, &state);
+	
+	for(i = 1; i <= ROUNDS; i++){
+		id = avl_testRandom(&state) % KEYS;
+		if(model[id] < COPIES && avl_testRandom(&state) % 3){
+			avl_insert(tree, avl_testData(id), id);
+			model[id]++;
+		} else if(model[id]){
+			avl_remove(tree, id);
+			model[id]--;
+		}
+		if(!(i % CHECK)) ranks(tree, model, &state);
+	}
+	
+	for(i = 0; i < KEYS; i++)
+		for(; model[i]; model[i]--) avl_remove(tree, i);
+	ranks(tree, model, &state);
+	
+	
+	avl_free(tree);
+	
+}
+
+
+
+/* Other roots, and engines whose roots aren't avl trees, rank nothing and have nothing to select */
+static void empty(int options){
+	
+	struct AVLtree *tree = avl_createTreeEx(options);
+	long long i;
+	
+	
+	for(i = 0; i < 100; i++) avl_insert(tree, avl_testData(i), i);
+	avl_check(avl_rank(tree, 50.0) == 0 && avl_rank(tree, "x") == 0);
+	avl_check(!avl_select(tree, 0.0, 0, NULL, NULL) && !avl_percentile(tree, "", 0.5, NULL, NULL));
+	
+	if(tree->int_root) avl_check(avl_rank(tree, (long long)50) == 50);
+	else {
+		avl_check(avl_rank(tree, (long long)50) == 0);
+		avl_check(!avl_select(tree, (long long)0, 0, NULL, NULL));
+		avl_check(!avl_percentile(tree, (long long)0, 0.5, NULL, NULL));
+	}
+	
+	
+	avl_free(tree);
+	
+}
+
+
+
+int main(void){
+	
+	workload(0);
+	workload(AVL_CONCURRENT);
+	workload(AVL_RCU);
+	workload(AVL_HASH_INDEX);
+	empty(0);
+	empty(AVL_ENGINE_BTREE);
+	empty(AVL_PERSISTENT);
+	
+	
+	puts("rank: ok");
+	return 0;
+	
+}
@@ -0,0 +1,160 @@
+/* alarm() is POSIX, which strict C11 headers leave out */
+#define _XOPEN_SOURCE 700
+
+#include <pthread.h>
+#include <unistd.h>
+
+#include "../avltree.h"
+#include "test.h"
+
+
+
+/* 	How many even IDs stay in the tree all along, and how many times each reader
+	and writer thread goes at it, while writers insert and remove odd IDs between them */
+#define STABLE	2000
+#define READERS	4
+#define WRITERS	2
+#define ROUNDS	50000
+
+
+
+/* What a range callback checks: the last ID it was passed, and how many even ones it saw */
+struct seen{
+	
+	long long last;
+	long evens;
+	
+};
+
+
+
+/* Checks IDs of a range come in ascending order, counting the even ones, which never leave */
+static int ascending(void* ID, void* data, void* arg){
+	
+	struct seen *seen = arg;
+	long long id = *(long long*)ID;
+	
+	
+	avl_check(id > seen->last);
+	avl_check(*(long*)data == id);
+	seen->last = id;
+	if(!(id % 2)) seen->evens++;
+	
+	
+	return 0;
+	
+}
+
+
+
+/* 	Searches, ranks and ranges through the tree with no lock, while writers rotate it
+	all around: even IDs must always be found, and ranges see each of them once, in order */
+static void* reader(void* arg){
+	
+	struct AVLtree *tree = arg;
+	unsigned long long state = 88172645463325252ull ^ (unsigned long long)pthread_self();
+	struct seen seen;
+	long long id, hi;
+	long i, rank, *data;
+	
+	
+	for(i = 0; i < ROUNDS; i++){
+		id = 2*(long long)(avl_testRandom(&state) % STABLE);
+	
+		avl_search(tree, id, data);
+		avl_check(data && *data == id);
+	
+		rank = avl_rank(tree, id);
+		avl_check(rank >= id/2 && rank <= id);
+	
+		if(!(i % 64)){
+			hi = id + 2*(long long)(avl_testRandom(&state) % 64);
+			seen.last = id - 1;
+			seen.evens = 0;
+			avl_range(tree, id, hi, ascending, &seen);
+			avl_check(seen.evens == (hi < 2*STABLE ? hi : 2*STABLE - 2) / 2 - id/2 + 1);
+		}
+	}
+	
+	
+	return NULL;
+	
+}
+
+
+
+/* 	Inserts and removes odd IDs of its own, one out of every WRITERS, at random,
+	keeping which ones it holds, and puts how many it holds at last into arg */
+static void* writer(void* arg){
+	
+	struct AVLtree *tree = ((void**)arg)[0];
+	long *held = ((void**)arg)[1], self = *held;
+	unsigned long long state = 2463534242ull + self;
+	char present[STABLE / WRITERS] = {0};
+	long long id;
+	long i, slot;
+	
+	
+	*held = 0;
+	for(i = 0; i < ROUNDS; i++){
+		slot = avl_testRandom(&state) % (STABLE / WRITERS);
+		id = 2*(slot*WRITERS + self) + 1;
+	
+		if(present[slot]) avl_check(avl_removeKey(tree, avl_getKeyType(id), avl_toKey(id)));
+		else avl_insert(tree, avl_testData(id), id);
+	
+		present[slot] = !present[slot];
+		*held += present[slot] ? 1 : -1;
+	}
+	
+	
+	return NULL;
+	
+}
+
+
+
+/* 	READERS readers go through an RCU tree while WRITERS writers change it, then the
+	tree must be balanced and hold every even ID and every odd one writers left there */
+static void concurrent(void){
+	
+	struct AVLtree *tree = avl_createTreeEx(AVL_RCU);
+	pthread_t threads[READERS + WRITERS];
+	void *args[WRITERS][2];
+	long held[WRITERS], total = STABLE;
+	long long i;
+	int t;
+	
+	
+	for(i = 0; i < STABLE; i++) avl_insert(tree, avl_testData(2*i), 2*i);
+	
+	alarm(120);
+	for(t = 0; t < WRITERS; t++){
+		held[t] = t;
+		args[t][0] = tree;
+		args[t][1] = &held[t];
+		pthread_create(&threads[READERS + t], NULL, writer, args[t]);
+	}
+	for(t = 0; t < READERS; t++) pthread_create(&threads[t], NULL, reader, tree);
+	for(t = 0; t < READERS + WRITERS; t++) pthread_join(threads[t], NULL);
+	alarm(0);
+	
+	for(t = 0; t < WRITERS; t++) total += held[t];
+	avl_check(tree->int_size == total);
+	avl_check(tree->int_root->size == (unsigned long)total);
+	avl_check(avl_verify(tree->int_root) >= 0);
+	avl_free(tree);
+	
+}
+
+
+
+int main(void){
+	
+	concurrent();
+	
+	
+	puts("rcu: ok");
+	return 0;
+	
+}
@@ -0,0 +1,138 @@
+/* alarm() is POSIX, which strict C11 headers leave out */
+#define _XOPEN_SOURCE 700
+
+#include <pthread.h>
+#include <unistd.h>
+
+#include "../avltree.h"
+#include "test.h"
+
+
+
+/* 	How many IDs each tree starts with, and how many times each thread runs its set
+	operations, on trees of SMALL IDs, so threads spend most of their time locking */
+#define COUNT	1000
+#define ROUNDS	200000
+#define SMALL	16
+
+
+
+/* Fills tree with IDs from 'from' to 'to', both inclusive, each one's data being itself */
+static void fill(struct AVLtree* tree, long long from, long long to){
+	for(; from <= to; from++) avl_insert(tree, avl_testData(from), from);
+}
+
+
+
+/* Checks tree holds exactly IDs from 'from' to 'to', both inclusive, in a balanced root */
+static void check(struct AVLtree* tree, long long from, long long to){
+	
+	long long i;
+	long *data;
+	
+	
+	avl_check(tree->int_size == to - from + 1);
+	avl_check(avl_verify(tree->int_root) >= 0);
+	for(i = from - 10; i <= to + 10; i++){
+		avl_search(tree, i, data);
+		avl_check((i >= from && i <= to) ? data && *data == i : !data);
+	}
+	
+}
+
+
+
+/* Results of union, intersection and difference of two overlapping trees */
+static void results(void){
+	
+	struct AVLtree *a = avl_createTree(), *b = avl_createTree();
+	
+	
+	fill(a, 0, COUNT-1);
+	fill(b, COUNT/2, COUNT + COUNT/2 - 1);
+	avl_check(avl_intersect(a, b));
+	check(a, COUNT/2, COUNT-1);
+	check(b, COUNT/2, COUNT + COUNT/2 - 1);
+	
+	avl_check(avl_difference(b, a));
+	check(b, COUNT, COUNT + COUNT/2 - 1);
+	
+	avl_check(avl_union(a, b));
+	check(a, COUNT/2, COUNT + COUNT/2 - 1);
+	avl_free(a);
+	
+}
+
+
+
+/* Both trees a thread runs set operations on, first taking from second */
+struct pair{
+	
+	struct AVLtree *first;
+	struct AVLtree *second;
+	
+};
+
+
+
+/* 	Intersects first with second, which soon leaves both trees with the same IDs, so
+	every round keeps going through them, then subtracts an empty tree, now and then */
+static void* filter(void* arg){
+	
+	struct pair *pair = arg;
+	struct AVLtree *empty = avl_createTreeEx(pair->first->options);
+	int i;
+	
+	
+	for(i = 0; i < ROUNDS; i++){
+		avl_intersect(pair->first, pair->second);
+		if(!(i % 16)) avl_difference(pair->first, empty);
+	}
+	
+	avl_free(empty);
+	
+	return NULL;
+	
+}
+
+
+
+/* 	Two threads intersect two concurrent trees with each other, in opposite
+	directions, which must not deadlock. A hang is ended by alarm() as a failure */
+static void opposite(int options){
+	
+	struct AVLtree *a = avl_createTreeEx(options), *b = avl_createTreeEx(options);
+	struct pair ab = {a, b}, ba = {b, a};
+	pthread_t threads[2];
+	
+	
+	fill(a, 0, SMALL-1);
+	fill(b, SMALL/2, SMALL + SMALL/2 - 1);
+	
+	alarm(20);
+	pthread_create(&threads[0], NULL, filter, &ab);
+	pthread_create(&threads[1], NULL, filter, &ba);
+	pthread_join(threads[0], NULL);
+	pthread_join(threads[1], NULL);
+	alarm(0);
+	
+	check(a, SMALL/2, SMALL-1);
+	check(b, SMALL/2, SMALL-1);
+	avl_free(a);
+	avl_free(b);
+	
+}
+
+
+
+int main(void){
+	
+	results();
+	opposite(AVL_CONCURRENT);
+	opposite(AVL_RCU);
+	
+	
+	puts("setops: ok");
+	return 0;
+	
+}
@@ -0,0 +1,134 @@
+#include <string.h>
+
+#include "../avlshard.h"
+#include "test.h"
+
+
+
+/* IDs the sharded trees hold, 0 to COUNT - 1, and how many random ranges are pulled out of each */
+#define COUNT	5000
+#define RANGES	200
+
+
+
+/* Counts the IDs a callback is passed, asking to stop once there are as many as arg holds */
+static int stops(void* ID, void* data, void* arg){
+	
+	long *left = arg;
+	avl_check(*(long*)data == *(long long*)ID);
+	return !--*left;
+	
+}
+
+
+
+/* 	Pulls IDs from lo to hi out of shards, which must come in ascending order, equal
+	ones one after another, each with its own value as data, as many as held tells */
+static void pulls(struct AVLshards* shards, const int* held, long long lo, long long hi){
+	
+	struct AVLshardRange range;
+	long long *ID, last = lo - 1, i;
+	long *data, n = 0, c = 0;
+	
+	
+	for(i = (lo > 0 ? lo : 0); i <= hi && i < COUNT; i++) n += held[i];
+	
+	avl_shardRangeBegin(shards, &range, lo, hi);
+	while(avl_shardRangeNext(&range, (void**)&ID, (void**)&data)){
+		avl_check(*ID >= last && *ID >= lo && *ID <= hi);
+		avl_check(*data == *ID);
+		last = *ID;
+		c++;
+	}
+	avl_check(!avl_shardRangeNext(&range, NULL, NULL));
+	avl_shardRangeEnd(&range);
+	avl_check(c == n);
+	
+}
+
+
+
+/* 	Fills 'count' shards with integer IDs by their hashes, then every tenth one
+	again into every shard, so equal IDs are spread among shards, and pulls
+	random ranges out of them, along with empty ones, then strings as well */
+static void ranges(int count, int options){
+	
+	struct AVLshards *shards = avl_createShards(count, options);
+	struct AVLshardRange range;
+	unsigned long long state = 88172645463325252ull;
+	int held[COUNT];
+	long long i, lo, hi;
+	long total = 0, left;
+	char key[16], last[16] = "", *ID;
+	int s;
+	
+	
+	for(i = 0; i < COUNT; i++){
+		avl_shardInsert(shards, avl_testData(i), i);
+		held[i] = 1;
+		if(i % 10) continue;
+		for(s = 0; s < count; s++) avl_insert(shards->trees[s], avl_testData(i), i);
+		held[i] += count;
+	}
+	for(i = 0; i < COUNT; i++) total += held[i];
+	avl_check(avl_shardCount(shards, (long long)0) == total);
+	
+	
+	/* Whole, random, single ID, reversed and out of bounds ranges */
+	pulls(shards, held, 0, COUNT - 1);
+	for(i = 0; i < RANGES; i++){
+		lo = avl_testRandom(&state) % COUNT;
+		hi = lo + avl_testRandom(&state) % 500;
+		pulls(shards, held, lo, hi);
+	}
+	pulls(shards, held, 10, 10);
+	pulls(shards, held, 11, 11);
+	pulls(shards, held, 200, 100);
+	pulls(shards, held, -100, -1);
+	pulls(shards, held, COUNT, COUNT + 100);
+	
+	
+	/* A callback stops the range early, and an empty root has nothing to pull */
+	left = 25;
+	avl_check(avl_shardRange(shards, (long long)0, (long long)COUNT, stops, &left) == 25);
+	avl_check(!left);
+	
+	avl_shardRangeBegin(shards, &range, 0.0, 1.0);
+	avl_check(!avl_shardRangeNext(&range, NULL, NULL));
+	avl_shardRangeEnd(&range);
+	
+	
+	/* String IDs, in strcmp() order across shards */
+	for(i = 0; i < COUNT; i++){
+		sprintf(key, "key%05lld", (i * 7919) % COUNT);
+		avl_shardInsert(shards, NULL, key);
+	}
+	avl_check(avl_shardCount(shards, "") == COUNT);
+	
+	avl_shardRangeBegin(shards, &range, "key01000", "key01999");
+	for(i = 0; avl_shardRangeNext(&range, (void**)&ID, NULL); i++){
+		avl_check(strcmp(ID, last) > 0);
+		strcpy(last, ID);
+	}
+	avl_shardRangeEnd(&range);
+	avl_check(i == 1000 && !strcmp(last, "key01999"));
+	
+	
+	avl_freeShards(shards);
+	
+}
+
+
+
+int main(void){
+	
+	ranges(1, 0);
+	ranges(4, 0);
+	ranges(7, AVL_RCU);
+	ranges(5, AVL_ENGINE_BTREE);
+	
+	
+	puts("shard: ok");
+	return 0;
+	
+}
@@ -0,0 +1,142 @@
+#include "../avlpersist.h"
+#include "test.h"
+
+
+
+/* How many IDs the tree starts with, 0 to COUNT - 1, and how many it gets past them later */
+#define COUNT	1000
+#define EXTRA	100
+
+
+
+/* 	Checks snapshot holds exactly the IDs from 0 to n - 1 which 'held' tells apart, with
+	their own values as datas, in ascending order. Freed datas would be caught by sanitizers */
+static void sees(struct AVLsnapshot* snapshot, long long n, int (*held)(long long)){
+	
+	void **ID = malloc(n*sizeof(void*)), **data = malloc(n*sizeof(void*));
+	long long i, c = 0;
+	long *value;
+	
+	
+	for(i = 0; i < n; i++){
+		avl_snapshotSearch(snapshot, i, value);
+		avl_check(held(i) ? value && *value == i : !value);
+		c += held(i);
+	}
+	avl_check(avl_snapshotCount(snapshot, (long long)0) == c);
+	avl_check(avl_snapshotTraverseInto(snapshot, ID, data, n, (long long)0) == c);
+	for(i = 0; i < c; i++){
+		avl_check(*(long*)data[i] == *(long long*)ID[i]);
+		if(i) avl_check(*(long long*)ID[i-1] < *(long long*)ID[i]);
+	}
+	
+	
+	free(ID);
+	free(data);
+	
+}
+
+
+
+/* Which IDs the tree holds at each stage: at first, after evens left and extras came, after lesser odds left, and after half the extras left */
+static int first(long long i){ return i < COUNT; }
+static int second(long long i){ return i % 2 || i >= COUNT; }
+static int third(long long i){ return second(i) && i >= COUNT/2; }
+static int fourth(long long i){ return third(i) && (i < COUNT || i >= COUNT + EXTRA/2); }
+
+
+
+/* Checks the live tree holds exactly the IDs from 0 to n - 1 which 'held' tells apart */
+static void live(struct AVLtree* tree, long long n, int (*held)(long long)){
+	
+	long long i, c = 0;
+	long *value;
+	
+	
+	for(i = 0; i < n; i++){
+		avl_search(tree, i, value);
+		avl_check(held(i) ? value && *value == i : !value);
+		c += held(i);
+	}
+	avl_check(tree->int_size == c);
+	avl_check(avl_persistVerify(tree->persist->int_root) >= 0);
+	
+}
+
+
+
+/* 	Three snapshots, taken between removals and insertions, each keep seeing the tree
+	as it was, while removed IDs and datas wait until no older snapshot is left */
+static void isolation(void){
+	
+	struct AVLtree *tree = avl_createTreeEx(AVL_PERSISTENT);
+	struct AVLsnapshot *a, *b, *c, *none;
+	long long i, n = COUNT + EXTRA;
+	
+	
+	/* A tree with no snapshot frees what's removed right away */
+	for(i = 0; i < COUNT; i++) avl_insert(tree, avl_testData(i), i);
+	avl_remove(tree, (long long)0);
+	avl_check(!tree->persist->deadCount);
+	avl_insert(tree, avl_testData(0), (long long)0);
+	
+	none = avl_snapshot(tree);
+	avl_releaseSnapshot(none);
+	avl_check(!tree->persist->snapshots);
+	
+	
+	/* 	a holds the evens removed after it, b the lesser odds, and c half
+		the extras, which came after a, so a never held them */
+	a = avl_snapshot(tree);
+	for(i = 0; i < COUNT; i += 2) avl_remove(tree, i);
+	for(i = COUNT; i < n; i++) avl_insert(tree, avl_testData(i), i);
+	avl_check(tree->persist->deadCount == COUNT/2);
+	sees(a, n, first);
+	live(tree, n, second);
+	
+	b = avl_snapshot(tree);
+	for(i = 1; i < COUNT/2; i += 2) avl_remove(tree, i);
+	avl_check(tree->persist->deadCount == COUNT/2 + COUNT/4);
+	sees(a, n, first);
+	sees(b, n, second);
+	live(tree, n, third);
+	
+	c = avl_snapshot(tree);
+	for(i = COUNT; i < COUNT + EXTRA/2; i++) avl_remove(tree, i);
+	avl_check(tree->persist->deadCount == COUNT/2 + COUNT/4 + EXTRA/2);
+	sees(c, n, third);
+	live(tree, n, fourth);
+	
+	
+	/* 	Releasing the middle one frees nothing, since a, older, still holds it all.
+		Releasing a then frees what it and b held, but not what c does */
+	avl_releaseSnapshot(b);
+	avl_check(tree->persist->deadCount == COUNT/2 + COUNT/4 + EXTRA/2);
+	sees(a, n, first);
+	sees(c, n, third);
+	
+	avl_releaseSnapshot(a);
+	avl_check(tree->persist->deadCount == EXTRA/2);
+	sees(c, n, third);
+	live(tree, n, fourth);
+	
+	avl_releaseSnapshot(c);
+	avl_check(!tree->persist->deadCount && !tree->persist->snapshots);
+	live(tree, n, fourth);
+	
+	
+	avl_free(tree);
+	
+}
+
+
+
+int main(void){
+	
+	isolation();
+	
+	
+	puts("snapshot: ok");
+	return 0;
+	
+}
@@ -0,0 +1,55 @@
+#ifndef __AVL_TEST__
+#define __AVL_TEST__
+
+
+
+#include <stdio.h>
+#include <stdlib.h>
+
+
+
+/**	@Functionality
+ *		Checks a condition of a test and, if it doesn't
+ *		hold, reports it, along with where it is, and ends
+ *		the test as a failure. Unlike assert(), it's never
+ *		compiled out.
+ *
+ *	@Argument
+ *		? condition:	any scalar expression, which must be non zero.
+ *
+ *	@Return
+ *		None
+ *
+ */
+#define avl_check(condition)													\
+		do {																	\
+																				\
+			if(!(condition)){													\
+				fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, #condition);	\
+				exit(1);														\
+			}																	\
+																				\
+		} while(0)
+
+
+
+/* Gets the next pseudo random number of a xorshift state, which must not start at 0, so runs can be repeated */
+static inline unsigned long long avl_testRandom(unsigned long long* state){
+	*state ^= *state << 13;
+	*state ^= *state >> 7;
+	*state ^= *state << 17;
+	return *state;
+}
+
+
+
+/* Gets a heap copy of value, as a data a super avl tree may own and free */
+static inline long* avl_testData(long value){
+	long *data = malloc(sizeof(long));
+	*data = value;
+	return data;
+}
+
+
+
+#endif
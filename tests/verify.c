@@ -0,0 +1,174 @@
+#include <math.h>
+#include <string.h>
+
+#include "../avlbtree.h"
+#include "test.h"
+
+
+
+/* How many IDs each workload inserts */
+#define COUNT	100000
+
+
+
+/* Fills keys with 0 to n-1 in 'r'andom, 'a'scending or 'd'escending order */
+static void fill(long long* keys, long n, char order){
+	
+	unsigned long long state = 88172645463325252ull;
+	long long swap;
+	long i, j;
+	
+	
+	for(i = 0; i < n; i++) keys[i] = (order == 'd') ? n-1 - i : i;
+	
+	if(order == 'r')
+		for(i = n-1; i > 0; i--){
+			j = avl_testRandom(&state) % (i+1);
+			swap = keys[i];
+			keys[i] = keys[j];
+			keys[j] = swap;
+		}
+	
+}
+
+
+
+/* 	Checks root holds the avl properties, with a height no greater than 1.44*log2(n+2), or,
+	on a B+ tree engine, its B+ tree holds its own, with nodes at least half full, and its IDs in order */
+static void check(struct AVLtree* tree, struct AVLtree_sub* root, long n, char type){
+	
+	void **ID = malloc((n+1)*sizeof(void*));
+	long height = tree->btree ? avl_btreeVerify(*avl_btreeRoot(tree->btree, type)) : avl_verify(root), i;
+	
+	
+	avl_check(height >= 0);
+	avl_check(height <= (tree->btree ? 1 + log2(n+1)/log2(AVL_BTREE_MIN+1) : 1.4405*log2(n+2)));
+	avl_check(avl_traverseRoot(tree, type, ID, NULL, n) == n);
+	
+	for(i = 1; i < n; i++)
+		avl_check(type == 'c' ? strcmp(ID[i-1], ID[i]) < 0 : avl_keyCompare(type, ID[i-1], ID[i]) < 0);
+	
+	
+	free(ID);
+	
+}
+
+
+
+/* Gets the k-th ID of a workload on root 'type': ints and reals around 0, unsigned ints around the middle of their range */
+static union AVLkey number(char type, long long k){
+	switch(type){
+		case 'u': return avl_uintegerKey((1ull << 63) + k - COUNT/2);
+		case 'd': return avl_realKey((k - COUNT/2) * 0.5L);
+	}
+	return avl_integerKey(k - COUNT/2);
+}
+
+
+
+/* Gets tree's root of 'type' and how many IDs it holds */
+static struct AVLtree_sub* rooted(struct AVLtree* tree, char type, long* size){
+	switch(type){
+		case 'u': *size = tree->uint_size; return tree->uint_root;
+		case 'd': *size = tree->double_size; return tree->double_root;
+	}
+	*size = tree->int_size;
+	return tree->int_root;
+}
+
+
+
+/* 	Inserts n numeric IDs of root 'type' in order, then removes every other one and,
+	at last, the rest, checking the root after each step */
+static void numbers(int options, char order, char type){
+	
+	struct AVLtree *tree = avl_createTreeEx(options);
+	long long *keys = malloc(COUNT*sizeof(long long));
+	long *data, size;
+	long i;
+	
+	
+	fill(keys, COUNT, order);
+	for(i = 0; i < COUNT; i++) avl_insertKey(tree, type, number(type, keys[i]), avl_testData(keys[i]));
+	check(tree, rooted(tree, type, &size), COUNT, type);
+	avl_check(size == COUNT);
+	
+	for(i = 0; i < COUNT; i += 2) avl_check(avl_removeKey(tree, type, number(type, keys[i])));
+	check(tree, rooted(tree, type, &size), COUNT/2, type);
+	avl_check(size == COUNT/2);
+	
+	for(i = 0; i < COUNT; i++){
+		data = avl_searchData(tree, type, number(type, keys[i]));
+		avl_check(i % 2 ? data && *data == keys[i] : !data);
+	}
+	
+	for(i = 1; i < COUNT; i += 2) avl_check(avl_removeKey(tree, type, number(type, keys[i])));
+	avl_check(!rooted(tree, type, &size) && !size);
+	avl_check(!tree->btree || !*avl_btreeRoot(tree->btree, type));
+	
+	
+	free(keys);
+	avl_free(tree);
+	
+}
+
+
+
+/* Same as integers(), with string IDs sharing a long prefix, as URLs do */
+static void strings(int options, char order){
+	
+	struct AVLtree *tree = avl_createTreeEx(options);
+	long long *keys = malloc(COUNT*sizeof(long long));
+	char (*ID)[40] = malloc(COUNT*sizeof(*ID));
+	long *data;
+	long i;
+	
+	
+	fill(keys, COUNT, order);
+	for(i = 0; i < COUNT; i++){
+		sprintf(ID[i], "https://example.com/item/%08lld", keys[i]);
+		avl_insert(tree, avl_testData(keys[i]), (char*)ID[i]);
+	}
+	avl_check(tree->string_size == COUNT);
+	check(tree, tree->string_root, COUNT, 'c');
+	
+	for(i = 0; i < COUNT; i += 2) avl_remove(tree, (char*)ID[i]);
+	check(tree, tree->string_root, COUNT/2, 'c');
+	
+	for(i = 0; i < COUNT; i++){
+		avl_search(tree, (char*)ID[i], data);
+		avl_check(i % 2 ? data && *data == keys[i] : !data);
+	}
+	
+	for(i = 1; i < COUNT; i += 2) avl_remove(tree, (char*)ID[i]);
+	avl_check(!tree->string_root && !tree->string_size);
+	avl_check(!tree->btree || !tree->btree->string_root);
+	
+	
+	free(keys);
+	free(ID);
+	avl_free(tree);
+	
+}
+
+
+
+int main(void){
+	
+	const int options[] = {0, AVL_CONCURRENT, AVL_RCU, AVL_HASH_INDEX, AVL_STRING_ARENA, AVL_ENGINE_BTREE};
+	const char *orders = "rad", *types = "iud";
+	int i, j, k;
+	
+	
+	/* Every workload order, on every root of every option whose IDs are kept in avl roots, or in B+ trees */
+	for(i = 0; i < (int)(sizeof(options)/sizeof(int)); i++)
+		for(j = 0; j < 3; j++){
+			for(k = 0; k < 3; k++) numbers(options[i], orders[j], types[k]);
+			strings(options[i], orders[j]);
+		}
+	
+	
+	puts("verify: ok");
+	return 0;
+	
+}
@@ -0,0 +1,352 @@
+/* unlink() is POSIX, which strict C11 headers leave out */
+#define _XOPEN_SOURCE 700
+
+#include <pthread.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../avlwal.h"
+#include "test.h"
+
+
+
+/* IDs the durable tree may hold, 0 to COUNT - 1 */
+#define COUNT	1000
+
+/* Threads inserting at once, each its own IDs, while another one removes some through an iterator */
+#define WRITERS	3
+
+/* Where the checkpoint is written, beside its log */
+#define IMAGE	"wal.test.img"
+#define LOG		"wal.test.img.log"
+
+
+
+/* Opens the durable tree at IMAGE with options, logging datas whole, and committing only when asked */
+static struct AVLtree* reopen(int options){
+	
+	struct AVLtree *tree = avl_openDurable(IMAGE, options, sizeof(long), 0, 0);
+	avl_check(tree);
+	return tree;
+	
+}
+
+
+
+/* Checks tree holds exactly the IDs model marks, each along with its own value as data */
+static void matches(struct AVLtree* tree, const char* model){
+	
+	long long i, n = 0;
+	long *data;
+	
+	
+	for(i = 0; i < COUNT; i++){
+		avl_search(tree, i, data);
+		avl_check(model[i] ? (data && *data == i) : !data);
+		n += model[i];
+	}
+	avl_check(tree->int_size == n);
+	
+}
+
+
+
+/* A tree of the IDs from lo to hi, not durable, to be joined into or filter a durable one */
+static struct AVLtree* ranged(long long lo, long long hi){
+	
+	struct AVLtree *tree = avl_createTree();
+	for(; lo <= hi; lo++) avl_insert(tree, avl_testData(lo), lo);
+	return tree;
+	
+}
+
+
+
+/* 	Changes a durable tree in every way, logged or not, committing each one, then freeing
+	and opening the tree again, which must recover the very same IDs every time */
+static void changes(int options){
+	
+	struct AVLtree *tree, *other;
+	struct AVLtree_sub *left, *node, *right;
+	struct AVLiter iter;
+	char model[COUNT] = {0};
+	long long i, *ID;
+	long *data;
+	
+	
+	unlink(IMAGE);
+	unlink(LOG);
+	tree = reopen(options);
+	for(i = 0; i < 100; i++){
+		avl_insert(tree, avl_testData(i), i);
+		model[i] = 1;
+	}
+	avl_check(avl_walCommit(tree));
+	
+	
+	/* A union isn't logged, though what's changed after it is */
+	avl_check(avl_union(tree, ranged(100, 199)));
+	for(i = 100; i <= 199; i++) model[i] = 1;
+	avl_remove(tree, (long long)150);
+	avl_insert(tree, avl_testData(200), (long long)200);
+	model[150] = 0;
+	model[200] = 1;
+	avl_check(avl_walCommit(tree));
+	avl_free(tree);
+	tree = reopen(options);
+	matches(tree, model);
+	
+	
+	/* Nodes an iterator removes under the root's lock are logged one by one */
+	avl_writeLock(tree, (long long)0);
+	for(avl_iterFirst(tree, &iter, (long long)0); iter.node; ){
+		node = iter.node;
+		avl_iterGet(&iter, (void**)&ID, (void**)&data);
+		avl_iterNext(&iter);
+		if(*ID < 50 && *ID % 2 == 0){
+			model[*ID] = 0;
+			avl_removeNode(tree, node);
+		}
+	}
+	avl_unlock(tree, (long long)0);
+	avl_check(avl_walCommit(tree));
+	avl_free(tree);
+	tree = reopen(options);
+	matches(tree, model);
+	
+	
+	/* A split and its join, each followed by a logged insertion */
+	node = avl_split(tree, (long long)120, &left, &right);
+	avl_check(node);
+	avl_insert(tree, avl_testData(300), (long long)300);
+	avl_check(avl_walCommit(tree));
+	avl_free(tree);
+	
+	tree = reopen(options);
+	avl_check(tree->int_size == 1);
+	avl_remove(tree, (long long)300);
+	node = avl_split(tree, (long long)120, &left, &right);
+	avl_check(!node && !left && !right);
+	
+	
+	/* 	Split nodes stay in their tree, so it's refilled, then
+		split and joined back together right away */
+	for(i = 0; i < COUNT; i++){
+		if(model[i]) avl_insert(tree, avl_testData(i), i);
+	}
+	node = avl_split(tree, (long long)120, &left, &right);
+	avl_check(node && avl_join(tree, (long long)0, left, node, right));
+	avl_insert(tree, avl_testData(301), (long long)301);
+	model[301] = 1;
+	avl_check(avl_walCommit(tree));
+	avl_free(tree);
+	tree = reopen(options);
+	matches(tree, model);
+	
+	
+	/* An intersection and a difference, neither logged */
+	other = ranged(0, 180);
+	avl_insert(other, avl_testData(301), (long long)301);
+	avl_check(avl_intersect(tree, other));
+	avl_free(other);
+	for(i = 181; i < COUNT; i++) model[i] &= i == 301;
+	
+	other = ranged(0, 9);
+	avl_check(avl_difference(tree, other));
+	avl_free(other);
+	for(i = 0; i <= 9; i++) model[i] = 0;
+	
+	avl_remove(tree, (long long)11);
+	model[11] = 0;
+	avl_insert(tree, avl_testData(302), (long long)302);
+	model[302] = 1;
+	avl_check(avl_walCommit(tree));
+	avl_free(tree);
+	tree = reopen(options);
+	matches(tree, model);
+	avl_free(tree);
+	
+	unlink(IMAGE);
+	unlink(LOG);
+	
+}
+
+
+
+/* 	Crashes a durable tree once bytes more are written, during insertions committed one
+	at a time after a set operation, and checks the recovered tree holds every committed
+	one, along with some, or none, of the next ones, in order, but nothing else */
+static void crashes(int options, long bytes){
+	
+	struct AVLtree *tree;
+	char model[COUNT] = {0};
+	long long i, committed = 500;
+	long *data;
+	size_t size;
+	int round;
+	
+	
+	unlink(IMAGE);
+	unlink(LOG);
+	tree = reopen(options);
+	for(i = 0; i < 400; i++){
+		avl_insert(tree, avl_testData(i), i);
+		model[i] = 1;
+	}
+	avl_check(avl_walCommit(tree));
+	avl_check(avl_union(tree, ranged(400, 499)));
+	for(i = 400; i < 500; i++) model[i] = 1;
+	
+	
+	avl_walCrash(tree, bytes);
+	for(i = 500; i < 600; i++){
+		avl_insert(tree, avl_testData(i), i);
+		if(avl_walCommit(tree)) committed = i + 1;
+	}
+	
+	/* 	Unless every commit got through, the log failed, and keeps none of
+		the changes made afterwards, not even in memory */
+	if(committed < 600){
+		avl_check(!tree->wal->used);
+		size = tree->wal->size;
+		for(round = 0; round < 20; round++){
+			for(i = 600; i < COUNT; i++) avl_insert(tree, avl_testData(i), i);
+			for(i = 600; i < COUNT; i++) avl_remove(tree, i);
+		}
+		avl_insert(tree, avl_testData(COUNT - 1), (long long)(COUNT - 1));
+		avl_check(!tree->wal->used && tree->wal->size == size);
+	}
+	avl_free(tree);
+	
+	
+	tree = reopen(options);
+	for(i = 500; i < 600; i++){
+		avl_search(tree, i, data);
+		if(!data) break;
+		avl_check(*data == i);
+		model[i] = 1;
+	}
+	avl_check(i >= committed);
+	matches(tree, model);
+	avl_free(tree);
+	
+	unlink(IMAGE);
+	unlink(LOG);
+	
+}
+
+
+
+/* A thread inserting into a durable tree, and the first of its IDs */
+struct Writer{
+	
+	struct AVLtree *tree;
+	long long first;
+	
+};
+
+
+
+/* Inserts writer's IDs, COUNT/WRITERS of them, one by one */
+static void* inserter(void* arg){
+	
+	struct Writer *writer = arg;
+	long long i;
+	
+	
+	for(i = writer->first; i < writer->first + COUNT/WRITERS; i++) avl_insert(writer->tree, avl_testData(i), i);
+	return NULL;
+	
+}
+
+
+
+/* Removes every ID found that's a multiple of 7, through an iterator under the root's lock, over and over */
+static void* remover(void* arg){
+	
+	struct AVLtree *tree = arg;
+	struct AVLtree_sub *node;
+	struct AVLiter iter;
+	long long *ID;
+	int round;
+	
+	
+	for(round = 0; round < 50; round++){
+		avl_writeLock(tree, (long long)0);
+		for(avl_iterFirst(tree, &iter, (long long)0); iter.node; ){
+			node = iter.node;
+			avl_iterGet(&iter, (void**)&ID, NULL);
+			avl_iterNext(&iter);
+			if(*ID % 7 == 0) avl_removeNode(tree, node);
+		}
+		avl_unlock(tree, (long long)0);
+	}
+	
+	
+	return NULL;
+	
+}
+
+
+
+/* 	Writers race each other and checkpoints, every few records, on a concurrent durable
+	tree, which must then recover just what it held once they were all over */
+static void racing(int options){
+	
+	struct AVLtree *tree;
+	pthread_t threads[WRITERS + 1];
+	struct Writer writers[WRITERS];
+	long long i;
+	char model[COUNT];
+	long *data;
+	int t;
+	
+	
+	unlink(IMAGE);
+	unlink(LOG);
+	tree = avl_openDurable(IMAGE, options, sizeof(long), 0, 16);
+	avl_check(tree);
+	for(t = 0; t < WRITERS; t++){
+		writers[t] = (struct Writer){tree, t*(COUNT/WRITERS)};
+		pthread_create(&threads[t], NULL, inserter, &writers[t]);
+	}
+	pthread_create(&threads[WRITERS], NULL, remover, tree);
+	for(t = 0; t <= WRITERS; t++) pthread_join(threads[t], NULL);
+	
+	
+	for(i = 0; i < COUNT; i++){
+		avl_search(tree, i, data);
+		model[i] = data != NULL;
+	}
+	avl_check(avl_walCommit(tree));
+	avl_free(tree);
+	
+	tree = reopen(options);
+	matches(tree, model);
+	avl_free(tree);
+	
+	unlink(IMAGE);
+	unlink(LOG);
+	
+}
+
+
+
+int main(void){
+	
+	const int options[] = {0, AVL_CONCURRENT, AVL_RCU};
+	const long bytes[] = {0, 1, 40, 100, 1000, 5000};
+	unsigned long i, j;
+	
+	
+	for(i = 0; i < sizeof(options)/sizeof(int); i++){
+		changes(options[i]);
+		if(options[i]) racing(options[i]);
+		for(j = 0; j < sizeof(bytes)/sizeof(long); j++) crashes(options[i], bytes[j]);
+	}
+	
+	
+	printf("wal: ok\n");
+	return 0;
+	
+}